@@ -13,8 +13,36 @@
 #include <getopt.h>
 
 #include <odp_api.h>
+#include <odp/helper/odph_api.h>
 
 #define START_OFFSET_NS ((uint64_t)(300 * ODP_TIME_MSEC_IN_NS))
+#define MAX_WORKERS     32
+
+typedef struct test_stat_t {
+	uint64_t after;
+	uint64_t min_after;
+	uint64_t max_after;
+	uint64_t before;
+	uint64_t min_before;
+	uint64_t max_before;
+	uint64_t num_after;
+	uint64_t num_before;
+	uint64_t num_exact;
+	uint64_t first_ns;
+	uint64_t last_ns;
+
+} test_stat_t;
+
+typedef struct test_worker_t {
+	odp_schedule_group_t group;
+	odp_queue_t      queue;
+	odp_timer_pool_t timer_pool;
+	odp_timer_t     *timer;
+	int64_t         *error_ns;
+	uint64_t         first_ns;
+	test_stat_t      stat;
+
+} test_worker_t;
 
 typedef struct test_global_t {
 	struct {
@@ -22,14 +50,17 @@ typedef struct test_global_t {
 		unsigned long long int res_ns;
 		int num;
 		int init;
+		int num_worker;
+		int private;
 	} opt;
 
-	odp_queue_t      queue;
 	odp_timer_pool_t timer_pool;
 	odp_pool_t       timeout_pool;
-	odp_timer_t     *timer;
 	uint64_t         period_ns;
-	uint64_t         first_ns;
+	odp_atomic_u32_t worker_idx;
+	odp_shm_t        error_shm;
+	int64_t         *error_ns;
+	test_worker_t    worker[MAX_WORKERS];
 
 } test_global_t;
 
@@ -39,11 +70,18 @@ static void print_usage(void)
 	       "Timer accuracy test application.\n"
 	       "\n"
 	       "OPTIONS:\n"
-	       "  -p, --period <nsec>     Timeout period. Default: 200 milliseconds\n"
+	       "  -p, --period <nsec>     Timeout period. Default: 200 msec\n"
 	       "  -r, --resolution <nsec> Timeout resolution. Default: period / 10\n"
-	       "  -n, --num <number>      Number of timeouts. Default: 50\n"
+	       "  -n, --num <number>      Number of timeouts per worker. Default: 50\n"
+	       "  -w, --workers <number>  Number of worker threads. Default: 1\n"
+	       "  -P, --private           Each worker creates a private timer pool\n"
+	       "                          (param.priv = 1). Default: one shared pool.\n"
 	       "  -i, --init              Set global init parameters. Default: init params not set.\n"
-	       "  -h, --help              Display help and exit.\n\n");
+	       "  -h, --help              Display help and exit.\n"
+	       "\n"
+	       "Timer pools are processed by a thread per pool, unless -i is used.\n"
+	       "Select the thread backend with 'timer.backend' in ODP_CONFIG_FILE\n"
+	       "to compare timeout jitter between backends.\n\n");
 }
 
 static int parse_options(int argc, char *argv[], test_global_t *test_global)
@@ -53,17 +91,21 @@ static int parse_options(int argc, char *argv[], test_global_t *test_global)
 		{"period",     required_argument, NULL, 'p'},
 		{"resolution", required_argument, NULL, 'r'},
 		{"num",        required_argument, NULL, 'n'},
+		{"workers",    required_argument, NULL, 'w'},
+		{"private",    no_argument,       NULL, 'P'},
 		{"init",       no_argument,       NULL, 'i'},
 		{"help",       no_argument,       NULL, 'h'},
 		{NULL, 0, NULL, 0}
 	};
-	const char *shortopts =  "+p:r:n:ih";
+	const char *shortopts =  "+p:r:n:w:Pih";
 	int ret = 0;
 
-	test_global->opt.period_ns = 200 * ODP_TIME_MSEC_IN_NS;
-	test_global->opt.res_ns    = 0;
-	test_global->opt.num       = 50;
-	test_global->opt.init      = 0;
+	test_global->opt.period_ns  = 200 * ODP_TIME_MSEC_IN_NS;
+	test_global->opt.res_ns     = 0;
+	test_global->opt.num        = 50;
+	test_global->opt.init       = 0;
+	test_global->opt.num_worker = 1;
+	test_global->opt.private    = 0;
 
 	while (1) {
 		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
@@ -81,6 +123,12 @@ static int parse_options(int argc, char *argv[], test_global_t *test_global)
 		case 'n':
 			test_global->opt.num = atoi(optarg);
 			break;
+		case 'w':
+			test_global->opt.num_worker = atoi(optarg);
+			break;
+		case 'P':
+			test_global->opt.private = 1;
+			break;
 		case 'i':
 			test_global->opt.init = 1;
 			break;
@@ -98,56 +146,91 @@ static int parse_options(int argc, char *argv[], test_global_t *test_global)
 	if (test_global->opt.res_ns == 0)
 		test_global->opt.res_ns = test_global->opt.period_ns / 10;
 
+	if (test_global->opt.num_worker < 1 ||
+	    test_global->opt.num_worker > MAX_WORKERS) {
+		printf("Number of workers must be 1 ... %i\n", MAX_WORKERS);
+		ret = -1;
+	}
+
 	return ret;
 }
 
-static int start_timers(test_global_t *test_global)
+static odp_timer_pool_t create_timer_pool(test_global_t *test_global,
+					  const char *name, int num_timers,
+					  int priv)
+{
+	odp_timer_pool_param_t timer_param;
+	odp_timer_pool_t timer_pool;
+	uint64_t period_ns = test_global->period_ns;
+
+	memset(&timer_param, 0, sizeof(odp_timer_pool_param_t));
+
+	timer_param.res_ns     = test_global->opt.res_ns;
+	timer_param.min_tmo    = period_ns;
+	timer_param.max_tmo    = START_OFFSET_NS +
+				 (test_global->opt.num * period_ns);
+	timer_param.num_timers = num_timers;
+	timer_param.priv       = priv;
+	timer_param.clk_src    = ODP_CLOCK_CPU;
+
+	timer_pool = odp_timer_pool_create(name, &timer_param);
+
+	if (timer_pool == ODP_TIMER_POOL_INVALID) {
+		printf("Timer pool create failed\n");
+		return ODP_TIMER_POOL_INVALID;
+	}
+
+	odp_timer_pool_start();
+
+	return timer_pool;
+}
+
+static int create_pools(test_global_t *test_global)
 {
 	odp_pool_t pool;
 	odp_pool_param_t pool_param;
-	odp_timer_pool_t timer_pool;
-	odp_timer_pool_param_t timer_param;
 	odp_timer_capability_t timer_capa;
-	odp_timer_t timer;
-	odp_queue_t queue;
-	odp_queue_param_t queue_param;
-	uint64_t tick, start_tick;
-	uint64_t period_ns, res_ns, start_ns, time_ns, res_capa;
-	odp_event_t event;
-	odp_timeout_t timeout;
-	odp_timer_set_t ret;
-	odp_time_t time;
-	int i, num;
+	uint64_t period_ns, res_ns, max_tmo, res_capa;
+	int num, num_worker;
 
 	num = test_global->opt.num;
+	num_worker = test_global->opt.num_worker;
 	period_ns = test_global->opt.period_ns;
+	res_ns = test_global->opt.res_ns;
+	max_tmo = START_OFFSET_NS + (num * period_ns);
 	test_global->period_ns = period_ns;
 
-	/* Always init globals for destroy calls */
-	test_global->queue = ODP_QUEUE_INVALID;
-	test_global->timer_pool = ODP_TIMER_POOL_INVALID;
-	test_global->timeout_pool = ODP_POOL_INVALID;
-
-	for (i = 0; i < num; i++)
-		test_global->timer[i] = ODP_TIMER_INVALID;
+	if (odp_timer_capability(ODP_CLOCK_CPU, &timer_capa)) {
+		printf("Timer capa failed\n");
+		return -1;
+	}
 
-	odp_queue_param_init(&queue_param);
-	queue_param.type        = ODP_QUEUE_TYPE_SCHED;
-	queue_param.sched.prio  = ODP_SCHED_PRIO_DEFAULT;
-	queue_param.sched.sync  = ODP_SCHED_SYNC_ATOMIC;
-	queue_param.sched.group = ODP_SCHED_GROUP_ALL;
+	res_capa = timer_capa.highest_res_ns;
 
-	queue = odp_queue_create("timeout_queue", &queue_param);
-	if (queue == ODP_QUEUE_INVALID) {
-		printf("Queue create failed.\n");
+	if (res_ns < res_capa) {
+		printf("Resolution %" PRIu64 " nsec too high. "
+		       "Highest resolution %" PRIu64 " nsec. "
+		       "Default resolution is period / 10.\n\n",
+		       res_ns, res_capa);
 		return -1;
 	}
 
-	test_global->queue = queue;
+	printf("\nTest parameters:\n");
+	printf("  resolution capa: %" PRIu64 " nsec\n", res_capa);
+	printf("  start offset:    %" PRIu64 " nsec\n", START_OFFSET_NS);
+	printf("  period:          %" PRIu64 " nsec\n", period_ns);
+	printf("  resolution:      %" PRIu64 " nsec\n", res_ns);
+	printf("  min timeout:     %" PRIu64 " nsec\n", period_ns);
+	printf("  max timeout:     %" PRIu64 " nsec\n", max_tmo);
+	printf("  num timeout:     %i per worker\n", num);
+	printf("  num workers:     %i\n", num_worker);
+	printf("  timer pools:     %s\n", test_global->opt.private ?
+	       "private per worker" : "shared");
+	printf("  test run time:   %.1f sec\n\n", max_tmo / 1000000000.0);
 
 	odp_pool_param_init(&pool_param);
 	pool_param.type    = ODP_POOL_TIMEOUT;
-	pool_param.tmo.num = num;
+	pool_param.tmo.num = num * num_worker;
 
 	pool = odp_pool_create("timeout pool", &pool_param);
 
@@ -158,52 +241,80 @@ static int start_timers(test_global_t *test_global)
 
 	test_global->timeout_pool = pool;
 
-	if (odp_timer_capability(ODP_CLOCK_CPU, &timer_capa)) {
-		printf("Timer capa failed\n");
+	/* Workers create private pools by themselves */
+	if (test_global->opt.private)
+		return 0;
+
+	test_global->timer_pool = create_timer_pool(test_global,
+						    "timer_accuracy",
+						    num * num_worker, 0);
+
+	if (test_global->timer_pool == ODP_TIMER_POOL_INVALID)
 		return -1;
-	}
 
-	res_capa = timer_capa.highest_res_ns;
+	return 0;
+}
 
-	res_ns = test_global->opt.res_ns;
+static int start_timers(test_global_t *test_global, test_worker_t *worker,
+			int idx)
+{
+	odp_pool_t pool = test_global->timeout_pool;
+	odp_timer_pool_t timer_pool;
+	odp_timer_t timer;
+	odp_queue_t queue;
+	odp_queue_param_t queue_param;
+	odp_thrmask_t thrmask;
+	uint64_t tick, start_tick;
+	uint64_t period_ns, start_ns, time_ns;
+	odp_event_t event;
+	odp_timeout_t timeout;
+	odp_timer_set_t ret;
+	odp_time_t time;
+	char name[ODP_TIMER_POOL_NAME_LEN];
+	int i, num;
 
-	if (res_ns < res_capa) {
-		printf("Resolution %" PRIu64 " nsec too high. "
-		       "Highest resolution %" PRIu64 " nsec. "
-		       "Default resolution is period / 10.\n\n",
-		       res_ns, res_capa);
-		return -1;
-	}
+	num = test_global->opt.num;
+	period_ns = test_global->period_ns;
 
-	memset(&timer_param, 0, sizeof(odp_timer_pool_param_t));
+	/* Each worker receives only its own timeouts */
+	odp_thrmask_zero(&thrmask);
+	odp_thrmask_set(&thrmask, odp_thread_id());
+	snprintf(name, sizeof(name), "timer_accuracy_%i", idx);
 
-	timer_param.res_ns     = res_ns;
-	timer_param.min_tmo    = period_ns;
-	timer_param.max_tmo    = START_OFFSET_NS + (num * period_ns);
-	timer_param.num_timers = num;
-	timer_param.clk_src    = ODP_CLOCK_CPU;
+	worker->group = odp_schedule_group_create(name, &thrmask);
 
-	printf("\nTest parameters:\n");
-	printf("  resolution capa: %" PRIu64 " nsec\n", res_capa);
-	printf("  start offset:    %" PRIu64 " nsec\n", START_OFFSET_NS);
-	printf("  period:          %" PRIu64 " nsec\n", period_ns);
-	printf("  resolution:      %" PRIu64 " nsec\n", timer_param.res_ns);
-	printf("  min timeout:     %" PRIu64 " nsec\n", timer_param.min_tmo);
-	printf("  max timeout:     %" PRIu64 " nsec\n", timer_param.max_tmo);
-	printf("  num timers:      %u\n", timer_param.num_timers);
-	printf("  test run time:   %.1f sec\n\n",
-	       timer_param.max_tmo / 1000000000.0);
+	if (worker->group == ODP_SCHED_GROUP_INVALID) {
+		printf("Schedule group create failed.\n");
+		return -1;
+	}
 
-	timer_pool = odp_timer_pool_create("timer_accuracy", &timer_param);
+	odp_queue_param_init(&queue_param);
+	queue_param.type        = ODP_QUEUE_TYPE_SCHED;
+	queue_param.sched.prio  = ODP_SCHED_PRIO_DEFAULT;
+	queue_param.sched.sync  = ODP_SCHED_SYNC_ATOMIC;
+	queue_param.sched.group = worker->group;
 
-	if (timer_pool == ODP_TIMER_POOL_INVALID) {
-		printf("Timer pool create failed\n");
+	queue = odp_queue_create(name, &queue_param);
+
+	if (queue == ODP_QUEUE_INVALID) {
+		printf("Queue create failed.\n");
 		return -1;
 	}
 
-	odp_timer_pool_start();
+	worker->queue = queue;
+
+	if (test_global->opt.private) {
+		/* Processed only by this thread with timer.inline_owner */
+		worker->timer_pool = create_timer_pool(test_global, name,
+						       num, 1);
 
-	test_global->timer_pool = timer_pool;
+		if (worker->timer_pool == ODP_TIMER_POOL_INVALID)
+			return -1;
+
+		timer_pool = worker->timer_pool;
+	} else {
+		timer_pool = test_global->timer_pool;
+	}
 
 	for (i = 0; i < num; i++) {
 		timer = odp_timer_alloc(timer_pool, queue, NULL);
@@ -213,13 +324,16 @@ static int start_timers(test_global_t *test_global)
 			return -1;
 		}
 
-		test_global->timer[i] = timer;
+		worker->timer[i] = timer;
 	}
 
-	start_tick = 0;
+	start_tick = odp_timer_current_tick(timer_pool);
+	time       = odp_time_local();
+	start_ns   = odp_time_to_ns(time);
+	worker->first_ns = start_ns + START_OFFSET_NS;
 
 	for (i = 0; i < num; i++) {
-		timer = test_global->timer[i];
+		timer = worker->timer[i];
 
 		timeout = odp_timeout_alloc(pool);
 		if (timeout == ODP_TIMEOUT_INVALID) {
@@ -229,19 +343,13 @@ static int start_timers(test_global_t *test_global)
 
 		event = odp_timeout_to_event(timeout);
 
-		if (i == 0) {
-			start_tick = odp_timer_current_tick(timer_pool);
-			time       = odp_time_local();
-			start_ns   = odp_time_to_ns(time);
-			test_global->first_ns = start_ns + START_OFFSET_NS;
-		}
-
-		time_ns = test_global->first_ns + (i * period_ns);
+		time_ns = START_OFFSET_NS + (i * period_ns);
 		tick = start_tick + odp_timer_ns_to_tick(timer_pool, time_ns);
 		ret = odp_timer_set_abs(timer, tick, &event);
 
 		if (ret != ODP_TIMER_SUCCESS) {
 			printf("Timer[%i] set failed: ret %i\n", i, ret);
+			odp_event_free(event);
 			return -1;
 		}
 	}
@@ -249,7 +357,7 @@ static int start_timers(test_global_t *test_global)
 	return 0;
 }
 
-static int destroy_timers(test_global_t *test_global)
+static int destroy_timers(test_global_t *test_global, test_worker_t *worker)
 {
 	int i, num;
 	odp_timer_t timer;
@@ -259,7 +367,7 @@ static int destroy_timers(test_global_t *test_global)
 	num = test_global->opt.num;
 
 	for (i = 0; i < num; i++) {
-		timer = test_global->timer[i];
+		timer = worker->timer[i];
 
 		if (timer == ODP_TIMER_INVALID)
 			break;
@@ -270,19 +378,19 @@ static int destroy_timers(test_global_t *test_global)
 			odp_event_free(ev);
 	}
 
-	if (test_global->timer_pool != ODP_TIMER_POOL_INVALID)
-		odp_timer_pool_destroy(test_global->timer_pool);
+	if (worker->timer_pool != ODP_TIMER_POOL_INVALID)
+		odp_timer_pool_destroy(worker->timer_pool);
 
-	if (test_global->timeout_pool != ODP_POOL_INVALID) {
-		if (odp_pool_destroy(test_global->timeout_pool)) {
-			printf("Pool destroy failed.\n");
+	if (worker->queue != ODP_QUEUE_INVALID) {
+		if (odp_queue_destroy(worker->queue)) {
+			printf("Queue destroy failed.\n");
 			ret = -1;
 		}
 	}
 
-	if (test_global->queue != ODP_QUEUE_INVALID) {
-		if (odp_queue_destroy(test_global->queue)) {
-			printf("Queue destroy failed.\n");
+	if (worker->group != ODP_SCHED_GROUP_INVALID) {
+		if (odp_schedule_group_destroy(worker->group)) {
+			printf("Schedule group destroy failed.\n");
 			ret = -1;
 		}
 	}
@@ -290,28 +398,18 @@ static int destroy_timers(test_global_t *test_global)
 	return ret;
 }
 
-static void run_test(test_global_t *test_global)
+static void run_test(test_global_t *test_global, test_worker_t *worker)
 {
-	int num, num_left;
+	uint64_t time_ns, diff_ns, next_tmo;
 	odp_event_t ev;
 	odp_time_t time;
-	uint64_t time_ns, diff_ns, next_tmo, res_ns;
-	uint64_t after = 0;
-	uint64_t min_after = UINT64_MAX;
-	uint64_t max_after = 0;
-	uint64_t before = 0;
-	uint64_t min_before = UINT64_MAX;
-	uint64_t max_before = 0;
-	double ave_after = 0.0;
-	double ave_before = 0.0;
-	int num_after = 0;
-	int num_exact = 0;
-	int num_before = 0;
+	test_stat_t *stat = &worker->stat;
+	int num_left = test_global->opt.num;
+	int i;
 
-	res_ns = test_global->opt.res_ns;
-	num = test_global->opt.num;
-	num_left = num;
-	next_tmo = test_global->first_ns;
+	stat->first_ns = worker->first_ns;
+	next_tmo = worker->first_ns;
+	i = 0;
 
 	while (num_left) {
 		ev = odp_schedule(NULL, ODP_SCHED_WAIT);
@@ -321,26 +419,27 @@ static void run_test(test_global_t *test_global)
 
 		if (time_ns > next_tmo) {
 			diff_ns = time_ns - next_tmo;
-			num_after++;
-			after += diff_ns;
-			if (diff_ns < min_after)
-				min_after = diff_ns;
-			if (diff_ns > max_after)
-				max_after = diff_ns;
+			stat->num_after++;
+			stat->after += diff_ns;
+			if (diff_ns < stat->min_after)
+				stat->min_after = diff_ns;
+			if (diff_ns > stat->max_after)
+				stat->max_after = diff_ns;
 
 		} else if (time_ns < next_tmo) {
 			diff_ns = next_tmo - time_ns;
-			num_before++;
-			before += diff_ns;
-			if (diff_ns < min_before)
-				min_before = diff_ns;
-			if (diff_ns > max_before)
-				max_before = diff_ns;
-
+			stat->num_before++;
+			stat->before += diff_ns;
+			if (diff_ns < stat->min_before)
+				stat->min_before = diff_ns;
+			if (diff_ns > stat->max_before)
+				stat->max_before = diff_ns;
 		} else {
-			num_exact++;
+			stat->num_exact++;
 		}
 
+		worker->error_ns[i++] = (int64_t)(time_ns - next_tmo);
+		stat->last_ns = time_ns;
 		odp_event_free(ev);
 
 		next_tmo += test_global->period_ns;
@@ -353,6 +452,130 @@ static void run_test(test_global_t *test_global)
 		printf("Dropping extra event\n");
 		odp_event_free(ev);
 	}
+}
+
+static int run_worker(void *arg)
+{
+	test_global_t *test_global = arg;
+	test_worker_t *worker;
+	uint32_t idx;
+	int i, ret = 0;
+
+	idx = odp_atomic_fetch_inc_u32(&test_global->worker_idx);
+	worker = &test_global->worker[idx];
+	worker->error_ns = &test_global->error_ns[idx * test_global->opt.num];
+
+	/* Always init for destroy calls */
+	worker->group      = ODP_SCHED_GROUP_INVALID;
+	worker->queue      = ODP_QUEUE_INVALID;
+	worker->timer_pool = ODP_TIMER_POOL_INVALID;
+	worker->stat.min_after  = UINT64_MAX;
+	worker->stat.min_before = UINT64_MAX;
+
+	worker->timer = malloc(test_global->opt.num * sizeof(odp_timer_t));
+
+	if (worker->timer == NULL) {
+		printf("Malloc failed.\n");
+		return -1;
+	}
+
+	for (i = 0; i < test_global->opt.num; i++)
+		worker->timer[i] = ODP_TIMER_INVALID;
+
+	if (start_timers(test_global, worker, idx) == 0)
+		run_test(test_global, worker);
+	else
+		ret = -1;
+
+	if (destroy_timers(test_global, worker))
+		ret = -1;
+
+	free(worker->timer);
+	worker->timer = NULL;
+
+	return ret;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a;
+	uint64_t y = *(const uint64_t *)b;
+
+	return (x > y) - (x < y);
+}
+
+/* Print percentiles of absolute timeout error (jitter) */
+static void print_jitter(test_global_t *test_global, uint64_t num)
+{
+	static const double percentile[] = {50.0, 90.0, 99.0, 99.9, 100.0};
+	uint64_t *jitter_ns = (uint64_t *)test_global->error_ns;
+	uint64_t i, idx;
+	int64_t err;
+	double res_ns = test_global->opt.res_ns;
+
+	/* Convert errors to absolute values in place */
+	for (i = 0; i < num; i++) {
+		err = test_global->error_ns[i];
+		jitter_ns[i] = err < 0 ? (uint64_t)-err : (uint64_t)err;
+	}
+
+	qsort(jitter_ns, num, sizeof(uint64_t), cmp_u64);
+
+	printf("  jitter (nsec):\n");
+
+	for (i = 0; i < sizeof(percentile) / sizeof(double); i++) {
+		idx = (uint64_t)(percentile[i] / 100.0 * num);
+		if (idx >= num)
+			idx = num - 1;
+
+		printf("     %6.1f%%: %12" PRIu64 "  /  %.3fx resolution\n",
+		       percentile[i], jitter_ns[idx], jitter_ns[idx] / res_ns);
+	}
+}
+
+static void print_results(test_global_t *test_global)
+{
+	test_stat_t *stat;
+	uint64_t num, res_ns;
+	uint64_t num_after = 0, num_before = 0, num_exact = 0;
+	uint64_t after = 0, before = 0, max_after = 0, max_before = 0;
+	uint64_t min_after = UINT64_MAX, min_before = UINT64_MAX;
+	uint64_t first_ns = UINT64_MAX, last_ns = 0;
+	double ave_after = 0.0;
+	double ave_before = 0.0;
+	double rate = 0.0;
+	int i;
+
+	for (i = 0; i < test_global->opt.num_worker; i++) {
+		stat = &test_global->worker[i].stat;
+
+		num_after  += stat->num_after;
+		num_before += stat->num_before;
+		num_exact  += stat->num_exact;
+		after      += stat->after;
+		before     += stat->before;
+
+		if (stat->min_after < min_after)
+			min_after = stat->min_after;
+		if (stat->max_after > max_after)
+			max_after = stat->max_after;
+		if (stat->min_before < min_before)
+			min_before = stat->min_before;
+		if (stat->max_before > max_before)
+			max_before = stat->max_before;
+		if (stat->first_ns && stat->first_ns < first_ns)
+			first_ns = stat->first_ns;
+		if (stat->last_ns > last_ns)
+			last_ns = stat->last_ns;
+	}
+
+	num = num_after + num_before + num_exact;
+	res_ns = test_global->opt.res_ns;
+
+	if (num == 0) {
+		printf("\n No timeouts received\n\n");
+		return;
+	}
 
 	if (num_after)
 		ave_after = (double)after / num_after;
@@ -364,12 +587,15 @@ static void run_test(test_global_t *test_global)
 	else
 		min_before = 0;
 
+	if (last_ns > first_ns)
+		rate = (double)num * ODP_TIME_SEC_IN_NS / (last_ns - first_ns);
+
 	printf("\n Test results:\n");
-	printf("  num after:  %12i  /  %.2f%%\n",
+	printf("  num after:  %12" PRIu64 "  /  %.2f%%\n",
 	       num_after, 100.0 * num_after / num);
-	printf("  num before: %12i  /  %.2f%%\n",
+	printf("  num before: %12" PRIu64 "  /  %.2f%%\n",
 	       num_before, 100.0 * num_before / num);
-	printf("  num exact:  %12i  /  %.2f%%\n",
+	printf("  num exact:  %12" PRIu64 "  /  %.2f%%\n",
 	       num_exact, 100.0 * num_exact / num);
 	printf("  error after (nsec):\n");
 	printf("         min: %12" PRIu64 "  /  %.3fx resolution\n",
@@ -385,6 +611,12 @@ static void run_test(test_global_t *test_global)
 	       max_before, (double)max_before / res_ns);
 	printf("         ave: %12.0f  /  %.3fx resolution\n",
 	       ave_before, ave_before / res_ns);
+	printf("  timeout rate: %10.0f  per sec\n", rate);
+
+	/* Errors are stored only when all timeouts were received */
+	if (num == (uint64_t)test_global->opt.num * test_global->opt.num_worker)
+		print_jitter(test_global, num);
+
 	printf("\n");
 }
 
@@ -392,14 +624,22 @@ int main(int argc, char *argv[])
 {
 	odp_instance_t instance;
 	odp_init_t init;
-	int num;
-	test_global_t test_global;
+	odp_shm_t shm;
+	odp_cpumask_t cpumask;
+	odph_odpthread_t thread_tbl[MAX_WORKERS];
+	odph_odpthread_params_t thr_params;
+	test_global_t *test_global;
+	test_global_t opt_global;
 	odp_init_t *init_ptr = NULL;
+	int num_worker;
 	int ret = 0;
 
-	memset(&test_global, 0, sizeof(test_global_t));
+	/* Let helper collect its own arguments (e.g. --odph_proc) */
+	argc = odph_parse_options(argc, argv);
+
+	memset(&opt_global, 0, sizeof(test_global_t));
 
-	if (parse_options(argc, argv, &test_global))
+	if (parse_options(argc, argv, &opt_global))
 		return -1;
 
 	/* List features not to be used (may optimize performance) */
@@ -409,7 +649,7 @@ int main(int argc, char *argv[])
 	init.not_used.feat.ipsec  = 1;
 	init.not_used.feat.tm     = 1;
 
-	if (test_global.opt.init)
+	if (opt_global.opt.init)
 		init_ptr = &init;
 
 	/* Init ODP before calling anything else */
@@ -419,34 +659,95 @@ int main(int argc, char *argv[])
 	}
 
 	/* Init this thread */
-	if (odp_init_local(instance, ODP_THREAD_WORKER)) {
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
 		printf("Local init failed.\n");
 		return -1;
 	}
 
+	shm = odp_shm_reserve("timer_accuracy_global", sizeof(test_global_t),
+			      ODP_CACHE_LINE_SIZE, 0);
+
+	if (shm == ODP_SHM_INVALID) {
+		printf("Shared memory reserve failed.\n");
+		ret = -1;
+		goto term;
+	}
+
+	test_global = odp_shm_addr(shm);
+	memset(test_global, 0, sizeof(test_global_t));
+	test_global->opt          = opt_global.opt;
+	test_global->timer_pool   = ODP_TIMER_POOL_INVALID;
+	test_global->timeout_pool = ODP_POOL_INVALID;
+	test_global->error_shm    = ODP_SHM_INVALID;
+	odp_atomic_init_u32(&test_global->worker_idx, 0);
+
 	odp_sys_info_print();
 
-	num = test_global.opt.num;
+	num_worker = odp_cpumask_default_worker(&cpumask,
+						test_global->opt.num_worker);
 
-	test_global.timer = calloc(num, sizeof(odp_timer_t));
+	if (num_worker != test_global->opt.num_worker) {
+		printf("Using %i workers (%i requested)\n", num_worker,
+		       test_global->opt.num_worker);
+		test_global->opt.num_worker = num_worker;
+	}
 
-	if (test_global.timer == NULL) {
-		printf("Malloc failed.\n");
+	test_global->error_shm = odp_shm_reserve("timer_accuracy_error",
+						 sizeof(int64_t) *
+						 test_global->opt.num *
+						 num_worker,
+						 ODP_CACHE_LINE_SIZE, 0);
+
+	if (test_global->error_shm == ODP_SHM_INVALID) {
+		printf("Shared memory reserve failed.\n");
+		ret = -1;
 		goto quit;
 	}
 
-	if (start_timers(&test_global))
+	test_global->error_ns = odp_shm_addr(test_global->error_shm);
+
+	if (create_pools(test_global)) {
+		ret = -1;
 		goto quit;
+	}
+
+	memset(thread_tbl, 0, sizeof(thread_tbl));
+	memset(&thr_params, 0, sizeof(thr_params));
+	thr_params.start    = run_worker;
+	thr_params.arg      = test_global;
+	thr_params.thr_type = ODP_THREAD_WORKER;
+	thr_params.instance = instance;
+
+	odph_odpthreads_create(thread_tbl, &cpumask, &thr_params);
+
+	if (odph_odpthreads_join(thread_tbl) != num_worker)
+		ret = -1;
 
-	run_test(&test_global);
+	print_results(test_global);
 
 quit:
-	if (destroy_timers(&test_global))
+	if (test_global->timer_pool != ODP_TIMER_POOL_INVALID)
+		odp_timer_pool_destroy(test_global->timer_pool);
+
+	if (test_global->timeout_pool != ODP_POOL_INVALID) {
+		if (odp_pool_destroy(test_global->timeout_pool)) {
+			printf("Timeout pool destroy failed.\n");
+			ret = -1;
+		}
+	}
+
+	if (test_global->error_shm != ODP_SHM_INVALID &&
+	    odp_shm_free(test_global->error_shm)) {
+		printf("Shared memory free failed.\n");
 		ret = -1;
+	}
 
-	if (test_global.timer)
-		free(test_global.timer);
+	if (odp_shm_free(shm)) {
+		printf("Shared memory free failed.\n");
+		ret = -1;
+	}
 
+term:
 	if (odp_term_local()) {
 		printf("Term local failed.\n");
 		ret = -1;
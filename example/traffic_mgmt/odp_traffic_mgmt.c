@@ -39,12 +39,27 @@
 
 #define RANDOM_BUF_LEN  1024
 
+/* Maximum value of the shaper rate scale option (-s) */
+#define MAX_SHAPER_SCALE  1000
+
+/* Shaper length adjustments of the test pkts (pkt and shaper profiles) */
+#define PKT_LEN_ADJUST     24
+#define SHAPER_LEN_ADJUST  20
+
 typedef struct {
 	odp_tm_shaper_params_t    shaper_params;
 	odp_tm_threshold_params_t threshold_params;
 	odp_tm_wred_params_t      wred_params[ODP_NUM_PACKET_COLORS];
 } profile_params_set_t;
 
+/* Egress statistics per service class */
+typedef struct {
+	odp_atomic_u64_t pkts;
+	odp_atomic_u64_t bytes;
+	odp_atomic_u64_t first_ns;
+	odp_atomic_u64_t last_ns;
+} egress_stats_t;
+
 typedef struct {
 	odp_tm_shaper_t    shaper_profile;
 	odp_tm_threshold_t threshold_profile;
@@ -239,8 +254,12 @@ static uint32_t next_rand_byte;
 static odp_atomic_u32_t atomic_pkts_into_tm;
 static odp_atomic_u32_t atomic_pkts_from_tm;
 
+static egress_stats_t egress_stats[NUM_SVC_CLASSES];
+static odp_time_t     start_time;
+
 static uint32_t g_num_pkts_to_send = 1000;
 static uint8_t  g_print_tm_stats   = TRUE;
+static uint32_t g_shaper_scale     = 1;
 
 static void tester_egress_fcn(odp_packet_t odp_pkt);
 
@@ -268,6 +287,7 @@ static uint32_t create_profile_set(profile_params_set_t *profile_params_set,
 
 	odp_tm_shaper_params_init(&shaper_params);
 	shaper                          = &profile_params_set->shaper_params;
+	shaper_scale                   *= g_shaper_scale;
 	shaper_params.commit_bps        = shaper->commit_bps   * shaper_scale;
 	shaper_params.peak_bps          = shaper->peak_bps     * shaper_scale;
 	shaper_params.commit_burst      = shaper->commit_burst * shaper_scale;
@@ -600,15 +620,77 @@ static odp_packet_t make_odp_packet(uint16_t pkt_len)
 
 	odp_packet_color_set(odp_pkt, pkt_color);
 	odp_packet_drop_eligible_set(odp_pkt, drop_eligible);
-	odp_packet_shaper_len_adjust_set(odp_pkt, 24);
+	odp_packet_shaper_len_adjust_set(odp_pkt, PKT_LEN_ADJUST);
 	return odp_pkt;
 }
 
-void tester_egress_fcn(odp_packet_t odp_pkt ODP_UNUSED)
+void tester_egress_fcn(odp_packet_t odp_pkt)
 {
+	egress_stats_t *stats;
+	uint64_t ns;
+	uint32_t svc_class;
+
+	svc_class = (uintptr_t)odp_packet_user_ptr(odp_pkt);
+	stats     = &egress_stats[svc_class];
+	ns        = odp_time_diff_ns(odp_time_local(), start_time);
+
+	odp_atomic_inc_u64(&stats->pkts);
+	odp_atomic_add_u64(&stats->bytes, odp_packet_len(odp_pkt) +
+			   PKT_LEN_ADJUST + SHAPER_LEN_ADJUST);
+	odp_atomic_min_u64(&stats->first_ns, ns);
+	odp_atomic_max_u64(&stats->last_ns, ns);
+
+	odp_packet_free(odp_pkt);
 	odp_atomic_inc_u32(&atomic_pkts_from_tm);
 }
 
+static void print_egress_stats(void)
+{
+	const profile_params_set_t *cos_params[NUM_SVC_CLASSES] = {
+		&COS0_PROFILE_PARAMS, &COS1_PROFILE_PARAMS,
+		&COS2_PROFILE_PARAMS, &COS3_PROFILE_PARAMS
+	};
+	const odp_tm_shaper_params_t *shaper;
+	egress_stats_t *stats;
+	uint64_t pkts, bytes, first_ns, last_ns, total_pkts, total_ns;
+	uint64_t scale;
+	uint32_t svc_class;
+
+	/* Service class nodes use shaper scale TM_QUEUES_PER_CLASS / 2 */
+	scale      = (TM_QUEUES_PER_CLASS / 2) * g_shaper_scale;
+	total_pkts = 0;
+	total_ns   = 0;
+
+	printf("\nEgress rates (incl. shaper length adjustments)\n");
+	printf("  class     pkts   duration ms        Mbps  commit Mbps"
+	       "    peak Mbps\n");
+
+	for (svc_class = 0; svc_class < NUM_SVC_CLASSES; svc_class++) {
+		stats    = &egress_stats[svc_class];
+		shaper   = &cos_params[svc_class]->shaper_params;
+		pkts     = odp_atomic_load_u64(&stats->pkts);
+		bytes    = odp_atomic_load_u64(&stats->bytes);
+		first_ns = odp_atomic_load_u64(&stats->first_ns);
+		last_ns  = odp_atomic_load_u64(&stats->last_ns);
+
+		total_pkts += pkts;
+		total_ns    = MAX(total_ns, last_ns);
+		if (pkts < 2)
+			continue;
+
+		printf("  %5u %8" PRIu64 " %13.3f %11.3f %12.3f %12.3f\n",
+		       svc_class, pkts, (last_ns - first_ns) / 1000000.0,
+		       (8000.0 * bytes) / (last_ns - first_ns),
+		       (double)(shaper->commit_bps * scale) / MBPS,
+		       (double)(shaper->peak_bps * scale) / MBPS);
+	}
+
+	if (total_ns)
+		printf("\n  %" PRIu64 " pkts in %.3f ms, %.4f Mpps\n\n",
+		       total_pkts, total_ns / 1000000.0,
+		       (1000.0 * total_pkts) / total_ns);
+}
+
 static int traffic_generator(uint32_t pkts_to_send)
 {
 	odp_pool_param_t pool_params;
@@ -628,6 +710,7 @@ static int traffic_generator(uint32_t pkts_to_send)
 
 	odp_pool        = odp_pool_create("MyPktPool", &pool_params);
 	odp_tm_enq_errs = 0;
+	start_time      = odp_time_local();
 
 	pkt_cnt = 0;
 	while (pkt_cnt < pkts_to_send) {
@@ -637,6 +720,7 @@ static int traffic_generator(uint32_t pkts_to_send)
 		pkt_len   = ((uint32_t)((random_8() & 0x7F) + 2)) * 32;
 		pkt_len   = MIN(pkt_len, 1500);
 		pkt       = make_odp_packet(pkt_len);
+		odp_packet_user_ptr_set(pkt, (void *)(uintptr_t)svc_class);
 
 		pkt_cnt++;
 		rc = odp_tm_enq(tm_queue, pkt);
@@ -700,6 +784,15 @@ static int process_cmd_line_options(uint32_t argc, char *argv[])
 				g_print_tm_stats = FALSE;
 				break;
 
+			case 's':
+				if (argc <= arg_idx)
+					return -1;
+				g_shaper_scale = atoi(argv[arg_idx++]);
+				if (g_shaper_scale < 1 ||
+				    g_shaper_scale > MAX_SHAPER_SCALE)
+					return -1;
+				break;
+
 			default:
 				printf("Unrecognized cmd line option '%s'\n",
 				       arg);
@@ -788,7 +881,7 @@ int main(int argc, char *argv[])
 {
 	struct sigaction signal_action;
 	struct rlimit    rlimit;
-	uint32_t pkts_into_tm, pkts_from_tm;
+	uint32_t pkts_into_tm, pkts_from_tm, svc_class;
 	odp_instance_t instance;
 	int rc;
 
@@ -828,6 +921,14 @@ int main(int argc, char *argv[])
 	odp_atomic_init_u32(&atomic_pkts_into_tm, 0);
 	odp_atomic_init_u32(&atomic_pkts_from_tm, 0);
 
+	for (svc_class = 0; svc_class < NUM_SVC_CLASSES; svc_class++) {
+		odp_atomic_init_u64(&egress_stats[svc_class].pkts, 0);
+		odp_atomic_init_u64(&egress_stats[svc_class].bytes, 0);
+		odp_atomic_init_u64(&egress_stats[svc_class].first_ns,
+				    UINT64_MAX);
+		odp_atomic_init_u64(&egress_stats[svc_class].last_ns, 0);
+	}
+
 	traffic_generator(g_num_pkts_to_send);
 
 	pkts_into_tm = odp_atomic_load_u32(&atomic_pkts_into_tm);
@@ -835,6 +936,8 @@ int main(int argc, char *argv[])
 	printf("pkts_into_tm=%" PRIu32 " pkts_from_tm=%" PRIu32 "\n",
 	       pkts_into_tm, pkts_from_tm);
 
+	print_egress_stats();
+
 	odp_tm_stats_print(odp_tm_test);
 
 	rc = destroy_tm_queues();
@@ -1157,6 +1157,51 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset);
 odp_packet_t odp_packet_ref_pkt(odp_packet_t pkt, uint32_t offset,
 				odp_packet_t hdr);
 
+/**
+ * Create multiple static references to a packet
+ *
+ * Otherwise like odp_packet_ref_static(), but creates 'num' static references
+ * with a single call and outputs them into 'ref' table. This is more
+ * efficient than calling odp_packet_ref_static() 'num' times, e.g. when a
+ * packet is replicated to multiple destinations. The same restrictions apply
+ * to all references.
+ *
+ * @param      pkt   Handle of the packet for which static references are
+ *                   to be created.
+ * @param[out] ref   Table for output references
+ * @param      num   Number of references to create
+ *
+ * @return Number of references created (0 ... num)
+ * @retval <0 on failure
+ */
+int odp_packet_ref_static_multi(odp_packet_t pkt, odp_packet_t ref[], int num);
+
+/**
+ * Create multiple references to a packet
+ *
+ * Otherwise like odp_packet_ref(), but creates up to 'num' (dynamic)
+ * references with a single call and outputs them into 'ref' table. Each
+ * reference shares data of 'pkt' starting from 'offset', and may be modified
+ * (e.g. a unique header pushed onto it) independently of the other
+ * references. This is more efficient than calling odp_packet_ref() 'num'
+ * times, e.g. when a packet is replicated to multiple destinations.
+ *
+ * Packet is not modified on failure.
+ *
+ * @param      pkt     Handle of the packet for which references are to be
+ *                     created.
+ * @param      offset  Byte offset in the packet at which the shared part is
+ *                     to begin. This must be in the range
+ *                     0 ... odp_packet_len(pkt)-1.
+ * @param[out] ref     Table for output references
+ * @param      num     Maximum number of references to create
+ *
+ * @return Number of references created (0 ... num)
+ * @retval <0 on failure
+ */
+int odp_packet_ref_multi(odp_packet_t pkt, uint32_t offset,
+			 odp_packet_t ref[], int num);
+
 /**
  * Test if packet has multiple references
  *
@@ -1164,8 +1209,9 @@ odp_packet_t odp_packet_ref_pkt(odp_packet_t pkt, uint32_t offset,
  * of a static reference it also shares metadata. Shared parts must be treated
  * as read only.
  *
- * New references are created with odp_packet_ref_static(), odp_packet_ref() and
- * odp_packet_ref_pkt() calls. The intent of multiple references is to avoid
+ * New references are created with odp_packet_ref_static(), odp_packet_ref(),
+ * odp_packet_ref_pkt(), odp_packet_ref_static_multi() and
+ * odp_packet_ref_multi() calls. The intent of multiple references is to avoid
  * packet copies, however some implementations may do a packet copy for some of
  * the calls. If a copy is done, the new reference is actually a new, unique
  * packet and this function returns '0' for it. When a real reference is
@@ -1754,6 +1800,34 @@ void odp_packet_l3_chksum_insert(odp_packet_t pkt, int insert);
  */
 void odp_packet_l4_chksum_insert(odp_packet_t pkt, int insert);
 
+/**
+ * Set TCP maximum segment size
+ *
+ * Request TCP segmentation of the packet during packet output processing.
+ * When the packet is output through a pktio that has TCP segmentation offload
+ * enabled (see odp_pktout_config_opt_t::tcp_seg_ena), TCP payload of the packet
+ * is split into segments of at most 'mss' bytes. The packet must have valid
+ * L3 and L4 offsets, and contain a well formed IPv4 or IPv6 header followed by
+ * a TCP header. Headers are copied into every segment. The value of zero
+ * disables segmentation, which is also the default value.
+ *
+ * @param pkt     Packet handle
+ * @param mss     Maximum TCP payload length per segment in bytes, or 0
+ *
+ * @see odp_packet_tcp_mss()
+ */
+void odp_packet_tcp_mss_set(odp_packet_t pkt, uint32_t mss);
+
+/**
+ * TCP maximum segment size
+ *
+ * @param pkt     Packet handle
+ *
+ * @return TCP maximum segment size set with odp_packet_tcp_mss_set()
+ * @retval 0 TCP segmentation not requested
+ */
+uint32_t odp_packet_tcp_mss(odp_packet_t pkt);
+
 /**
  * Ones' complement sum of packet data
  *
@@ -273,6 +273,33 @@ typedef struct odp_pktio_param_t {
  * Whether checksum checking was done and whether a checksum was correct
  * can be queried for each received packet with odp_packet_l3_chksum_status()
  * and odp_packet_l4_chksum_status().
+ *
+ * Flow hash calculation and flow grouping may be enabled only with parsing
+ * level ODP_PROTO_LAYER_L4 or higher. When flow hash is enabled, a flow hash
+ * value is calculated for every received packet and can be read with
+ * odp_packet_flow_hash(). When flow grouping is enabled, packets of a burst
+ * received with a single odp_pktin_recv() call (or a single scheduler pktin
+ * poll) are reordered so that packets with the same flow hash are adjacent.
+ * The relative order of packets within a flow is maintained, so application
+ * may perform a per-flow state lookup once per group instead of once per
+ * packet. Flow grouping implies flow hash calculation.
+ *
+ * TCP receive offload (tcp_gro) may be enabled only with parsing level
+ * ODP_PROTO_LAYER_L4 or higher. When enabled, consecutive in-order TCP segments
+ * of the same connection received in the same burst are merged into a single
+ * packet. Segment data is linked into the first packet without copying, so
+ * merged packets are typically segmented (see odp_packet_num_segs()). The
+ * merged packet contains headers of the first segment, with IP length, TCP
+ * checksum, window and PSH flag updated to cover all merged segments. Only
+ * IPv4 (without options) and IPv6 (without extension headers) packets with
+ * only the ACK flag set (PSH is allowed on the last segment), and identical
+ * headers apart from length, identification, sequence number, window and
+ * checksum, are merged. TCP maximum segment size of a merged packet is set to
+ * the payload length of its first segment (see odp_packet_tcp_mss()), so that
+ * the original segments are restored when the packet is output through a pktio
+ * with TCP segmentation offload enabled. Enabling flow grouping makes segments
+ * of the same connection adjacent, which improves merging when flows are
+ * interleaved.
  */
 typedef union odp_pktin_config_opt_t {
 	/** Option flags */
@@ -311,6 +338,16 @@ typedef union odp_pktin_config_opt_t {
 		/** Drop packets with a SCTP error on packet input */
 		uint64_t drop_sctp_err : 1;
 
+		/** Calculate flow hash for all packets on packet input */
+		uint64_t flow_hash     : 1;
+
+		/** Group packets of a received burst by flow hash on packet
+		  * input */
+		uint64_t flow_group    : 1;
+
+		/** Merge TCP segments of a received burst on packet input */
+		uint64_t tcp_gro       : 1;
+
 	} bit;
 
 	/** All bits of the bit field structure
@@ -320,6 +357,18 @@ typedef union odp_pktin_config_opt_t {
 	uint64_t all_bits;
 } odp_pktin_config_opt_t;
 
+/**
+ * Packet input TCP receive offload statistics
+ */
+typedef struct odp_pktin_gro_stats_t {
+	/** Number of packets created by merging TCP segments */
+	uint64_t merged_pkts;
+
+	/** Number of received TCP segments merged into those packets */
+	uint64_t merged_segs;
+
+} odp_pktin_gro_stats_t;
+
 /**
  * Packet output configuration options bit field
  *
@@ -389,6 +438,21 @@ typedef union odp_pktout_config_opt_t {
 		/** Insert SCTP checksum on packet by default */
 		uint64_t sctp_chksum     : 1;
 
+		/** Enable TCP segmentation offload
+		 *
+		 *  When enabled, a TCP packet that has a segment size set with
+		 *  odp_packet_tcp_mss_set() and carries more TCP payload than
+		 *  the segment size is output as multiple TCP segments. Each
+		 *  output segment contains a copy of the packet headers
+		 *  (L2 to L4) followed by at most 'mss' bytes of the payload.
+		 *  IPv4 total length, identification and header checksum,
+		 *  IPv6 payload length, TCP sequence number and TCP checksum
+		 *  are updated per segment. FIN and PSH flags are set only on
+		 *  the last segment and CWR flag only on the first segment.
+		 *  The packet must have valid L3 and L4 offsets. Other packets
+		 *  are output unmodified. */
+		uint64_t tcp_seg_ena     : 1;
+
 	} bit;
 
 	/** All bits of the bit field structure
@@ -940,6 +1004,49 @@ int odp_pktin_recv_mq_tmo(const odp_pktin_queue_t queues[], unsigned num_q,
  */
 uint64_t odp_pktin_wait_time(uint64_t nsec);
 
+/**
+ * Read TCP receive offload statistics of a packet input queue
+ *
+ * Counters are updated when TCP receive offload is enabled
+ * (see odp_pktin_config_opt_t::tcp_gro). Counters are reset with
+ * odp_pktio_stats_reset().
+ *
+ * @param      queue   Packet input queue handle
+ * @param[out] stats   Output buffer for counters
+ *
+ * @retval  0 on success
+ * @retval <0 on failure
+ */
+int odp_pktin_gro_stats(odp_pktin_queue_t queue, odp_pktin_gro_stats_t *stats);
+
+/**
+ * Read statistics of a packet input queue
+ *
+ * Counters are reset with odp_pktio_stats_reset().
+ *
+ * @param      queue   Packet input queue handle
+ * @param[out] stats   Output buffer for counters
+ *
+ * @retval  0 on success
+ * @retval <0 on failure
+ */
+int odp_pktin_queue_stats(odp_pktin_queue_t queue,
+			  odp_pktin_queue_stats_t *stats);
+
+/**
+ * Read statistics of a packet output queue
+ *
+ * Counters are reset with odp_pktio_stats_reset().
+ *
+ * @param      queue   Packet output queue handle
+ * @param[out] stats   Output buffer for counters
+ *
+ * @retval  0 on success
+ * @retval <0 on failure
+ */
+int odp_pktout_queue_stats(odp_pktout_queue_t queue,
+			   odp_pktout_queue_stats_t *stats);
+
 /**
  * Send packets directly to an interface output queue
  *
@@ -106,6 +106,62 @@ typedef struct odp_pktio_stats_t {
 	uint64_t out_errors;
 } odp_pktio_stats_t;
 
+/**
+ * Packet input queue statistics
+ *
+ * Counters of a single packet input queue. Counters that are not supported
+ * by the interface are zero.
+ */
+typedef struct odp_pktin_queue_stats_t {
+	/** Number of octets in packets received from the queue */
+	uint64_t octets;
+
+	/** Number of packets received from the queue */
+	uint64_t packets;
+
+	/** Number of packets discarded without errors being detected, e.g.
+	 *  due to lack of buffer space */
+	uint64_t discards;
+
+	/** Number of packets discarded due to errors */
+	uint64_t errors;
+
+	/** Number of failed packet allocations. Depending on the interface,
+	 *  the received packet is either left to the interface for the next
+	 *  receive call or discarded (and counted also in 'discards'). */
+	uint64_t alloc_fails;
+
+	/** Number of packets discarded by the classifier, e.g. packets of
+	 *  a class of service with drop policy */
+	uint64_t cls_discards;
+
+} odp_pktin_queue_stats_t;
+
+/**
+ * Packet output queue statistics
+ *
+ * Counters of a single packet output queue. Counters that are not supported
+ * by the interface are zero.
+ */
+typedef struct odp_pktout_queue_stats_t {
+	/** Number of octets in packets sent through the queue */
+	uint64_t octets;
+
+	/** Number of packets sent through the queue */
+	uint64_t packets;
+
+	/** Number of packets discarded without errors being detected */
+	uint64_t discards;
+
+	/** Number of packets discarded due to errors */
+	uint64_t errors;
+
+	/** Number of times transmission was retried because the interface
+	 *  was temporarily out of transmit resources (e.g. ring full) */
+	uint64_t retries;
+
+} odp_pktout_queue_stats_t;
+
 /**
  * Get statistics for pktio handle
  *
@@ -123,7 +179,8 @@ int odp_pktio_stats(odp_pktio_t pktio,
 /**
  * Reset statistics for pktio handle
  *
- * Reset all pktio counters to 0.
+ * Reset all pktio counters to 0. Also packet input and output queue
+ * counters are reset.
  * @param	pktio	 Packet IO handle
  * @retval  0 on success
  * @retval <0 on failure
@@ -1612,6 +1612,23 @@ int odp_tm_enq(odp_tm_queue_t tm_queue, odp_packet_t pkt);
  */
 int odp_tm_enq_with_cnt(odp_tm_queue_t tm_queue, odp_packet_t pkt);
 
+/** Send multiple packets to a TM system
+ *
+ * Like odp_tm_enq(), but enqueues multiple packets into the same tm_queue.
+ * Packets are enqueued in the order they are in the array. Enqueue stops at
+ * the first packet that cannot be enqueued (e.g. due to WRED drop). The
+ * caller retains ownership of packets that were not enqueued.
+ *
+ * @param tm_queue  Specifies the tm_queue (and indirectly the TM system).
+ * @param packets   Array of packet handles
+ * @param num       Number of packets to enqueue
+ *
+ * @return Number of packets actually enqueued (0 ... num)
+ * @retval <0 on failure
+ */
+int odp_tm_enq_multi(odp_tm_queue_t tm_queue, const odp_packet_t packets[],
+		     int num);
+
 /* Dynamic state query functions */
 
 /** The odp_tm_node_info_t record type  is used to return various bits of
@@ -111,7 +111,7 @@ typedef union {
 	uint32_t all_flags;
 
 	struct {
-		uint32_t reserved1:     10;
+		uint32_t reserved1:      9;
 
 	/*
 	 * Init flags
@@ -126,6 +126,7 @@ typedef union {
 		uint32_t l4_chksum_set:  1; /* L4 chksum bit is valid */
 		uint32_t l4_chksum:      1; /* L4 chksum override  */
 		uint32_t shaper_len_adj: 8; /* Adjustment for traffic mgr */
+		uint32_t tcp_seg:        1; /* TCP segmentation requested */
 
 	/*
 	 * Error flags
@@ -143,8 +144,8 @@ typedef union {
 
 	/* Flag groups */
 	struct {
-		uint32_t reserved2:     10;
-		uint32_t other:         13; /* All other flags */
+		uint32_t reserved2:      9;
+		uint32_t other:         14; /* All other flags */
 		uint32_t error:          9; /* All error flags */
 	} all;
 
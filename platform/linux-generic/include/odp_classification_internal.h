@@ -41,6 +41,19 @@ int cls_classify_packet(pktio_entry_t *entry, const uint8_t *base,
 			uint16_t pkt_len, uint32_t seg_len, odp_pool_t *pool,
 			odp_packet_hdr_t *pkt_hdr, odp_bool_t parse);
 
+/**
+@internal
+
+Packet RSS hash
+
+Calculate Toeplitz hash over the fields selected in hash_proto. The packet
+must have been parsed up to L4 and 'base' must point to packet data that
+covers the L3 and L4 headers.
+**/
+uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
+			 odp_cls_hash_proto_t hash_proto,
+			 const uint8_t *base);
+
 /**
 Packet IO classifier init
 
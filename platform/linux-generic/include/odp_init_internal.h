@@ -39,6 +39,7 @@ int _odp_schedule_term_global(void);
 int odp_pktio_init_global(void);
 int odp_pktio_term_global(void);
 int odp_pktio_init_local(void);
+int odp_pktio_term_local(void);
 
 int odp_classification_init_global(void);
 int odp_classification_term_global(void);
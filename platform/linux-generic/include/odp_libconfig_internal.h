@@ -17,11 +17,16 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 int _odp_libconfig_init_global(void);
 int _odp_libconfig_term_global(void);
 
 int _odp_libconfig_lookup_int(const char *path, int *value);
 
+int _odp_libconfig_lookup_str(const char *path, char *value,
+			      uint32_t str_size);
+
 int _odp_libconfig_lookup_ext_int(const char *base_path,
 				  const char *local_path,
 				  const char *name,
@@ -98,6 +98,13 @@ typedef struct {
 	/* Type of extra data */
 	uint8_t extra_type;
 
+	/* Segments may be shared with other packets (references have been
+	 * created). Initialized on packet allocation. */
+	uint8_t shared_segs;
+
+	/* TCP segment size for segmentation offload */
+	uint16_t tcp_mss;
+
 	/* Flow hash value */
 	uint32_t flow_hash;
 
@@ -309,6 +316,11 @@ int _odp_packet_ipv4_chksum_insert(odp_packet_t pkt);
 int _odp_packet_tcp_chksum_insert(odp_packet_t pkt);
 int _odp_packet_udp_chksum_insert(odp_packet_t pkt);
 int _odp_packet_sctp_chksum_insert(odp_packet_t pkt);
+int _odp_packet_tcp_seg(odp_packet_t pkt, uint32_t first, odp_packet_t seg[],
+			int max_seg);
+uint32_t _odp_packet_tcp_seg_num(odp_packet_t pkt);
+int _odp_packet_tcp_gro(odp_packet_t pkt[], int num, int check_dst_queue,
+			uint32_t *merged_pkts, uint32_t *merged_segs);
 
 
 #ifdef __cplusplus
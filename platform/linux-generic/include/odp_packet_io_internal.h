@@ -42,14 +42,19 @@ extern "C" {
 #define PKTIN_INVALID  ((odp_pktin_queue_t) {ODP_PKTIO_INVALID, 0})
 #define PKTOUT_INVALID ((odp_pktout_queue_t) {ODP_PKTIO_INVALID, 0})
 
+/* Receive loops of drivers prefetch packet data and metadata this many
+ * packets ahead of the packet being processed */
+#define PKTIN_PREFETCH_AHEAD 4
+
 /** Determine if a socket read/write error should be reported. Transient errors
  *  that simply require the caller to retry are ignored, the _send/_recv APIs
  *  are non-blocking and it is the caller's responsibility to retry if the
  *  requested number of packets were not handled. */
 #define SOCK_ERR_REPORT(e) (e != EAGAIN && e != EWOULDBLOCK && e != EINTR)
 
-/* Forward declaration */
+/* Forward declarations */
 struct pktio_if_ops;
+struct pcapng_queue_s;
 
 #if defined(ODP_NETMAP)
 #define PKTIO_PRIVATE_SIZE 74752
@@ -59,6 +64,17 @@ struct pktio_if_ops;
 #define PKTIO_PRIVATE_SIZE 384
 #endif
 
+/* Per queue statistics. Counters of a queue are written only by the thread
+ * operating the queue (lockless queue or queue lock held), which allows
+ * plain increments. Each queue has its own cache line. */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_pktin_queue_stats_t s;
+} pktin_queue_stats_t;
+
+typedef struct ODP_ALIGNED_CACHE {
+	odp_pktout_queue_stats_t s;
+} pktout_queue_stats_t;
+
 struct pktio_entry {
 	const struct pktio_if_ops *ops; /**< Implementation specific methods */
 	/* These two locks together lock the whole pktio device */
@@ -66,7 +82,14 @@ struct pktio_entry {
 	odp_ticketlock_t txl;		/**< TX ticketlock */
 	uint8_t cls_enabled;            /**< classifier enabled */
 	uint8_t chksum_insert_ena;      /**< pktout checksum offload enabled */
+	uint8_t flow_hash_ena;          /**< pktin flow hash enabled */
+	uint8_t flow_group_ena;         /**< pktin flow grouping enabled */
+	uint8_t tcp_seg_ena;            /**< pktout TCP segmentation enabled */
+	uint8_t tcp_seg_drv;            /**< TCP segmentation done by driver */
+	uint8_t tcp_gro_ena;            /**< pktin TCP receive offload enabled */
 	odp_pktio_t handle;		/**< pktio handle */
+	uint32_t fd_gen;		/**< pktin file descriptor generation,
+					   incremented on every start */
 	unsigned char ODP_ALIGNED_CACHE pkt_priv[PKTIO_PRIVATE_SIZE];
 	enum {
 		/* Not allocated */
@@ -102,10 +125,17 @@ struct pktio_entry {
 	 * Multi-queue support is pktio driver specific */
 	unsigned num_in_queue;
 	unsigned num_out_queue;
+	/* Operation mode of output queues */
+	odp_pktio_op_mode_t out_op_mode;
 
 	struct {
 		odp_queue_t        queue;
 		odp_pktin_queue_t  pktin;
+		/* TCP receive offload statistics */
+		odp_atomic_u64_t   gro_pkts;
+		odp_atomic_u64_t   gro_segs;
+		/* Current scheduler poll burst size */
+		uint16_t           sched_burst;
 	} in_queue[PKTIO_MAX_QUEUES];
 
 	struct {
@@ -113,6 +143,10 @@ struct pktio_entry {
 		odp_pktout_queue_t pktout;
 	} out_queue[PKTIO_MAX_QUEUES];
 
+	/* Input and output queue statistics */
+	pktin_queue_stats_t in_queue_stats[PKTIO_MAX_QUEUES];
+	pktout_queue_stats_t out_queue_stats[PKTIO_MAX_QUEUES];
+
 	/**< inotify instance for pcapng fifos */
 	struct {
 		enum {
@@ -120,6 +154,14 @@ struct pktio_entry {
 			PCAPNG_WR_PKT,
 		} state[PKTIO_MAX_QUEUES];
 		int fd[PKTIO_MAX_QUEUES];
+		/* Ignore inotify open event caused by fifo open of our own */
+		uint8_t skip_open[PKTIO_MAX_QUEUES];
+		/* Per queue capture rings, NULL when datapath writes fifos */
+		struct pcapng_queue_s *queue;
+		odp_shm_t shm;
+		uint32_t snaplen;		/**< max captured packet length */
+		uint32_t rec_size;		/**< capture record size */
+		uint32_t ring_mask;
 	} pcapng;
 };
 
@@ -130,6 +172,14 @@ typedef union {
 
 typedef struct {
 	odp_spinlock_t lock;
+
+	struct {
+		/* Adapt scheduler poll burst sizes to pktin queue occupancy */
+		uint8_t sched_burst_adapt;
+		/* Minimum adapted burst size */
+		uint16_t sched_burst_min;
+	} config;
+
 	pktio_entry_t entries[ODP_CONFIG_PKTIO_ENTRIES];
 } pktio_table_t;
 
@@ -155,7 +205,9 @@ typedef struct pktio_if_ops {
 	int (*recv_mq_tmo)(pktio_entry_t *entry[], int index[], int num_q,
 			   odp_packet_t packets[], int num, unsigned *from,
 			   uint64_t wait_usecs);
-	int (*fd_set)(pktio_entry_t *entry, int index, fd_set *readfds);
+	/* Output file descriptors that become readable when input queue
+	 * 'index' may have packets. Returns the number of descriptors. */
+	int (*pktin_fds)(pktio_entry_t *entry, int index, int fds[], int num);
 	int (*send)(pktio_entry_t *entry, int index,
 		    const odp_packet_t packets[], int num);
 	uint32_t (*mtu_get)(pktio_entry_t *pktio_entry);
@@ -204,6 +256,33 @@ static inline void pktio_cls_enabled_set(pktio_entry_t *entry, int ena)
 	entry->s.cls_enabled = ena;
 }
 
+/* Update TCP receive offload statistics of an input queue */
+static inline void pktio_gro_stats_add(pktio_entry_t *entry, int index,
+				       uint32_t merged_pkts,
+				       uint32_t merged_segs)
+{
+	odp_atomic_add_u64(&entry->s.in_queue[index].gro_pkts, merged_pkts);
+	odp_atomic_add_u64(&entry->s.in_queue[index].gro_segs, merged_segs);
+}
+
+/* Statistics of an input queue, updated by drivers */
+static inline odp_pktin_queue_stats_t *pktio_in_stats(pktio_entry_t *entry,
+						      int index)
+{
+	return &entry->s.in_queue_stats[index].s;
+}
+
+/* Statistics of an output queue, updated by drivers */
+static inline odp_pktout_queue_stats_t *pktio_out_stats(pktio_entry_t *entry,
+							int index)
+{
+	return &entry->s.out_queue_stats[index].s;
+}
+
+/* Add input and output queue counters to interface statistics */
+void _odp_pktio_queue_stats_sum(pktio_entry_t *entry,
+				odp_pktio_stats_t *stats);
+
 extern const pktio_if_ops_t netmap_pktio_ops;
 extern const pktio_if_ops_t dpdk_pktio_ops;
 extern const pktio_if_ops_t sock_mmsg_pktio_ops;
@@ -215,6 +294,7 @@ extern const pktio_if_ops_t pcap_pktio_ops;
 extern const pktio_if_ops_t tap_pktio_ops;
 extern const pktio_if_ops_t null_pktio_ops;
 extern const pktio_if_ops_t ipc_pktio_ops;
+extern const pktio_if_ops_t memif_pktio_ops;
 extern const pktio_if_ops_t * const pktio_if_ops[];
 
 /**
@@ -237,6 +317,28 @@ int sock_recv_mq_tmo_try_int_driven(const struct odp_pktin_queue_t queues[],
 				    uint64_t usecs,
 				    int *trial_successful);
 
+/**
+ * Wait for packets on input queues
+ *
+ * Blocks on the file descriptors of the queues (see pktin_fds operation) until
+ * any of the queues may have packets, or the timeout expires. A wait may also
+ * end early, so callers must check the time and poll the queues again.
+ *
+ * @param entry Pktio entries of the queues
+ * @param index Queue indices
+ * @param num_q Number of queues
+ * @param nsec Nanoseconds to wait
+ *
+ * @retval 1 A queue may have packets
+ * @retval 0 Timeout
+ * @retval <0 A queue does not support waiting, caller needs to poll
+ */
+int _odp_pktin_fd_wait(pktio_entry_t *entry[], const int index[],
+		       uint32_t num_q, uint64_t nsec);
+
+/* Release thread local resources of _odp_pktin_fd_wait() */
+void _odp_pktin_fd_wait_term_local(void);
+
 #ifdef __cplusplus
 }
 #endif
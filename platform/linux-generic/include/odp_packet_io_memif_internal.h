@@ -0,0 +1,156 @@
+/* Copyright (c) 2018, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+/**
+ * @file
+ *
+ * Shared memory packet interface (memif) protocol definitions
+ *
+ * Wire compatible with version 2.0 of the memif protocol of libmemif and
+ * the VPP memif plugin. The slave creates shared memory regions and rings,
+ * and passes them (file descriptors) to the master over a Unix domain
+ * control socket. Slave to master (S2M) rings carry packets from the slave
+ * to the master and master to slave (M2S) rings the opposite way. Buffers
+ * of both ring types are owned by the slave.
+ */
+
+#ifndef ODP_PACKET_IO_MEMIF_INTERNAL_H_
+#define ODP_PACKET_IO_MEMIF_INTERNAL_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <odp/api/align.h>
+#include <odp/api/debug.h>
+
+#include <stdint.h>
+
+#define MEMIF_COOKIE		0x3E31F20
+#define MEMIF_VERSION_MAJOR	2
+#define MEMIF_VERSION_MINOR	0
+#define MEMIF_VERSION		((MEMIF_VERSION_MAJOR << 8) | \
+				 MEMIF_VERSION_MINOR)
+
+#define MEMIF_NAME_LEN		32
+#define MEMIF_SECRET_LEN	24
+#define MEMIF_ERR_STRING_LEN	96
+
+/* Cache line size of the protocol, independent of ODP_CACHE_LINE_SIZE */
+#define MEMIF_CACHE_LINE_SIZE	64
+
+/* Control message types */
+#define MEMIF_MSG_TYPE_NONE		0
+#define MEMIF_MSG_TYPE_ACK		1
+#define MEMIF_MSG_TYPE_HELLO		2
+#define MEMIF_MSG_TYPE_INIT		3
+#define MEMIF_MSG_TYPE_ADD_REGION	4
+#define MEMIF_MSG_TYPE_ADD_RING		5
+#define MEMIF_MSG_TYPE_CONNECT		6
+#define MEMIF_MSG_TYPE_CONNECTED	7
+#define MEMIF_MSG_TYPE_DISCONNECT	8
+
+#define MEMIF_INTERFACE_MODE_ETHERNET	0
+
+/* Ring is a slave to master ring (add ring message flag) */
+#define MEMIF_MSG_ADD_RING_FLAG_S2M	0x1
+
+/* Ring consumer polls the ring and does not want interrupts (ring flag) */
+#define MEMIF_RING_FLAG_MASK_INT	0x1
+
+/* Packet continues in the next descriptor (descriptor flag) */
+#define MEMIF_DESC_FLAG_NEXT		0x1
+
+typedef struct ODP_PACKED {
+	uint8_t name[MEMIF_NAME_LEN];
+	uint16_t min_version;
+	uint16_t max_version;
+	uint16_t max_region;		/**< max region index */
+	uint16_t max_m2s_ring;		/**< max M2S ring index */
+	uint16_t max_s2m_ring;		/**< max S2M ring index */
+	uint8_t max_log2_ring_size;
+} memif_msg_hello_t;
+
+typedef struct ODP_PACKED {
+	uint16_t version;
+	uint32_t id;			/**< interface id */
+	uint8_t mode;
+	uint8_t secret[MEMIF_SECRET_LEN];
+	uint8_t name[MEMIF_NAME_LEN];
+} memif_msg_init_t;
+
+typedef struct ODP_PACKED {
+	uint16_t index;
+	uint64_t size;
+} memif_msg_add_region_t;
+
+typedef struct ODP_PACKED {
+	uint16_t flags;
+	uint16_t index;
+	uint16_t region;
+	uint32_t offset;		/**< ring offset in region */
+	uint8_t log2_ring_size;
+	uint16_t private_hdr_size;
+} memif_msg_add_ring_t;
+
+typedef struct ODP_PACKED {
+	uint8_t if_name[MEMIF_NAME_LEN];
+} memif_msg_connect_t;
+
+typedef struct ODP_PACKED {
+	uint32_t code;
+	uint8_t string[MEMIF_ERR_STRING_LEN];
+} memif_msg_disconnect_t;
+
+/* Control message. Region and ring messages carry a file descriptor
+ * (SCM_RIGHTS): the region memory and the ring interrupt eventfd. */
+typedef struct ODP_PACKED ODP_ALIGNED(128) {
+	uint16_t type;
+	union ODP_PACKED {
+		memif_msg_hello_t hello;
+		memif_msg_init_t init;
+		memif_msg_add_region_t add_region;
+		memif_msg_add_ring_t add_ring;
+		memif_msg_connect_t connect;
+		memif_msg_connect_t connected;
+		memif_msg_disconnect_t disconnect;
+	};
+} memif_msg_t;
+
+ODP_STATIC_ASSERT(sizeof(memif_msg_t) == 128, "memif_msg_t size");
+
+/* Ring descriptor */
+typedef struct ODP_PACKED {
+	uint16_t flags;
+	uint16_t region;
+	uint32_t length;		/**< data length or buffer size */
+	uint32_t offset;		/**< buffer offset in region */
+	uint32_t metadata;
+} memif_desc_t;
+
+ODP_STATIC_ASSERT(sizeof(memif_desc_t) == 16, "memif_desc_t size");
+
+/* Ring header followed by descriptors. Producer of a ring moves head and
+ * consumer tail. On M2S rings the slave produces empty buffers (head) and
+ * the master fills them (tail). */
+typedef struct {
+	uint32_t cookie;
+	uint16_t flags;
+	volatile uint16_t head;
+	uint8_t pad0[MEMIF_CACHE_LINE_SIZE - 8];
+	volatile uint16_t tail;
+	uint8_t pad1[MEMIF_CACHE_LINE_SIZE - 2];
+	memif_desc_t desc[];
+} memif_ring_t;
+
+ODP_STATIC_ASSERT(sizeof(memif_ring_t) == 2 * MEMIF_CACHE_LINE_SIZE,
+		  "memif_ring_t size");
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -14,6 +14,10 @@
 #define PCAPNG_ENDIAN_MAGIC 0x1A2B3C4DUL
 #define PCAPNG_DATA_ALIGN 4
 #define PCAPNG_LINKTYPE_ETHERNET 0x1
+#define PCAPNG_OPT_END 0
+#define PCAPNG_OPT_IF_TSRESOL 9
+/* Timestamps in nanoseconds */
+#define PCAPNG_TSRESOL_NS 9
 
 /* inotify */
 #define INOTIFY_BUF_LEN (16 * (sizeof(struct inotify_event)))
@@ -36,6 +40,12 @@ typedef struct pcapng_interface_description_block {
 	uint16_t linktype;
 	uint16_t reserved;
 	uint32_t snaplen;
+	uint16_t tsresol_code;
+	uint16_t tsresol_len;
+	uint8_t tsresol;
+	uint8_t tsresol_pad[3];
+	uint16_t end_code;
+	uint16_t end_len;
 	uint32_t block_total_length2;
 } pcapng_interface_description_block_t;
 
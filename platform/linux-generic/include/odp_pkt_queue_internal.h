@@ -37,12 +37,21 @@ typedef uint32_t _odp_int_pkt_queue_t;
  * some sort of backlog.
  */
 
-/* max_num_queues must be <= 16 * 1024 * 1024. */
+/* max_num_queues must be <= 16 * 1024 * 1024. Queue blocks and per queue
+ * state are allocated in chunks on demand, so memory usage follows the number
+ * of created queues and the peak number of queued pkts. Any pkts still queued
+ * are freed by _odp_queue_pool_destroy(). */
 _odp_int_queue_pool_t _odp_queue_pool_create(uint32_t max_num_queues,
 					     uint32_t max_queued_pkts);
 
 _odp_int_pkt_queue_t _odp_pkt_queue_create(_odp_int_queue_pool_t queue_pool);
 
+/* Destroy an empty pkt_queue. Queue numbers are handed out in creation order
+ * and only the most recently created queue can be destroyed, which returns its
+ * number to the pool. Returns 0 on success, -1 otherwise. */
+int _odp_pkt_queue_destroy(_odp_int_queue_pool_t queue_pool,
+			   _odp_int_pkt_queue_t  pkt_queue);
+
 int _odp_pkt_queue_append(_odp_int_queue_pool_t queue_pool,
 			  _odp_int_pkt_queue_t  pkt_queue,
 			  odp_packet_t          pkt);
@@ -51,6 +60,21 @@ int _odp_pkt_queue_remove(_odp_int_queue_pool_t queue_pool,
 			  _odp_int_pkt_queue_t  pkt_queue,
 			  odp_packet_t         *pkt);
 
+/* Append up to num pkts to the tail of pkt_queue, in order. Returns the number
+ * of pkts appended, which is less than num when the pool runs out of queue
+ * blocks, 0 when num is 0, or -1 when no pkts could be appended. */
+int _odp_pkt_queue_append_multi(_odp_int_queue_pool_t queue_pool,
+				_odp_int_pkt_queue_t  pkt_queue,
+				const odp_packet_t    pkts[],
+				int                   num);
+
+/* Remove up to max_num pkts from the head of pkt_queue. Returns the number of
+ * pkts removed (0 when the queue is empty). */
+int _odp_pkt_queue_remove_multi(_odp_int_queue_pool_t queue_pool,
+				_odp_int_pkt_queue_t  pkt_queue,
+				odp_packet_t          pkts[],
+				int                   max_num);
+
 void _odp_pkt_queue_stats_print(_odp_int_queue_pool_t queue_pool);
 
 void _odp_queue_pool_destroy(_odp_int_queue_pool_t queue_pool);
@@ -19,6 +19,16 @@ extern "C" {
 #define _ODP_SHM_PROC_NOCREAT 0x40  /**< Do not create shm if not exist */
 #define _ODP_SHM_O_EXCL	      0x80  /**< Do not create shm if exist */
 
+/**
+ * File descriptor of a shared memory block
+ *
+ * The descriptor can be passed to other processes for mapping the block.
+ * It remains owned by the shm block and must not be closed.
+ *
+ * @return File descriptor, or -1 on failure
+ */
+int _odp_shm_fd(odp_shm_t shm);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,12 @@ extern "C" {
 
 #include <string.h>
 #include <linux/if_ether.h>
+#include <linux/virtio_net.h>
+
+#include <odp/api/packet.h>
+
+/* Maximum length of packet headers (L2-L4) of kernel segmented TCP packets */
+#define VNET_TCP_HDR_MAX 256
 
 static inline void
 ethaddr_copy(unsigned char mac_dst[], unsigned char mac_src[])
@@ -51,6 +57,30 @@ int promisc_mode_get_fd(int fd, const char *name);
  */
 int link_status_fd(int fd, const char *name);
 
+/**
+ * Complete partial checksum of a packet received with
+ * VIRTIO_NET_HDR_F_NEEDS_CSUM
+ */
+int vnet_hdr_csum_complete(odp_packet_t pkt,
+			   const struct virtio_net_hdr *vnet);
+
+/**
+ * Set MSS of a parsed TCP packet coalesced by the kernel and return the
+ * number of segments it contains (0 when not a TCP packet)
+ */
+uint32_t vnet_hdr_gso_segs(odp_packet_t pkt, uint32_t gso_size);
+
+/**
+ * Fill in virtio net header for kernel TCP segmentation
+ *
+ * Packet headers (L2-L4) must be in the first segment and fit into
+ * VNET_TCP_HDR_MAX bytes. Headers are copied into 'hdr' with the pseudo header
+ * checksum in the TCP checksum field. Packet data is not modified. Returns the
+ * header length when the packet is segmented by the kernel, 0 otherwise.
+ */
+uint32_t vnet_hdr_tcp_seg(odp_packet_t pkt, uint32_t len,
+			  struct virtio_net_hdr *vnet, uint8_t hdr[]);
+
 #ifdef __cplusplus
 }
 #endif
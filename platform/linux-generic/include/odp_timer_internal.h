@@ -45,6 +45,11 @@ typedef struct {
  * If the application will use both scheduler and timer this flag is set
  * to true, otherwise false. This application conveys this information via
  * the 'not_used' bits in odp_init_t which are passed to odp_global_init().
+ *
+ * Timer pools are processed by any thread calling the scheduler. When
+ * enabled with the timer.inline_owner config option, a private timer pool
+ * (odp_timer_pool_param_t 'priv') is processed only by the thread that
+ * created it.
  */
 extern odp_bool_t inline_timers;
 
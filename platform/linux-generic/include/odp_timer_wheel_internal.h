@@ -49,6 +49,17 @@ int _odp_timer_wheel_insert(_odp_timer_wheel_t timer_wheel,
  */
 uint64_t _odp_timer_wheel_next_expired(_odp_timer_wheel_t timer_wheel);
 
+/* Advances the timer wheels to current_time (like
+ * _odp_timer_wheel_curr_time_update) and then stores up to num expired
+ * timers into user_context[], oldest first.  Returns the number of timers
+ * stored.  Expired timers that did not fit are returned by later calls, so
+ * a caller may pass a small array and call this once per iteration.
+ */
+uint32_t _odp_timer_wheel_expired_get(_odp_timer_wheel_t timer_wheel,
+				      uint64_t           current_time,
+				      uint64_t           user_context[],
+				      uint32_t           num);
+
 /* Returns the number of timers that have been inserted but not yet passed
  * back to the user.  This number includes the number of timers that have
  * internally expired and are in the expired list, but have not yet been
@@ -35,6 +35,18 @@ typedef struct stat  file_stat_t;
 
 #define INPUT_WORK_RING_SIZE  (16 * 1024)
 
+/* Maximum number of input work items processed and packets sent to pktout
+ * per TM thread loop iteration (tm.burst_size config option) */
+#define TM_MAX_BURST  64
+
+/* Maximum number of partitions (TM threads) per TM system (tm.num_threads
+ * config option) */
+#define TM_MAX_PARTITIONS  16
+
+/* Maximum shaper time slot length in nsec (tm.shaper_slot_ns config
+ * option) */
+#define TM_MAX_SHAPER_SLOT_NS  (1000 * 1000)
+
 #define TM_QUEUE_MAGIC_NUM   0xBABEBABE
 #define TM_NODE_MAGIC_NUM    0xBEEFBEEF
 
@@ -280,6 +292,7 @@ struct tm_queue_obj_s {
 	uint8_t priority;
 	uint8_t blocked_priority;
 	uint8_t tm_idx;
+	uint8_t partition;
 	uint8_t delayed_cnt;
 	uint8_t blocked_cnt;
 	odp_queue_t queue;
@@ -300,6 +313,7 @@ struct tm_node_obj_s {
 	uint8_t              is_root_node;  /* Represents the egress. */
 	uint8_t              level;   /* Primarily for debugging */
 	uint8_t              tm_idx;
+	uint8_t              partition;
 	uint8_t              marked;
 };
 
@@ -308,15 +322,26 @@ typedef struct {
 	uint32_t     queue_num;
 } input_work_item_t;
 
+/* Lock-free ring of input work items. Any number of threads may append
+ * (odp_tm_enq() et al), only the TM thread removes items. Ring indexes are
+ * formed from free running head and tail counters with a mask, so
+ * INPUT_WORK_RING_SIZE must be a power of two. A producer first reserves
+ * slots by moving w_head, writes the items and then releases them to the TM
+ * thread by moving w_tail in reservation order. The TM thread frees slots by
+ * moving r_tail. */
 typedef struct {
-	uint64_t          total_enqueues;
-	uint64_t          enqueue_fail_cnt;
-	uint64_t          total_dequeues;
-	odp_atomic_u64_t  queue_cnt;
+	/* Producer side */
+	odp_atomic_u32_t  w_head;
+	odp_atomic_u32_t  w_tail;
+	odp_atomic_u64_t  enqueue_fail_cnt;
+	uint8_t           pad0[ODP_CACHE_LINE_SIZE];
+
+	/* TM thread side */
+	odp_atomic_u32_t  r_tail;
 	uint32_t          peak_cnt;
-	uint32_t          head_idx;
-	uint32_t          tail_idx;
-	odp_ticketlock_t  lock;
+	uint64_t          total_dequeues;
+	uint8_t           pad1[ODP_CACHE_LINE_SIZE];
+
 	input_work_item_t work_ring[INPUT_WORK_RING_SIZE];
 } input_work_queue_t;
 
@@ -379,6 +404,17 @@ struct tm_system_s {
 	_odp_timer_wheel_t     _odp_int_timer_wheel;
 	_odp_int_sorted_pool_t _odp_int_sorted_pool;
 
+	/* A TM system is partitioned by top-level node subtrees. Each
+	 * partition is serviced by its own TM thread and has its own input
+	 * work queue, pools, timer wheel and egress state. Partition 0 is the
+	 * TM system itself, the others are separate tm_system_t records.
+	 * Configuration, queue counters and marking are kept in the parent
+	 * (partition 0), which is also the parent of itself. */
+	tm_system_t *parent;
+	tm_system_t *partition[TM_MAX_PARTITIONS];
+	uint32_t     num_partitions;
+	uint32_t     next_partition;
+
 	tm_node_obj_t        *root_node;
 	odp_tm_egress_t       egress;
 	odp_tm_requirements_t requirements;
@@ -392,7 +428,12 @@ struct tm_system_s {
 
 	tm_random_data_t tm_random_data;
 	odp_pktout_queue_t pktout;
+	uint32_t     egress_burst_num;
+	odp_packet_t egress_burst[TM_MAX_BURST];
 	uint64_t   current_time;
+	/* Start time of the current shaper time slot. Equals current_time
+	 * when time slotted shaping is not used. */
+	uint64_t   shaper_time;
 	uint8_t    tm_idx;
 	uint8_t    first_enq;
 	odp_bool_t is_idle;
@@ -400,6 +441,7 @@ struct tm_system_s {
 	uint64_t shaper_green_cnt;
 	uint64_t shaper_yellow_cnt;
 	uint64_t shaper_red_cnt;
+	uint64_t shaper_delay_cnt;
 };
 
 /* A tm_system_group is a set of 1 to N tm_systems that share some processing
@@ -414,7 +456,7 @@ struct tm_system_group_s {
 	odp_barrier_t  tm_group_barrier;
 	tm_system_t   *first_tm_system;
 	uint32_t       num_tm_systems;
-	uint32_t       first_enq;
+	odp_atomic_u32_t first_enq;
 	pthread_t      thread;
 	pthread_attr_t attr;
 };
@@ -32,6 +32,11 @@ AC_CONFIG_FILES([platform/linux-generic/Makefile
 		 platform/linux-generic/test/validation/api/pktio/Makefile
 		 platform/linux-generic/test/mmap_vlan_ins/Makefile
 		 platform/linux-generic/test/pktio_ipc/Makefile
+		 platform/linux-generic/test/pktio_memif/Makefile
+		 platform/linux-generic/test/pkt_queue/Makefile
+		 platform/linux-generic/test/name_table/Makefile
 		 platform/linux-generic/test/ring/Makefile
+		 platform/linux-generic/test/sorted_list/Makefile
+		 platform/linux-generic/test/timer_wheel/Makefile
 		 platform/linux-generic/test/performance/Makefile])
 ])
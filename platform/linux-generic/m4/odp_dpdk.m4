@@ -13,16 +13,6 @@ AC_ARG_WITH([dpdk-path],
     [DPDK_PATH="$withval"
      pktio_dpdk_support=yes],[])
 
-##########################################################################
-# Enable zero-copy DPDK pktio
-##########################################################################
-zero_copy=0
-AC_ARG_ENABLE([dpdk-zero-copy],
-    [AS_HELP_STRING([--enable-dpdk-zero-copy], [enable experimental zero-copy DPDK pktio mode])],
-    [if test x$enableval = xyes; then
-        zero_copy=1
-    fi])
-
 ##########################################################################
 # Check for DPDK availability
 #
@@ -50,8 +40,6 @@ then
 
     AC_DEFINE([ODP_PKTIO_DPDK], [1],
 	      [Define to 1 to enable DPDK packet I/O support])
-    AC_DEFINE_UNQUOTED([ODP_DPDK_ZERO_COPY], [$zero_copy],
-	      [Define to 1 to enable DPDK zero copy support])
 else
     pktio_dpdk_support=no
 fi
@@ -985,10 +985,6 @@ static inline cos_t *cls_select_cos(pktio_entry_t *entry,
 	return cls->default_cos;
 }
 
-static uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
-				odp_cls_hash_proto_t hash_proto,
-				const uint8_t *base);
-
 /**
  * Classify packet
  *
@@ -1049,9 +1045,9 @@ int cls_classify_packet(pktio_entry_t *entry, const uint8_t *base,
 	return 0;
 }
 
-static uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
-				odp_cls_hash_proto_t hash_proto,
-				const uint8_t *base)
+uint32_t packet_rss_hash(odp_packet_hdr_t *pkt_hdr,
+			 odp_cls_hash_proto_t hash_proto,
+			 const uint8_t *base)
 {
 	thash_tuple_t tuple;
 	const _odp_ipv4hdr_t *ipv4;
@@ -412,6 +412,13 @@ static int term_local(enum init_stage stage)
 		}
 		/* Fall through */
 
+	case PKTIO_INIT:
+		if (odp_pktio_term_local()) {
+			ODP_ERR("ODP packet io local term failed.\n");
+			rc = -1;
+		}
+		/* Fall through */
+
 	case THREAD_INIT:
 		rc_thd = odp_thread_term_local();
 		if (rc_thd < 0) {
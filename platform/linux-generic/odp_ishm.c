@@ -1324,6 +1324,38 @@ void *_odp_ishm_address(int block_index)
 	return addr;
 }
 
+/*
+ * Returns the file descriptor of a given block (which has to be known in the
+ * current process). Returns -1 if the block is unknown. The descriptor remains
+ * owned by ishm and must not be closed by the caller.
+ */
+int _odp_ishm_fd(int block_index)
+{
+	int proc_index;
+	int fd;
+
+	odp_spinlock_lock(&ishm_tbl->lock);
+	procsync();
+
+	if ((block_index < 0) ||
+	    (block_index >= ISHM_MAX_NB_BLOCKS) ||
+	    (ishm_tbl->block[block_index].len == 0)) {
+		ODP_ERR("Request for fd of an invalid block\n");
+		odp_spinlock_unlock(&ishm_tbl->lock);
+		return -1;
+	}
+
+	proc_index = procfind_block(block_index);
+	if (proc_index < 0) {
+		odp_spinlock_unlock(&ishm_tbl->lock);
+		return -1;
+	}
+
+	fd = ishm_proctable->entry[proc_index].fd;
+	odp_spinlock_unlock(&ishm_tbl->lock);
+	return fd;
+}
+
 int _odp_ishm_info(int block_index, _odp_ishm_info_t *info)
 {
 	int proc_index;
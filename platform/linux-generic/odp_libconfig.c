@@ -60,7 +60,8 @@ int _odp_libconfig_init_global(void)
 		goto fail;
 	}
 	if (strcmp(vers, vers_rt) || strcmp(ipml, ipml_rt)) {
-		ODP_ERR("Runtime configuration mismatch\n");
+		ODP_ERR("Runtime configuration mismatch: %s %s, expected %s %s\n",
+			ipml_rt, vers_rt, ipml, vers);
 		goto fail;
 	}
 
@@ -94,6 +95,32 @@ int _odp_libconfig_lookup_int(const char *path, int *value)
 	return  (ret_def == CONFIG_TRUE || ret_rt == CONFIG_TRUE) ? 1 : 0;
 }
 
+/* Returns string length, or -1 when the option is not found or does not fit
+ * into the value buffer */
+int _odp_libconfig_lookup_str(const char *path, char *value,
+			      uint32_t str_size)
+{
+	const char *str;
+	size_t len;
+
+	/* Runtime option overrides default value */
+	if (config_lookup_string(&odp_global_data.libconfig_runtime, path,
+				 &str) != CONFIG_TRUE &&
+	    config_lookup_string(&odp_global_data.libconfig_default, path,
+				 &str) != CONFIG_TRUE)
+		return -1;
+
+	len = strlen(str);
+	if (len >= str_size) {
+		ODP_ERR("Config option %s too long\n", path);
+		return -1;
+	}
+
+	memcpy(value, str, len + 1);
+
+	return len;
+}
+
 static int lookup_int(config_t *cfg,
 		      const char *base_path,
 		      const char *local_path,
@@ -46,6 +46,15 @@
  /* The number of name tables should not be changed. */
 #define NUM_NAME_TBLS  16
 
+/* Maximum number of name_tbl_entry_t records a lock-free lookup walks
+ * before falling back to a locked lookup. Lists longer than this are
+ * possible only at the last secondary hash table level. */
+#define MAX_LOOKUP_LIST_LEN  0x40
+
+/* Number of lock-free lookup attempts before falling back to a locked
+ * lookup */
+#define MAX_LOOKUP_RETRIES   16
+
 #define SECONDARY_HASH_HISTO_PRINT  1
 #define SECONDARY_HASH_DUMP         0
 
@@ -111,6 +120,18 @@ static name_tbls_t        name_tbls;
 static odp_ticketlock_t   name_table_lock;
 static primary_hash_tbl_t name_hash_tbl;
 
+/* Writers (add and delete) are serialized by name_table_lock. Lookups do
+ * not take the lock, but use name_table_seq as a sequence lock: writers
+ * keep it odd while modifying hash tables or name_tbl_entry_t records, and
+ * a lookup that overlaps a modification is retried. Memory read by lookups
+ * is never returned to malloc while the name table is in use: name tables
+ * are only freed at term_global and freed secondary hash tables are kept
+ * on a free list for reuse, so a lookup following a stale pointer still
+ * reads valid (although possibly inconsistent) data.
+ */
+static odp_atomic_u32_t      name_table_seq;
+static secondary_hash_tbl_t *secondary_hash_free_list;
+
 static void *aligned_malloc(uint32_t length, uint32_t align)
 {
 	uintptr_t malloc_addr, mem_addr, alignment, total_length;
@@ -162,15 +183,48 @@ static secondary_hash_tbl_t *secondary_hash_tbl_alloc(void)
 {
 	secondary_hash_tbl_t *secondary_hash_tbl;
 
-	secondary_hash_tbl = aligned_malloc(sizeof(secondary_hash_tbl_t),
-					    ODP_CACHE_LINE_SIZE);
+	secondary_hash_tbl = secondary_hash_free_list;
+	if (secondary_hash_tbl)
+		secondary_hash_free_list = (secondary_hash_tbl_t *)
+			(uintptr_t)secondary_hash_tbl->hash_entries[0];
+	else
+		secondary_hash_tbl =
+			aligned_malloc(sizeof(secondary_hash_tbl_t),
+				       ODP_CACHE_LINE_SIZE);
+
 	memset(secondary_hash_tbl, 0, sizeof(secondary_hash_tbl_t));
 	return secondary_hash_tbl;
 }
 
 static void secondary_hash_tbl_free(secondary_hash_tbl_t *secondary_hash_tbl)
 {
-	aligned_free(secondary_hash_tbl);
+	/* Lock-free lookups may still read this table, so keep it for reuse
+	 * as a secondary hash table. The free list link is stored into the
+	 * first entry, which looks like a pointer to another secondary hash
+	 * table to a lookup. */
+	memset(secondary_hash_tbl, 0, sizeof(secondary_hash_tbl_t));
+	secondary_hash_tbl->hash_entries[0] =
+		(hash_tbl_entry_t)(uintptr_t)secondary_hash_free_list;
+	secondary_hash_free_list = secondary_hash_tbl;
+}
+
+static inline void name_table_write_begin(void)
+{
+	odp_atomic_store_u32(&name_table_seq,
+			     odp_atomic_load_u32(&name_table_seq) + 1);
+	/* Sequence count update is visible before any table modification */
+	odp_mb_release();
+}
+
+static inline void name_table_write_end(void)
+{
+	odp_atomic_store_rel_u32(&name_table_seq,
+				 odp_atomic_load_u32(&name_table_seq) + 1);
+}
+
+static inline hash_tbl_entry_t hash_entry_load(const hash_tbl_entry_t *ptr)
+{
+	return __atomic_load_n(ptr, __ATOMIC_RELAXED);
 }
 
 static void check_secondary_hash(secondary_hash_tbl_t *secondary_hash_tbl)
@@ -374,8 +428,10 @@ static void name_tbl_entry_free(name_tbl_entry_t *name_tbl_entry)
 	if (!entry)
 		return;
 
+	/* The id identifies the entry slot, keep it for the next user */
 	memset(name_tbl_entry, 0, sizeof(name_tbl_entry_t));
-	name_tbl_entry->next_entry = name_tbl->free_list_head;
+	name_tbl_entry->name_tbl_id = name_tbl_id;
+	name_tbl_entry->next_entry  = name_tbl->free_list_head;
 	name_tbl->free_list_head   = name_tbl_entry;
 }
 
@@ -399,7 +455,8 @@ static name_tbl_entry_t *name_hash_tbl_lookup(uint32_t hash_value)
 	uint32_t              hash_idx;
 
 	hash_idx       = hash_value & (PRIMARY_HASH_TBL_SIZE - 1);
-	hash_tbl_entry = name_hash_tbl.hash_entries[hash_idx];
+	hash_tbl_entry =
+		hash_entry_load(&name_hash_tbl.hash_entries[hash_idx]);
 	if (hash_tbl_entry == 0)
 		return NULL;
 	else if ((hash_tbl_entry & 0x3F) != 0)
@@ -410,7 +467,8 @@ static name_tbl_entry_t *name_hash_tbl_lookup(uint32_t hash_value)
 	*/
 	hash_idx       = (hash_value >> 16) & (SECONDARY_HASH_TBL_SIZE - 1);
 	secondary_hash = (secondary_hash_tbl_t *)(uintptr_t)hash_tbl_entry;
-	hash_tbl_entry = secondary_hash->hash_entries[hash_idx];
+	hash_tbl_entry =
+		hash_entry_load(&secondary_hash->hash_entries[hash_idx]);
 	if (hash_tbl_entry == 0)
 		return NULL;
 	else if ((hash_tbl_entry & 0x3F) != 0)
@@ -424,7 +482,8 @@ static name_tbl_entry_t *name_hash_tbl_lookup(uint32_t hash_value)
 	*/
 	hash_idx       = (hash_value >> 24) & (SECONDARY_HASH_TBL_SIZE - 1);
 	secondary_hash = (secondary_hash_tbl_t *)(uintptr_t)hash_tbl_entry;
-	hash_tbl_entry = secondary_hash->hash_entries[hash_idx];
+	hash_tbl_entry =
+		hash_entry_load(&secondary_hash->hash_entries[hash_idx]);
 	if (hash_tbl_entry == 0)
 		return NULL;
 	else if ((hash_tbl_entry & 0x3F) != 0)
@@ -455,6 +514,38 @@ static name_tbl_entry_t *internal_name_lookup(const char *name,
 	return NULL;
 }
 
+/* Lock-free version of internal_name_lookup(). Returns 1 and the name
+ * table id when found, 0 when not found and -1 when the lookup walked into
+ * a too long (or, due to a concurrent modification, circular) list.
+ */
+static int lockless_name_lookup(const char      *name,
+				uint8_t          name_kind,
+				uint32_t         hash_value,
+				uint32_t         name_len,
+				_odp_int_name_t *name_tbl_id)
+{
+	name_tbl_entry_t *name_tbl_entry;
+	uint32_t          cnt;
+
+	name_tbl_entry = name_hash_tbl_lookup(hash_value);
+	for (cnt = 0; name_tbl_entry; cnt++) {
+		if (cnt == MAX_LOOKUP_LIST_LEN)
+			return -1;
+
+		if ((name_tbl_entry->name_kind == name_kind)   &&
+		    (name_tbl_entry->name_len  == name_len)    &&
+		    (memcmp(name_tbl_entry->name, name, name_len) == 0)) {
+			*name_tbl_id = name_tbl_entry->name_tbl_id;
+			return 1;
+		}
+
+		name_tbl_entry = __atomic_load_n(&name_tbl_entry->next_entry,
+						 __ATOMIC_RELAXED);
+	}
+
+	return 0;
+}
+
 static hash_tbl_entry_t secondary_hash_add(name_tbl_entry_t *name_tbl_entry,
 					   uint32_t level,
 					   uint32_t hash_shift)
@@ -889,6 +980,10 @@ _odp_int_name_t _odp_int_name_tbl_add(const char *name,
 		return ODP_INVALID_NAME;
 	}
 
+	/* A lookup may still hold a pointer to this entry from its previous
+	 * use */
+	name_table_write_begin();
+
 	hash_value                  = hash_name_and_kind(name, name_kind);
 	name_tbl_entry->next_entry  = NULL;
 	name_tbl_entry->user_data   = user_data;
@@ -901,10 +996,12 @@ _odp_int_name_t _odp_int_name_tbl_add(const char *name,
 	rc = name_hash_tbl_add(name_tbl_entry, hash_value);
 	if (rc < 0) {
 		name_tbl_entry_free(name_tbl_entry);
+		name_table_write_end();
 		odp_ticketlock_unlock(&name_table_lock);
 		return ODP_INVALID_NAME;
 	}
 
+	name_table_write_end();
 	name_tbls.num_adds++;
 	name_tbls.current_num_names++;
 	odp_ticketlock_unlock(&name_table_lock);
@@ -926,6 +1023,7 @@ int _odp_int_name_tbl_delete(_odp_int_name_t odp_name)
 
 	/* First disconnect this entry from its hash bucket linked list. */
 	odp_ticketlock_lock(&name_table_lock);
+	name_table_write_begin();
 	rc = name_hash_tbl_delete(entry_to_delete, entry_to_delete->hash_value);
 	if (0 <= rc) {
 		name_tbls.num_deletes++;
@@ -935,6 +1033,7 @@ int _odp_int_name_tbl_delete(_odp_int_name_t odp_name)
 		name_tbl_entry_free(entry_to_delete);
 	}
 
+	name_table_write_end();
 	odp_ticketlock_unlock(&name_table_lock);
 	return rc;
 }
@@ -965,6 +1064,8 @@ _odp_int_name_t _odp_int_name_tbl_lookup(const char *name, uint8_t name_kind)
 {
 	name_tbl_entry_t *name_tbl_entry;
 	_odp_int_name_t   name_tbl_id;
+	uint32_t          hash_value, name_len, seq, retry;
+	int               rc;
 
 	/* Check for name_tbls_initialized. */
 	if (name_tbls_initialized == 0)
@@ -975,6 +1076,36 @@ _odp_int_name_t _odp_int_name_tbl_lookup(const char *name, uint8_t name_kind)
 	if ((!name) || (name[0] == '\0'))
 		return name_tbl_id;
 
+	name_len = strlen(name);
+	if (_ODP_INT_NAME_LEN < name_len)
+		return name_tbl_id;
+
+	hash_value = hash_name_and_kind(name, name_kind);
+
+	for (retry = 0; retry < MAX_LOOKUP_RETRIES; retry++) {
+		seq = odp_atomic_load_acq_u32(&name_table_seq);
+		if (seq & 1) {
+			odp_cpu_pause();
+			continue;
+		}
+
+		name_tbl_id = ODP_INVALID_NAME;
+		rc = lockless_name_lookup(name, name_kind, hash_value,
+					  name_len, &name_tbl_id);
+
+		/* Table reads complete before the sequence count check */
+		odp_mb_acquire();
+		if (odp_atomic_load_u32(&name_table_seq) != seq)
+			continue;
+
+		if (rc >= 0)
+			return name_tbl_id;
+
+		/* A valid list longer than the lock-free walk limit */
+		break;
+	}
+
+	name_tbl_id = ODP_INVALID_NAME;
 	odp_ticketlock_lock(&name_table_lock);
 	name_tbl_entry = internal_name_lookup(name, name_kind);
 	if (name_tbl_entry)
@@ -1188,6 +1319,8 @@ int _odp_int_name_tbl_init_global(void)
 
 	memset(&name_hash_tbl, 0, sizeof(name_hash_tbl));
 	odp_ticketlock_init(&name_table_lock);
+	odp_atomic_init_u32(&name_table_seq, 0);
+	secondary_hash_free_list = NULL;
 
 	memset(&name_tbls, 0, sizeof(name_tbls));
 	new_name_tbl = name_tbl_alloc(0, INITIAL_NAME_TBL_SIZE);
@@ -1203,11 +1336,19 @@ int _odp_int_name_tbl_init_global(void)
 
 int _odp_int_name_tbl_term_global(void)
 {
+	secondary_hash_tbl_t *secondary_hash;
 	int i;
 
 	for (i = 0; i < name_tbls.num_name_tbls; i++)
 		aligned_free(name_tbls.tbls[i]);
 
+	while (secondary_hash_free_list) {
+		secondary_hash = secondary_hash_free_list;
+		secondary_hash_free_list = (secondary_hash_tbl_t *)
+			(uintptr_t)secondary_hash->hash_entries[0];
+		aligned_free(secondary_hash);
+	}
+
 	name_tbls_initialized = 0;
 	return 0;
 }
@@ -266,6 +266,10 @@ static inline void packet_seg_copy_md(odp_packet_hdr_t *dst,
 	dst->dst_queue = src->dst_queue;
 	dst->flow_hash = src->flow_hash;
 	dst->timestamp = src->timestamp;
+	dst->tcp_mss   = src->tcp_mss;
+
+	/* dst becomes packet descriptor for (some of) the same segments */
+	dst->shared_segs = src->shared_segs;
 
 	/* buffer header side packet metadata */
 	dst->buf_hdr.user_ptr   = src->buf_hdr.user_ptr;
@@ -453,6 +457,7 @@ static inline void init_segments(odp_packet_hdr_t *pkt_hdr[], int num)
 	/* Defaults for single segment packet */
 	hdr->buf_hdr.seg[0].data = hdr->buf_hdr.base_data;
 	hdr->buf_hdr.seg[0].len  = seg_len;
+	hdr->shared_segs = 0;
 
 	if (ODP_DEBUG == 1) {
 		uint32_t prev_ref =
@@ -519,6 +524,7 @@ static inline void add_all_segs(odp_packet_hdr_t *to, odp_packet_hdr_t *from)
 	last->buf_hdr.next_seg = from;
 	to->buf_hdr.last_seg   = from->buf_hdr.last_seg;
 	to->buf_hdr.segcount  += from->buf_hdr.segcount;
+	to->shared_segs       |= from->shared_segs;
 }
 
 static inline odp_packet_hdr_t *alloc_segments(pool_t *pool, int num)
@@ -593,15 +599,20 @@ static inline int seg_is_link(void *hdr)
 	return pkt_hdr != pkt_hdr->buf_hdr.seg[0].hdr;
 }
 
-static inline void buffer_ref_inc(odp_buffer_hdr_t *buf_hdr)
+static inline void buffer_ref_add(odp_buffer_hdr_t *buf_hdr, uint32_t num)
 {
 	uint32_t ref_cnt = odp_atomic_load_u32(&buf_hdr->ref_cnt);
 
 	/* First count increment after alloc */
 	if (odp_likely(ref_cnt) == 0)
-		odp_atomic_store_u32(&buf_hdr->ref_cnt, 2);
+		odp_atomic_store_u32(&buf_hdr->ref_cnt, num + 1);
 	else
-		odp_atomic_inc_u32(&buf_hdr->ref_cnt);
+		odp_atomic_add_u32(&buf_hdr->ref_cnt, num);
+}
+
+static inline void buffer_ref_inc(odp_buffer_hdr_t *buf_hdr)
+{
+	buffer_ref_add(buf_hdr, 1);
 }
 
 static inline uint32_t buffer_ref_dec(odp_buffer_hdr_t *buf_hdr)
@@ -619,7 +630,14 @@ static inline int is_multi_ref(uint32_t ref_cnt)
 	return (ref_cnt > 1);
 }
 
-static inline void packet_ref_inc(odp_packet_hdr_t *pkt_hdr)
+/* Packets that have never been referenced do not need reference count
+ * updates on free. Debug builds count references of all segments. */
+static inline int packet_segs_shared(odp_packet_hdr_t *pkt_hdr)
+{
+	return ODP_DEBUG == 1 || pkt_hdr->shared_segs;
+}
+
+static inline void packet_ref_add(odp_packet_hdr_t *pkt_hdr, uint32_t num)
 {
 	seg_entry_t *seg;
 	int i;
@@ -627,9 +645,11 @@ static inline void packet_ref_inc(odp_packet_hdr_t *pkt_hdr)
 	odp_packet_hdr_t *hdr = pkt_hdr;
 	uint8_t idx = 0;
 
+	pkt_hdr->shared_segs = 1;
+
 	for (i = 0; i < seg_count; i++) {
 		seg = seg_entry_next(&hdr, &idx);
-		buffer_ref_inc(seg->hdr);
+		buffer_ref_add(seg->hdr, num);
 	}
 }
 
@@ -673,6 +693,19 @@ static inline void free_all_segments(odp_packet_hdr_t *pkt_hdr, int num)
 	int i;
 	odp_buffer_hdr_t *buf_hdr[num + 1];
 
+	if (odp_likely(!packet_segs_shared(pkt_hdr))) {
+		seg_entry_t *seg;
+		uint8_t idx = 0;
+
+		for (i = 0; i < num; i++) {
+			seg = seg_entry_next(&pkt_hdr, &idx);
+			buf_hdr[i] = seg->hdr;
+		}
+
+		buffer_free_multi(buf_hdr, num);
+		return;
+	}
+
 	if (odp_likely(pkt_hdr->buf_hdr.num_seg == num)) {
 		for (i = 0; i < num; i++)
 			buf_hdr[i] = pkt_hdr->buf_hdr.seg[i].hdr;
@@ -932,6 +965,11 @@ void odp_packet_free(odp_packet_t pkt)
 
 		buf_hdr[0] = &pkt_hdr->buf_hdr;
 
+		if (odp_likely(!packet_segs_shared(pkt_hdr))) {
+			buffer_free_multi(buf_hdr, 1);
+			return;
+		}
+
 		if (odp_unlikely(seg_is_link(pkt_hdr))) {
 			num        = 2;
 			buf_hdr[1] = pkt_hdr->buf_hdr.seg[0].hdr;
@@ -946,10 +984,10 @@ void odp_packet_free(odp_packet_t pkt)
 void odp_packet_free_multi(const odp_packet_t pkt[], int num)
 {
 	odp_buffer_hdr_t *buf_hdr[num];
-	odp_buffer_hdr_t *buf_hdr2[num];
+	odp_buffer_hdr_t *ref_hdr[2 * num];
 	int i;
-	int links = 0;
-	int num_freed = 0;
+	int num_ref = 0;
+	int num_free = 0;
 
 	for (i = 0; i < num; i++) {
 		odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt[i]);
@@ -959,23 +997,26 @@ void odp_packet_free_multi(const odp_packet_t pkt[], int num)
 
 		if (odp_unlikely(num_seg > 1)) {
 			free_all_segments(pkt_hdr, num_seg);
-			num_freed++;
 			continue;
 		}
 
-		if (odp_unlikely(seg_is_link(pkt_hdr))) {
-			buf_hdr2[links] = pkt_hdr->buf_hdr.seg[0].hdr;
-			links++;
+		if (odp_likely(!packet_segs_shared(pkt_hdr))) {
+			buf_hdr[num_free++] = &pkt_hdr->buf_hdr;
+			continue;
 		}
 
-		buf_hdr[i - num_freed] = &pkt_hdr->buf_hdr;
+		/* Link header and the segment it points to */
+		if (odp_unlikely(seg_is_link(pkt_hdr)))
+			ref_hdr[num_ref++] = pkt_hdr->buf_hdr.seg[0].hdr;
+
+		ref_hdr[num_ref++] = &pkt_hdr->buf_hdr;
 	}
 
-	if (odp_unlikely(links))
-		packet_free_multi(buf_hdr2, links);
+	if (odp_unlikely(num_ref))
+		packet_free_multi(ref_hdr, num_ref);
 
-	if (odp_likely(num - num_freed))
-		packet_free_multi(buf_hdr, num - num_freed);
+	if (odp_likely(num_free))
+		buffer_free_multi(buf_hdr, num_free);
 }
 
 void odp_packet_free_sp(const odp_packet_t pkt[], int num)
@@ -1340,6 +1381,27 @@ void odp_packet_l4_chksum_insert(odp_packet_t pkt, int insert)
 	pkt_hdr->p.flags.l4_chksum = insert;
 }
 
+void odp_packet_tcp_mss_set(odp_packet_t pkt, uint32_t mss)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+
+	if (mss > UINT16_MAX)
+		mss = UINT16_MAX;
+
+	pkt_hdr->tcp_mss = mss;
+	pkt_hdr->p.flags.tcp_seg = !!mss;
+}
+
+uint32_t odp_packet_tcp_mss(odp_packet_t pkt)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+
+	if (!pkt_hdr->p.flags.tcp_seg)
+		return 0;
+
+	return pkt_hdr->tcp_mss;
+}
+
 odp_packet_chksum_status_t odp_packet_l3_chksum_status(odp_packet_t pkt)
 {
 	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
@@ -1416,7 +1478,8 @@ uint32_t odp_packet_seg_data_len(odp_packet_t pkt, odp_packet_seg_t seg)
  *
  */
 
-int odp_packet_add_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
+static int packet_add_data_copy(odp_packet_t *pkt_ptr, uint32_t offset,
+				uint32_t len)
 {
 	odp_packet_t pkt = *pkt_ptr;
 	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
@@ -1424,9 +1487,6 @@ int odp_packet_add_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
 	pool_t *pool = pkt_hdr->buf_hdr.pool_ptr;
 	odp_packet_t newpkt;
 
-	if (offset > pktlen)
-		return -1;
-
 	newpkt = odp_packet_alloc(pool->pool_hdl, pktlen + len);
 
 	if (newpkt == ODP_PACKET_INVALID)
@@ -1446,17 +1506,51 @@ int odp_packet_add_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
 	return 1;
 }
 
-int odp_packet_rem_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
+int odp_packet_add_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
 {
 	odp_packet_t pkt = *pkt_ptr;
 	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
 	uint32_t pktlen = pkt_hdr->frame_len;
-	pool_t *pool = pkt_hdr->buf_hdr.pool_ptr;
-	odp_packet_t newpkt;
 
-	if (offset > pktlen || offset + len > pktlen)
+	if (offset > pktlen)
 		return -1;
 
+	if (odp_unlikely(odp_packet_has_ref(pkt)))
+		return packet_add_data_copy(pkt_ptr, offset, len);
+
+	/* Grow the packet from the end nearest to the offset (new segments
+	 * are linked in when head/tailroom runs out) and move only the data
+	 * between that end and the offset. */
+	if (offset <= pktlen - offset) {
+		if ((!CONFIG_PACKET_SEG_DISABLED || len <= pkt_hdr->headroom) &&
+		    odp_packet_extend_head(&pkt, len, NULL, NULL) == 0) {
+			if (offset)
+				(void)odp_packet_move_data(pkt, 0, len, offset);
+
+			*pkt_ptr = pkt;
+			return 1;
+		}
+	} else {
+		if ((!CONFIG_PACKET_SEG_DISABLED || len <= pkt_hdr->tailroom) &&
+		    odp_packet_extend_tail(&pkt, len, NULL, NULL) == 0) {
+			(void)odp_packet_move_data(pkt, offset + len, offset,
+						   pktlen - offset);
+			return 1;
+		}
+	}
+
+	return packet_add_data_copy(pkt_ptr, offset, len);
+}
+
+static int packet_rem_data_copy(odp_packet_t *pkt_ptr, uint32_t offset,
+				uint32_t len)
+{
+	odp_packet_t pkt = *pkt_ptr;
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t pktlen = pkt_hdr->frame_len;
+	pool_t *pool = pkt_hdr->buf_hdr.pool_ptr;
+	odp_packet_t newpkt;
+
 	newpkt = odp_packet_alloc(pool->pool_hdl, pktlen - len);
 
 	if (newpkt == ODP_PACKET_INVALID)
@@ -1476,6 +1570,78 @@ int odp_packet_rem_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
 	return 1;
 }
 
+int odp_packet_rem_data(odp_packet_t *pkt_ptr, uint32_t offset, uint32_t len)
+{
+	odp_packet_t pkt = *pkt_ptr;
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t pktlen = pkt_hdr->frame_len;
+
+	if (offset > pktlen || offset + len > pktlen)
+		return -1;
+
+	/* Removing all data would leave no segment to keep */
+	if (odp_unlikely(len == pktlen || odp_packet_has_ref(pkt)))
+		return packet_rem_data_copy(pkt_ptr, offset, len);
+
+	/* Move the shorter side over the removed area and truncate from that
+	 * end. Segments that become empty are freed, not copied. */
+	if (offset <= pktlen - offset - len) {
+		if (offset)
+			(void)odp_packet_move_data(pkt, len, 0, offset);
+
+		(void)odp_packet_trunc_head(&pkt, len, NULL, NULL);
+		*pkt_ptr = pkt;
+	} else {
+		(void)odp_packet_move_data(pkt, offset, offset + len,
+					   pktlen - offset - len);
+		(void)odp_packet_trunc_tail(&pkt, len, NULL, NULL);
+	}
+
+	return 1;
+}
+
+/* Move the first 'len' bytes of the packet into a new head segment, so that
+ * data at 'offset' gets the requested alignment. The rest of the packet
+ * stays in place. Returns 0 on success, or -1 when no segment was available.
+ */
+static int packet_align_head(odp_packet_t *pkt, uint32_t offset, uint32_t len,
+			     uint32_t align)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(*pkt);
+	pool_t *pool = pkt_hdr->buf_hdr.pool_ptr;
+	odp_packet_hdr_t *new_hdr;
+	uint64_t uaddr;
+	uint32_t pad;
+
+	if (pkt_hdr->buf_hdr.segcount >= CONFIG_PACKET_MAX_SEGS)
+		return -1;
+
+	new_hdr = alloc_segments(pool, 1);
+
+	if (new_hdr == NULL)
+		return -1;
+
+	uaddr = (uint64_t)(uintptr_t)(new_hdr->buf_hdr.seg[0].data + offset);
+	pad   = align <= 1 ? 0 : ROUNDUP_ALIGN(uaddr, align) - uaddr;
+
+	new_hdr->buf_hdr.seg[0].data += pad;
+	new_hdr->buf_hdr.seg[0].len   = len;
+	(void)odp_packet_copy_to_mem(*pkt, 0, len,
+				     new_hdr->buf_hdr.seg[0].data);
+
+	(void)odp_packet_trunc_head(pkt, len, NULL, NULL);
+	pkt_hdr = packet_hdr(*pkt);
+
+	add_all_segs(new_hdr, pkt_hdr);
+	packet_seg_copy_md(new_hdr, pkt_hdr);
+	new_hdr->frame_len = pkt_hdr->frame_len + len;
+	new_hdr->headroom  = pool->headroom + pad;
+	new_hdr->tailroom  = pkt_hdr->tailroom;
+
+	*pkt = packet_handle(new_hdr);
+	return 0;
+}
+
 int odp_packet_align(odp_packet_t *pkt, uint32_t offset, uint32_t len,
 		     uint32_t align)
 {
@@ -1487,6 +1653,7 @@ int odp_packet_align(odp_packet_t *pkt, uint32_t offset, uint32_t len,
 	void *addr = packet_map(pkt_hdr, offset, &seglen, NULL);
 	uint64_t uaddr = (uint64_t)(uintptr_t)addr;
 	uint64_t misalign;
+	uint32_t head_len = offset + len;
 
 	if (align > ODP_CACHE_LINE_SIZE)
 		return -1;
@@ -1510,6 +1677,15 @@ int odp_packet_align(odp_packet_t *pkt, uint32_t offset, uint32_t len,
 			shift += align - misalign;
 	}
 
+	/* When the data after the aligned area is longer than the data up to
+	 * its end, copy only the latter into a new head segment instead of
+	 * moving the whole packet. */
+	if (!CONFIG_PACKET_SEG_DISABLED &&
+	    head_len + align <= pool->seg_len &&
+	    pkt_hdr->frame_len - head_len > head_len &&
+	    packet_align_head(pkt, offset, head_len, align) == 0)
+		return 1;
+
 	rc = odp_packet_extend_head(pkt, shift, NULL, NULL);
 	if (rc < 0)
 		return rc;
@@ -1613,6 +1789,39 @@ odp_packet_t odp_packet_copy_part(odp_packet_t pkt, uint32_t offset,
 	return newpkt;
 }
 
+/* Move data towards packet tail within a packet. Data is copied from the end
+ * backwards, so that overlapping source data is read before it gets
+ * overwritten. */
+static void packet_move_data_back(odp_packet_hdr_t *pkt_hdr,
+				  uint32_t dst_offset, uint32_t src_offset,
+				  uint32_t len)
+{
+	odp_packet_hdr_t *hdr;
+	uint8_t idx;
+	uint32_t seg_offset, seg_idx, dst_len, src_len, cpylen;
+	uint8_t *dst_map, *src_map;
+
+	while (len > 0) {
+		hdr = pkt_hdr;
+		seg_entry_find_offset(&hdr, &idx, &seg_offset, &seg_idx,
+				      dst_offset + len - 1);
+		dst_map = hdr->buf_hdr.seg[idx].data + seg_offset + 1;
+		dst_len = seg_offset + 1;
+
+		hdr = pkt_hdr;
+		seg_entry_find_offset(&hdr, &idx, &seg_offset, &seg_idx,
+				      src_offset + len - 1);
+		src_map = hdr->buf_hdr.seg[idx].data + seg_offset + 1;
+		src_len = seg_offset + 1;
+
+		cpylen = dst_len > src_len ? src_len : dst_len;
+		cpylen = len > cpylen ? cpylen : len;
+
+		memmove(dst_map - cpylen, src_map - cpylen, cpylen);
+		len -= cpylen;
+	}
+}
+
 int odp_packet_copy_from_pkt(odp_packet_t dst, uint32_t dst_offset,
 			     odp_packet_t src, uint32_t src_offset,
 			     uint32_t len)
@@ -1637,13 +1846,7 @@ int odp_packet_copy_from_pkt(odp_packet_t dst, uint32_t dst_offset,
 		     src_offset + len >= dst_offset)));
 
 	if (overlap && src_offset < dst_offset) {
-		odp_packet_t temp =
-			odp_packet_copy_part(src, src_offset, len,
-					     odp_packet_pool(src));
-		if (temp == ODP_PACKET_INVALID)
-			return -1;
-		odp_packet_copy_from_pkt(dst, dst_offset, temp, 0, len);
-		odp_packet_free(temp);
+		packet_move_data_back(dst_hdr, dst_offset, src_offset, len);
 		return 0;
 	}
 
@@ -1898,6 +2101,7 @@ int _odp_packet_copy_md_to_packet(odp_packet_t srcpkt, odp_packet_t dstpkt)
 
 	dsthdr->input = srchdr->input;
 	dsthdr->dst_queue = srchdr->dst_queue;
+	dsthdr->tcp_mss = srchdr->tcp_mss;
 	dsthdr->buf_hdr.user_ptr = srchdr->buf_hdr.user_ptr;
 	if (dsthdr->buf_hdr.uarea_addr != NULL &&
 	    srchdr->buf_hdr.uarea_addr != NULL) {
@@ -1958,11 +2162,31 @@ static uint32_t segment_sum16_32(const uint8_t *p,
 		sum += sum1 + (sum2 << 8);
 #endif
 	} else {
+		uint64_t sum64 = 0;
+
+		/* Sum 32-bit words into a 64-bit accumulator. Ones' complement
+		 * sum of 32-bit words folds into the same 16-bit sum. */
+		while (len >= 16) {
+			uint64_t w[2];
+
+			memcpy(w, p, sizeof(w));
+			sum64 += (w[0] & 0xffffffff) + (w[0] >> 32);
+			sum64 += (w[1] & 0xffffffff) + (w[1] >> 32);
+			p += 16;
+			len -= 16;
+		}
+
 		while (len > 1) {
-			sum += *(const uint16_t *)(uintptr_t)p;
+			sum64 += *(const uint16_t *)(uintptr_t)p;
 			p += 2;
 			len -= 2;
 		}
+
+		sum64 = (sum64 & 0xffffffff) + (sum64 >> 32);
+		sum64 = (sum64 & 0xffffffff) + (sum64 >> 32);
+		sum64 = (sum64 & 0xffff) + (sum64 >> 16);
+		sum64 = (sum64 & 0xffff) + (sum64 >> 16);
+		sum += sum64;
 	}
 
 	/* Add left-over byte, if any */
@@ -2666,6 +2890,537 @@ int _odp_packet_sctp_chksum_insert(odp_packet_t pkt)
 	return odp_packet_copy_from_mem(pkt, pkt_hdr->p.l4_offset + 8, 4, &sum);
 }
 
+/* Maximum length of L2 to L4 headers copied into each TCP segment */
+#define TCP_SEG_MAX_HDR_LEN 256
+
+static inline uint16_t sum16_fold(uint32_t sum)
+{
+	/* Not more than two additions */
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return sum;
+}
+
+/**
+ * Split a TCP packet into MSS sized segments
+ *
+ * Headers (L2 to L4) of the packet are copied in front of each MSS sized slice
+ * of the TCP payload. Header checksums are summed once per packet with the
+ * segment specific fields zeroed, and completed per segment by adding those
+ * fields and the payload sum. Segments have checksum insertion disabled, since
+ * their checksums are already valid. The original packet is not modified.
+ *
+ * Segments are created starting from segment index 'first', at most 'max_seg'
+ * of them. A packet with more segments is split in several passes.
+ *
+ * @param      pkt      Packet with TCP segmentation requested
+ * @param      first    Index of the first segment to create
+ * @param[out] seg      Table for output segments
+ * @param      max_seg  Number of entries in the table
+ *
+ * @return Number of segments created
+ * @retval 0 Packet does not need segmentation, or 'first' is past the last
+ *           segment
+ * @retval <0 on failure
+ */
+int _odp_packet_tcp_seg(odp_packet_t pkt, uint32_t first, odp_packet_t seg[],
+			int max_seg)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t l3_offset = pkt_hdr->p.l3_offset;
+	uint32_t l4_offset = pkt_hdr->p.l4_offset;
+	uint32_t mss = pkt_hdr->tcp_mss;
+	uint8_t hdr[TCP_SEG_MAX_HDR_LEN];
+	_odp_ipv4hdr_t *ipv4 = NULL;
+	_odp_ipv6hdr_t *ipv6 = NULL;
+	_odp_tcphdr_t *tcp;
+	uint32_t tcp_hdr_len, hdr_len, payload_len, offset, len, seq;
+	uint32_t ip_sum = 0, tcp_sum, sum, num, idx, last_len;
+	uint16_t ip_id = 0, doffset_flags;
+	int n, i, ret;
+
+	if (!pkt_hdr->p.flags.tcp_seg || mss == 0)
+		return 0;
+
+	if (l3_offset == ODP_PACKET_OFFSET_INVALID ||
+	    l4_offset == ODP_PACKET_OFFSET_INVALID ||
+	    l4_offset + _ODP_TCPHDR_LEN > TCP_SEG_MAX_HDR_LEN ||
+	    l4_offset + _ODP_TCPHDR_LEN > pkt_hdr->frame_len)
+		return -1;
+
+	tcp = (_odp_tcphdr_t *)(uintptr_t)&hdr[l4_offset];
+	odp_packet_copy_to_mem(pkt, l4_offset, _ODP_TCPHDR_LEN, tcp);
+	tcp_hdr_len = tcp->hl * 4;
+	hdr_len = l4_offset + tcp_hdr_len;
+
+	if (tcp_hdr_len < _ODP_TCPHDR_LEN || hdr_len > TCP_SEG_MAX_HDR_LEN ||
+	    hdr_len > pkt_hdr->frame_len)
+		return -1;
+
+	payload_len = pkt_hdr->frame_len - hdr_len;
+	if (payload_len <= mss)
+		return 0;
+
+	num = (payload_len + mss - 1) / mss;
+	if (first >= num || max_seg <= 0)
+		return 0;
+
+	n = num - first < (uint32_t)max_seg ? (int)(num - first) : max_seg;
+	last_len = payload_len - (num - 1) * mss;
+
+	odp_packet_copy_to_mem(pkt, 0, hdr_len, hdr);
+
+	if ((hdr[l3_offset] >> 4) == _ODP_IPV4) {
+		ipv4 = (_odp_ipv4hdr_t *)(uintptr_t)&hdr[l3_offset];
+
+		if (ipv4->proto != _ODP_IPPROTO_TCP ||
+		    l3_offset + _ODP_IPV4HDR_IHL(ipv4->ver_ihl) * 4 > l4_offset)
+			return -1;
+
+		ip_id = odp_be_to_cpu_16(ipv4->id);
+		ipv4->tot_len = 0;
+		ipv4->id = 0;
+		ipv4->chksum = 0;
+		ip_sum = segment_sum16_32((uint8_t *)ipv4,
+					  _ODP_IPV4HDR_IHL(ipv4->ver_ihl) * 4,
+					  0);
+		tcp_sum = segment_sum16_32((uint8_t *)&ipv4->src_addr,
+					   2 * _ODP_IPV4ADDR_LEN, 0);
+	} else if ((hdr[l3_offset] >> 4) == _ODP_IPV6) {
+		ipv6 = (_odp_ipv6hdr_t *)(uintptr_t)&hdr[l3_offset];
+
+		if (l3_offset + _ODP_IPV6HDR_LEN > l4_offset)
+			return -1;
+
+		tcp_sum = segment_sum16_32((uint8_t *)&ipv6->src_addr,
+					   2 * _ODP_IPV6ADDR_LEN, 0);
+	} else {
+		return -1;
+	}
+
+	tcp_sum += odp_cpu_to_be_16(_ODP_IPPROTO_TCP);
+
+	/* Sum TCP header without sequence number, flags and checksum */
+	seq = odp_be_to_cpu_32(tcp->seq_no);
+	doffset_flags = tcp->doffset_flags;
+	tcp->seq_no = 0;
+	tcp->doffset_flags = 0;
+	tcp->cksm = 0;
+	tcp_sum += segment_sum16_32((uint8_t *)tcp, tcp_hdr_len, 0);
+
+	/* The last segment of the packet may be shorter than MSS */
+	i = first + n == num ? n - 1 : n;
+	ret = i ? odp_packet_alloc_multi(odp_packet_pool(pkt), hdr_len + mss,
+					 seg, i) : 0;
+
+	if (ret == i && i < n) {
+		seg[i] = odp_packet_alloc(odp_packet_pool(pkt),
+					  hdr_len + last_len);
+		if (seg[i] != ODP_PACKET_INVALID)
+			ret = n;
+	}
+
+	if (odp_unlikely(ret != n)) {
+		if (ret > 0)
+			odp_packet_free_multi(seg, ret);
+		return -1;
+	}
+
+	offset = hdr_len + first * mss;
+
+	for (i = 0; i < n; i++) {
+		odp_packet_hdr_t *seg_hdr = packet_hdr(seg[i]);
+
+		idx = first + i;
+		len = idx < num - 1 ? mss : last_len;
+
+		odp_packet_copy_from_pkt(seg[i], hdr_len, pkt, offset, len);
+		sum = sum16_fold(packet_sum16_32(seg_hdr, hdr_len, len));
+
+		/* Payload was summed relative to packet start */
+		if (l4_offset % 2)
+			sum = ((sum << 8) | (sum >> 8)) & 0xffff;
+
+		if (ipv4) {
+			ipv4->tot_len = odp_cpu_to_be_16(hdr_len - l3_offset +
+							 len);
+			ipv4->id = odp_cpu_to_be_16(ip_id + idx);
+			ipv4->chksum = ~sum16_fold(ip_sum + ipv4->tot_len +
+						   ipv4->id);
+		} else {
+			ipv6->payload_len = odp_cpu_to_be_16(hdr_len -
+							     l3_offset -
+							     _ODP_IPV6HDR_LEN +
+							     len);
+		}
+
+		tcp->seq_no = odp_cpu_to_be_32(seq + (offset - hdr_len));
+		tcp->doffset_flags = doffset_flags;
+		if (idx < num - 1) {
+			tcp->fin = 0;
+			tcp->psh = 0;
+		}
+		if (idx > 0)
+			tcp->cwr = 0;
+
+		sum += tcp_sum + odp_cpu_to_be_16(tcp_hdr_len + len);
+		sum += segment_sum16_32((uint8_t *)&tcp->seq_no, 4, 0);
+		sum += tcp->doffset_flags;
+		tcp->cksm = ~sum16_fold(sum);
+
+		odp_packet_copy_from_mem(seg[i], 0, hdr_len, hdr);
+
+		_odp_packet_copy_md_to_packet(pkt, seg[i]);
+		seg_hdr->p.flags.tcp_seg = 0;
+		seg_hdr->p.flags.l3_chksum_set = 1;
+		seg_hdr->p.flags.l3_chksum = 0;
+		seg_hdr->p.flags.l4_chksum_set = 1;
+		seg_hdr->p.flags.l4_chksum = 0;
+
+		offset += len;
+	}
+
+	return n;
+}
+
+/* Number of segments _odp_packet_tcp_seg() creates from the packet, or 0 when
+ * the packet is not segmented */
+uint32_t _odp_packet_tcp_seg_num(odp_packet_t pkt)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t l4_offset = pkt_hdr->p.l4_offset;
+	uint32_t mss = pkt_hdr->tcp_mss;
+	uint32_t hdr_len;
+	_odp_tcphdr_t tcp;
+
+	if (!pkt_hdr->p.flags.tcp_seg || mss == 0 ||
+	    l4_offset == ODP_PACKET_OFFSET_INVALID ||
+	    odp_packet_copy_to_mem(pkt, l4_offset, _ODP_TCPHDR_LEN, &tcp))
+		return 0;
+
+	hdr_len = l4_offset + tcp.hl * 4;
+	if (hdr_len + mss >= pkt_hdr->frame_len)
+		return 0;
+
+	return (pkt_hdr->frame_len - hdr_len + mss - 1) / mss;
+}
+
+/* TCP flags used in receive offload */
+#define TCP_GRO_FLAGS_OFFSET 13
+#define TCP_GRO_FLAG_PSH     0x08
+#define TCP_GRO_FLAG_ACK     0x10
+
+/* Maximum IP packet length of a merged TCP segment */
+#define TCP_GRO_MAX_IP_LEN   UINT16_MAX
+
+typedef struct {
+	odp_packet_t pkt;
+	odp_packet_hdr_t *pkt_hdr;
+	uint8_t *data;
+	_odp_tcphdr_t *tcp;
+	uint32_t tcp_hdr_len;
+	uint32_t payload_len;
+	uint32_t mss;
+	uint32_t seq;
+	uint32_t addr_sum;
+	uint32_t data_sum;
+	uint32_t num;
+	uint8_t ipv4;
+	uint8_t psh;
+} tcp_gro_t;
+
+/* Returns TCP payload length of a packet, or 0 when it cannot be merged */
+static inline uint32_t tcp_gro_payload_len(odp_packet_hdr_t *pkt_hdr,
+					   int head)
+{
+	uint32_t l3_offset = pkt_hdr->p.l3_offset;
+	uint32_t l4_offset = pkt_hdr->p.l4_offset;
+	uint32_t seg_len = packet_first_seg_len(pkt_hdr);
+	uint8_t *data = packet_data(pkt_hdr);
+	_odp_tcphdr_t *tcp;
+	uint32_t ip_len, hdr_len;
+	uint8_t flags;
+
+	if (!pkt_hdr->p.input_flags.tcp || pkt_hdr->p.input_flags.ipfrag ||
+	    pkt_hdr->p.input_flags.ipopt || pkt_hdr->p.flags.all.error)
+		return 0;
+
+	if (pkt_hdr->p.input_flags.ipv4) {
+		_odp_ipv4hdr_t *ipv4 = (_odp_ipv4hdr_t *)(data + l3_offset);
+
+		if (l4_offset - l3_offset != _ODP_IPV4HDR_LEN ||
+		    l4_offset + _ODP_TCPHDR_LEN > seg_len)
+			return 0;
+
+		ip_len = odp_be_to_cpu_16(ipv4->tot_len);
+	} else if (pkt_hdr->p.input_flags.ipv6) {
+		_odp_ipv6hdr_t *ipv6 = (_odp_ipv6hdr_t *)(data + l3_offset);
+
+		if (l4_offset - l3_offset != _ODP_IPV6HDR_LEN ||
+		    l4_offset + _ODP_TCPHDR_LEN > seg_len)
+			return 0;
+
+		ip_len = _ODP_IPV6HDR_LEN + odp_be_to_cpu_16(ipv6->payload_len);
+	} else {
+		return 0;
+	}
+
+	tcp = (_odp_tcphdr_t *)(data + l4_offset);
+	hdr_len = l4_offset + tcp->hl * 4;
+	flags = data[l4_offset + TCP_GRO_FLAGS_OFFSET];
+
+	/* Only pure ACK segments start a merge, a push ends it */
+	if (flags != TCP_GRO_FLAG_ACK &&
+	    (head || flags != (TCP_GRO_FLAG_ACK | TCP_GRO_FLAG_PSH)))
+		return 0;
+
+	/* Headers must be followed by payload in the first segment, and no
+	 * link layer padding is allowed */
+	if (tcp->hl * 4 < _ODP_TCPHDR_LEN || hdr_len >= seg_len ||
+	    l3_offset + ip_len != pkt_hdr->frame_len ||
+	    hdr_len >= pkt_hdr->frame_len)
+		return 0;
+
+	return pkt_hdr->frame_len - hdr_len;
+}
+
+/* Payload sum of a TCP segment. Checksum of a valid segment sums to zero,
+ * so payload sum is the complement of the header and pseudo header sum. */
+static inline uint16_t tcp_gro_payload_sum(tcp_gro_t *gro, _odp_tcphdr_t *tcp,
+				       uint32_t payload_len)
+{
+	uint32_t sum;
+
+	sum = gro->addr_sum + odp_cpu_to_be_16(_ODP_IPPROTO_TCP) +
+	      odp_cpu_to_be_16(gro->tcp_hdr_len + payload_len) +
+	      segment_sum16_32((uint8_t *)tcp, gro->tcp_hdr_len, 0);
+
+	return ~sum16_fold(sum);
+}
+
+static inline void tcp_gro_start(tcp_gro_t *gro, odp_packet_t pkt,
+				 uint32_t payload_len)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint8_t *data = packet_data(pkt_hdr);
+	uint8_t *l3 = data + pkt_hdr->p.l3_offset;
+
+	gro->pkt = pkt;
+	gro->pkt_hdr = pkt_hdr;
+	gro->data = data;
+	gro->tcp = (_odp_tcphdr_t *)(data + pkt_hdr->p.l4_offset);
+	gro->tcp_hdr_len = gro->tcp->hl * 4;
+	gro->payload_len = payload_len;
+	gro->mss = payload_len;
+	gro->seq = odp_be_to_cpu_32(gro->tcp->seq_no) + payload_len;
+	gro->num = 1;
+	gro->psh = 0;
+	gro->ipv4 = pkt_hdr->p.input_flags.ipv4;
+
+	if (gro->ipv4)
+		gro->addr_sum = segment_sum16_32(l3 + 12,
+						 2 * _ODP_IPV4ADDR_LEN, 0);
+	else
+		gro->addr_sum = segment_sum16_32(l3 + 8,
+						 2 * _ODP_IPV6ADDR_LEN, 0);
+
+	gro->data_sum = tcp_gro_payload_sum(gro, gro->tcp, payload_len);
+}
+
+/* Check that a packet continues the TCP flow of the merged packet */
+static inline int tcp_gro_match(tcp_gro_t *gro, odp_packet_hdr_t *pkt_hdr,
+				uint32_t payload_len, int check_dst_queue)
+{
+	odp_packet_hdr_t *head = gro->pkt_hdr;
+	uint32_t l3_offset = head->p.l3_offset;
+	uint32_t l4_offset = head->p.l4_offset;
+	uint8_t *data = packet_data(pkt_hdr);
+	uint8_t *l3 = data + l3_offset;
+	uint8_t *head_l3 = gro->data + l3_offset;
+	_odp_tcphdr_t *tcp = (_odp_tcphdr_t *)(data + l4_offset);
+	uint8_t *tcp_u8 = (uint8_t *)tcp;
+	uint8_t *head_tcp_u8 = (uint8_t *)gro->tcp;
+
+	if (pkt_hdr->p.l3_offset != l3_offset ||
+	    pkt_hdr->p.l4_offset != l4_offset ||
+	    pkt_hdr->p.input_flags.ipv4 != gro->ipv4 ||
+	    tcp->hl * 4u != gro->tcp_hdr_len ||
+	    payload_len > gro->mss ||
+	    odp_be_to_cpu_32(tcp->seq_no) != gro->seq ||
+	    pkt_hdr->buf_hdr.pool_ptr != head->buf_hdr.pool_ptr ||
+	    head->buf_hdr.segcount + pkt_hdr->buf_hdr.segcount >
+	    CONFIG_PACKET_MAX_SEGS ||
+	    head->frame_len - l3_offset + payload_len > TCP_GRO_MAX_IP_LEN)
+		return 0;
+
+	if (check_dst_queue && pkt_hdr->dst_queue != head->dst_queue)
+		return 0;
+
+	/* Link layer header */
+	if (memcmp(data, gro->data, l3_offset))
+		return 0;
+
+	/* IP header fields other than length, ID and checksum */
+	if (gro->ipv4) {
+		if (memcmp(l3, head_l3, 2) || memcmp(l3 + 6, head_l3 + 6, 4) ||
+		    memcmp(l3 + 12, head_l3 + 12, 2 * _ODP_IPV4ADDR_LEN))
+			return 0;
+	} else {
+		if (memcmp(l3, head_l3, 4) ||
+		    memcmp(l3 + 6, head_l3 + 6, _ODP_IPV6HDR_LEN - 6))
+			return 0;
+	}
+
+	/* Ports, acknowledgment number and options */
+	if (memcmp(tcp_u8, head_tcp_u8, 4) ||
+	    memcmp(tcp_u8 + 8, head_tcp_u8 + 8, 4) ||
+	    memcmp(tcp_u8 + _ODP_TCPHDR_LEN, head_tcp_u8 + _ODP_TCPHDR_LEN,
+		   gro->tcp_hdr_len - _ODP_TCPHDR_LEN))
+		return 0;
+
+	return 1;
+}
+
+/* Append payload of a matching packet to the merged packet */
+static inline void tcp_gro_merge(tcp_gro_t *gro, odp_packet_hdr_t *pkt_hdr,
+				 uint32_t payload_len)
+{
+	odp_packet_hdr_t *head = gro->pkt_hdr;
+	_odp_tcphdr_t *tcp;
+	uint32_t sum;
+
+	tcp = (_odp_tcphdr_t *)((uint8_t *)packet_data(pkt_hdr) +
+				pkt_hdr->p.l4_offset);
+
+	sum = tcp_gro_payload_sum(gro, tcp, payload_len);
+
+	/* Payload is appended at an odd offset */
+	if (gro->payload_len % 2)
+		sum = ((sum << 8) | (sum >> 8)) & 0xffff;
+
+	gro->tcp->window = tcp->window;
+	gro->psh = !!(((uint8_t *)tcp)[TCP_GRO_FLAGS_OFFSET] &
+		      TCP_GRO_FLAG_PSH);
+
+	/* Link payload segments to the merged packet (same pool) */
+	pull_head(pkt_hdr, pkt_hdr->frame_len - payload_len);
+	add_all_segs(head, pkt_hdr);
+	head->frame_len += payload_len;
+	head->tailroom = pkt_hdr->tailroom;
+
+	gro->data_sum += sum;
+	gro->payload_len += payload_len;
+	gro->seq += payload_len;
+	gro->num++;
+}
+
+static inline void tcp_gro_finish(tcp_gro_t *gro)
+{
+	odp_packet_hdr_t *pkt_hdr = gro->pkt_hdr;
+	uint8_t *l3 = gro->data + pkt_hdr->p.l3_offset;
+	_odp_tcphdr_t *tcp = gro->tcp;
+	uint32_t tcp_len = gro->tcp_hdr_len + gro->payload_len;
+	uint32_t sum;
+
+	if (gro->ipv4) {
+		_odp_ipv4hdr_t *ipv4 = (_odp_ipv4hdr_t *)l3;
+
+		ipv4->tot_len = odp_cpu_to_be_16(_ODP_IPV4HDR_LEN + tcp_len);
+		ipv4->chksum = 0;
+		ipv4->chksum = ~sum16_fold(segment_sum16_32(l3,
+							    _ODP_IPV4HDR_LEN,
+							    0));
+	} else {
+		_odp_ipv6hdr_t *ipv6 = (_odp_ipv6hdr_t *)l3;
+
+		ipv6->payload_len = odp_cpu_to_be_16(tcp_len);
+	}
+
+	if (gro->psh)
+		((uint8_t *)tcp)[TCP_GRO_FLAGS_OFFSET] |= TCP_GRO_FLAG_PSH;
+
+	tcp->cksm = 0;
+	sum = (uint16_t)~tcp_gro_payload_sum(gro, tcp, gro->payload_len);
+	tcp->cksm = ~sum16_fold(sum + sum16_fold(gro->data_sum));
+
+	/* Merged packet can be segmented again on output */
+	odp_packet_tcp_mss_set(gro->pkt, gro->mss);
+}
+
+/**
+ * Merge consecutive segments of TCP flows
+ *
+ * Packets are scanned in order. An in-order run of ACK segments of the same
+ * flow (equal headers except for sequence number, window and checksums) is
+ * merged into the first packet of the run, which is left in place. Payloads
+ * of the other packets are linked to the first packet as segments without
+ * copying, and the table is compacted. Only headers of each segment are
+ * summed, the payload sum is derived from the segment checksum. Thus an
+ * invalid segment checksum results in an invalid merged checksum. A segment
+ * shorter than the first one, or one with PSH set, ends the run. Merged
+ * packets have the payload length of the first segment set as TCP MSS.
+ *
+ * @param         pkt              Packet table
+ * @param         num              Number of packets in the table
+ * @param         check_dst_queue  Merge only packets with the same
+ *                                 destination queue
+ * @param[out]    merged_pkts      Number of merged packets produced
+ * @param[out]    merged_segs      Number of segments merged into them
+ *
+ * @return Number of packets in the table after merging
+ */
+int _odp_packet_tcp_gro(odp_packet_t pkt[], int num, int check_dst_queue,
+			uint32_t *merged_pkts, uint32_t *merged_segs)
+{
+	tcp_gro_t gro;
+	uint32_t payload_len;
+	int i, out = 0;
+
+	*merged_pkts = 0;
+	*merged_segs = 0;
+
+	i = 0;
+	while (i < num) {
+		payload_len = tcp_gro_payload_len(packet_hdr(pkt[i]), 1);
+
+		if (payload_len == 0 || i == num - 1) {
+			pkt[out++] = pkt[i++];
+			continue;
+		}
+
+		tcp_gro_start(&gro, pkt[i], payload_len);
+		i++;
+
+		while (i < num) {
+			odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt[i]);
+
+			payload_len = tcp_gro_payload_len(pkt_hdr, 0);
+
+			if (payload_len == 0 ||
+			    !tcp_gro_match(&gro, pkt_hdr, payload_len,
+					   check_dst_queue))
+				break;
+
+			tcp_gro_merge(&gro, pkt_hdr, payload_len);
+			i++;
+
+			if (gro.psh || payload_len < gro.mss)
+				break;
+		}
+
+		if (gro.num > 1) {
+			tcp_gro_finish(&gro);
+			(*merged_pkts)++;
+			*merged_segs += gro.num;
+		}
+
+		pkt[out++] = gro.pkt;
+	}
+
+	return out;
+}
+
 static int packet_l4_chksum(odp_packet_hdr_t *pkt_hdr,
 			    odp_proto_chksums_t chksums,
 			    uint32_t l4_part_sum)
@@ -2848,14 +3603,34 @@ odp_packet_t odp_packet_ref_static(odp_packet_t pkt)
 {
 	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
 
-	packet_ref_inc(pkt_hdr);
+	packet_ref_add(pkt_hdr, 1);
 
 	return pkt;
 }
 
-odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
+int odp_packet_ref_static_multi(odp_packet_t pkt, odp_packet_t ref[], int num)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	int i;
+
+	if (odp_unlikely(num <= 0))
+		return num < 0 ? -1 : 0;
+
+	/* One reference count update per segment for all references */
+	packet_ref_add(pkt_hdr, num);
+
+	for (i = 0; i < num; i++)
+		ref[i] = pkt;
+
+	return num;
+}
+
+/* Create 'num' dynamic references to a packet. Segment reference counts are
+ * updated once for all references and link headers are allocated with a
+ * single call. Returns number of references created. */
+static int packet_ref_multi(odp_packet_t pkt, uint32_t offset,
+			    odp_packet_t ref[], int num)
 {
-	odp_packet_t ref;
 	odp_packet_hdr_t *link_hdr;
 	odp_packet_hdr_t *next_hdr;
 	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
@@ -2869,16 +3644,17 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 
 	if (offset >= pkt_hdr->frame_len) {
 		ODP_DBG("offset too large\n");
-		return ODP_PACKET_INVALID;
+		return -1;
 	}
 
-	/* Allocate link segment */
-	if (packet_alloc(pkt_hdr->buf_hdr.pool_ptr, 0, 1, 1, &ref) != 1) {
+	/* Allocate link segments */
+	num = packet_alloc(pkt_hdr->buf_hdr.pool_ptr, 0, num, 1, ref);
+	if (num <= 0) {
 		ODP_DBG("segment alloc failed\n");
-		return ODP_PACKET_INVALID;
+		return -1;
 	}
 
-	link_hdr = packet_hdr(ref);
+	link_hdr = packet_hdr(ref[0]);
 
 	seg_entry_find_offset(&hdr, &idx, &seg_offset, &seg_idx, offset);
 	num_copy = hdr->buf_hdr.num_seg - idx;
@@ -2887,14 +3663,14 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 	/* In addition to segments, update reference count of
 	 * an existing link header. */
 	if (seg_is_link(hdr))
-		buffer_ref_inc((odp_buffer_hdr_t *)hdr);
+		buffer_ref_add((odp_buffer_hdr_t *)hdr, num);
 
 	seg = seg_entry_next(&hdr, &idx);
 	link_hdr->buf_hdr.num_seg = 1;
 	link_hdr->buf_hdr.seg[0].hdr  = seg->hdr;
 	link_hdr->buf_hdr.seg[0].data = seg->data + seg_offset;
 	link_hdr->buf_hdr.seg[0].len  = seg->len  - seg_offset;
-	buffer_ref_inc(seg->hdr);
+	buffer_ref_add(seg->hdr, num);
 
 	/* The 'CONFIG_PACKET_SEGS_PER_HDR > 1' condition is required to fix an
 	 * invalid error ('array subscript is above array bounds') thrown by
@@ -2902,7 +3678,7 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 	for (i = 1; CONFIG_PACKET_SEGS_PER_HDR > 1 && i < num_copy; i++) {
 		/* Update link header reference count */
 		if (idx == 0 && seg_is_link(hdr))
-			buffer_ref_inc((odp_buffer_hdr_t *)hdr);
+			buffer_ref_add((odp_buffer_hdr_t *)hdr, num);
 
 		seg = seg_entry_next(&hdr, &idx);
 
@@ -2910,7 +3686,7 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 		link_hdr->buf_hdr.seg[i].hdr  = seg->hdr;
 		link_hdr->buf_hdr.seg[i].data = seg->data;
 		link_hdr->buf_hdr.seg[i].len  = seg->len;
-		buffer_ref_inc(seg->hdr);
+		buffer_ref_add(seg->hdr, num);
 	}
 
 	next_hdr = hdr;
@@ -2919,10 +3695,10 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 	for (i = seg_idx + num_copy; i < segcount; i++) {
 		/* Update link header reference count */
 		if (idx == 0 && seg_is_link(hdr))
-			buffer_ref_inc((odp_buffer_hdr_t *)hdr);
+			buffer_ref_add((odp_buffer_hdr_t *)hdr, num);
 
 		seg = seg_entry_next(&hdr, &idx);
-		buffer_ref_inc(seg->hdr);
+		buffer_ref_add(seg->hdr, num);
 	}
 
 	len = pkt_hdr->frame_len - offset;
@@ -2937,8 +3713,47 @@ odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
 	 * is not pushed through a reference. */
 	link_hdr->headroom          = 0;
 
+	link_hdr->shared_segs = 1;
+	pkt_hdr->shared_segs  = 1;
+
+	/* Other references link to the same segments */
+	for (i = 1; i < num; i++) {
+		odp_packet_hdr_t *hdr_i = packet_hdr(ref[i]);
+		int j;
+
+		for (j = 0; j < link_hdr->buf_hdr.num_seg; j++)
+			hdr_i->buf_hdr.seg[j] = link_hdr->buf_hdr.seg[j];
+
+		hdr_i->buf_hdr.num_seg  = link_hdr->buf_hdr.num_seg;
+		hdr_i->buf_hdr.next_seg = link_hdr->buf_hdr.next_seg;
+		hdr_i->buf_hdr.last_seg = link_hdr->buf_hdr.last_seg;
+		hdr_i->buf_hdr.segcount = link_hdr->buf_hdr.segcount;
+		hdr_i->frame_len        = link_hdr->frame_len;
+		hdr_i->tailroom         = link_hdr->tailroom;
+		hdr_i->headroom         = 0;
+		hdr_i->shared_segs      = 1;
+	}
+
+	return num;
+}
+
+odp_packet_t odp_packet_ref(odp_packet_t pkt, uint32_t offset)
+{
+	odp_packet_t ref;
+
+	if (packet_ref_multi(pkt, offset, &ref, 1) != 1)
+		return ODP_PACKET_INVALID;
+
 	return ref;
+}
+
+int odp_packet_ref_multi(odp_packet_t pkt, uint32_t offset,
+			 odp_packet_t ref[], int num)
+{
+	if (odp_unlikely(num <= 0))
+		return num < 0 ? -1 : 0;
 
+	return packet_ref_multi(pkt, offset, ref, num);
 }
 
 odp_packet_t odp_packet_ref_pkt(odp_packet_t pkt, uint32_t offset,
@@ -2976,6 +3791,9 @@ int odp_packet_has_ref(odp_packet_t pkt)
 	odp_packet_hdr_t *hdr = pkt_hdr;
 	uint8_t idx = 0;
 
+	if (odp_likely(!pkt_hdr->shared_segs))
+		return 0;
+
 	for (i = 0; i < seg_count; i++) {
 		seg = seg_entry_next(&hdr, &idx);
 		buf_hdr = seg->hdr;
@@ -29,6 +29,7 @@
 #include <odp/api/plat/time_inlines.h>
 #include <odp_pcapng.h>
 #include <odp/api/plat/queue_inlines.h>
+#include <odp_libconfig_internal.h>
 
 #include <string.h>
 #include <inttypes.h>
@@ -58,6 +59,39 @@ static inline pktio_entry_t *pktio_entry_by_index(int index)
 	return pktio_entry_ptr[index];
 }
 
+static int read_config_file(pktio_table_t *tbl)
+{
+	const char *str;
+	int val = 0;
+
+	ODP_PRINT("Packet IO config:\n");
+
+	str = "pktio.sched_burst_adapt";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	tbl->config.sched_burst_adapt = !!val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "pktio.sched_burst_min";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1 || val > QUEUE_MULTI_MAX) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	tbl->config.sched_burst_min = val;
+	ODP_PRINT("  %s: %i\n\n", str, val);
+
+	return 0;
+}
+
 int odp_pktio_init_global(void)
 {
 	pktio_entry_t *pktio_entry;
@@ -76,6 +110,11 @@ int odp_pktio_init_global(void)
 
 	odp_spinlock_init(&pktio_tbl->lock);
 
+	if (read_config_file(pktio_tbl)) {
+		odp_shm_free(shm);
+		return -1;
+	}
+
 	for (i = 0; i < ODP_CONFIG_PKTIO_ENTRIES; ++i) {
 		pktio_entry = &pktio_tbl->entries[i];
 
@@ -139,6 +178,10 @@ static void init_in_queues(pktio_entry_t *entry)
 	for (i = 0; i < PKTIO_MAX_QUEUES; i++) {
 		entry->s.in_queue[i].queue = ODP_QUEUE_INVALID;
 		entry->s.in_queue[i].pktin = PKTIN_INVALID;
+		odp_atomic_init_u64(&entry->s.in_queue[i].gro_pkts, 0);
+		odp_atomic_init_u64(&entry->s.in_queue[i].gro_segs, 0);
+		entry->s.in_queue[i].sched_burst =
+			pktio_tbl->config.sched_burst_min;
 	}
 }
 
@@ -152,12 +195,24 @@ static void init_out_queues(pktio_entry_t *entry)
 	}
 }
 
+static void queue_stats_reset(pktio_entry_t *entry)
+{
+	memset(entry->s.in_queue_stats, 0, sizeof(entry->s.in_queue_stats));
+	memset(entry->s.out_queue_stats, 0, sizeof(entry->s.out_queue_stats));
+}
+
 static void init_pktio_entry(pktio_entry_t *entry)
 {
 	pktio_cls_enabled_set(entry, 0);
+	entry->s.flow_hash_ena = 0;
+	entry->s.flow_group_ena = 0;
+	entry->s.tcp_seg_ena = 0;
+	entry->s.tcp_seg_drv = 0;
+	entry->s.tcp_gro_ena = 0;
 
 	init_in_queues(entry);
 	init_out_queues(entry);
+	queue_stats_reset(entry);
 
 	pktio_classifier_init(entry);
 }
@@ -398,6 +453,7 @@ int odp_pktio_close(odp_pktio_t hdl)
 
 	entry->s.num_in_queue  = 0;
 	entry->s.num_out_queue = 0;
+	entry->s.out_op_mode   = ODP_PKTIO_OP_MT;
 
 	odp_spinlock_lock(&pktio_tbl->lock);
 	res = _pktio_close(entry);
@@ -448,6 +504,18 @@ int odp_pktio_config(odp_pktio_t hdl, const odp_pktio_config_t *config)
 		return -1;
 	}
 
+	if ((config->pktin.bit.flow_hash || config->pktin.bit.flow_group) &&
+	    config->parser.layer < ODP_PROTO_LAYER_L4) {
+		ODP_ERR("Flow hash requires L4 parsing\n");
+		return -1;
+	}
+
+	if (config->pktin.bit.tcp_gro &&
+	    config->parser.layer < ODP_PROTO_LAYER_L4) {
+		ODP_ERR("TCP receive offload requires L4 parsing\n");
+		return -1;
+	}
+
 	lock_entry(entry);
 	if (entry->s.state == PKTIO_STATE_STARTED) {
 		unlock_entry(entry);
@@ -463,6 +531,12 @@ int odp_pktio_config(odp_pktio_t hdl, const odp_pktio_config_t *config)
 	entry->s.in_chksums.chksum.udp = config->pktin.bit.udp_chksum;
 	entry->s.in_chksums.chksum.sctp = config->pktin.bit.sctp_chksum;
 
+	entry->s.flow_group_ena = config->pktin.bit.flow_group;
+	entry->s.flow_hash_ena = config->pktin.bit.flow_hash ||
+				 config->pktin.bit.flow_group;
+	entry->s.tcp_seg_ena = config->pktout.bit.tcp_seg_ena;
+	entry->s.tcp_gro_ena = config->pktin.bit.tcp_gro;
+
 	if (entry->s.ops->config)
 		res = entry->s.ops->config(entry, config);
 
@@ -491,11 +565,19 @@ int odp_pktio_start(odp_pktio_t hdl)
 	}
 	if (entry->s.ops->start)
 		res = entry->s.ops->start(entry);
-	if (!res)
+	if (!res) {
 		entry->s.state = PKTIO_STATE_STARTED;
+		/* Drivers may reopen file descriptors on start */
+		entry->s.fd_gen++;
+	}
 
 	unlock_entry(entry);
 
+	/* Start may fail until the peer is present (ipc, memif) and the
+	 * application retries. Scheduler polls only started interfaces. */
+	if (res)
+		return res;
+
 	mode = entry->s.param.in_mode;
 
 	if (mode == ODP_PKTIN_MODE_SCHED) {
@@ -605,6 +687,136 @@ odp_pktio_t odp_pktio_lookup(const char *name)
 	return hdl;
 }
 
+static inline uint32_t pktin_flow_hash(odp_packet_hdr_t *pkt_hdr)
+{
+	odp_cls_hash_proto_t hash_proto;
+	uint8_t buf[PACKET_PARSE_SEG_LEN];
+	const uint8_t *base;
+	uint32_t seg_len = pkt_hdr->buf_hdr.seg[0].len;
+
+	hash_proto.all = 0;
+	hash_proto.ipv4 = 1;
+	hash_proto.ipv6 = 1;
+	hash_proto.udp = 1;
+	hash_proto.tcp = 1;
+
+	base = pkt_hdr->buf_hdr.seg[0].data;
+
+	/* Make sure that L3 and L4 headers are contiguous in the case of
+	 * a segmented packet */
+	if (odp_unlikely(seg_len < PACKET_PARSE_SEG_LEN &&
+			 pkt_hdr->frame_len > seg_len)) {
+		uint32_t len = pkt_hdr->frame_len;
+
+		if (len > PACKET_PARSE_SEG_LEN)
+			len = PACKET_PARSE_SEG_LEN;
+
+		odp_packet_copy_to_mem(packet_handle(pkt_hdr), 0, len, buf);
+		base = buf;
+	}
+
+	return packet_rss_hash(pkt_hdr, hash_proto, base);
+}
+
+/* Calculate flow hash for received packets and optionally group packets of
+ * the same flow together. Grouping is a stable insertion sort on flow hash,
+ * which keeps packet order within each flow. Bursts are short and typically
+ * contain only a few flows, so the sort is close to linear in practice. */
+static void pktin_flow_process(pktio_entry_t *entry, odp_packet_t packets[],
+			       int num)
+{
+	uint32_t hash[num];
+	odp_packet_hdr_t *pkt_hdr;
+	int i, j;
+
+	for (i = 0; i < num; i++) {
+		pkt_hdr = packet_hdr(packets[i]);
+
+		/* Keep flow hash calculated by the driver (e.g. HW RSS) */
+		if (!pkt_hdr->p.input_flags.flow_hash)
+			packet_set_flow_hash(pkt_hdr,
+					     pktin_flow_hash(pkt_hdr));
+
+		hash[i] = pkt_hdr->flow_hash;
+	}
+
+	if (!entry->s.flow_group_ena)
+		return;
+
+	for (i = 1; i < num; i++) {
+		odp_packet_t pkt = packets[i];
+		uint32_t h = hash[i];
+
+		/* Already adjacent to the previous packet of the same flow */
+		if (h == hash[i - 1])
+			continue;
+
+		/* Find the last packet of the same flow, if any */
+		for (j = i - 2; j >= 0; j--)
+			if (hash[j] == h)
+				break;
+
+		if (j < 0)
+			continue;
+
+		/* Move the packet right after the last one of its flow */
+		memmove(&packets[j + 2], &packets[j + 1],
+			(i - j - 1) * sizeof(odp_packet_t));
+		memmove(&hash[j + 2], &hash[j + 1],
+			(i - j - 1) * sizeof(uint32_t));
+		packets[j + 1] = pkt;
+		hash[j + 1] = h;
+	}
+}
+
+/* Merge TCP segments of received packets and update statistics */
+static int pktin_gro(pktio_entry_t *entry, int pktin_index,
+		     odp_packet_t packets[], int num)
+{
+	uint32_t merged_pkts, merged_segs;
+
+	num = _odp_packet_tcp_gro(packets, num, pktio_cls_enabled(entry),
+				  &merged_pkts, &merged_segs);
+
+	if (merged_pkts)
+		pktio_gro_stats_add(entry, pktin_index, merged_pkts,
+				    merged_segs);
+
+	return num;
+}
+
+static void pktin_gro_stats_read(pktio_entry_t *entry, int pktin_index,
+				 odp_pktin_gro_stats_t *stats)
+{
+	stats->merged_pkts =
+		odp_atomic_load_u64(&entry->s.in_queue[pktin_index].gro_pkts);
+	stats->merged_segs =
+		odp_atomic_load_u64(&entry->s.in_queue[pktin_index].gro_segs);
+}
+
+/* Process packets received from a driver. Returns number of packets. */
+static inline int pktin_process(pktio_entry_t *entry, int pktin_index,
+				odp_packet_t packets[], int num)
+{
+	if (odp_unlikely(entry->s.flow_hash_ena) && num > 0)
+		pktin_flow_process(entry, packets, num);
+
+	if (odp_unlikely(entry->s.tcp_gro_ena) && num > 1)
+		num = pktin_gro(entry, pktin_index, packets, num);
+
+	return num;
+}
+
+static inline int pktin_recv(pktio_entry_t *entry, int pktin_index,
+			     odp_packet_t packets[], int num)
+{
+	int ret;
+
+	ret = entry->s.ops->recv(entry, pktin_index, packets, num);
+
+	return pktin_process(entry, pktin_index, packets, ret);
+}
+
 static inline int pktin_recv_buf(pktio_entry_t *entry, int pktin_index,
 				 odp_buffer_hdr_t *buffer_hdrs[], int num)
 {
@@ -616,7 +828,7 @@ static inline int pktin_recv_buf(pktio_entry_t *entry, int pktin_index,
 	int pkts;
 	int num_rx = 0;
 
-	pkts = entry->s.ops->recv(entry, pktin_index, packets, num);
+	pkts = pktin_recv(entry, pktin_index, packets, num);
 
 	for (i = 0; i < pkts; i++) {
 		pkt = packets[i];
@@ -757,11 +969,48 @@ static int pktin_deq_multi(odp_queue_t queue, odp_buffer_hdr_t *buf_hdr[],
 	return nbr;
 }
 
+/* Scheduler polls a pktin queue with a burst size adapted to the queue
+ * occupancy. Burst size is doubled when a poll returns a full burst, as
+ * the queue has a backlog and larger bursts amortize per poll overhead.
+ * It is halved when a poll fills less than a quarter of the burst, so that
+ * lightly loaded queues are polled with small bursts. Drivers prepare
+ * packets for the whole burst (e.g. socket allocates and frees them), and
+ * small bursts pass packets sooner to the scheduler. */
+static inline int sched_burst_get(pktio_entry_t *entry, int pktin_index,
+				  int num)
+{
+	int burst = entry->s.in_queue[pktin_index].sched_burst;
+
+	if (!pktio_tbl->config.sched_burst_adapt || burst > num)
+		return num;
+
+	return burst;
+}
+
+static inline void sched_burst_update(pktio_entry_t *entry, int pktin_index,
+				      int burst, int num_rx)
+{
+	int min = pktio_tbl->config.sched_burst_min;
+
+	if (!pktio_tbl->config.sched_burst_adapt)
+		return;
+
+	if (num_rx >= burst)
+		burst = 2 * burst > QUEUE_MULTI_MAX ? QUEUE_MULTI_MAX :
+						      2 * burst;
+	else if (4 * num_rx < burst)
+		burst = burst / 2 < min ? min : burst / 2;
+	else
+		return;
+
+	entry->s.in_queue[pktin_index].sched_burst = burst;
+}
+
 int sched_cb_pktin_poll_one(int pktio_index,
 			    int rx_queue,
 			    odp_event_t evt_tbl[QUEUE_MULTI_MAX])
 {
-	int num_rx, num_pkts, i;
+	int num_rx, num_pkts, i, burst;
 	pktio_entry_t *entry = pktio_entry_by_index(pktio_index);
 	odp_packet_t pkt;
 	odp_packet_hdr_t *pkt_hdr;
@@ -779,8 +1028,9 @@ int sched_cb_pktin_poll_one(int pktio_index,
 	}
 
 	ODP_ASSERT((unsigned)rx_queue < entry->s.num_in_queue);
-	num_pkts = entry->s.ops->recv(entry, rx_queue,
-				      packets, QUEUE_MULTI_MAX);
+	burst = sched_burst_get(entry, rx_queue, QUEUE_MULTI_MAX);
+	num_pkts = pktin_recv(entry, rx_queue, packets, burst);
+	sched_burst_update(entry, rx_queue, burst, num_pkts);
 
 	num_rx = 0;
 	for (i = 0; i < num_pkts; i++) {
@@ -813,6 +1063,7 @@ int sched_cb_pktin_poll(int pktio_index, int pktin_index,
 {
 	pktio_entry_t *entry = pktio_entry_by_index(pktio_index);
 	int state = entry->s.state;
+	int burst, num_rx;
 
 	if (odp_unlikely(state != PKTIO_STATE_STARTED)) {
 		if (state < PKTIO_STATE_ACTIVE ||
@@ -823,7 +1074,11 @@ int sched_cb_pktin_poll(int pktio_index, int pktin_index,
 		return 0;
 	}
 
-	return pktin_recv_buf(entry, pktin_index, hdr_tbl, num);
+	burst = sched_burst_get(entry, pktin_index, num);
+	num_rx = pktin_recv_buf(entry, pktin_index, hdr_tbl, burst);
+	sched_burst_update(entry, pktin_index, burst, num_rx);
+
+	return num_rx;
 }
 
 int sched_cb_pktin_poll_old(int pktio_index, int num_queue, int index[])
@@ -844,10 +1099,11 @@ int sched_cb_pktin_poll_old(int pktio_index, int num_queue, int index[])
 
 	for (idx = 0; idx < num_queue; idx++) {
 		odp_queue_t queue;
-		int num_enq;
+		int num_enq, burst;
 
-		num = pktin_recv_buf(entry, index[idx], hdr_tbl,
-				     QUEUE_MULTI_MAX);
+		burst = sched_burst_get(entry, index[idx], QUEUE_MULTI_MAX);
+		num = pktin_recv_buf(entry, index[idx], hdr_tbl, burst);
+		sched_burst_update(entry, index[idx], burst, num);
 
 		if (num == 0)
 			continue;
@@ -1176,6 +1432,32 @@ odp_time_t odp_pktin_ts_from_ns(odp_pktio_t hdl, uint64_t ns)
 	return odp_time_global_from_ns(ns);
 }
 
+static void queue_stats_print(pktio_entry_t *entry)
+{
+	uint32_t i;
+
+	for (i = 0; i < entry->s.num_in_queue; i++) {
+		odp_pktin_queue_stats_t *in = pktio_in_stats(entry, i);
+
+		ODP_PRINT("  pktin %-2u          %" PRIu64 " pkts, %" PRIu64
+			  " octets, %" PRIu64 " discards, %" PRIu64
+			  " errors, %" PRIu64 " alloc fails, %" PRIu64
+			  " cls discards\n", i, in->packets, in->octets,
+			  in->discards, in->errors, in->alloc_fails,
+			  in->cls_discards);
+	}
+
+	for (i = 0; i < entry->s.num_out_queue; i++) {
+		odp_pktout_queue_stats_t *out = pktio_out_stats(entry, i);
+
+		ODP_PRINT("  pktout %-2u         %" PRIu64 " pkts, %" PRIu64
+			  " octets, %" PRIu64 " discards, %" PRIu64
+			  " errors, %" PRIu64 " retries\n", i, out->packets,
+			  out->octets, out->discards, out->errors,
+			  out->retries);
+	}
+}
+
 void odp_pktio_print(odp_pktio_t hdl)
 {
 	pktio_entry_t *entry;
@@ -1233,16 +1515,42 @@ void odp_pktio_print(odp_pktio_t hdl)
 				capa.max_output_queues);
 	}
 
+	if (entry->s.tcp_gro_ena) {
+		odp_pktin_gro_stats_t gro, total;
+		unsigned i;
+
+		memset(&total, 0, sizeof(total));
+		for (i = 0; i < entry->s.num_in_queue; i++) {
+			pktin_gro_stats_read(entry, i, &gro);
+			total.merged_pkts += gro.merged_pkts;
+			total.merged_segs += gro.merged_segs;
+		}
+
+		len += snprintf(&str[len], n - len,
+				"  tcp gro           %" PRIu64 " pkts from %"
+				PRIu64 " segs\n", total.merged_pkts,
+				total.merged_segs);
+	}
+
 	str[len] = '\0';
 
 	ODP_PRINT("\n%s", str);
 
+	queue_stats_print(entry);
+
 	if (entry->s.ops->print)
 		entry->s.ops->print(entry);
 
 	ODP_PRINT("\n");
 }
 
+int odp_pktio_term_local(void)
+{
+	_odp_pktin_fd_wait_term_local();
+
+	return 0;
+}
+
 int odp_pktio_term_global(void)
 {
 	int ret = 0;
@@ -1314,9 +1622,14 @@ int odp_pktio_capability(odp_pktio_t pktio, odp_pktio_capability_t *capa)
 	else
 		ret = single_capability(capa);
 
-	/* The same parser is used for all pktios */
-	if (ret == 0)
+	/* The same parser and flow hash are used for all pktios */
+	if (ret == 0) {
 		capa->config.parser.layer = ODP_PROTO_LAYER_ALL;
+		capa->config.pktin.bit.flow_hash = 1;
+		capa->config.pktin.bit.flow_group = 1;
+		capa->config.pktout.bit.tcp_seg_ena = 1;
+		capa->config.pktin.bit.tcp_gro = 1;
+	}
 
 	return ret;
 }
@@ -1353,10 +1666,31 @@ int odp_pktio_stats(odp_pktio_t pktio,
 	return ret;
 }
 
+void _odp_pktio_queue_stats_sum(pktio_entry_t *entry,
+				odp_pktio_stats_t *stats)
+{
+	int i;
+
+	for (i = 0; i < PKTIO_MAX_QUEUES; i++) {
+		odp_pktin_queue_stats_t *in = pktio_in_stats(entry, i);
+		odp_pktout_queue_stats_t *out = pktio_out_stats(entry, i);
+
+		stats->in_octets += in->octets;
+		stats->in_ucast_pkts += in->packets;
+		stats->in_discards += in->discards + in->cls_discards;
+		stats->in_errors += in->errors;
+		stats->out_octets += out->octets;
+		stats->out_ucast_pkts += out->packets;
+		stats->out_discards += out->discards;
+		stats->out_errors += out->errors;
+	}
+}
+
 int odp_pktio_stats_reset(odp_pktio_t pktio)
 {
 	pktio_entry_t *entry;
 	int ret = -1;
+	int i;
 
 	entry = get_pktio_entry(pktio);
 	if (entry == NULL) {
@@ -1374,6 +1708,12 @@ int odp_pktio_stats_reset(odp_pktio_t pktio)
 
 	if (entry->s.ops->stats)
 		ret = entry->s.ops->stats_reset(entry);
+
+	for (i = 0; i < PKTIO_MAX_QUEUES; i++) {
+		odp_atomic_store_u64(&entry->s.in_queue[i].gro_pkts, 0);
+		odp_atomic_store_u64(&entry->s.in_queue[i].gro_segs, 0);
+	}
+	queue_stats_reset(entry);
 	unlock_entry(entry);
 
 	return ret;
@@ -1567,6 +1907,7 @@ int odp_pktout_queue_config(odp_pktio_t pktio,
 	}
 
 	entry->s.num_out_queue = num_queues;
+	entry->s.out_op_mode = param->op_mode;
 
 	if (mode == ODP_PKTOUT_MODE_QUEUE) {
 		for (i = 0; i < num_queues; i++) {
@@ -1754,7 +2095,7 @@ int odp_pktin_recv(odp_pktin_queue_t queue, odp_packet_t packets[], int num)
 		return -1;
 	}
 
-	ret = entry->s.ops->recv(entry, queue.index, packets, num);
+	ret = pktin_recv(entry, queue.index, packets, num);
 	if (_ODP_PCAPNG)
 		_odp_dump_pcapng_pkts(entry, queue.index, packets, ret);
 
@@ -1768,6 +2109,7 @@ int odp_pktin_recv_tmo(odp_pktin_queue_t queue, odp_packet_t packets[], int num,
 	odp_time_t t1, t2;
 	struct timespec ts;
 	int started = 0;
+	int fd_wait;
 	uint64_t sleep_round = 0;
 	pktio_entry_t *entry;
 
@@ -1783,14 +2125,18 @@ int odp_pktin_recv_tmo(odp_pktin_queue_t queue, odp_packet_t packets[], int num,
 	if (entry->s.ops->recv_tmo && wait != ODP_PKTIN_NO_WAIT) {
 		ret = entry->s.ops->recv_tmo(entry, queue.index, packets, num,
 					      wait);
+		ret = pktin_process(entry, queue.index, packets, ret);
 		if (_ODP_PCAPNG)
 			_odp_dump_pcapng_pkts(entry, queue.index, packets, ret);
 
 		return ret;
 	}
 
+	/* Block on the queue file descriptor when the driver has one */
+	fd_wait = entry->s.ops->pktin_fds != NULL;
+
 	while (1) {
-		ret = entry->s.ops->recv(entry, queue.index, packets, num);
+		ret = pktin_recv(entry, queue.index, packets, num);
 		if (_ODP_PCAPNG)
 			_odp_dump_pcapng_pkts(entry, queue.index, packets, ret);
 
@@ -1810,6 +2156,19 @@ int odp_pktin_recv_tmo(odp_pktin_queue_t queue, odp_packet_t packets[], int num,
 			t1 = odp_time_sum(odp_time_local(), t);
 		}
 
+		if (fd_wait) {
+			t2 = odp_time_local();
+
+			if (odp_time_cmp(t2, t1) > 0)
+				return 0;
+
+			if (_odp_pktin_fd_wait(&entry, &queue.index, 1,
+					       odp_time_diff_ns(t1, t2)) >= 0)
+				continue;
+
+			fd_wait = 0;
+		}
+
 		/* Check every SLEEP_CHECK rounds if total wait time
 		 * has been exceeded. */
 		if ((++sleep_round & (SLEEP_CHECK - 1)) == 0) {
@@ -1833,9 +2192,12 @@ int odp_pktin_recv_mq_tmo(const odp_pktin_queue_t queues[], unsigned num_q,
 	odp_time_t t1, t2;
 	struct timespec ts;
 	int started = 0;
+	int fd_wait = 1;
 	uint64_t sleep_round = 0;
 	int trial_successful = 0;
 	unsigned int lfrom = 0;
+	pktio_entry_t *entry[num_q];
+	int index[num_q];
 
 	for (i = 0; i < num_q; i++) {
 		ret = odp_pktin_recv(queues[i], packets, num);
@@ -1856,18 +2218,31 @@ int odp_pktin_recv_mq_tmo(const odp_pktin_queue_t queues[], unsigned num_q,
 	if (ret > 0 && from)
 		*from = lfrom;
 	if (trial_successful) {
-		if (_ODP_PCAPNG) {
-			pktio_entry_t *entry;
+		pktio_entry_t *lentry;
 
-			entry = get_pktio_entry(queues[lfrom].pktio);
-			if (entry)
-				_odp_dump_pcapng_pkts(entry, lfrom, packets,
-						      ret);
-		}
+		lentry = get_pktio_entry(queues[lfrom].pktio);
+		if (lentry)
+			ret = pktin_process(lentry, queues[lfrom].index,
+					    packets, ret);
+
+		if (_ODP_PCAPNG && lentry)
+			_odp_dump_pcapng_pkts(lentry, queues[lfrom].index,
+					      packets, ret);
 
 		return ret;
 	}
 
+	for (i = 0; i < num_q; i++) {
+		entry[i] = get_pktio_entry(queues[i].pktio);
+		index[i] = queues[i].index;
+
+		if (entry[i] == NULL) {
+			ODP_DBG("pktio entry %d does not exist\n",
+				queues[i].pktio);
+			return -1;
+		}
+	}
+
 	ts.tv_sec  = 0;
 	ts.tv_nsec = 1000 * SLEEP_USEC;
 
@@ -1896,6 +2271,21 @@ int odp_pktin_recv_mq_tmo(const odp_pktin_queue_t queues[], unsigned num_q,
 			t1 = odp_time_sum(odp_time_local(), t);
 		}
 
+		/* Block on file descriptors of all queues, or poll when some
+		 * queue does not have one */
+		if (fd_wait) {
+			t2 = odp_time_local();
+
+			if (odp_time_cmp(t2, t1) > 0)
+				return 0;
+
+			if (_odp_pktin_fd_wait(entry, index, num_q,
+					       odp_time_diff_ns(t1, t2)) >= 0)
+				continue;
+
+			fd_wait = 0;
+		}
+
 		/* Check every SLEEP_CHECK rounds if total wait time
 		 * has been exceeded. */
 		if ((++sleep_round & (SLEEP_CHECK - 1)) == 0) {
@@ -1920,6 +2310,172 @@ uint64_t odp_pktin_wait_time(uint64_t nsec)
 	return (nsec / (1000)) + 1;
 }
 
+int odp_pktin_gro_stats(odp_pktin_queue_t queue, odp_pktin_gro_stats_t *stats)
+{
+	pktio_entry_t *entry;
+
+	entry = get_pktio_entry(queue.pktio);
+	if (entry == NULL) {
+		ODP_DBG("pktio entry %d does not exist\n", queue.pktio);
+		return -1;
+	}
+
+	if (queue.index < 0 || queue.index >= PKTIO_MAX_QUEUES) {
+		ODP_DBG("Bad pktin queue index %d\n", queue.index);
+		return -1;
+	}
+
+	pktin_gro_stats_read(entry, queue.index, stats);
+
+	return 0;
+}
+
+int odp_pktin_queue_stats(odp_pktin_queue_t queue,
+			  odp_pktin_queue_stats_t *stats)
+{
+	pktio_entry_t *entry;
+
+	entry = get_pktio_entry(queue.pktio);
+	if (entry == NULL) {
+		ODP_DBG("pktio entry %d does not exist\n", queue.pktio);
+		return -1;
+	}
+
+	if (queue.index < 0 || queue.index >= PKTIO_MAX_QUEUES) {
+		ODP_DBG("Bad pktin queue index %d\n", queue.index);
+		return -1;
+	}
+
+	*stats = *pktio_in_stats(entry, queue.index);
+
+	return 0;
+}
+
+int odp_pktout_queue_stats(odp_pktout_queue_t queue,
+			   odp_pktout_queue_stats_t *stats)
+{
+	pktio_entry_t *entry;
+
+	entry = get_pktio_entry(queue.pktio);
+	if (entry == NULL) {
+		ODP_DBG("pktio entry %d does not exist\n", queue.pktio);
+		return -1;
+	}
+
+	if (queue.index < 0 || queue.index >= PKTIO_MAX_QUEUES) {
+		ODP_DBG("Bad pktout queue index %d\n", queue.index);
+		return -1;
+	}
+
+	*stats = *pktio_out_stats(entry, queue.index);
+
+	return 0;
+}
+
+/* Maximum number of segments created per pass in software TCP segmentation.
+ * Maximum length packets with MSS smaller than 512 bytes are segmented in
+ * several passes. */
+#define TCP_SEG_MAX_NUM (CONFIG_PACKET_MAX_LEN / 512)
+
+/* Output packets through a pktio that does not segment TCP packets itself.
+ * Packets that do not need segmentation are sent in bursts. Packets that do
+ * are replaced by their segments, and freed once segments have been sent.
+ * Packets that cannot be segmented are sent unmodified. */
+static int pktout_send_tcp_seg(pktio_entry_t *entry, int index,
+			       const odp_packet_t packets[], int num)
+{
+	odp_pktout_queue_stats_t *stats = pktio_out_stats(entry, index);
+	odp_packet_t seg[TCP_SEG_MAX_NUM];
+	uint32_t done, total;
+	int i, ret, num_seg, sent;
+	int first = 0;
+
+	for (i = 0; i < num; i++) {
+		if (odp_likely(!packet_hdr(packets[i])->p.flags.tcp_seg))
+			continue;
+
+		num_seg = _odp_packet_tcp_seg(packets[i], 0, seg,
+					      TCP_SEG_MAX_NUM);
+		if (num_seg == 0)
+			continue;
+
+		if (odp_unlikely(num_seg < 0)) {
+			ODP_DBG("pktio %s: TCP segmentation failed\n",
+				entry->s.name);
+			continue;
+		}
+
+		/* Send packets preceding the segmented one */
+		if (i > first) {
+			ret = entry->s.ops->send(entry, index, &packets[first],
+						 i - first);
+			if (ret < i - first) {
+				odp_packet_free_multi(seg, num_seg);
+				if (ret < 0)
+					return first ? first : ret;
+				return first + ret;
+			}
+		}
+
+		done = 0;
+		ret = 0;
+
+		/* Send segments, a pass at a time */
+		while (1) {
+			sent = 0;
+			while (sent < num_seg) {
+				ret = entry->s.ops->send(entry, index,
+							 &seg[sent],
+							 num_seg - sent);
+				if (ret <= 0)
+					break;
+				sent += ret;
+			}
+
+			done += sent;
+
+			if (odp_unlikely(sent < num_seg)) {
+				odp_packet_free_multi(&seg[sent],
+						      num_seg - sent);
+				break;
+			}
+
+			num_seg = _odp_packet_tcp_seg(packets[i], done, seg,
+						      TCP_SEG_MAX_NUM);
+			if (num_seg <= 0)
+				break;
+		}
+
+		if (done == 0) {
+			if (ret < 0 && i == 0)
+				return ret;
+			return i;
+		}
+
+		/* Rest of the segments are dropped, as the packet cannot be
+		 * partially returned to the caller */
+		total = _odp_packet_tcp_seg_num(packets[i]);
+		if (odp_unlikely(done < total)) {
+			ODP_DBG("pktio %s: %" PRIu32 " TCP segments dropped\n",
+				entry->s.name, total - done);
+			__atomic_fetch_add(&stats->discards, total - done,
+					   __ATOMIC_RELAXED);
+		}
+
+		odp_packet_free(packets[i]);
+		first = i + 1;
+	}
+
+	if (first == num)
+		return num;
+
+	ret = entry->s.ops->send(entry, index, &packets[first], num - first);
+	if (ret < 0)
+		return first ? first : ret;
+
+	return first + ret;
+}
+
 int odp_pktout_send(odp_pktout_queue_t queue, const odp_packet_t packets[],
 		    int num)
 {
@@ -1935,6 +2491,9 @@ int odp_pktout_send(odp_pktout_queue_t queue, const odp_packet_t packets[],
 	if (_ODP_PCAPNG)
 		_odp_dump_pcapng_pkts(entry, queue.index, packets, num);
 
+	if (odp_unlikely(entry->s.tcp_seg_ena && !entry->s.tcp_seg_drv))
+		return pktout_send_tcp_seg(entry, queue.index, packets, num);
+
 	return entry->s.ops->send(entry, queue.index, packets, num);
 }
 
@@ -11,19 +11,93 @@
 #include <odp_macros_internal.h>
 #include <odp_packet_io_internal.h>
 #include <odp/api/plat/packet_inlines.h>
+#include <odp/api/shared_memory.h>
+#include <odp/api/time.h>
 #include <odp_posix_extensions.h>
+#include <odp_libconfig_internal.h>
+#include <odp_ring_mpmc_internal.h>
 #include <odp_pcapng.h>
 
 #include <errno.h>
 #include <fcntl.h>
+#include <inttypes.h>
 #include <limits.h>
 #include <pthread.h>
+#include <time.h>
 #include <unistd.h>
+#include <sys/eventfd.h>
 #include <sys/stat.h>
 #include <sys/uio.h>
 #include <sys/inotify.h>
 #include <sys/select.h>
 
+#ifdef HAVE_PCAP
+#include <pcap/pcap.h>
+#include <pcap/bpf.h>
+#endif
+
+/* Maximum number of packets copied or records written in one go */
+#define PCAPNG_BURST 64
+
+/* Maximum captured packet length */
+#define PCAPNG_SNAPLEN_MAX (64 * 1024)
+
+/* Writer thread poll interval in microseconds while capture is active */
+#define PCAPNG_POLL_US 100
+
+/* Maximum filter expression length */
+#define PCAPNG_FILTER_LEN 256
+
+/* Per queue capture rings. Datapath threads take free records from the free
+ * ring, copy packets into them and pass them to the writer thread through the
+ * full ring. Packets are dropped when there are no free records. */
+typedef struct ODP_ALIGNED_CACHE pcapng_queue_s {
+	ring_mpmc_t full;
+	ring_mpmc_t free;
+	odp_atomic_u64_t captured;
+	odp_atomic_u64_t dropped;
+	uint32_t *full_data;
+	uint32_t *free_data;
+	uint8_t *rec;
+
+	/* Writer thread: records wr_rec[wr_first...wr_num - 1] are being
+	 * written, wr_offset bytes of the first one are already written */
+	uint32_t wr_num;
+	uint32_t wr_first;
+	uint32_t wr_offset;
+	uint32_t wr_rec[PCAPNG_BURST];
+} pcapng_queue_t;
+
+typedef struct {
+	/* Serializes pcapng_prepare() and pcapng_destroy() calls */
+	pthread_mutex_t ctrl_lock;
+	/* Protects pktio entry table, held by writer thread while it
+	 * processes inotify events and captured packets */
+	pthread_mutex_t lock;
+	pktio_entry_t *entry[ODP_CONFIG_PKTIO_ENTRIES];
+	int num_entry;
+	/* Event to stop writer thread */
+	int stop_fd;
+	/* ODP global time to wall clock time offset in nsec */
+	uint64_t ts_offset;
+	int filter_ena;
+#ifdef HAVE_PCAP
+	struct bpf_program filter;
+#endif
+} pcapng_global_t;
+
+static pcapng_global_t pcapng_gbl = {
+	.ctrl_lock = PTHREAD_MUTEX_INITIALIZER,
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.stop_fd = -1
+};
+
+static inline uint8_t *pcapng_rec(pktio_entry_t *entry,
+				  pcapng_queue_t *queue, uint32_t idx)
+{
+	return queue->rec + (size_t)idx * entry->s.pcapng.rec_size;
+}
+
 static void pcapng_drain_fifo(int fd)
 {
 	char buffer[4096];
@@ -34,16 +108,44 @@ static void pcapng_drain_fifo(int fd)
 	} while (len > 0);
 }
 
+/* Return records not yet written to the free ring */
+static void pcapng_queue_flush(pktio_entry_t *entry, pcapng_queue_t *queue)
+{
+	uint32_t mask = entry->s.pcapng.ring_mask;
+	uint32_t rec[PCAPNG_BURST];
+	uint32_t num;
+
+	if (queue->wr_first < queue->wr_num)
+		ring_mpmc_enq_multi(&queue->free, queue->free_data, mask,
+				    &queue->wr_rec[queue->wr_first],
+				    queue->wr_num - queue->wr_first);
+
+	queue->wr_num = 0;
+	queue->wr_first = 0;
+	queue->wr_offset = 0;
+
+	while ((num = ring_mpmc_deq_multi(&queue->full, queue->full_data,
+					  mask, rec, PCAPNG_BURST)))
+		ring_mpmc_enq_multi(&queue->free, queue->free_data, mask, rec,
+				    num);
+}
+
 static void inotify_event_handle(pktio_entry_t *entry, int qidx,
 				 struct inotify_event *event)
 {
-	int mtu = MAX(odp_pktin_maxlen(entry->s.handle),
-		      odp_pktout_maxlen(entry->s.handle));
-
 	if (event->mask & IN_OPEN) {
 		int ret;
 
-		if (PIPE_BUF < mtu + sizeof(pcapng_enhanced_packet_block_t) +
+		if (entry->s.pcapng.skip_open[qidx]) {
+			entry->s.pcapng.skip_open[qidx] = 0;
+			return;
+		}
+
+		/* Datapath threads write directly into the fifo. Writes must
+		 * not exceed PIPE_BUF to be atomic. */
+		if (entry->s.pcapng.queue == NULL &&
+		    PIPE_BUF < entry->s.pcapng.snaplen +
+		    sizeof(pcapng_enhanced_packet_block_t) +
 		    sizeof(uint32_t)) {
 			ODP_ERR("PIPE_BUF:%d too small. Disabling pcap\n",
 				PIPE_BUF);
@@ -62,9 +164,20 @@ static void inotify_event_handle(pktio_entry_t *entry, int qidx,
 	} else if (event->mask & IN_CLOSE) {
 		int fd = entry->s.pcapng.fd[qidx];
 
-		pcapng_drain_fifo(fd);
 		entry->s.pcapng.state[qidx] = PCAPNG_WR_STOP;
-		ODP_DBG("Close %s for pcap tracing\n", event->name);
+		pcapng_drain_fifo(fd);
+
+		if (entry->s.pcapng.queue) {
+			pcapng_queue_t *queue = &entry->s.pcapng.queue[qidx];
+
+			pcapng_queue_flush(entry, queue);
+			ODP_DBG("Close %s for pcap tracing: %" PRIu64 " packets "
+				"captured, %" PRIu64 " dropped\n", event->name,
+				odp_atomic_load_u64(&queue->captured),
+				odp_atomic_load_u64(&queue->dropped));
+		} else {
+			ODP_DBG("Close %s for pcap tracing\n", event->name);
+		}
 	} else {
 		ODP_ERR("Unknown inotify event 0x%08x\n", event->mask);
 	}
@@ -108,44 +221,145 @@ static int get_qidx_from_fifo(pktio_entry_t *entry, char *name)
 	return -1;
 }
 
-static void *inotify_update(void *arg)
+static void inotify_update(void)
 {
-	pktio_entry_t *entry = (pktio_entry_t *)arg;
-	struct timeval time;
 	ssize_t rdlen;
-	int offset;
+	int offset = 0;
 	char buffer[INOTIFY_BUF_LEN];
-	fd_set rfds;
+
+	rdlen = read(odp_global_data.inotify_pcapng_fd, buffer,
+		     INOTIFY_BUF_LEN);
+	while (offset < rdlen) {
+		struct inotify_event *event =
+			(struct inotify_event *)(void *)&buffer[offset];
+		int i, qidx;
+
+		for (i = 0; i < pcapng_gbl.num_entry; i++) {
+			pktio_entry_t *entry = pcapng_gbl.entry[i];
+
+			qidx = get_qidx_from_fifo(entry, event->name);
+			if (qidx == -1)
+				continue;
+
+			inotify_event_handle(entry, qidx, event);
+			break;
+		}
+
+		offset += sizeof(struct inotify_event) + event->len;
+	}
+}
+
+/* Write captured packets of a queue into its fifo until the ring is empty or
+ * the fifo is full */
+static void pcapng_queue_write(pktio_entry_t *entry, int qidx)
+{
+	pcapng_queue_t *queue = &entry->s.pcapng.queue[qidx];
+	uint32_t mask = entry->s.pcapng.ring_mask;
+	int fd = entry->s.pcapng.fd[qidx];
+	struct iovec iov[PCAPNG_BURST];
+	uint32_t i, num, first;
+	ssize_t len;
 
 	while (1) {
-		offset = 0;
+		if (queue->wr_first == queue->wr_num) {
+			queue->wr_num = ring_mpmc_deq_multi(&queue->full,
+							    queue->full_data,
+							    mask, queue->wr_rec,
+							    PCAPNG_BURST);
+			queue->wr_first = 0;
+			queue->wr_offset = 0;
+
+			if (queue->wr_num == 0)
+				return;
+		}
+
+		first = queue->wr_first;
+		num = queue->wr_num - first;
+
+		for (i = 0; i < num; i++) {
+			uint8_t *rec = pcapng_rec(entry, queue,
+						  queue->wr_rec[first + i]);
+			pcapng_enhanced_packet_block_t *epb =
+				(pcapng_enhanced_packet_block_t *)(void *)rec;
+			uint32_t offset = i ? 0 : queue->wr_offset;
+
+			iov[i].iov_base = rec + offset;
+			iov[i].iov_len = epb->block_total_length - offset;
+		}
+
+		len = writev(fd, iov, num);
+		if (len <= 0)
+			return;
+
+		for (i = 0; i < num && (size_t)len >= iov[i].iov_len; i++)
+			len -= iov[i].iov_len;
+
+		/* Return completely written records to the free ring */
+		if (i)
+			ring_mpmc_enq_multi(&queue->free, queue->free_data,
+					    mask, &queue->wr_rec[first], i);
+
+		queue->wr_first = first + i;
+
+		if (i < num) {
+			/* Fifo full, continue from middle of the record */
+			queue->wr_offset = (i ? 0 : queue->wr_offset) + len;
+			return;
+		}
+
+		queue->wr_offset = 0;
+	}
+}
+
+static void *pcapng_writer(void *arg ODP_UNUSED)
+{
+	int inotify_fd = odp_global_data.inotify_pcapng_fd;
+	int stop_fd = pcapng_gbl.stop_fd;
+	int active = 0;
+
+	while (1) {
+		struct timeval time;
+		fd_set rfds;
+		int ret, i;
+
 		FD_ZERO(&rfds);
-		FD_SET(odp_global_data.inotify_pcapng_fd, &rfds);
-		time.tv_sec = 2;
-		time.tv_usec = 0;
-		select(odp_global_data.inotify_pcapng_fd + 1, &rfds, NULL,
-		       NULL, &time);
-		if (FD_ISSET(odp_global_data.inotify_pcapng_fd, &rfds)) {
-			rdlen = read(odp_global_data.inotify_pcapng_fd,
-				     buffer, INOTIFY_BUF_LEN);
-			while (offset < rdlen) {
-				int qidx;
-				struct inotify_event *event =
-					(struct inotify_event *)(void *)
-					 &buffer[offset];
-
-				qidx = get_qidx_from_fifo(entry, event->name);
-				if (qidx == -1) {
-					offset += sizeof(struct inotify_event) +
-						event->len;
+		FD_SET(inotify_fd, &rfds);
+		FD_SET(stop_fd, &rfds);
+		time.tv_sec = 0;
+		time.tv_usec = PCAPNG_POLL_US;
+
+		/* Sleep until an inotify event while no capture is active */
+		ret = select(MAX(inotify_fd, stop_fd) + 1, &rfds, NULL, NULL,
+			     active ? &time : NULL);
+		if (ret > 0 && FD_ISSET(stop_fd, &rfds))
+			break;
+
+		pthread_mutex_lock(&pcapng_gbl.lock);
+
+		if (ret > 0 && FD_ISSET(inotify_fd, &rfds))
+			inotify_update();
+
+		active = 0;
+		for (i = 0; i < pcapng_gbl.num_entry; i++) {
+			pktio_entry_t *entry = pcapng_gbl.entry[i];
+			unsigned int max_queue = MAX(entry->s.num_in_queue,
+						     entry->s.num_out_queue);
+			unsigned int qidx;
+
+			if (entry->s.pcapng.queue == NULL)
+				continue;
+
+			for (qidx = 0; qidx < max_queue; qidx++) {
+				if (entry->s.pcapng.state[qidx] !=
+				    PCAPNG_WR_PKT)
 					continue;
-				}
 
-				inotify_event_handle(entry, qidx, event);
-				offset += sizeof(struct inotify_event) +
-						 event->len;
+				active = 1;
+				pcapng_queue_write(entry, qidx);
 			}
 		}
+
+		pthread_mutex_unlock(&pcapng_gbl.lock);
 	}
 
 	return NULL;
@@ -169,26 +383,319 @@ static int get_fifo_max_size(void)
 	return ret;
 }
 
+static int pcapng_filter_init(void)
+{
+	char filter[PCAPNG_FILTER_LEN];
+	int len;
+
+	len = _odp_libconfig_lookup_str("pcapng.filter", filter,
+					sizeof(filter));
+	if (len < 0) {
+		ODP_ERR("Config option 'pcapng.filter' not found\n");
+		return -1;
+	}
+
+	pcapng_gbl.filter_ena = 0;
+	if (len == 0)
+		return 0;
+
+#ifdef HAVE_PCAP
+	pcap_t *pcap = pcap_open_dead(DLT_EN10MB, PCAPNG_SNAPLEN_MAX);
+
+	if (pcap == NULL) {
+		ODP_ERR("pcap_open_dead() failed\n");
+		return -1;
+	}
+
+	if (pcap_compile(pcap, &pcapng_gbl.filter, filter, 1,
+			 PCAP_NETMASK_UNKNOWN)) {
+		ODP_ERR("Invalid pcapng filter '%s': %s\n", filter,
+			pcap_geterr(pcap));
+		pcap_close(pcap);
+		return -1;
+	}
+	pcap_close(pcap);
+	pcapng_gbl.filter_ena = 1;
+
+	return 0;
+#else
+	ODP_ERR("pcapng filter requires libpcap\n");
+	return -1;
+#endif
+}
+
+static void pcapng_filter_term(void)
+{
+#ifdef HAVE_PCAP
+	if (pcapng_gbl.filter_ena)
+		pcap_freecode(&pcapng_gbl.filter);
+#endif
+	pcapng_gbl.filter_ena = 0;
+}
+
+static inline int pcapng_filter_match(odp_packet_t pkt)
+{
+#ifdef HAVE_PCAP
+	struct pcap_pkthdr hdr;
+
+	if (odp_likely(!pcapng_gbl.filter_ena))
+		return 1;
+
+	memset(&hdr.ts, 0, sizeof(hdr.ts));
+	hdr.caplen = odp_packet_seg_len(pkt);
+	hdr.len = odp_packet_len(pkt);
+
+	return pcap_offline_filter(&pcapng_gbl.filter, &hdr,
+				   odp_packet_data(pkt)) != 0;
+#else
+	(void)pkt;
+
+	return 1;
+#endif
+}
+
+/* Packet timestamp in nsec since the Epoch. Packets without input timestamp
+ * are stamped with the current time. */
+static inline uint64_t pcapng_ts(odp_packet_hdr_t *pkt_hdr, uint64_t *now)
+{
+	if (pkt_hdr->p.input_flags.timestamp)
+		return odp_time_to_ns(pkt_hdr->timestamp) +
+			pcapng_gbl.ts_offset;
+
+	if (*now == 0)
+		*now = odp_time_to_ns(odp_time_global()) +
+			pcapng_gbl.ts_offset;
+
+	return *now;
+}
+
+static int pcapng_rings_alloc(pktio_entry_t *entry, unsigned int num_queue,
+			      uint32_t ring_size)
+{
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t rec_size = sizeof(pcapng_enhanced_packet_block_t) +
+			    ROUNDUP_ALIGN(entry->s.pcapng.snaplen,
+					  PCAPNG_DATA_ALIGN) +
+			    sizeof(uint32_t);
+	uint64_t data_size = ROUNDUP_CACHE_LINE(2 * ring_size *
+						sizeof(uint32_t) +
+						(uint64_t)ring_size * rec_size);
+	uint64_t queues_size = ROUNDUP_CACHE_LINE(num_queue *
+						  sizeof(pcapng_queue_t));
+	uint32_t rec[PCAPNG_BURST];
+	uint8_t *data;
+	unsigned int i;
+	uint32_t j, k;
+	odp_shm_t shm;
+
+	snprintf(name, sizeof(name), "pktio_%d_pcapng",
+		 odp_pktio_index(entry->s.handle));
+	shm = odp_shm_reserve(name, queues_size + num_queue * data_size,
+			      ODP_CACHE_LINE_SIZE, 0);
+	if (shm == ODP_SHM_INVALID) {
+		ODP_ERR("pcapng ring reserve failed\n");
+		return -1;
+	}
+
+	entry->s.pcapng.shm = shm;
+	entry->s.pcapng.queue = odp_shm_addr(shm);
+	entry->s.pcapng.rec_size = rec_size;
+	entry->s.pcapng.ring_mask = ring_size - 1;
+	data = (uint8_t *)entry->s.pcapng.queue + queues_size;
+
+	for (i = 0; i < num_queue; i++) {
+		pcapng_queue_t *queue = &entry->s.pcapng.queue[i];
+
+		memset(queue, 0, sizeof(pcapng_queue_t));
+		ring_mpmc_init(&queue->full);
+		ring_mpmc_init(&queue->free);
+		odp_atomic_init_u64(&queue->captured, 0);
+		odp_atomic_init_u64(&queue->dropped, 0);
+		queue->full_data = (uint32_t *)(void *)data;
+		queue->free_data = queue->full_data + ring_size;
+		queue->rec = (uint8_t *)(queue->free_data + ring_size);
+		data += data_size;
+
+		for (j = 0; j < ring_size; j += k) {
+			for (k = 0; k < PCAPNG_BURST && j + k < ring_size; k++)
+				rec[k] = j + k;
+
+			ring_mpmc_enq_multi(&queue->free, queue->free_data,
+					    ring_size - 1, rec, k);
+		}
+	}
+
+	return 0;
+}
+
+static void pcapng_rings_free(pktio_entry_t *entry)
+{
+	unsigned int max_queue =
+		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
+	unsigned int i;
+
+	if (entry->s.pcapng.queue == NULL)
+		return;
+
+	for (i = 0; i < max_queue; i++) {
+		pcapng_queue_t *queue = &entry->s.pcapng.queue[i];
+
+		ODP_DBG("pcapng %s queue %u: %" PRIu64 " packets captured, %"
+			PRIu64 " dropped\n", entry->s.name, i,
+			odp_atomic_load_u64(&queue->captured),
+			odp_atomic_load_u64(&queue->dropped));
+	}
+
+	entry->s.pcapng.queue = NULL;
+
+	if (odp_shm_free(entry->s.pcapng.shm))
+		ODP_ERR("pcapng ring free failed\n");
+
+	entry->s.pcapng.shm = ODP_SHM_INVALID;
+}
+
+/* Start writer thread for the first pktio */
+static int pcapng_writer_start(void)
+{
+	struct timespec ts;
+	pthread_attr_t attr;
+	int ret;
+
+	odp_global_data.inotify_pcapng_fd = -1;
+	odp_global_data.inotify_watch_fd = -1;
+	pcapng_gbl.stop_fd = -1;
+
+	if (pcapng_filter_init())
+		return -1;
+
+	clock_gettime(CLOCK_REALTIME, &ts);
+	pcapng_gbl.ts_offset = ts.tv_sec * ODP_TIME_SEC_IN_NS + ts.tv_nsec -
+			       odp_time_to_ns(odp_time_global());
+
+	odp_global_data.inotify_pcapng_fd = inotify_init();
+	if (odp_global_data.inotify_pcapng_fd == -1) {
+		ODP_ERR("can't init inotify. pcap disabled\n");
+		goto out_destroy;
+	}
+
+	odp_global_data.inotify_watch_fd =
+		inotify_add_watch(odp_global_data.inotify_pcapng_fd,
+				  PCAPNG_WATCH_DIR, IN_CLOSE | IN_OPEN);
+
+	if (odp_global_data.inotify_watch_fd == -1) {
+		ODP_ERR("can't register inotify for %s. pcap disabled\n",
+			strerror(errno));
+		goto out_destroy;
+	}
+
+	pcapng_gbl.stop_fd = eventfd(0, 0);
+	if (pcapng_gbl.stop_fd == -1) {
+		ODP_ERR("can't create eventfd. pcap disabled\n");
+		goto out_destroy;
+	}
+
+	/* create a thread to poll inotify triggers and write packets */
+	pthread_attr_init(&attr);
+	ret = pthread_create(&odp_global_data.inotify_thread, &attr,
+			     pcapng_writer, NULL);
+	if (ret) {
+		ODP_ERR("can't start inotify thread. pcap disabled\n");
+		goto out_destroy;
+	}
+
+	odp_global_data.inotify_pcapng_is_running = 1;
+
+	return 0;
+
+out_destroy:
+	if (odp_global_data.inotify_watch_fd != -1)
+		inotify_rm_watch(odp_global_data.inotify_pcapng_fd,
+				 odp_global_data.inotify_watch_fd);
+
+	if (odp_global_data.inotify_pcapng_fd != -1)
+		close(odp_global_data.inotify_pcapng_fd);
+
+	if (pcapng_gbl.stop_fd != -1)
+		close(pcapng_gbl.stop_fd);
+
+	pcapng_filter_term();
+
+	return -1;
+}
+
+/* Stop writer thread after the last pktio */
+static void pcapng_writer_stop(void)
+{
+	uint64_t val = 1;
+	int ret;
+
+	if (odp_global_data.inotify_pcapng_is_running == 0)
+		return;
+
+	if (write(pcapng_gbl.stop_fd, &val, sizeof(val)) != sizeof(val))
+		ODP_ERR("can't stop inotify thread %s\n", strerror(errno));
+	else
+		pthread_join(odp_global_data.inotify_thread, NULL);
+
+	odp_global_data.inotify_pcapng_is_running = 0;
+
+	ret = inotify_rm_watch(odp_global_data.inotify_pcapng_fd,
+			       odp_global_data.inotify_watch_fd);
+	if (ret)
+		ODP_ERR("can't deregister inotify %s\n", strerror(errno));
+
+	close(odp_global_data.inotify_pcapng_fd);
+	close(pcapng_gbl.stop_fd);
+	pcapng_gbl.stop_fd = -1;
+
+	pcapng_filter_term();
+}
+
 int pcapng_prepare(pktio_entry_t *entry)
 {
 	int ret = -1, fd;
-	pthread_attr_t attr;
 	unsigned int i;
 	unsigned int max_queue =
 		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
 	int fifo_sz;
+	int ring_size, snaplen;
+	/* Inotify reports fifo open events once the writer is running */
+	int skip_open = odp_global_data.inotify_pcapng_is_running;
+
+	entry->s.pcapng.queue = NULL;
+	entry->s.pcapng.shm = ODP_SHM_INVALID;
+
+	for (i = 0; i < max_queue; i++) {
+		entry->s.pcapng.fd[i] = -1;
+		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
+	}
+
+	if (!_odp_libconfig_lookup_int("pcapng.ring_size", &ring_size) ||
+	    !_odp_libconfig_lookup_int("pcapng.snaplen", &snaplen)) {
+		ODP_ERR("Config options 'pcapng.*' not found\n");
+		return -1;
+	}
+
+	if (snaplen <= 0)
+		snaplen = MAX(odp_pktin_maxlen(entry->s.handle),
+			      odp_pktout_maxlen(entry->s.handle));
+	entry->s.pcapng.snaplen = MIN(snaplen, PCAPNG_SNAPLEN_MAX);
+
+	if (ring_size > 0 &&
+	    pcapng_rings_alloc(entry, max_queue,
+			       ROUNDUP_POWER2_U32(ring_size)))
+		return -1;
 
 	fifo_sz = get_fifo_max_size();
 	if (fifo_sz < 0)
 		ODP_DBG("failed to read max fifo size\n");
 
+	pthread_mutex_lock(&pcapng_gbl.ctrl_lock);
+
 	for (i = 0; i < max_queue; i++) {
 		char pcapng_name[128];
 		char pcapng_path[256];
 
-		entry->s.pcapng.fd[i] = -1;
-		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
-
 		get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
 				     entry->s.name, i);
 		snprintf(pcapng_path, sizeof(pcapng_path), "%s/%s",
@@ -216,80 +723,62 @@ int pcapng_prepare(pktio_entry_t *entry)
 		}
 
 		entry->s.pcapng.fd[i] = fd;
+		entry->s.pcapng.skip_open[i] = skip_open;
 	}
 
 	/* already running from a previous pktio */
-	if (odp_global_data.inotify_pcapng_is_running == 1)
-		return 0;
+	if (odp_global_data.inotify_pcapng_is_running == 0 &&
+	    pcapng_writer_start())
+		goto out;
 
-	odp_global_data.inotify_pcapng_fd = -1;
-	odp_global_data.inotify_watch_fd = -1;
+	pthread_mutex_lock(&pcapng_gbl.lock);
+	pcapng_gbl.entry[pcapng_gbl.num_entry++] = entry;
+	pthread_mutex_unlock(&pcapng_gbl.lock);
 
-	odp_global_data.inotify_pcapng_fd = inotify_init();
-	if (odp_global_data.inotify_pcapng_fd == -1) {
-		ODP_ERR("can't init inotify. pcap disabled\n");
-		goto out_destroy;
-	}
+	ret = 0;
 
-	odp_global_data.inotify_watch_fd =
-		inotify_add_watch(odp_global_data.inotify_pcapng_fd,
-				  PCAPNG_WATCH_DIR, IN_CLOSE | IN_OPEN);
-
-	if (odp_global_data.inotify_watch_fd == -1) {
-		ODP_ERR("can't register inotify for %s. pcap disabled\n",
-			strerror(errno));
-		goto out_destroy;
-	}
-
-	/* create a thread to poll inotify triggers */
-	pthread_attr_init(&attr);
-	ret = pthread_create(&odp_global_data.inotify_thread, &attr,
-			     inotify_update, entry);
-	if (ret)
-		ODP_ERR("can't start inotify thread. pcap disabled\n");
-	else
-		odp_global_data.inotify_pcapng_is_running = 1;
-
-	return ret;
-
-out_destroy:
-	pcapng_destroy(entry);
+out:
+	pthread_mutex_unlock(&pcapng_gbl.ctrl_lock);
 
 	return ret;
 }
 
 void pcapng_destroy(pktio_entry_t *entry)
 {
-	int ret;
 	unsigned int i;
 	unsigned int max_queue =
 		MAX(entry->s.num_in_queue, entry->s.num_out_queue);
-
-	if (odp_global_data.inotify_pcapng_is_running == 1) {
-		ret = pthread_cancel(odp_global_data.inotify_thread);
-		if (ret)
-			ODP_ERR("can't cancel inotify thread %s\n",
-				strerror(errno));
+	int found = 0;
+	int n;
+
+	pthread_mutex_lock(&pcapng_gbl.ctrl_lock);
+
+	/* Writer thread does not access the entry after this */
+	pthread_mutex_lock(&pcapng_gbl.lock);
+	for (n = 0; n < pcapng_gbl.num_entry; n++) {
+		if (pcapng_gbl.entry[n] == entry) {
+			found = 1;
+			pcapng_gbl.num_entry--;
+			pcapng_gbl.entry[n] =
+				pcapng_gbl.entry[pcapng_gbl.num_entry];
+			break;
+		}
 	}
+	pthread_mutex_unlock(&pcapng_gbl.lock);
 
-	/* fd's will be -1 in case of any failure */
-	ret = inotify_rm_watch(odp_global_data.inotify_pcapng_fd,
-			       odp_global_data.inotify_watch_fd);
-	if (ret)
-		ODP_ERR("can't deregister inotify %s\n", strerror(errno));
-
-	if (odp_global_data.inotify_pcapng_fd != -1)
-		close(odp_global_data.inotify_pcapng_fd);
-
-	if (odp_global_data.inotify_watch_fd != -1)
-		close(odp_global_data.inotify_watch_fd);
+	if (found && pcapng_gbl.num_entry == 0)
+		pcapng_writer_stop();
 
 	for (i = 0; i < max_queue; i++) {
 		char pcapng_name[128];
 		char pcapng_path[256];
 
 		entry->s.pcapng.state[i] = PCAPNG_WR_STOP;
+		if (entry->s.pcapng.fd[i] == -1)
+			continue;
+
 		close(entry->s.pcapng.fd[i]);
+		entry->s.pcapng.fd[i] = -1;
 
 		get_pcapng_fifo_name(pcapng_name, sizeof(pcapng_name),
 				     entry->s.name, i);
@@ -299,6 +788,10 @@ void pcapng_destroy(pktio_entry_t *entry)
 		if (remove(pcapng_path))
 			ODP_ERR("can't delete fifo %s\n", pcapng_path);
 	}
+
+	pcapng_rings_free(entry);
+
+	pthread_mutex_unlock(&pcapng_gbl.ctrl_lock);
 }
 
 int write_pcapng_hdr(pktio_entry_t *entry, int qidx)
@@ -331,7 +824,12 @@ int write_pcapng_hdr(pktio_entry_t *entry, int qidx)
 	idb.block_total_length = sizeof(idb);
 	idb.block_total_length2 = sizeof(idb);
 	idb.linktype = PCAPNG_LINKTYPE_ETHERNET;
-	idb.snaplen = 0x0; /* unlimited */
+	idb.snaplen = entry->s.pcapng.snaplen;
+	idb.tsresol_code = PCAPNG_OPT_IF_TSRESOL;
+	idb.tsresol_len = sizeof(idb.tsresol);
+	idb.tsresol = PCAPNG_TSRESOL_NS;
+	idb.end_code = PCAPNG_OPT_END;
+	idb.end_len = 0;
 	len = write(fd, &idb, sizeof(idb));
 	if (len != sizeof(idb)) {
 		ODP_ERR("Failed to write pcapng interface description\n");
@@ -364,6 +862,78 @@ static ssize_t write_fifo(int fd, struct iovec *iov, int iovcnt)
 	return len;
 }
 
+/* Copy packets into capture ring of the queue */
+static int pcapng_ring_pkts(pktio_entry_t *entry, int qidx,
+			    const odp_packet_t packets[], int num)
+{
+	pcapng_queue_t *queue = &entry->s.pcapng.queue[qidx];
+	uint32_t mask = entry->s.pcapng.ring_mask;
+	uint32_t snaplen = entry->s.pcapng.snaplen;
+	odp_packet_t pkt_tbl[PCAPNG_BURST];
+	uint32_t rec_idx[PCAPNG_BURST];
+	uint64_t now = 0;
+	int captured = 0;
+	int i, j, n;
+
+	for (i = 0; i < num; i += n) {
+		uint32_t num_pkt = 0;
+		uint32_t num_rec;
+
+		n = MIN(num - i, PCAPNG_BURST);
+
+		for (j = 0; j < n; j++)
+			if (pcapng_filter_match(packets[i + j]))
+				pkt_tbl[num_pkt++] = packets[i + j];
+
+		if (num_pkt == 0)
+			continue;
+
+		num_rec = ring_mpmc_deq_multi(&queue->free, queue->free_data,
+					      mask, rec_idx, num_pkt);
+		if (odp_unlikely(num_rec < num_pkt))
+			odp_atomic_add_u64(&queue->dropped, num_pkt - num_rec);
+
+		if (num_rec == 0)
+			continue;
+
+		for (j = 0; j < (int)num_rec; j++) {
+			odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt_tbl[j]);
+			uint8_t *rec = pcapng_rec(entry, queue, rec_idx[j]);
+			pcapng_enhanced_packet_block_t *epb =
+				(pcapng_enhanced_packet_block_t *)(void *)rec;
+			uint32_t pkt_len = packet_len(pkt_hdr);
+			uint32_t cap_len = MIN(pkt_len, snaplen);
+			uint32_t data_len = ROUNDUP_ALIGN(cap_len,
+							  PCAPNG_DATA_ALIGN);
+			uint32_t blk_len = sizeof(*epb) + data_len +
+					   sizeof(uint32_t);
+			uint64_t ts = pcapng_ts(pkt_hdr, &now);
+			uint8_t *data = rec + sizeof(*epb);
+
+			epb->block_type = PCAPNG_BLOCK_TYPE_EPB;
+			epb->block_total_length = blk_len;
+			epb->interface_idx = 0;
+			epb->timestamp_high = (uint32_t)(ts >> 32);
+			epb->timestamp_low = (uint32_t)ts;
+			epb->captured_len = cap_len;
+			epb->packet_len = pkt_len;
+
+			odp_packet_copy_to_mem(pkt_tbl[j], 0, cap_len, data);
+			memset(data + cap_len, 0, data_len - cap_len);
+			memcpy(data + data_len, &blk_len, sizeof(uint32_t));
+		}
+
+		ring_mpmc_enq_multi(&queue->full, queue->full_data, mask,
+				    rec_idx, num_rec);
+		captured += num_rec;
+	}
+
+	if (captured)
+		odp_atomic_add_u64(&queue->captured, captured);
+
+	return captured;
+}
+
 int write_pcapng_pkts(pktio_entry_t *entry, int qidx,
 		      const odp_packet_t packets[], int num)
 {
@@ -374,12 +944,23 @@ int write_pcapng_pkts(pktio_entry_t *entry, int qidx,
 	ssize_t block_len = 0;
 	int fd = entry->s.pcapng.fd[qidx];
 	ssize_t len = 0, wlen;
+	uint64_t now = 0;
+
+	if (entry->s.pcapng.queue)
+		return pcapng_ring_pkts(entry, qidx, packets, num);
 
 	for (i = 0; i < num; i++) {
 		odp_packet_hdr_t *pkt_hdr = packet_hdr(packets[i]);
 		uint32_t seg_len;
 		char *buf = (char *)odp_packet_offset(packets[i], 0, &seg_len,
 						      NULL);
+		uint64_t ts;
+
+		if (!pcapng_filter_match(packets[i]))
+			continue;
+
+		seg_len = MIN(seg_len, entry->s.pcapng.snaplen);
+		ts = pcapng_ts(pkt_hdr, &now);
 
 		if (block_len + sizeof(epb[i]) +
 		    ROUNDUP_ALIGN(seg_len, PCAPNG_DATA_ALIGN) +
@@ -396,11 +977,10 @@ int write_pcapng_pkts(pktio_entry_t *entry, int qidx,
 			ROUNDUP_ALIGN(seg_len, PCAPNG_DATA_ALIGN) +
 			PCAPNG_DATA_ALIGN;
 		epb[i].interface_idx = 0;
-		epb[i].timestamp_high =
-			(uint32_t)(pkt_hdr->timestamp.u64 >> 32);
-		epb[i].timestamp_low = (uint32_t)(pkt_hdr->timestamp.u64);
+		epb[i].timestamp_high = (uint32_t)(ts >> 32);
+		epb[i].timestamp_low = (uint32_t)ts;
 		epb[i].captured_len = seg_len;
-		epb[i].packet_len = seg_len;
+		epb[i].packet_len = packet_len(pkt_hdr);
 
 		/* epb */
 		packet_iov[iovcnt].iov_base = &epb[i];
@@ -20,32 +20,37 @@
 
 #define NUM_PKTS     7
 
+/* queue_blk_t records are allocated in chunks of BLKS_PER_CHUNK records, as
+ * the number of queued pkts grows. A queue_blk_idx is the chunk number and
+ * the index of the record within the chunk. queue_blk_idx 0 is never used,
+ * so that value 0 means "no block". */
+#define BLK_CHUNK_SHIFT   10
+#define BLKS_PER_CHUNK    (1 << BLK_CHUNK_SHIFT)
+
+/* Queue descriptors are allocated in chunks of QUEUES_PER_CHUNK as queues are
+ * created, so that the memory usage does not depend on max_num_queues. */
+#define QUEUE_CHUNK_SHIFT 12
+#define QUEUES_PER_CHUNK  (1 << QUEUE_CHUNK_SHIFT)
+
+#define MAX_QUEUE_NUM     (16 * 1024 * 1024)
+
 /* Must be exactly 64 bytes long AND cacheline aligned! */
 typedef struct ODP_ALIGNED_CACHE {
 	uint32_t next_queue_blk_idx;
-	uint32_t tail_queue_blk_idx;
+	uint32_t reserved;
 	odp_packet_t pkts[NUM_PKTS];
 } queue_blk_t;
 
-typedef struct ODP_ALIGNED_CACHE {
-	queue_blk_t blks[0];
-} queue_blks_t;
-
-/* The queue_num_tbl is used to map from a queue_num to a queue_num_desc.
- * The reason is based on the assumption that usually only a small fraction
- * of the max_num_queues will have more than 1 pkt associated with it.  This
- * way the active queue_desc's can be dynamically allocated and freed according
- * to the actual usage pattern.
+/* A pkt queue is a linked list of queue_blk_t records. Pkts are removed from
+ * head_off of the head block and appended to tail_off of the tail block.
+ * Empty queues do not hold any blocks (head_blk_idx is 0).
  */
 typedef struct {
-	uint32_t queue_num_to_blk_idx[0];
-} queue_num_tbl_t;
-
-typedef struct {
-	uint32_t num_blks;
-	uint32_t next_blk_idx; /* blk_idx of queue_blks not yet added. */
-	queue_blks_t *queue_blks;
-} queue_region_desc_t;
+	uint32_t head_blk_idx;
+	uint32_t tail_blk_idx;
+	uint8_t  head_off;
+	uint8_t  tail_off;
+} queue_desc_t;
 
 typedef struct {
 	uint64_t total_pkt_appends;
@@ -58,115 +63,69 @@ typedef struct {
 	uint32_t max_queue_num;
 	uint32_t max_queued_pkts;
 	uint32_t next_queue_num;
-	queue_region_desc_t queue_region_descs[16];
-	uint32_t *queue_num_tbl;
-	uint8_t current_region;
-	uint8_t all_regions_used;
+	uint32_t num_blk_chunks;
+	uint32_t max_blk_chunks;
+	queue_blk_t **blk_chunks;
+	queue_desc_t **queue_chunks;
 } queue_pool_t;
 
-static inline void init_queue_blk(queue_blk_t *queue_blk)
+static inline queue_blk_t *blk_idx_to_queue_blk(queue_pool_t *pool,
+						uint32_t queue_blk_idx)
 {
-	int i;
-
-	memset(queue_blk, 0, sizeof(queue_blk_t));
-
-	for (i = 0; i < NUM_PKTS; i++)
-		queue_blk->pkts[i] = ODP_PACKET_INVALID;
+	return &pool->blk_chunks[queue_blk_idx >> BLK_CHUNK_SHIFT]
+		[queue_blk_idx & (BLKS_PER_CHUNK - 1)];
 }
 
-static queue_blk_t *blk_idx_to_queue_blk(queue_pool_t *queue_pool,
-					 uint32_t queue_blk_idx)
+static inline queue_desc_t *queue_num_to_desc(queue_pool_t *pool,
+					      uint32_t queue_num)
 {
-	queue_region_desc_t *queue_region_desc;
-	uint32_t which_region, blk_tbl_idx;
+	uint32_t idx = queue_num - 1;
 
-	which_region = queue_blk_idx >> 28;
-	blk_tbl_idx = queue_blk_idx & ((1 << 28) - 1);
-	queue_region_desc = &queue_pool->queue_region_descs[which_region];
-	return &queue_region_desc->queue_blks->blks[blk_tbl_idx];
+	return &pool->queue_chunks[idx >> QUEUE_CHUNK_SHIFT]
+		[idx & (QUEUES_PER_CHUNK - 1)];
 }
 
-static void free_alloced_queue_blks(uint32_t end, queue_blks_t *blk_array[])
+/* Allocate a new chunk of queue_blk_t records and add them to the free
+ * list. */
+static int pkt_queue_free_list_add(queue_pool_t *pool)
 {
-	uint32_t i;
+	queue_blk_t *chunk;
+	uint32_t chunk_idx, first, idx;
 
-	for (i = 0; i < end; i++)
-		free(blk_array[i]);
-}
+	if (pool->num_blk_chunks >= pool->max_blk_chunks)
+		return -1;
 
-static int pkt_queue_free_list_add(queue_pool_t *pool,
-				   uint32_t num_queue_blks)
-{
-	queue_region_desc_t *region_desc;
-	queue_blks_t *queue_blks;
-	queue_blks_t *alloced_queue_blks[num_queue_blks];
-	queue_blk_t *queue_blk;
-	uint32_t which_region, blks_added, num_blks, start_idx;
-	uint32_t malloc_len, blks_to_add, cnt, i, alloc_cnt;
-
-	which_region = pool->current_region;
-	blks_added = 0;
-	alloc_cnt = 0;
-	while ((blks_added < num_queue_blks) && (pool->all_regions_used == 0)) {
-		region_desc = &pool->queue_region_descs[which_region];
-		start_idx = region_desc->next_blk_idx;
-		num_blks = region_desc->num_blks;
-		queue_blks = region_desc->queue_blks;
-		if (!queue_blks) {
-			malloc_len = num_blks * sizeof(queue_blk_t);
-			queue_blks = malloc(malloc_len);
-			if (!queue_blks) {
-				free_alloced_queue_blks(alloc_cnt,
-							alloced_queue_blks);
-				return -1;
-			}
-			alloced_queue_blks[alloc_cnt] = queue_blks;
-			alloc_cnt++;
-
-			for (i = 0; i < num_blks; i++)
-				init_queue_blk(&queue_blks->blks[i]);
-
-			region_desc->queue_blks = queue_blks;
-		}
+	chunk = malloc(BLKS_PER_CHUNK * sizeof(queue_blk_t));
+	if (!chunk)
+		return -1;
 
-		/* Now add as many queue_blks to the free list as... */
-		blks_to_add = MIN(num_blks - start_idx, num_queue_blks);
-		queue_blk = &queue_blks->blks[start_idx];
-		for (cnt = 1; cnt <= blks_to_add; cnt++) {
-			queue_blk->next_queue_blk_idx = start_idx + cnt;
-			queue_blk++;
-		}
+	chunk_idx = pool->num_blk_chunks++;
+	pool->blk_chunks[chunk_idx] = chunk;
 
-		blks_added += blks_to_add;
-		pool->free_list_size += blks_to_add;
-		region_desc->next_blk_idx += blks_to_add;
-		if (blks_to_add == (num_blks - start_idx)) {
-			/* Advance to the next region */
-			pool->current_region++;
-			if (16 <= pool->current_region) {
-				pool->all_regions_used = 1;
-				return blks_added;
-			}
-
-			which_region = pool->current_region;
-		}
+	/* Skip queue_blk_idx 0 */
+	first = chunk_idx == 0 ? 1 : 0;
+	for (idx = first; idx < BLKS_PER_CHUNK; idx++) {
+		chunk[idx].next_queue_blk_idx = pool->free_list_head_idx;
+		pool->free_list_head_idx =
+			(chunk_idx << BLK_CHUNK_SHIFT) | idx;
 	}
 
-	return blks_added;
+	pool->free_list_size += BLKS_PER_CHUNK - first;
+	if (pool->peak_free_list_size < pool->free_list_size)
+		pool->peak_free_list_size = pool->free_list_size;
+
+	return 0;
 }
 
-static queue_blk_t *queue_blk_alloc(queue_pool_t *pool,
-				    uint32_t *queue_blk_idx)
+static inline queue_blk_t *queue_blk_alloc(queue_pool_t *pool,
+					   uint32_t *queue_blk_idx)
 {
 	queue_blk_t *head_queue_blk;
 	uint32_t head_queue_blk_idx;
-	int rc;
 
-	if (pool->free_list_size <= 1) {
+	if (odp_unlikely(pool->free_list_size == 0)) {
 		/* Replenish the queue_blk_t free list. */
-		pool->min_free_list_size = pool->free_list_size;
-		rc = pkt_queue_free_list_add(pool, 64);
-		if (rc <= 0)
+		if (pkt_queue_free_list_add(pool))
 			return NULL;
 	}
 
@@ -178,16 +137,13 @@ static queue_blk_t *queue_blk_alloc(queue_pool_t *pool,
 	if (pool->free_list_size < pool->min_free_list_size)
 		pool->min_free_list_size = pool->free_list_size;
 
-	init_queue_blk(head_queue_blk);
+	head_queue_blk->next_queue_blk_idx = 0;
 	return head_queue_blk;
 }
 
-static void queue_blk_free(queue_pool_t *pool, queue_blk_t *queue_blk,
-			   uint32_t queue_blk_idx)
+static inline void queue_blk_free(queue_pool_t *pool, queue_blk_t *queue_blk,
+				  uint32_t queue_blk_idx)
 {
-	if ((!queue_blk) || (queue_blk_idx == 0))
-		return;
-
 	queue_blk->next_queue_blk_idx = pool->free_list_head_idx;
 	pool->free_list_head_idx = queue_blk_idx;
 	pool->free_list_size++;
@@ -195,21 +151,14 @@ static void queue_blk_free(queue_pool_t *pool, queue_blk_t *queue_blk,
 		pool->peak_free_list_size = pool->free_list_size;
 }
 
-static void queue_region_desc_init(queue_pool_t *pool, uint32_t which_region,
-				   uint32_t num_blks)
-{
-	queue_region_desc_t *queue_region_desc;
-
-	queue_region_desc = &pool->queue_region_descs[which_region];
-	queue_region_desc->num_blks = num_blks;
-}
-
 _odp_int_queue_pool_t _odp_queue_pool_create(uint32_t max_num_queues,
 					     uint32_t max_queued_pkts)
 {
 	queue_pool_t *pool;
-	uint32_t idx, initial_free_list_size, malloc_len, first_queue_blk_idx;
-	int rc;
+	uint32_t num_queue_chunks;
+
+	if (max_num_queues == 0 || max_num_queues > MAX_QUEUE_NUM)
+		return _ODP_INT_QUEUE_POOL_INVALID;
 
 	pool = malloc(sizeof(queue_pool_t));
 	if (!pool)
@@ -217,39 +166,21 @@ _odp_int_queue_pool_t _odp_queue_pool_create(uint32_t max_num_queues,
 
 	memset(pool, 0, sizeof(queue_pool_t));
 
-	malloc_len = max_num_queues * sizeof(uint32_t);
-	pool->queue_num_tbl = malloc(malloc_len);
-	if (!pool->queue_num_tbl)  {
-		free(pool);
-		return _ODP_INT_QUEUE_POOL_INVALID;
-	}
-	memset(pool->queue_num_tbl, 0, malloc_len);
-
-       /* Initialize the queue_blk_tbl_sizes array based upon the
-	* max_queued_pkts.
-	*/
+	/* Every queued pkt may be in a block of its own */
 	max_queued_pkts = MAX(max_queued_pkts, 64 * UINT32_C(1024));
-	queue_region_desc_init(pool, 0, max_queued_pkts / 4);
-	queue_region_desc_init(pool, 1, max_queued_pkts / 64);
-	queue_region_desc_init(pool, 2, max_queued_pkts / 64);
-	queue_region_desc_init(pool, 3, max_queued_pkts / 64);
-	queue_region_desc_init(pool, 4, max_queued_pkts / 64);
-	for (idx = 5; idx < 16; idx++)
-		queue_region_desc_init(pool, idx, max_queued_pkts / 16);
-
-       /* Now allocate the first queue_blk_tbl and add its blks to the free
-	* list.  Replenish the queue_blk_t free list.
-	*/
-	initial_free_list_size = MIN(64 * UINT32_C(1024), max_queued_pkts / 4);
-	rc = pkt_queue_free_list_add(pool, initial_free_list_size);
-	if (rc < 0) {
-		free(pool->queue_num_tbl);
-		free(pool);
-		return _ODP_INT_QUEUE_POOL_INVALID;
-	}
+	pool->max_blk_chunks = (max_queued_pkts + BLKS_PER_CHUNK - 1) /
+			       BLKS_PER_CHUNK;
+	num_queue_chunks = (max_num_queues + QUEUES_PER_CHUNK - 1) /
+			   QUEUES_PER_CHUNK;
 
-	/* Discard the first queue blk with idx 0 */
-	queue_blk_alloc(pool, &first_queue_blk_idx);
+	pool->blk_chunks = calloc(pool->max_blk_chunks, sizeof(queue_blk_t *));
+	pool->queue_chunks = calloc(num_queue_chunks, sizeof(queue_desc_t *));
+	if (!pool->blk_chunks || !pool->queue_chunks)
+		goto error;
+
+	/* Allocate the first chunk of queue_blk_t records up front */
+	if (pkt_queue_free_list_add(pool))
+		goto error;
 
 	pool->max_queue_num = max_num_queues;
 	pool->max_queued_pkts = max_queued_pkts;
@@ -258,132 +189,213 @@ _odp_int_queue_pool_t _odp_queue_pool_create(uint32_t max_num_queues,
 	pool->min_free_list_size = pool->free_list_size;
 	pool->peak_free_list_size = pool->free_list_size;
 	return (_odp_int_queue_pool_t)(uintptr_t)pool;
+
+error:
+	free(pool->blk_chunks);
+	free(pool->queue_chunks);
+	free(pool);
+	return _ODP_INT_QUEUE_POOL_INVALID;
 }
 
 _odp_int_pkt_queue_t _odp_pkt_queue_create(_odp_int_queue_pool_t queue_pool)
 {
 	queue_pool_t *pool;
-	uint32_t queue_num;
+	queue_desc_t *queue_chunk;
+	uint32_t queue_num, chunk_idx;
 
 	pool = (queue_pool_t *)(uintptr_t)queue_pool;
-	queue_num = pool->next_queue_num++;
+	queue_num = pool->next_queue_num;
 	if (pool->max_queue_num < queue_num)
 		return _ODP_INT_PKT_QUEUE_INVALID;
 
+	chunk_idx = (queue_num - 1) >> QUEUE_CHUNK_SHIFT;
+	if (!pool->queue_chunks[chunk_idx]) {
+		queue_chunk = calloc(QUEUES_PER_CHUNK, sizeof(queue_desc_t));
+		if (!queue_chunk)
+			return _ODP_INT_PKT_QUEUE_INVALID;
+
+		pool->queue_chunks[chunk_idx] = queue_chunk;
+	}
+
+	pool->next_queue_num++;
 	return (_odp_int_pkt_queue_t)queue_num;
 }
 
-int _odp_pkt_queue_append(_odp_int_queue_pool_t queue_pool,
-			  _odp_int_pkt_queue_t pkt_queue, odp_packet_t pkt)
+static inline int valid_queue_num(queue_pool_t *pool, uint32_t queue_num)
+{
+	return (queue_num != 0) && (queue_num < pool->next_queue_num);
+}
+
+int _odp_pkt_queue_destroy(_odp_int_queue_pool_t queue_pool,
+			   _odp_int_pkt_queue_t  pkt_queue)
 {
 	queue_pool_t *pool;
-	queue_blk_t *first_blk, *tail_blk, *new_tail_blk;
-	uint32_t queue_num, first_blk_idx, tail_blk_idx, new_tail_blk_idx;
-	uint32_t idx;
+	uint32_t queue_num;
 
 	pool = (queue_pool_t *)(uintptr_t)queue_pool;
 	queue_num = (uint32_t)pkt_queue;
-	if ((queue_num == 0) || (pool->max_queue_num < queue_num))
+	if (!valid_queue_num(pool, queue_num) ||
+	    queue_num != pool->next_queue_num - 1 ||
+	    queue_num_to_desc(pool, queue_num)->head_blk_idx != 0)
+		return -1;
+
+	pool->next_queue_num--;
+	return 0;
+}
+
+int _odp_pkt_queue_append_multi(_odp_int_queue_pool_t queue_pool,
+				_odp_int_pkt_queue_t pkt_queue,
+				const odp_packet_t pkts[], int num)
+{
+	queue_pool_t *pool;
+	queue_desc_t *desc;
+	queue_blk_t *tail_blk, *new_tail_blk;
+	uint32_t queue_num, new_tail_blk_idx, tail_off, cnt;
+	int i;
+
+	pool = (queue_pool_t *)(uintptr_t)queue_pool;
+	queue_num = (uint32_t)pkt_queue;
+	if (!valid_queue_num(pool, queue_num))
 		return -2;
 
-	if (pkt == ODP_PACKET_INVALID)
-		return -3;
+	if (num <= 0)
+		return 0;
 
-	pool->total_pkt_appends++;
-	first_blk_idx = pool->queue_num_tbl[queue_num - 1];
-	if (first_blk_idx == 0) {
-		first_blk = queue_blk_alloc(pool, &first_blk_idx);
-		if (!first_blk)
+	desc = queue_num_to_desc(pool, queue_num);
+	if (desc->head_blk_idx == 0) {
+		tail_blk = queue_blk_alloc(pool, &new_tail_blk_idx);
+		if (!tail_blk)
 			return -1;
 
-		pool->queue_num_tbl[queue_num - 1] = first_blk_idx;
-		init_queue_blk(first_blk);
-		first_blk->pkts[0] = pkt;
-		return 0;
+		desc->head_blk_idx = new_tail_blk_idx;
+		desc->tail_blk_idx = new_tail_blk_idx;
+		desc->head_off = 0;
+		desc->tail_off = 0;
+	} else {
+		tail_blk = blk_idx_to_queue_blk(pool, desc->tail_blk_idx);
 	}
 
-	first_blk = blk_idx_to_queue_blk(pool, first_blk_idx);
-	tail_blk_idx = first_blk->tail_queue_blk_idx;
-	if (tail_blk_idx == 0)
-		tail_blk = first_blk;
-	else
-		tail_blk = blk_idx_to_queue_blk(pool, tail_blk_idx);
-
-	/* Find first empty slot and insert pkt there. */
-	for (idx = 0; idx < NUM_PKTS; idx++) {
-		if (tail_blk->pkts[idx] == ODP_PACKET_INVALID) {
-			tail_blk->pkts[idx] = pkt;
-			return 0;
-		}
+	tail_off = desc->tail_off;
+	i = 0;
+
+	while (1) {
+		/* Copy as many pkts as fit into the tail block */
+		cnt = MIN((uint32_t)(num - i), NUM_PKTS - tail_off);
+		memcpy(&tail_blk->pkts[tail_off], &pkts[i],
+		       cnt * sizeof(odp_packet_t));
+		tail_off += cnt;
+		i += cnt;
+
+		if (i == num)
+			break;
+
+		/* Tail block is full, link in a new one */
+		new_tail_blk = queue_blk_alloc(pool, &new_tail_blk_idx);
+		if (!new_tail_blk)
+			break;
+
+		tail_blk->next_queue_blk_idx = new_tail_blk_idx;
+		desc->tail_blk_idx = new_tail_blk_idx;
+		tail_blk = new_tail_blk;
+		tail_off = 0;
 	}
 
-       /* If we reach here, the tai_blk was full, so we need to allocate a new
-	* one and link it in.
-	*/
-	new_tail_blk = queue_blk_alloc(pool, &new_tail_blk_idx);
-	if (!new_tail_blk)
+	/* Tail block was full and a new block could not be allocated */
+	if (i == 0)
 		return -1;
 
-	init_queue_blk(new_tail_blk);
-	new_tail_blk->pkts[0] = pkt;
-	tail_blk->next_queue_blk_idx = new_tail_blk_idx;
-	first_blk->tail_queue_blk_idx = new_tail_blk_idx;
-	return 0;
+	desc->tail_off = tail_off;
+	pool->total_pkt_appends += i;
+	return i;
 }
 
-int _odp_pkt_queue_remove(_odp_int_queue_pool_t queue_pool,
-			  _odp_int_pkt_queue_t pkt_queue, odp_packet_t *pkt)
+int _odp_pkt_queue_append(_odp_int_queue_pool_t queue_pool,
+			  _odp_int_pkt_queue_t pkt_queue, odp_packet_t pkt)
+{
+	int rc;
+
+	if (pkt == ODP_PACKET_INVALID)
+		return -3;
+
+	rc = _odp_pkt_queue_append_multi(queue_pool, pkt_queue, &pkt, 1);
+	if (rc < 0)
+		return rc;
+
+	return rc == 1 ? 0 : -1;
+}
+
+int _odp_pkt_queue_remove_multi(_odp_int_queue_pool_t queue_pool,
+				_odp_int_pkt_queue_t pkt_queue,
+				odp_packet_t pkts[], int max_num)
 {
 	queue_pool_t *pool;
-	queue_blk_t *first_blk, *second_blk;
-	uint32_t queue_num, first_blk_idx, next_blk_idx, idx;
+	queue_desc_t *desc;
+	queue_blk_t *head_blk;
+	uint32_t queue_num, head_blk_idx, next_blk_idx, head_off, end, cnt;
+	int i;
 
 	pool = (queue_pool_t *)(uintptr_t)queue_pool;
 	queue_num = (uint32_t)pkt_queue;
-	if ((queue_num == 0) || (pool->max_queue_num < queue_num))
+	if (!valid_queue_num(pool, queue_num)) {
+		pool->total_bad_removes++;
 		return -2;
+	}
 
-	first_blk_idx = pool->queue_num_tbl[queue_num - 1];
-	if (first_blk_idx == 0)
+	desc = queue_num_to_desc(pool, queue_num);
+	head_blk_idx = desc->head_blk_idx;
+	if (head_blk_idx == 0 || max_num <= 0)
 		return 0; /* pkt queue is empty. */
 
-	/* Now remove the first valid odp_packet_t handle value we find. */
-	first_blk = blk_idx_to_queue_blk(pool, first_blk_idx);
-	for (idx = 0; idx < NUM_PKTS; idx++) {
-		if (first_blk->pkts[idx] != ODP_PACKET_INVALID) {
-			*pkt = first_blk->pkts[idx];
-			first_blk->pkts[idx] = ODP_PACKET_INVALID;
-
-			/* Now see if there are any more pkts in this queue. */
-			if ((idx == 6) ||
-			    (first_blk->pkts[idx + 1] == ODP_PACKET_INVALID)) {
-				/* We have reached the end of this queue_blk.
-				 * Check to see if there is a following block
-				 * or not
-				 */
-				next_blk_idx = first_blk->next_queue_blk_idx;
-				if (next_blk_idx != 0) {
-					second_blk =
-						blk_idx_to_queue_blk
-						(pool,
-						 next_blk_idx);
-					second_blk->tail_queue_blk_idx =
-						first_blk->tail_queue_blk_idx;
-				}
-
-				pool->queue_num_tbl[queue_num - 1] =
-					next_blk_idx;
-				queue_blk_free(pool, first_blk, first_blk_idx);
-			}
-
-			pool->total_pkt_removes++;
-			return 1;
+	head_blk = blk_idx_to_queue_blk(pool, head_blk_idx);
+	head_off = desc->head_off;
+	i = 0;
+
+	while (1) {
+		/* Copy as many pkts as requested from the head block */
+		if (head_blk_idx == desc->tail_blk_idx)
+			end = desc->tail_off;
+		else
+			end = NUM_PKTS;
+
+		cnt = MIN((uint32_t)(max_num - i), end - head_off);
+		memcpy(&pkts[i], &head_blk->pkts[head_off],
+		       cnt * sizeof(odp_packet_t));
+		head_off += cnt;
+		i += cnt;
+
+		if (head_off < end)
+			break;
+
+		/* Head block is empty, free it */
+		next_blk_idx = head_blk->next_queue_blk_idx;
+		queue_blk_free(pool, head_blk, head_blk_idx);
+		head_off = 0;
+
+		if (head_blk_idx == desc->tail_blk_idx) {
+			/* pkt queue is now empty */
+			head_blk_idx = 0;
+			desc->tail_blk_idx = 0;
+			desc->tail_off = 0;
+			break;
 		}
+
+		head_blk_idx = next_blk_idx;
+		head_blk = blk_idx_to_queue_blk(pool, head_blk_idx);
+
+		if (i == max_num)
+			break;
 	}
 
-	/* It is an error to not find at least one pkt in the first_blk! */
-	pool->total_bad_removes++;
-	return -1;
+	desc->head_blk_idx = head_blk_idx;
+	desc->head_off = head_off;
+	pool->total_pkt_removes += i;
+	return i;
+}
+
+int _odp_pkt_queue_remove(_odp_int_queue_pool_t queue_pool,
+			  _odp_int_pkt_queue_t pkt_queue, odp_packet_t *pkt)
+{
+	return _odp_pkt_queue_remove_multi(queue_pool, pkt_queue, pkt, 1);
 }
 
 void _odp_pkt_queue_stats_print(_odp_int_queue_pool_t queue_pool)
@@ -402,21 +414,36 @@ void _odp_pkt_queue_stats_print(_odp_int_queue_pool_t queue_pool)
 	ODP_PRINT("  free_list size=%u min size=%u peak size=%u\n",
 		  pool->free_list_size, pool->min_free_list_size,
 		  pool->peak_free_list_size);
+	ODP_PRINT("  queue_blk chunks=%u max chunks=%u (%u blks per chunk)\n",
+		  pool->num_blk_chunks, pool->max_blk_chunks, BLKS_PER_CHUNK);
 }
 
 void _odp_queue_pool_destroy(_odp_int_queue_pool_t queue_pool)
 {
-	queue_region_desc_t *queue_region_desc;
 	queue_pool_t *pool;
-	uint32_t idx;
+	odp_packet_t pkts[NUM_PKTS];
+	uint32_t queue_num, idx, num_queue_chunks;
+	int num;
 
 	pool = (queue_pool_t *)(uintptr_t)queue_pool;
-	for (idx = 0; idx < 16; idx++) {
-		queue_region_desc = &pool->queue_region_descs[idx];
-		if (queue_region_desc->queue_blks)
-			free(queue_region_desc->queue_blks);
+
+	/* Free pkts that are still queued */
+	for (queue_num = 1; queue_num < pool->next_queue_num; queue_num++) {
+		while ((num = _odp_pkt_queue_remove_multi(queue_pool, queue_num,
+							  pkts,
+							  NUM_PKTS)) > 0)
+			odp_packet_free_multi(pkts, num);
 	}
 
-	free(pool->queue_num_tbl);
+	for (idx = 0; idx < pool->num_blk_chunks; idx++)
+		free(pool->blk_chunks[idx]);
+
+	num_queue_chunks = (pool->max_queue_num + QUEUES_PER_CHUNK - 1) /
+			   QUEUES_PER_CHUNK;
+	for (idx = 0; idx < num_queue_chunks; idx++)
+		free(pool->queue_chunks[idx]);
+
+	free(pool->blk_chunks);
+	free(pool->queue_chunks);
 	free(pool);
 }
@@ -12,6 +12,7 @@
 #include <odp/api/shared_memory.h>
 #include <odp/api/plat/strong_types.h>
 #include <odp_ishm_internal.h>
+#include <odp_shm_internal.h>
 #include <odp_init_internal.h>
 #include <odp_global_data.h>
 #include <string.h>
@@ -87,6 +88,11 @@ int odp_shm_free(odp_shm_t shm)
 	return _odp_ishm_free_by_index(from_handle(shm));
 }
 
+int _odp_shm_fd(odp_shm_t shm)
+{
+	return _odp_ishm_fd(from_handle(shm));
+}
+
 odp_shm_t odp_shm_lookup(const char *name)
 {
 	return to_handle(_odp_ishm_lookup_by_name(name));
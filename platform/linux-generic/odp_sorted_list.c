@@ -16,18 +16,36 @@
 #include <odp_debug_internal.h>
 #include <odp_sorted_list_internal.h>
 
-typedef struct sorted_list_item_s sorted_list_item_t;
+/* Each sorted list is a binary min heap of item indexes, ordered by sort_key
+ * and then by insertion sequence number, so that ties go to the oldest entry.
+ * Items are allocated from a pool wide item array, which grows by doubling
+ * and is never freed before the pool. A pool wide hash table of
+ * <list, user_data> pairs finds items for find and delete operations. When a
+ * list holds several entries with the same user_data, those operations pick
+ * the first one in sort order. Insert, delete and remove are O(log n), find
+ * is O(1). Indexes of destroyed lists are reused by later list creates. */
+
+#define ITEM_NULL        UINT32_MAX
+#define MIN_ITEMS        64
+#define MIN_HEAP_SIZE    8
 
-struct sorted_list_item_s {
-	sorted_list_item_t *next_item;
-	uint64_t            sort_key;
-	uint64_t            user_data;
-};
+typedef struct {
+	uint64_t sort_key;
+	uint64_t user_data;
+	uint64_t seq;        /* Insertion order within the list */
+	uint32_t list_idx;
+	uint32_t heap_pos;   /* Position in the list heap */
+	uint32_t next_item;  /* Next item in hash chain or free list */
+	uint32_t pad;
+} sorted_list_item_t;
 
 typedef struct {
-	sorted_list_item_t *first_item;
-	uint32_t            sorted_list_len;
-	uint32_t            pad;
+	uint32_t *heap;      /* Item indexes, heap[0] has the smallest key */
+	uint32_t  heap_size;
+	uint32_t  sorted_list_len;
+	uint64_t  next_seq;
+	uint32_t  next_free; /* Next destroyed list index */
+	uint32_t  pad;
 } sorted_list_desc_t;
 
 typedef struct {
@@ -40,9 +58,200 @@ typedef struct {
 	uint64_t             total_removes;
 	uint32_t             max_sorted_lists;
 	uint32_t             next_list_idx;
+	uint32_t             free_list_idx;
+	uint32_t             pad0;
 	sorted_list_descs_t *list_descs;
+
+	sorted_list_item_t  *items;
+	uint32_t             num_items;
+	uint32_t             free_item;
+	uint32_t            *hash_tbl;
+	uint32_t             hash_mask;
+	uint32_t             pad;
 } sorted_pool_t;
 
+static inline uint32_t item_hash(sorted_pool_t *pool, uint32_t list_idx,
+				 uint64_t user_data)
+{
+	uint64_t hash;
+
+	hash = (user_data ^ ((uint64_t)list_idx << 40)) *
+		UINT64_C(0x9E3779B97F4A7C15);
+	return (uint32_t)(hash >> 32) & pool->hash_mask;
+}
+
+static inline int item_less(sorted_list_item_t *item_a,
+			    sorted_list_item_t *item_b)
+{
+	if (item_a->sort_key != item_b->sort_key)
+		return item_a->sort_key < item_b->sort_key;
+
+	return item_a->seq < item_b->seq;
+}
+
+static void hash_insert(sorted_pool_t *pool, uint32_t item_idx)
+{
+	sorted_list_item_t *item = &pool->items[item_idx];
+	uint32_t hash;
+
+	hash = item_hash(pool, item->list_idx, item->user_data);
+	item->next_item = pool->hash_tbl[hash];
+	pool->hash_tbl[hash] = item_idx;
+}
+
+static void hash_remove(sorted_pool_t *pool, uint32_t item_idx)
+{
+	sorted_list_item_t *item = &pool->items[item_idx];
+	uint32_t *link;
+
+	link = &pool->hash_tbl[item_hash(pool, item->list_idx,
+					 item->user_data)];
+	while (*link != item_idx)
+		link = &pool->items[*link].next_item;
+
+	*link = item->next_item;
+}
+
+/* Find the first item of <list_idx, user_data> in sort order */
+static uint32_t hash_find(sorted_pool_t *pool, uint32_t list_idx,
+			  uint64_t user_data)
+{
+	sorted_list_item_t *item;
+	uint32_t item_idx, found = ITEM_NULL;
+
+	item_idx = pool->hash_tbl[item_hash(pool, list_idx, user_data)];
+	while (item_idx != ITEM_NULL) {
+		item = &pool->items[item_idx];
+		if (item->list_idx == list_idx &&
+		    item->user_data == user_data &&
+		    (found == ITEM_NULL ||
+		     item_less(item, &pool->items[found])))
+			found = item_idx;
+
+		item_idx = item->next_item;
+	}
+
+	return found;
+}
+
+/* Double the item array and the hash table. All items are in use when this
+ * is called. */
+static int items_grow(sorted_pool_t *pool)
+{
+	sorted_list_item_t *items;
+	uint32_t *hash_tbl;
+	uint32_t num_items, idx;
+
+	num_items = pool->num_items ? 2 * pool->num_items : MIN_ITEMS;
+	hash_tbl  = malloc(num_items * sizeof(uint32_t));
+	if (!hash_tbl)
+		return -1;
+
+	/* Pool is left untouched when either allocation fails */
+	items = realloc(pool->items, num_items * sizeof(sorted_list_item_t));
+	if (!items) {
+		free(hash_tbl);
+		return -1;
+	}
+
+	free(pool->hash_tbl);
+	pool->items     = items;
+	pool->hash_tbl  = hash_tbl;
+	pool->hash_mask = num_items - 1;
+	memset(hash_tbl, 0xFF, num_items * sizeof(uint32_t));
+
+	for (idx = 0; idx < pool->num_items; idx++)
+		hash_insert(pool, idx);
+
+	for (idx = pool->num_items; idx < num_items; idx++)
+		items[idx].next_item = idx + 1;
+
+	items[num_items - 1].next_item = pool->free_item;
+	pool->free_item = pool->num_items;
+	pool->num_items = num_items;
+	return 0;
+}
+
+static inline void heap_set(sorted_pool_t *pool, sorted_list_desc_t *list_desc,
+			    uint32_t pos, uint32_t item_idx)
+{
+	list_desc->heap[pos] = item_idx;
+	pool->items[item_idx].heap_pos = pos;
+}
+
+static void heap_sift_up(sorted_pool_t *pool, sorted_list_desc_t *list_desc,
+			 uint32_t pos)
+{
+	sorted_list_item_t *item;
+	uint32_t item_idx, parent;
+
+	item_idx = list_desc->heap[pos];
+	item     = &pool->items[item_idx];
+
+	while (pos > 0) {
+		parent = (pos - 1) / 2;
+		if (!item_less(item, &pool->items[list_desc->heap[parent]]))
+			break;
+
+		heap_set(pool, list_desc, pos, list_desc->heap[parent]);
+		pos = parent;
+	}
+
+	heap_set(pool, list_desc, pos, item_idx);
+}
+
+static void heap_sift_down(sorted_pool_t *pool, sorted_list_desc_t *list_desc,
+			   uint32_t pos)
+{
+	sorted_list_item_t *item;
+	uint32_t item_idx, child, len;
+
+	len      = list_desc->sorted_list_len;
+	item_idx = list_desc->heap[pos];
+	item     = &pool->items[item_idx];
+
+	while ((child = 2 * pos + 1) < len) {
+		if (child + 1 < len &&
+		    item_less(&pool->items[list_desc->heap[child + 1]],
+			      &pool->items[list_desc->heap[child]]))
+			child++;
+
+		if (!item_less(&pool->items[list_desc->heap[child]], item))
+			break;
+
+		heap_set(pool, list_desc, pos, list_desc->heap[child]);
+		pos = child;
+	}
+
+	heap_set(pool, list_desc, pos, item_idx);
+}
+
+/* Unlink the item at heap position pos from the heap and free it */
+static void heap_remove(sorted_pool_t *pool, sorted_list_desc_t *list_desc,
+			uint32_t pos)
+{
+	uint32_t item_idx, last_idx;
+
+	item_idx = list_desc->heap[pos];
+	hash_remove(pool, item_idx);
+
+	list_desc->sorted_list_len--;
+	if (pos != list_desc->sorted_list_len) {
+		last_idx = list_desc->heap[list_desc->sorted_list_len];
+		heap_set(pool, list_desc, pos, last_idx);
+
+		if (pos > 0 &&
+		    item_less(&pool->items[last_idx],
+			      &pool->items[list_desc->heap[(pos - 1) / 2]]))
+			heap_sift_up(pool, list_desc, pos);
+		else
+			heap_sift_down(pool, list_desc, pos);
+	}
+
+	pool->items[item_idx].next_item = pool->free_item;
+	pool->free_item = item_idx;
+}
+
 _odp_int_sorted_pool_t _odp_sorted_pool_create(uint32_t max_sorted_lists)
 {
 	sorted_list_descs_t *list_descs;
@@ -50,26 +259,63 @@ _odp_int_sorted_pool_t _odp_sorted_pool_create(uint32_t max_sorted_lists)
 	uint32_t             malloc_len;
 
 	pool = malloc(sizeof(sorted_pool_t));
+	if (!pool)
+		return _ODP_INT_SORTED_POOL_INVALID;
+
 	memset(pool, 0, sizeof(sorted_pool_t));
 	pool->max_sorted_lists = max_sorted_lists;
 	pool->next_list_idx    = 1;
+	pool->free_item        = ITEM_NULL;
 
 	malloc_len = max_sorted_lists * sizeof(sorted_list_desc_t);
 	list_descs = malloc(malloc_len);
+	if (!list_descs) {
+		free(pool);
+		return _ODP_INT_SORTED_POOL_INVALID;
+	}
+
 	memset(list_descs, 0, malloc_len);
 	pool->list_descs = list_descs;
+
+	if (items_grow(pool)) {
+		_odp_sorted_pool_destroy((_odp_int_sorted_pool_t)(uintptr_t)
+					 pool);
+		return _ODP_INT_SORTED_POOL_INVALID;
+	}
+
 	return (_odp_int_sorted_pool_t)(uintptr_t)pool;
 }
 
 _odp_int_sorted_list_t
 _odp_sorted_list_create(_odp_int_sorted_pool_t sorted_pool,
-			uint32_t max_entries ODP_UNUSED)
+			uint32_t max_entries)
 {
+	sorted_list_desc_t *list_desc;
 	sorted_pool_t *pool;
-	uint32_t       list_idx;
+	uint32_t       list_idx, heap_size;
+
+	pool = (sorted_pool_t *)(uintptr_t)sorted_pool;
+
+	/* Reuse the most recently destroyed list first */
+	if (pool->free_list_idx != _ODP_INT_SORTED_LIST_INVALID) {
+		list_idx  = pool->free_list_idx;
+		list_desc = &pool->list_descs->descs[list_idx];
+		pool->free_list_idx = list_desc->next_free;
+		memset(list_desc, 0, sizeof(sorted_list_desc_t));
+	} else {
+		list_idx = pool->next_list_idx++;
+		if (pool->max_sorted_lists <= list_idx)
+			return (_odp_int_sorted_list_t)list_idx;
+
+		list_desc = &pool->list_descs->descs[list_idx];
+	}
+
+	/* Heap grows later if max_entries is exceeded */
+	heap_size = max_entries > MIN_HEAP_SIZE ? max_entries : MIN_HEAP_SIZE;
+	list_desc->heap = malloc(heap_size * sizeof(uint32_t));
+	if (list_desc->heap)
+		list_desc->heap_size = heap_size;
 
-	pool     = (sorted_pool_t *)(uintptr_t)sorted_pool;
-	list_idx = pool->next_list_idx++;
 	return (_odp_int_sorted_list_t)list_idx;
 }
 
@@ -79,9 +325,10 @@ int _odp_sorted_list_insert(_odp_int_sorted_pool_t sorted_pool,
 			    uint64_t              user_data)
 {
 	sorted_list_desc_t *list_desc;
-	sorted_list_item_t *new_list_item, *list_item, *prev_list_item;
+	sorted_list_item_t *item;
 	sorted_pool_t      *pool;
-	uint32_t            list_idx;
+	uint32_t           *heap;
+	uint32_t            list_idx, item_idx, heap_size;
 
 	pool     = (sorted_pool_t *)(uintptr_t)sorted_pool;
 	list_idx = (uint32_t)sorted_list;
@@ -89,30 +336,37 @@ int _odp_sorted_list_insert(_odp_int_sorted_pool_t sorted_pool,
 	    (pool->max_sorted_lists <= list_idx))
 		return -1;
 
-	list_desc     = &pool->list_descs->descs[list_idx];
-	new_list_item = malloc(sizeof(sorted_list_item_t));
-	memset(new_list_item, 0, sizeof(sorted_list_item_t));
-	new_list_item->next_item = NULL;
-	new_list_item->sort_key  = sort_key;
-	new_list_item->user_data = user_data;
-
-       /* Now insert the new_list_item according to the sort_key (lowest
-	* value first).
-	*/
-	list_item      = list_desc->first_item;
-	prev_list_item = NULL;
-	while ((list_item) && (list_item->sort_key <= sort_key)) {
-		prev_list_item = list_item;
-		list_item      = list_item->next_item;
+	list_desc = &pool->list_descs->descs[list_idx];
+	if (odp_unlikely(list_desc->sorted_list_len == list_desc->heap_size)) {
+		heap_size = list_desc->heap_size ?
+			2 * list_desc->heap_size : MIN_HEAP_SIZE;
+		heap = realloc(list_desc->heap, heap_size * sizeof(uint32_t));
+		if (!heap)
+			return -1;
+
+		list_desc->heap      = heap;
+		list_desc->heap_size = heap_size;
 	}
 
-	new_list_item->next_item = list_item;
-	if (!prev_list_item)
-		list_desc->first_item = new_list_item;
-	else
-		prev_list_item->next_item = new_list_item;
+	if (odp_unlikely(pool->free_item == ITEM_NULL) && items_grow(pool))
+		return -1;
+
+	item_idx        = pool->free_item;
+	item            = &pool->items[item_idx];
+	pool->free_item = item->next_item;
+
+	item->sort_key  = sort_key;
+	item->user_data = user_data;
+	item->seq       = list_desc->next_seq++;
+	item->list_idx  = list_idx;
+	hash_insert(pool, item_idx);
 
+	/* Now insert the new item according to the sort_key (lowest value
+	 * first). */
+	list_desc->heap[list_desc->sorted_list_len] = item_idx;
 	list_desc->sorted_list_len++;
+	heap_sift_up(pool, list_desc, list_desc->sorted_list_len - 1);
+
 	pool->total_inserts++;
 	return 0;
 }
@@ -122,10 +376,8 @@ int _odp_sorted_list_find(_odp_int_sorted_pool_t sorted_pool,
 			  uint64_t              user_data,
 			  uint64_t             *sort_key_ptr)
 {
-	sorted_list_desc_t *list_desc;
-	sorted_list_item_t *list_item;
-	sorted_pool_t      *pool;
-	uint32_t            list_idx;
+	sorted_pool_t *pool;
+	uint32_t       list_idx, item_idx;
 
 	pool     = (sorted_pool_t *)(uintptr_t)sorted_pool;
 	list_idx = (uint32_t)sorted_list;
@@ -133,25 +385,14 @@ int _odp_sorted_list_find(_odp_int_sorted_pool_t sorted_pool,
 	    (pool->max_sorted_lists <= list_idx))
 		return -1;
 
-	list_desc = &pool->list_descs->descs[list_idx];
-
-       /* Now search the sorted linked list - as described by list_desc -
-	* until an entry is found whose user_data field matches the supplied
-	* user_data or the end of the list is reached.
-	*/
-	list_item = list_desc->first_item;
-	while (list_item) {
-		if (list_item->user_data == user_data) {
-			if (sort_key_ptr)
-				*sort_key_ptr = list_item->sort_key;
-
-			return 1;
-		}
+	item_idx = hash_find(pool, list_idx, user_data);
+	if (item_idx == ITEM_NULL)
+		return 0;
 
-		list_item = list_item->next_item;
-	}
+	if (sort_key_ptr)
+		*sort_key_ptr = pool->items[item_idx].sort_key;
 
-	return 0;
+	return 1;
 }
 
 int _odp_sorted_list_delete(_odp_int_sorted_pool_t sorted_pool,
@@ -159,9 +400,8 @@ int _odp_sorted_list_delete(_odp_int_sorted_pool_t sorted_pool,
 			    uint64_t              user_data)
 {
 	sorted_list_desc_t *list_desc;
-	sorted_list_item_t *next_list_item, *list_item, *prev_list_item;
 	sorted_pool_t      *pool;
-	uint32_t            list_idx;
+	uint32_t            list_idx, item_idx;
 
 	pool     = (sorted_pool_t *)(uintptr_t)sorted_pool;
 	list_idx = (uint32_t)sorted_list;
@@ -169,34 +409,14 @@ int _odp_sorted_list_delete(_odp_int_sorted_pool_t sorted_pool,
 	    (pool->max_sorted_lists <= list_idx))
 		return -1;
 
-	list_desc = &pool->list_descs->descs[list_idx];
-
-       /* Now search the sorted linked list - as described by list_desc -
-	* until an entry is found whose user_data field matches the supplied
-	* user_data or the end of the list is reached.
-	*/
-	list_item      = list_desc->first_item;
-	prev_list_item = NULL;
-	while (list_item) {
-		next_list_item = list_item->next_item;
-
-		if (list_item->user_data == user_data) {
-			if (!prev_list_item)
-				list_desc->first_item = next_list_item;
-			else
-				prev_list_item->next_item = next_list_item;
-
-			list_desc->sorted_list_len--;
-			free(list_item);
-			pool->total_deletes++;
-			return 0;
-		}
-
-		prev_list_item = list_item;
-		list_item      = next_list_item;
-	}
+	item_idx = hash_find(pool, list_idx, user_data);
+	if (item_idx == ITEM_NULL)
+		return -1;
 
-	return -1;
+	list_desc = &pool->list_descs->descs[list_idx];
+	heap_remove(pool, list_desc, pool->items[item_idx].heap_pos);
+	pool->total_deletes++;
+	return 0;
 }
 
 int _odp_sorted_list_remove(_odp_int_sorted_pool_t sorted_pool,
@@ -205,7 +425,7 @@ int _odp_sorted_list_remove(_odp_int_sorted_pool_t sorted_pool,
 			    uint64_t              *user_data_ptr)
 {
 	sorted_list_desc_t *list_desc;
-	sorted_list_item_t *list_item;
+	sorted_list_item_t *item;
 	sorted_pool_t      *pool;
 	uint32_t            list_idx;
 
@@ -216,21 +436,17 @@ int _odp_sorted_list_remove(_odp_int_sorted_pool_t sorted_pool,
 		return -1;
 
 	list_desc = &pool->list_descs->descs[list_idx];
-	if ((list_desc->sorted_list_len == 0) ||
-	    (!list_desc->first_item))
+	if (list_desc->sorted_list_len == 0)
 		return -1;
 
-	list_item             = list_desc->first_item;
-	list_desc->first_item = list_item->next_item;
-	list_desc->sorted_list_len--;
-
+	item = &pool->items[list_desc->heap[0]];
 	if (sort_key_ptr)
-		*sort_key_ptr = list_item->sort_key;
+		*sort_key_ptr = item->sort_key;
 
 	if (user_data_ptr)
-		*user_data_ptr = list_item->user_data;
+		*user_data_ptr = item->user_data;
 
-	free(list_item);
+	heap_remove(pool, list_desc, 0);
 	pool->total_removes++;
 	return 1;
 }
@@ -252,7 +468,11 @@ int _odp_sorted_list_destroy(_odp_int_sorted_pool_t sorted_pool,
 	if (list_desc->sorted_list_len != 0)
 		return -2;
 
-	/* TBD Mark the list as free. */
+	free(list_desc->heap);
+	list_desc->heap      = NULL;
+	list_desc->heap_size = 0;
+	list_desc->next_free = pool->free_list_idx;
+	pool->free_list_idx  = list_idx;
 	return 0;
 }
 
@@ -262,8 +482,9 @@ void _odp_sorted_list_stats_print(_odp_int_sorted_pool_t sorted_pool)
 
 	pool = (sorted_pool_t *)(uintptr_t)sorted_pool;
 	ODP_PRINT("sorted_pool=0x%" PRIX64 "\n", sorted_pool);
-	ODP_PRINT("  max_sorted_lists=%u next_list_idx=%u\n",
-		  pool->max_sorted_lists, pool->next_list_idx);
+	ODP_PRINT("  max_sorted_lists=%u next_list_idx=%u num_items=%u\n",
+		  pool->max_sorted_lists, pool->next_list_idx,
+		  pool->num_items);
 	ODP_PRINT("  total_inserts=%" PRIu64 " total_deletes=%" PRIu64
 		  " total_removes=%" PRIu64 "\n", pool->total_inserts,
 		  pool->total_deletes, pool->total_removes);
@@ -272,24 +493,19 @@ void _odp_sorted_list_stats_print(_odp_int_sorted_pool_t sorted_pool)
 void _odp_sorted_pool_destroy(_odp_int_sorted_pool_t sorted_pool)
 {
 	sorted_list_descs_t *list_descs;
-	sorted_list_desc_t  *list_desc;
-	sorted_list_item_t  *list_item, *next_list_item;
 	sorted_pool_t       *pool;
-	uint32_t             list_idx;
+	uint32_t             list_idx, max_idx;
 
 	pool       = (sorted_pool_t *)(uintptr_t)sorted_pool;
 	list_descs = pool->list_descs;
 
-	for (list_idx = 0; list_idx < pool->next_list_idx; list_idx++) {
-		list_desc = &list_descs->descs[list_idx];
-		list_item = list_desc->first_item;
-		while (list_item) {
-			next_list_item = list_item->next_item;
-			free(list_item);
-			list_item = next_list_item;
-		}
-	}
+	max_idx = pool->next_list_idx < pool->max_sorted_lists ?
+		pool->next_list_idx : pool->max_sorted_lists;
+	for (list_idx = 0; list_idx < max_idx; list_idx++)
+		free(list_descs->descs[list_idx].heap);
 
+	free(pool->hash_tbl);
+	free(pool->items);
 	free(list_descs);
 	free(pool);
 }
@@ -30,6 +30,8 @@
 #include <pthread.h>
 #include <unistd.h>
 #include <sys/syscall.h>
+#include <sys/timerfd.h>
+#include <sys/epoll.h>
 #include <inttypes.h>
 #include <string.h>
 
@@ -46,6 +48,7 @@
 #include <odp/api/event.h>
 #include <odp/api/hints.h>
 #include <odp_init_internal.h>
+#include <odp_libconfig_internal.h>
 #include <odp_errno_define.h>
 #include <odp/api/queue.h>
 #include <odp/api/shared_memory.h>
@@ -195,6 +198,8 @@ typedef struct timer_pool_s {
 	char name[ODP_TIMER_POOL_NAME_LEN];
 	odp_shm_t shm;
 	timer_t timerid;
+	int timerfd; /* timerfd of timerfd backend */
+	int epollfd; /* epoll instance waiting on timerfd */
 	int notify_overrun;
 	pthread_t timer_thread; /* pthread_t of timer thread */
 	pid_t timer_thread_id; /* gettid() for timer thread */
@@ -207,12 +212,34 @@ typedef struct timer_pool_s {
 #define INDEX_BITS 24
 #define TIMER_RES_TEST_LOOP_COUNT 10
 #define TIMER_RES_ROUNDUP_FACTOR 10
+/* timerfd reports the exact number of expirations, so it needs less margin
+ * over the calibrated resolution than POSIX timer overrun counts */
+#define TIMERFD_RES_ROUNDUP_FACTOR 2
+/* Minimum time to test each timerfd resolution candidate */
+#define TIMERFD_RES_TEST_TIME_NS ODP_TIME_MSEC_IN_NS
+#define BUSY_RES_TEST_ROUNDS 1000
+#define BUSY_RES_MIN_NS 100
+
+/* Timer pool thread backends (timer.backend config option) */
+#define TIMER_BACKEND_POSIX   0
+#define TIMER_BACKEND_TIMERFD 1
+#define TIMER_BACKEND_BUSY    2
 
 typedef struct timer_global_t {
 	odp_ticketlock_t lock;
 	int num_timer_pools;
 	uint8_t timer_pool_used[MAX_TIMER_POOLS];
 	timer_pool_t *timer_pool[MAX_TIMER_POOLS];
+	/* Thread id of the thread that processes a private timer pool inline,
+	 * or -1 for pools processed by all threads. Kept outside of timer
+	 * pools, so that other threads skip a private pool without touching
+	 * its cache lines. */
+	int timer_pool_owner[MAX_TIMER_POOLS];
+	/* Private timer pools are processed inline only by the creating
+	 * thread (timer.inline_owner config option) */
+	int inline_owner;
+	/* Backend of timer pool threads, when timers are not inline */
+	int backend;
 
 } timer_global_t;
 
@@ -323,6 +350,13 @@ static odp_timer_pool_t timer_pool_new(const char *name,
 	tp->tp_idx = tp_idx;
 	odp_spinlock_init(&tp->lock);
 	odp_ticketlock_lock(&timer_global.lock);
+	/* Optionally, a private timer pool is processed inline only by the
+	 * thread that created it */
+	if (inline_timers && timer_global.inline_owner && param->priv)
+		timer_global.timer_pool_owner[tp_idx] = odp_thread_id();
+	else
+		timer_global.timer_pool_owner[tp_idx] = -1;
+
 	timer_global.timer_pool[tp_idx] = tp;
 	odp_ticketlock_unlock(&timer_global.lock);
 	if (!inline_timers) {
@@ -346,7 +380,7 @@ static void stop_timer_thread(timer_pool_t *tp)
 	int ret;
 
 	ODP_DBG("stop\n");
-	tp->timer_thread_exit = 1;
+	__atomic_store_n(&tp->timer_thread_exit, 1, __ATOMIC_RELAXED);
 	ret = pthread_join(tp->timer_thread, NULL);
 	if (ret != 0)
 		ODP_ABORT("unable to join thread, err %d\n", ret);
@@ -795,14 +829,37 @@ static unsigned odp_timer_pool_expire(odp_timer_pool_t tpid, uint64_t tick)
  * Inline timer processing
  *****************************************************************************/
 
+static inline unsigned timer_pool_scan(timer_pool_t *tp, uint64_t nticks)
+{
+	uint64_t tp_tick = _odp_atomic_u64_fetch_add_mm(&tp->cur_tick, nticks,
+							_ODP_MEMMODEL_RLX);
+
+	if (tp->notify_overrun && nticks > 1) {
+		ODP_ERR("\n\t%d ticks overrun on timer pool "
+			"\"%s\", timer resolution too high\n",
+			nticks - 1, tp->name);
+		tp->notify_overrun = 0;
+	}
+
+	return odp_timer_pool_expire(tp, tp_tick + nticks);
+}
+
 static unsigned process_timer_pools(void)
 {
 	timer_pool_t *tp;
 	odp_time_t prev_scan, now;
 	uint64_t nticks;
 	unsigned nexp = 0;
+	int thr = odp_thread_id();
+	int owner;
 
 	for (size_t i = 0; i < MAX_TIMER_POOLS; i++) {
+		owner = timer_global.timer_pool_owner[i];
+
+		/* Private timer pool of another thread */
+		if (owner >= 0 && owner != thr)
+			continue;
+
 		tp = timer_global.timer_pool[i];
 
 		if (tp == NULL)
@@ -820,21 +877,19 @@ static unsigned process_timer_pools(void)
 		if (nticks < 1)
 			continue;
 
+		/* Only the owner scans a private timer pool */
+		if (owner >= 0) {
+			tp->prev_scan.u64 = prev_scan.u64 +
+				(tp->time_per_tick.u64 * nticks);
+			nexp += timer_pool_scan(tp, nticks);
+			continue;
+		}
+
 		if (__atomic_compare_exchange_n(
 			    &tp->prev_scan.u64, &prev_scan.u64,
 			    prev_scan.u64 + (tp->time_per_tick.u64 * nticks),
-			    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
-			uint64_t tp_tick = _odp_atomic_u64_fetch_add_mm(
-				&tp->cur_tick, nticks, _ODP_MEMMODEL_RLX);
-
-			if (tp->notify_overrun && nticks > 1) {
-				ODP_ERR("\n\t%d ticks overrun on timer pool "
-					"\"%s\", timer resolution too high\n",
-					nticks - 1, tp->name);
-				tp->notify_overrun = 0;
-			}
-			nexp += odp_timer_pool_expire(tp, tp_tick + nticks);
-		}
+			    false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+			nexp += timer_pool_scan(tp, nticks);
 	}
 	return nexp;
 }
@@ -923,7 +978,7 @@ static void *timer_thread(void *arg)
 
 	while (1) {
 		ret = sigtimedwait(&sigset, &si, &tmo);
-		if (tp->timer_thread_exit) {
+		if (__atomic_load_n(&tp->timer_thread_exit, __ATOMIC_RELAXED)) {
 			tp->timer_thread_id = 0;
 			return NULL;
 		}
@@ -940,7 +995,7 @@ static void *timer_thread(void *arg)
  * that the timer would not be overrun.
  * The candidate resolution value is from 1ms to 100us, 10us...1ns etc.
  */
-static int timer_res_init(void)
+static void posix_res_init(void)
 {
 	struct sigevent sigev;
 	timer_t timerid;
@@ -1009,10 +1064,9 @@ timer_res_init_done:
 			  strerror(errno));
 	sigemptyset(&sigset);
 	sigprocmask(SIG_BLOCK, &sigset, NULL);
-	return 0;
 }
 
-static void itimer_init(timer_pool_t *tp)
+static void posix_timer_init(timer_pool_t *tp)
 {
 	struct sigevent   sigev;
 	struct itimerspec ispec;
@@ -1057,13 +1111,253 @@ static void itimer_init(timer_pool_t *tp)
 			  strerror(errno));
 }
 
-static void itimer_fini(timer_pool_t *tp)
+static void posix_timer_fini(timer_pool_t *tp)
 {
 	if (timer_delete(tp->timerid) != 0)
 		ODP_ABORT("timer_delete() returned error %s\n",
 			  strerror(errno));
 }
 
+/******************************************************************************
+ * timerfd support
+ * Timer pool thread waits on a periodic timerfd with epoll. A timerfd read
+ * returns the number of expirations since the previous read, so ticks are
+ * not lost when the thread is late.
+ *****************************************************************************/
+
+static void *timerfd_thread(void *arg)
+{
+	timer_pool_t *tp = (timer_pool_t *)arg;
+	struct epoll_event event;
+	uint64_t nticks;
+	int ret;
+
+	while (!__atomic_load_n(&tp->timer_thread_exit, __ATOMIC_RELAXED)) {
+		/* Wake up at least every 100 ms to check for exit */
+		ret = epoll_wait(tp->epollfd, &event, 1, 100);
+		if (ret <= 0)
+			continue;
+
+		if (read(tp->timerfd, &nticks, sizeof(nticks)) !=
+		    sizeof(nticks))
+			continue;
+
+		(void)timer_pool_scan(tp, nticks);
+	}
+
+	close(tp->epollfd);
+	close(tp->timerfd);
+	return NULL;
+}
+
+static void timerfd_set(int fd, uint64_t res)
+{
+	struct itimerspec ispec;
+	uint64_t sec, nsec;
+
+	sec  = res / ODP_TIME_SEC_IN_NS;
+	nsec = res - sec * ODP_TIME_SEC_IN_NS;
+
+	memset(&ispec, 0, sizeof(ispec));
+	ispec.it_interval.tv_sec  = (time_t)sec;
+	ispec.it_interval.tv_nsec = (long)nsec;
+	ispec.it_value.tv_sec     = (time_t)sec;
+	ispec.it_value.tv_nsec    = (long)nsec;
+
+	if (timerfd_settime(fd, 0, &ispec, NULL))
+		ODP_ABORT("timerfd_settime() returned error %s\n",
+			  strerror(errno));
+}
+
+/* Find the highest timerfd resolution without missed expirations. Each
+ * candidate is tested for at least TIMERFD_RES_TEST_TIME_NS. */
+static void timerfd_res_init(void)
+{
+	static const uint64_t res_candidate[] = {1000000, 500000, 200000,
+						 100000, 50000, 20000, 10000,
+						 5000, 2000, 1000};
+	uint64_t res, nticks, loop_cnt;
+	size_t i;
+	int fd;
+
+	fd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (fd < 0)
+		ODP_ABORT("timerfd_create() returned error %s\n",
+			  strerror(errno));
+
+	highest_res_ns = res_candidate[0];
+
+	for (i = 0; i < sizeof(res_candidate) / sizeof(uint64_t); i++) {
+		res = res_candidate[i];
+		loop_cnt = TIMERFD_RES_TEST_TIME_NS / res;
+		if (loop_cnt < TIMER_RES_TEST_LOOP_COUNT)
+			loop_cnt = TIMER_RES_TEST_LOOP_COUNT;
+
+		timerfd_set(fd, res);
+
+		while (loop_cnt--) {
+			if (read(fd, &nticks, sizeof(nticks)) !=
+			    sizeof(nticks))
+				ODP_ABORT("timerfd read failed: %s\n",
+					  strerror(errno));
+
+			/* Missed expirations at this resolution */
+			if (nticks > 1)
+				goto timerfd_res_init_done;
+		}
+
+		highest_res_ns = res;
+	}
+
+timerfd_res_init_done:
+	highest_res_ns *= TIMERFD_RES_ROUNDUP_FACTOR;
+	close(fd);
+}
+
+static void timerfd_timer_init(timer_pool_t *tp)
+{
+	struct epoll_event event;
+	int ret;
+
+	ODP_DBG("Creating timerfd for timer pool %s, period %" PRIu64 " ns\n",
+		tp->name, tp->param.res_ns);
+
+	tp->timerfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+	if (tp->timerfd < 0)
+		ODP_ABORT("timerfd_create() returned error %s\n",
+			  strerror(errno));
+
+	tp->epollfd = epoll_create1(EPOLL_CLOEXEC);
+	if (tp->epollfd < 0)
+		ODP_ABORT("epoll_create1() returned error %s\n",
+			  strerror(errno));
+
+	memset(&event, 0, sizeof(event));
+	event.events = EPOLLIN;
+	event.data.ptr = tp;
+
+	if (epoll_ctl(tp->epollfd, EPOLL_CTL_ADD, tp->timerfd, &event))
+		ODP_ABORT("epoll_ctl() returned error %s\n",
+			  strerror(errno));
+
+	timerfd_set(tp->timerfd, tp->param.res_ns);
+
+	ret = pthread_create(&tp->timer_thread, NULL, timerfd_thread, tp);
+	if (ret)
+		ODP_ABORT("unable to create timer thread\n");
+}
+
+static void timerfd_timer_fini(timer_pool_t *tp)
+{
+	struct itimerspec ispec;
+
+	/* Disarm the timer. The thread closes file descriptors on exit. */
+	memset(&ispec, 0, sizeof(ispec));
+
+	if (timerfd_settime(tp->timerfd, 0, &ispec, NULL))
+		ODP_ABORT("timerfd_settime() returned error %s\n",
+			  strerror(errno));
+}
+
+/******************************************************************************
+ * Busy poll support
+ * Timer pool thread polls the time source without sleeping. This gives the
+ * highest resolution and lowest latency, but the thread consumes a full CPU
+ * and should run on an isolated core.
+ *****************************************************************************/
+
+static void *busy_thread(void *arg)
+{
+	timer_pool_t *tp = (timer_pool_t *)arg;
+	odp_time_t prev_scan, now;
+	uint64_t nticks;
+
+	prev_scan = odp_time_global();
+
+	while (!__atomic_load_n(&tp->timer_thread_exit, __ATOMIC_RELAXED)) {
+		now = odp_time_global();
+		nticks = (now.u64 - prev_scan.u64) / tp->time_per_tick.u64;
+
+		if (nticks < 1) {
+			odp_cpu_pause();
+			continue;
+		}
+
+		prev_scan.u64 += tp->time_per_tick.u64 * nticks;
+		(void)timer_pool_scan(tp, nticks);
+	}
+
+	return NULL;
+}
+
+/* Resolution is limited by the duration of a poll loop round */
+static void busy_res_init(void)
+{
+	odp_time_t t1, t2;
+	uint64_t round_ns;
+	int i;
+
+	t1 = odp_time_global();
+	t2 = t1;
+
+	for (i = 0; i < BUSY_RES_TEST_ROUNDS; i++) {
+		t2 = odp_time_global();
+		odp_cpu_pause();
+	}
+
+	round_ns = odp_time_diff_ns(t2, t1) / BUSY_RES_TEST_ROUNDS;
+	highest_res_ns = round_ns * TIMER_RES_ROUNDUP_FACTOR;
+
+	if (highest_res_ns < BUSY_RES_MIN_NS)
+		highest_res_ns = BUSY_RES_MIN_NS;
+}
+
+static void busy_timer_init(timer_pool_t *tp)
+{
+	int ret;
+
+	ODP_DBG("Creating busy poll thread for timer pool %s, period %" PRIu64
+		" ns\n", tp->name, tp->param.res_ns);
+
+	ret = pthread_create(&tp->timer_thread, NULL, busy_thread, tp);
+	if (ret)
+		ODP_ABORT("unable to create timer thread\n");
+}
+
+/******************************************************************************
+ * Timer pool thread backend selection
+ *****************************************************************************/
+
+static void timer_res_init(void)
+{
+	if (timer_global.backend == TIMER_BACKEND_TIMERFD)
+		timerfd_res_init();
+	else if (timer_global.backend == TIMER_BACKEND_BUSY)
+		busy_res_init();
+	else
+		posix_res_init();
+}
+
+static void itimer_init(timer_pool_t *tp)
+{
+	tp->timer_thread_exit = 0;
+
+	if (timer_global.backend == TIMER_BACKEND_TIMERFD)
+		timerfd_timer_init(tp);
+	else if (timer_global.backend == TIMER_BACKEND_BUSY)
+		busy_timer_init(tp);
+	else
+		posix_timer_init(tp);
+}
+
+static void itimer_fini(timer_pool_t *tp)
+{
+	if (timer_global.backend == TIMER_BACKEND_TIMERFD)
+		timerfd_timer_fini(tp);
+	else if (timer_global.backend == TIMER_BACKEND_POSIX)
+		posix_timer_fini(tp);
+}
+
 /******************************************************************************
  * Public API functions
  * Some parameter checks and error messages
@@ -1285,6 +1579,39 @@ void odp_timeout_free(odp_timeout_t tmo)
 	odp_buffer_free(odp_buffer_from_event(ev));
 }
 
+static int read_config_file(void)
+{
+	const char *str;
+	int val = 0;
+
+	ODP_PRINT("Timer config:\n");
+
+	str = "timer.backend";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < TIMER_BACKEND_POSIX || val > TIMER_BACKEND_BUSY) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	timer_global.backend = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "timer.inline_owner";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	timer_global.inline_owner = !!val;
+	ODP_PRINT("  %s: %i\n\n", str, val);
+
+	return 0;
+}
+
 int odp_timer_init_global(const odp_init_t *params)
 {
 	memset(&timer_global, 0, sizeof(timer_global_t));
@@ -1303,6 +1630,9 @@ int odp_timer_init_global(const odp_init_t *params)
 			!params->not_used.feat.schedule &&
 			!params->not_used.feat.timer;
 
+	if (read_config_file())
+		return -1;
+
 	time_per_ratelimit_period =
 		odp_time_global_from_ns(min_res_ns / 2);
 
@@ -149,7 +149,9 @@ typedef struct {
 	uint32_t ticks_shift;
 	uint32_t ticks_per_slot;   /* Must be a power of 2. */
 	uint64_t ticks_per_rev;    /* = num_slots * ticks_per_slot */
-	uint64_t max_ticks;        /* = current_ticks + ticks_per_rev */
+	uint32_t occupied;         /* Number of non-empty slots */
+	uint32_t peak_occupied;
+	uint64_t insert_cnt;       /* Inserts and promotes into this wheel */
 } wheel_desc_t;
 
 typedef struct {
@@ -165,6 +167,9 @@ typedef struct {
 	uint64_t          total_promote_cnt;
 	uint64_t          promote_fail_cnt;
 	uint64_t          current_ticks;
+	uint64_t          expired_slot_cnt;
+	uint64_t          total_late_ticks;
+	uint64_t          max_late_ticks;
 	wheel_desc_t      wheel_descs[4];
 	current_wheel_t  *current_wheel;
 	general_wheel_t  *general_wheels[3];
@@ -209,7 +214,6 @@ static current_wheel_t *current_wheel_alloc(timer_wheels_t *timer_wheels,
 	wheel_desc->slot_idx      = 0;
 	wheel_desc->ticks_per_rev = num_slots;
 	wheel_desc->ticks_shift   = 0;
-	wheel_desc->max_ticks     = 0;
 	wheel_desc->gear_mask     = (num_slots / wheel_desc->gear_ratio) - 1;
 	return current_wheel;
 }
@@ -224,8 +228,7 @@ static void current_wheel_start(timer_wheels_t *timer_wheels,
 	wheel_desc = &timer_wheels->wheel_descs[desc_idx];
 	wheel_idx  = current_ticks & (wheel_desc->num_slots - 1);
 
-	wheel_desc->slot_idx  = wheel_idx;
-	wheel_desc->max_ticks = wheel_idx + wheel_desc->ticks_per_rev;
+	wheel_desc->slot_idx = wheel_idx;
 }
 
 static general_wheel_t *general_wheel_alloc(timer_wheels_t *timer_wheels,
@@ -247,7 +250,6 @@ static general_wheel_t *general_wheel_alloc(timer_wheels_t *timer_wheels,
 	wheel_desc->slot_idx      = 0;
 	wheel_desc->ticks_per_rev = num_slots * ticks_per_slot;
 	wheel_desc->ticks_shift   = ticks_shift;
-	wheel_desc->max_ticks     = 0;
 	wheel_desc->gear_mask     = (num_slots / wheel_desc->gear_ratio) - 1;
 	return general_wheel;
 }
@@ -264,8 +266,7 @@ static void general_wheel_start(timer_wheels_t *timer_wheels,
 	ticks_shift = wheel_desc->ticks_shift;
 	wheel_idx   = (current_ticks >> ticks_shift) & (num_slots - 1);
 
-	wheel_desc->slot_idx  = wheel_idx;
-	wheel_desc->max_ticks = wheel_idx + wheel_desc->ticks_per_rev;
+	wheel_desc->slot_idx = wheel_idx;
 }
 
 static int expired_ring_create(timer_wheels_t *timer_wheels,
@@ -361,6 +362,13 @@ static void timer_blk_free(timer_wheels_t *timer_wheels,
 			timer_wheels->free_list_size;
 }
 
+static inline void wheel_slot_occupy(wheel_desc_t *wheel_desc)
+{
+	wheel_desc->occupied++;
+	if (wheel_desc->peak_occupied < wheel_desc->occupied)
+		wheel_desc->peak_occupied = wheel_desc->occupied;
+}
+
 static int current_wheel_insert(timer_wheels_t *timer_wheels,
 				uint64_t        rel_ticks,
 				uint64_t        user_data)
@@ -389,6 +397,7 @@ static int current_wheel_insert(timer_wheels_t *timer_wheels,
 	*/
 	if (timer_slot->user_data == 0) {                    /* case (a) */
 		timer_slot->user_data = user_data | 0x01;
+		wheel_slot_occupy(wheel_desc);
 	} else if ((timer_slot->user_data & 0x3) == 0x01)  { /* case (b) */
 	       /* Need to promote this pre-existing single user_data plus the
 		* new user_data into a timer_blk with two entries.
@@ -408,6 +417,7 @@ static int current_wheel_insert(timer_wheels_t *timer_wheels,
 			if (timer_blk->current_blk.user_data[idx] == 0) {
 				timer_blk->current_blk.user_data[idx] =
 					user_data;
+				wheel_desc->insert_cnt++;
 				return 0;
 			}
 		}
@@ -424,6 +434,7 @@ static int current_wheel_insert(timer_wheels_t *timer_wheels,
 		timer_slot->timer_blk_list              = new_timer_blk;
 	}
 
+	wheel_desc->insert_cnt++;
 	return 0;
 }
 
@@ -450,6 +461,16 @@ static int general_wheel_insert(timer_wheels_t *timer_wheels,
 	num_slots     = (uint64_t)wheel_desc->num_slots;
 	wakeup32      = (uint32_t)(wakeup_ticks & 0xFFFFFFFF);
 	rel_ticks     = rel_ticks >> wheel_desc->ticks_shift;
+
+	/* Slot slot_idx is cascaded at the next gear boundary of the lower
+	 * wheel, which may be up to one slot period away. Use the slot before
+	 * the wakeup slot, so that entries are cascaded before (and not up to
+	 * one slot period after) their wakeup time. Gear ratio leaves enough
+	 * room in the lower wheel for the extra slot period.
+	 */
+	if (rel_ticks != 0)
+		rel_ticks--;
+
 	wheel_idx     = (uint32_t)((slot_idx + rel_ticks) & (num_slots - 1));
 	timer_slot    = &general_wheel->slots[wheel_idx];
 	kind          = timer_slot->single_entry.kind;
@@ -463,6 +484,7 @@ static int general_wheel_insert(timer_wheels_t *timer_wheels,
 		timer_slot->single_entry.kind      = 1;
 		timer_slot->single_entry.wakeup32  = wakeup32;
 		timer_slot->single_entry.user_data = user_data;
+		wheel_slot_occupy(wheel_desc);
 	} else if (kind == 1) {          /* case (b) */
 	       /* Need to promote this single entry plus the new user_data
 		* into a timer_blk with two entries.
@@ -491,6 +513,7 @@ static int general_wheel_insert(timer_wheels_t *timer_wheels,
 					user_data;
 				timer_blk->general_blk.wakeup32[idx]  =
 					wakeup32;
+				wheel_desc->insert_cnt++;
 				return 0;
 			}
 		}
@@ -510,6 +533,7 @@ static int general_wheel_insert(timer_wheels_t *timer_wheels,
 		timer_slot->list_entry.timer_blk_list   = new_timer_blk;
 	}
 
+	wheel_desc->insert_cnt++;
 	return 0;
 }
 
@@ -539,69 +563,55 @@ static int expired_timers_append(timer_wheels_t       *timer_wheels,
 	return 0;
 }
 
-static int timer_blk_list_search(timer_wheels_t       *timer_wheels,
-				 current_timer_slot_t *head_entry,
-				 uint64_t             *user_data_ptr)
-{
-	timer_blk_t *timer_blk, *next_timer_blk;
-	uint64_t     user_data;
-	uint32_t     idx;
-
-	timer_blk = head_entry->timer_blk_list;
-	while (timer_blk) {
-		for (idx = 0; idx < 15; idx++) {
-			user_data = timer_blk->current_blk.user_data[idx];
-			if (user_data != 0) {
-				*user_data_ptr =
-					timer_blk->current_blk.user_data[idx];
-				timer_blk->current_blk.user_data[idx] = 0;
-				return 1;
-			}
-		}
-
-		next_timer_blk = timer_blk->next_timer_blk;
-		timer_blk_free(timer_wheels, timer_blk);
-		timer_blk = next_timer_blk;
-	}
-
-	return 0;
-}
-
-static int expired_timers_remove(timer_wheels_t *timer_wheels,
-				 uint64_t       *user_data_ptr)
+/* Move up to num expired timers from the expired ring into user_data[]. A
+ * partially consumed timer_blk_list stays at the head of the ring. */
+static uint32_t expired_timers_get(timer_wheels_t *timer_wheels,
+				   uint64_t        user_data[],
+				   uint32_t        num)
 {
 	current_timer_slot_t *head_entry;
 	expired_ring_t       *expired_ring;
-	uint32_t              count, head_idx;
-	int                   rc;
+	timer_blk_t          *timer_blk, *next_timer_blk;
+	uint32_t              head_idx, idx, cnt;
 
 	expired_ring = timer_wheels->expired_timers_ring;
-	for (count = 1; count <= 2; count++) {
-		if (expired_ring->count == 0)
-			return 0;
+	cnt          = 0;
 
+	while ((cnt < num) && (expired_ring->count != 0)) {
 		head_idx   = expired_ring->head_idx;
 		head_entry = &expired_ring->entries[head_idx];
 		if ((head_entry->user_data & 0x3) == 1) {
-			*user_data_ptr = head_entry->user_data;
-			expired_ring->entries[head_idx].user_data = 0;
-			head_idx++;
-			if (expired_ring->max_idx < head_idx)
-				head_idx = 0;
-
-			expired_ring->head_idx = head_idx;
-			expired_ring->count--;
-			return 1;
-		}
+			user_data[cnt++] = head_entry->user_data & ~0x3;
+		} else {
+			timer_blk = head_entry->timer_blk_list;
+			while (timer_blk) {
+				for (idx = 0; (idx < 15) && (cnt < num); idx++) {
+					if (timer_blk->current_blk.user_data[idx]
+					    == 0)
+						continue;
+
+					user_data[cnt++] =
+						timer_blk->current_blk.
+						user_data[idx] & ~0x3;
+					timer_blk->current_blk.user_data[idx] =
+						0;
+				}
+
+				if (idx < 15)
+					break;
+
+				next_timer_blk = timer_blk->next_timer_blk;
+				timer_blk_free(timer_wheels, timer_blk);
+				timer_blk = next_timer_blk;
+			}
 
-		/* Search timer_blk_list for non-empty user_data values. */
-		rc = timer_blk_list_search(timer_wheels, head_entry,
-					   user_data_ptr);
-		if (0 < rc)
-			return 1;
+			head_entry->timer_blk_list = timer_blk;
+			if (timer_blk)
+				break;
+		}
 
 		/* Advance to use the next ring entry. */
-		expired_ring->entries[head_idx].user_data = 0;
+		head_entry->user_data = 0;
 		head_idx++;
 		if (expired_ring->max_idx < head_idx)
 			head_idx = 0;
@@ -610,54 +620,13 @@ static int expired_timers_remove(timer_wheels_t *timer_wheels,
 		expired_ring->count--;
 	}
 
-	return 0;
-}
-
-static int timer_current_wheel_update(timer_wheels_t *timer_wheels,
-				      uint32_t        elapsed_ticks)
-{
-	current_timer_slot_t *timer_slot;
-	current_wheel_t      *current_wheel;
-	wheel_desc_t         *wheel_desc;
-	uint64_t              max_ticks;
-	uint32_t              num_slots, slot_idx, max_cnt, cnt;
-	int                   ret_code, rc;
-
-	/* Advance current wheel for each elapsed tick, up to a maximum. */
-	wheel_desc    = &timer_wheels->wheel_descs[0];
-	slot_idx      = wheel_desc->slot_idx;
-	num_slots     = wheel_desc->num_slots;
-	max_ticks     = wheel_desc->max_ticks;
-	max_cnt       = MIN(elapsed_ticks, UINT32_C(32));
-	current_wheel = timer_wheels->current_wheel;
-	ret_code      = 0;
-	rc            = -1;
-
-	for (cnt = 1; cnt <= max_cnt; cnt++) {
-		ret_code  |= (slot_idx & wheel_desc->gear_mask) == 0;
-		timer_slot = &current_wheel->slots[slot_idx];
-		if (timer_slot->user_data != 0) {
-			rc = expired_timers_append(timer_wheels, timer_slot);
-			if (rc < 0)
-				timer_wheels->
-					expired_timers_ring->
-					expired_ring_full_cnt++;
-
-			timer_slot->user_data = 0;
-		}
-
-		timer_wheels->current_ticks++;
-		slot_idx++;
-		max_ticks++;
-		if (num_slots <= slot_idx) {
-			slot_idx = 0;
-			max_ticks = wheel_desc->ticks_per_rev;
-		}
-	}
+	timer_wheels->total_timer_removes += cnt;
+	if (timer_wheels->current_cnt < cnt)
+		timer_wheels->current_cnt = 0;
+	else
+		timer_wheels->current_cnt -= cnt;
 
-	wheel_desc->slot_idx  = slot_idx;
-	wheel_desc->max_ticks = max_ticks;
-	return ret_code;
+	return cnt;
 }
 
 static int _odp_int_timer_wheel_promote(timer_wheels_t *timer_wheels,
@@ -748,14 +717,12 @@ static int timer_general_wheel_update(timer_wheels_t *timer_wheels,
 	general_timer_slot_t *timer_slot;
 	general_wheel_t      *general_wheel;
 	wheel_desc_t         *wheel_desc;
-	uint64_t              max_ticks;
 	uint32_t              num_slots, slot_idx;
 	int                   ret_code;
 
 	wheel_desc    = &timer_wheels->wheel_descs[desc_idx];
 	slot_idx      = wheel_desc->slot_idx;
 	num_slots     = wheel_desc->num_slots;
-	max_ticks     = wheel_desc->max_ticks;
 	general_wheel = timer_wheels->general_wheels[desc_idx - 1];
 	timer_slot    = &general_wheel->slots[slot_idx];
 	ret_code      = (slot_idx & wheel_desc->gear_mask) == 0;
@@ -764,20 +731,96 @@ static int timer_general_wheel_update(timer_wheels_t *timer_wheels,
 		timer_wheel_slot_promote(timer_wheels,
 					 desc_idx - 1, timer_slot);
 		timer_slot->single_entry.kind = 0;
+		wheel_desc->occupied--;
 	}
 
 	slot_idx++;
-	max_ticks++;
-	if (num_slots <= slot_idx) {
+	if (num_slots <= slot_idx)
 		slot_idx = 0;
-		max_ticks = wheel_desc->ticks_per_rev;
-	}
 
-	wheel_desc->slot_idx  = slot_idx;
-	wheel_desc->max_ticks = max_ticks;
+	wheel_desc->slot_idx = slot_idx;
 	return ret_code;
 }
 
+/* Advance all wheels up to new_current_ticks. Expired current wheel slots are
+ * appended to the expired ring and upper wheel slots are cascaded each time
+ * the current wheel crosses a gear boundary. Runs of empty current wheel
+ * slots between gear boundaries are skipped in one step. Advancing stops at
+ * the first slot that does not fit into the expired ring, so that no timers
+ * are lost, and continues from there on the next call.
+ */
+static void timer_wheels_advance(timer_wheels_t *timer_wheels,
+				 uint64_t        new_current_ticks)
+{
+	current_timer_slot_t *timer_slot;
+	current_wheel_t      *current_wheel;
+	wheel_desc_t         *wheel_desc;
+	uint64_t              elapsed_ticks, skip_ticks;
+	uint32_t              num_slots, slot_idx, gear_mask, desc_idx;
+	int                   rc;
+
+	wheel_desc    = &timer_wheels->wheel_descs[0];
+	current_wheel = timer_wheels->current_wheel;
+	num_slots     = wheel_desc->num_slots;
+	gear_mask     = wheel_desc->gear_mask;
+	slot_idx      = wheel_desc->slot_idx;
+
+	while (timer_wheels->current_ticks < new_current_ticks) {
+		elapsed_ticks = new_current_ticks - timer_wheels->current_ticks;
+
+		if ((wheel_desc->occupied == 0) &&
+		    ((slot_idx & gear_mask) != 0)) {
+			skip_ticks = (gear_mask + 1) - (slot_idx & gear_mask);
+			if (elapsed_ticks < skip_ticks)
+				skip_ticks = elapsed_ticks;
+
+			slot_idx = (slot_idx + skip_ticks) & (num_slots - 1);
+			timer_wheels->current_ticks += skip_ticks;
+			continue;
+		}
+
+		timer_slot = &current_wheel->slots[slot_idx];
+		if (timer_slot->user_data != 0) {
+			rc = expired_timers_append(timer_wheels, timer_slot);
+			if (rc < 0) {
+				timer_wheels->
+					expired_timers_ring->
+					expired_ring_full_cnt++;
+				break;
+			}
+
+			timer_slot->user_data = 0;
+			wheel_desc->occupied--;
+
+			/* Ticks between the slot time and now */
+			timer_wheels->expired_slot_cnt++;
+			timer_wheels->total_late_ticks += elapsed_ticks - 1;
+			if (timer_wheels->max_late_ticks < elapsed_ticks - 1)
+				timer_wheels->max_late_ticks =
+					elapsed_ticks - 1;
+		}
+
+		timer_wheels->current_ticks++;
+		if ((slot_idx & gear_mask) != 0) {
+			slot_idx = (slot_idx + 1) & (num_slots - 1);
+			continue;
+		}
+
+		/* Gear boundary passed. Wheel state must be up to date before
+		 * cascading, since promotes insert relative to it. */
+		slot_idx = (slot_idx + 1) & (num_slots - 1);
+		wheel_desc->slot_idx = slot_idx;
+
+		desc_idx = 1;
+		rc       = 1;
+		while ((0 < rc) && (desc_idx <= 3))
+			rc = timer_general_wheel_update(timer_wheels,
+							desc_idx++);
+	}
+
+	wheel_desc->slot_idx = slot_idx;
+}
+
 _odp_timer_wheel_t _odp_timer_wheel_create(uint32_t max_concurrent_timers,
 					   void    *tm_system)
 {
@@ -839,28 +882,36 @@ uint32_t _odp_timer_wheel_curr_time_update(_odp_timer_wheel_t timer_wheel,
 					   uint64_t           current_time)
 {
 	timer_wheels_t *timer_wheels;
-	uint64_t        new_current_ticks, elapsed_ticks;
-	uint32_t        desc_idx;
-	int             rc;
+
+	timer_wheels = (timer_wheels_t *)(uintptr_t)timer_wheel;
+	timer_wheels_advance(timer_wheels, current_time >> TIME_TO_TICKS_SHIFT);
+
+	return timer_wheels->expired_timers_ring->count;
+}
+
+uint32_t _odp_timer_wheel_expired_get(_odp_timer_wheel_t timer_wheel,
+				      uint64_t           current_time,
+				      uint64_t           user_context[],
+				      uint32_t           num)
+{
+	timer_wheels_t *timer_wheels;
+	uint64_t        new_current_ticks;
+	uint32_t        cnt;
 
 	timer_wheels      = (timer_wheels_t *)(uintptr_t)timer_wheel;
 	new_current_ticks = current_time >> TIME_TO_TICKS_SHIFT;
-	elapsed_ticks     = new_current_ticks - timer_wheels->current_ticks;
-	if (elapsed_ticks == 0)
-		return 0;
 
-       /* Advance current wheel for each elapsed tick, up to a maximum. This
-	* function returns a value > 0, then the next level's timer wheel
-	* needs to be updated.
-	*/
-	rc = timer_current_wheel_update(timer_wheels, (uint32_t)elapsed_ticks);
+	timer_wheels_advance(timer_wheels, new_current_ticks);
+	cnt = expired_timers_get(timer_wheels, user_context, num);
 
-	/* See if we need to do any higher wheel advancing or processing.*/
-	desc_idx = 1;
-	while ((0 < rc) && (desc_idx <= 3))
-		rc = timer_general_wheel_update(timer_wheels, desc_idx++);
+	/* Expired ring was full. Continue advancing now that it has room. */
+	if ((cnt < num) && (timer_wheels->current_ticks < new_current_ticks)) {
+		timer_wheels_advance(timer_wheels, new_current_ticks);
+		cnt += expired_timers_get(timer_wheels, &user_context[cnt],
+					  num - cnt);
+	}
 
-	return timer_wheels->expired_timers_ring->count;
+	return cnt;
 }
 
 int _odp_timer_wheel_insert(_odp_timer_wheel_t timer_wheel,
@@ -882,16 +933,16 @@ int _odp_timer_wheel_insert(_odp_timer_wheel_t timer_wheel,
 		return -6;
 
 	rel_ticks = wakeup_ticks - timer_wheels->current_ticks;
-	if (rel_ticks < timer_wheels->wheel_descs[0].max_ticks)
+	if (rel_ticks < timer_wheels->wheel_descs[0].ticks_per_rev)
 		rc = current_wheel_insert(timer_wheels, rel_ticks,
 					  user_context);
-	else if (rel_ticks < timer_wheels->wheel_descs[1].max_ticks)
+	else if (rel_ticks < timer_wheels->wheel_descs[1].ticks_per_rev)
 		rc = general_wheel_insert(timer_wheels, 1, wakeup_ticks,
 					  rel_ticks, user_context);
-	else if (rel_ticks < timer_wheels->wheel_descs[2].max_ticks)
+	else if (rel_ticks < timer_wheels->wheel_descs[2].ticks_per_rev)
 		rc = general_wheel_insert(timer_wheels, 2, wakeup_ticks,
 					  rel_ticks, user_context);
-	else if (rel_ticks < timer_wheels->wheel_descs[3].max_ticks)
+	else if (rel_ticks < timer_wheels->wheel_descs[3].ticks_per_rev)
 		rc = general_wheel_insert(timer_wheels, 3, wakeup_ticks,
 					  rel_ticks, user_context);
 	else
@@ -911,18 +962,12 @@ uint64_t _odp_timer_wheel_next_expired(_odp_timer_wheel_t timer_wheel)
 {
 	timer_wheels_t *timer_wheels;
 	uint64_t        user_data;
-	int             rc;
 
 	/* Remove the head of the timer wheel. */
 	timer_wheels = (timer_wheels_t *)(uintptr_t)timer_wheel;
-	rc = expired_timers_remove(timer_wheels, &user_data);
-	if (rc <= 0)
+	if (expired_timers_get(timer_wheels, &user_data, 1) == 0)
 		return 0;
 
-	user_data &= ~0x3;
-	timer_wheels->total_timer_removes++;
-	if (timer_wheels->current_cnt != 0)
-		timer_wheels->current_cnt--;
 	return user_data;
 }
 
@@ -942,6 +987,9 @@ static void _odp_int_timer_wheel_desc_print(wheel_desc_t *wheel_desc,
 		  " ticks_per_rev=%" PRIu64 "\n",
 		  wheel_idx, wheel_desc->num_slots, wheel_desc->ticks_shift,
 		  wheel_desc->ticks_per_slot, wheel_desc->ticks_per_rev);
+	ODP_PRINT("    occupied_slots=%u peak_occupied_slots=%u"
+		  " inserts=%" PRIu64 "\n", wheel_desc->occupied,
+		  wheel_desc->peak_occupied, wheel_desc->insert_cnt);
 }
 
 void _odp_timer_wheel_stats_print(_odp_timer_wheel_t timer_wheel)
@@ -977,6 +1025,13 @@ void _odp_timer_wheel_stats_print(_odp_timer_wheel_t timer_wheel)
 		  expired_ring->max_idx + 1, expired_ring->count,
 		  expired_ring->peak_count,
 		  expired_ring->expired_ring_full_cnt);
+	ODP_PRINT("  expired_slots=%" PRIu64 " avg_latency=%" PRIu64
+		  " ns max_latency=%" PRIu64 " ns\n",
+		  timer_wheels->expired_slot_cnt,
+		  timer_wheels->expired_slot_cnt ?
+		  (timer_wheels->total_late_ticks << TIME_TO_TICKS_SHIFT) /
+		  timer_wheels->expired_slot_cnt : 0,
+		  timer_wheels->max_late_ticks << TIME_TO_TICKS_SHIFT);
 }
 
 void _odp_timer_wheel_destroy(_odp_timer_wheel_t timer_wheel)
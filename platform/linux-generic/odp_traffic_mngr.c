@@ -29,8 +29,11 @@
 #include <odp/api/time.h>
 #include <odp/api/plat/time_inlines.h>
 #include <odp_macros_internal.h>
+#include <odp_align_internal.h>
 #include <odp_init_internal.h>
 #include <odp_errno_define.h>
+#include <odp_libconfig_internal.h>
+#include <odp_packet_io_internal.h>
 
 /* Local vars */
 static const
@@ -96,6 +99,16 @@ static odp_barrier_t tm_first_enq;
 static int g_main_thread_cpu = -1;
 static int g_tm_cpu_num;
 
+/* Input work items processed and packets sent per TM thread loop iteration */
+static uint32_t tm_burst_size = 1;
+
+/* Number of partitions (TM threads) per TM system */
+static uint32_t tm_num_threads = 1;
+
+/* Shaper time slot length in nsec. When non-zero, shaper token buckets are
+ * refilled once per time slot and delayed pkts wake up on slot boundaries. */
+static uint64_t tm_shaper_slot_ns;
+
 /* Forward function declarations. */
 static void tm_queue_cnts_decrement(tm_system_t *tm_system,
 				    tm_wred_node_t *tm_wred_node,
@@ -281,10 +294,15 @@ static input_work_queue_t *input_work_queue_create(void)
 {
 	input_work_queue_t *input_work_queue;
 
+	ODP_STATIC_ASSERT(CHECK_IS_POWER2(INPUT_WORK_RING_SIZE),
+			  "INPUT_WORK_RING_SIZE must be a power of two");
+
 	input_work_queue = malloc(sizeof(input_work_queue_t));
 	memset(input_work_queue, 0, sizeof(input_work_queue_t));
-	odp_atomic_init_u64(&input_work_queue->queue_cnt, 0);
-	odp_ticketlock_init(&input_work_queue->lock);
+	odp_atomic_init_u32(&input_work_queue->w_head, 0);
+	odp_atomic_init_u32(&input_work_queue->w_tail, 0);
+	odp_atomic_init_u32(&input_work_queue->r_tail, 0);
+	odp_atomic_init_u64(&input_work_queue->enqueue_fail_cnt, 0);
 	return input_work_queue;
 }
 
@@ -294,66 +312,93 @@ static void input_work_queue_destroy(input_work_queue_t *input_work_queue)
 	* freeing it.  Of course, elsewhere it is essential to have first
 	* stopped new tm_enq() (et al) calls from succeeding.
 	*/
-	odp_ticketlock_lock(&input_work_queue->lock);
 	free(input_work_queue);
 }
 
-static int input_work_queue_append(tm_system_t *tm_system,
-				   input_work_item_t *work_item)
+static inline uint32_t input_work_queue_cnt(input_work_queue_t *input_work_queue)
+{
+	return odp_atomic_load_u32(&input_work_queue->w_tail) -
+		odp_atomic_load_u32(&input_work_queue->r_tail);
+}
+
+/* Append up to num work items. Returns the number of items appended, or -1
+ * when the ring is full. */
+static int input_work_queue_append_multi(tm_system_t *tm_system,
+					 const input_work_item_t work_items[],
+					 uint32_t num)
 {
 	input_work_queue_t *input_work_queue;
-	input_work_item_t *entry_ptr;
-	uint32_t queue_cnt, tail_idx;
+	uint32_t old_head, new_head, r_tail, num_free, i;
+	const uint32_t mask = INPUT_WORK_RING_SIZE - 1;
 
 	input_work_queue = tm_system->input_work_queue;
-	queue_cnt = odp_atomic_load_u64(&input_work_queue->queue_cnt);
-	if (INPUT_WORK_RING_SIZE <= queue_cnt) {
-		input_work_queue->enqueue_fail_cnt++;
-		return -1;
-	}
 
-	odp_ticketlock_lock(&input_work_queue->lock);
-	tail_idx = input_work_queue->tail_idx;
-	entry_ptr = &input_work_queue->work_ring[tail_idx];
+	/* Load acquire of r_tail ensures that the TM thread has read the
+	 * items of the slots it has freed. When CAS succeeds, this thread
+	 * owns the slots between old and new w_head. */
+	old_head = odp_atomic_load_u32(&input_work_queue->w_head);
 
-	*entry_ptr = *work_item;
-	tail_idx++;
-	if (INPUT_WORK_RING_SIZE <= tail_idx)
-		tail_idx = 0;
+	do {
+		r_tail   = odp_atomic_load_acq_u32(&input_work_queue->r_tail);
+		num_free = INPUT_WORK_RING_SIZE - (old_head - r_tail);
 
-	input_work_queue->total_enqueues++;
-	input_work_queue->tail_idx = tail_idx;
-	odp_ticketlock_unlock(&input_work_queue->lock);
-	odp_atomic_inc_u64(&input_work_queue->queue_cnt);
-	if (input_work_queue->peak_cnt <= queue_cnt)
-		input_work_queue->peak_cnt = queue_cnt + 1;
-	return 0;
+		if (num_free == 0) {
+			odp_atomic_inc_u64(&input_work_queue->enqueue_fail_cnt);
+			return -1;
+		}
+
+		if (num > num_free)
+			num = num_free;
+
+		new_head = old_head + num;
+
+	} while (odp_unlikely(!odp_atomic_cas_u32(&input_work_queue->w_head,
+						  &old_head, new_head)));
+
+	for (i = 0; i < num; i++)
+		input_work_queue->work_ring[(old_head + i) & mask] =
+			work_items[i];
+
+	/* Wait until producers that reserved earlier slots have released
+	 * them. Items become visible to the TM thread in ring order. */
+	while (odp_unlikely(odp_atomic_load_acq_u32(&input_work_queue->w_tail)
+			    != old_head))
+		odp_cpu_pause();
+
+	odp_atomic_store_rel_u32(&input_work_queue->w_tail, new_head);
+	return num;
 }
 
-static int input_work_queue_remove(input_work_queue_t *input_work_queue,
-				   input_work_item_t *work_item)
+/* Remove up to num work items. Called only by the TM thread. Returns the
+ * number of items removed. */
+static uint32_t input_work_queue_remove_multi(input_work_queue_t *input_work_queue,
+					      input_work_item_t work_items[],
+					      uint32_t num)
 {
-	input_work_item_t *entry_ptr;
-	uint32_t queue_cnt, head_idx;
+	uint32_t head, w_tail, queue_cnt, i;
+	const uint32_t mask = INPUT_WORK_RING_SIZE - 1;
+
+	head      = odp_atomic_load_u32(&input_work_queue->r_tail);
+	w_tail    = odp_atomic_load_acq_u32(&input_work_queue->w_tail);
+	queue_cnt = w_tail - head;
 
-	queue_cnt = odp_atomic_load_u64(&input_work_queue->queue_cnt);
 	if (queue_cnt == 0)
-		return -1;
+		return 0;
 
-	odp_ticketlock_lock(&input_work_queue->lock);
-	head_idx = input_work_queue->head_idx;
-	entry_ptr = &input_work_queue->work_ring[head_idx];
+	if (input_work_queue->peak_cnt < queue_cnt)
+		input_work_queue->peak_cnt = queue_cnt;
 
-	*work_item = *entry_ptr;
-	head_idx++;
-	if (INPUT_WORK_RING_SIZE <= head_idx)
-		head_idx = 0;
+	if (num > queue_cnt)
+		num = queue_cnt;
 
-	input_work_queue->total_dequeues++;
-	input_work_queue->head_idx = head_idx;
-	odp_ticketlock_unlock(&input_work_queue->lock);
-	odp_atomic_dec_u64(&input_work_queue->queue_cnt);
-	return 0;
+	for (i = 0; i < num; i++)
+		work_items[i] = input_work_queue->work_ring[(head + i) & mask];
+
+	input_work_queue->total_dequeues += num;
+
+	/* Release the slots to producers */
+	odp_atomic_store_rel_u32(&input_work_queue->r_tail, head + num);
+	return num;
 }
 
 static tm_system_t *tm_system_alloc(void)
@@ -565,7 +610,7 @@ static void tm_shaper_obj_init(tm_system_t *tm_system,
 			       tm_shaper_obj_t *shaper_obj)
 {
 	shaper_obj->shaper_params = shaper_params;
-	shaper_obj->last_update_time = tm_system->current_time;
+	shaper_obj->last_update_time = tm_system->shaper_time;
 	shaper_obj->callback_time = 0;
 	shaper_obj->commit_cnt = shaper_params->max_commit;
 	shaper_obj->peak_cnt = shaper_params->max_peak;
@@ -672,6 +717,17 @@ static void tm_wred_config_set(tm_wred_node_t *wred_node,
 	wred_node->wred_params[color] = wred_params;
 }
 
+static void tm_time_update(tm_system_t *tm_system, uint64_t current_ns)
+{
+	tm_system->current_time = current_ns;
+
+	if (tm_shaper_slot_ns)
+		tm_system->shaper_time = current_ns -
+					 current_ns % tm_shaper_slot_ns;
+	else
+		tm_system->shaper_time = current_ns;
+}
+
 static void update_shaper_elapsed_time(tm_system_t        *tm_system,
 				       tm_shaper_params_t *shaper_params,
 				       tm_shaper_obj_t    *shaper_obj)
@@ -682,22 +738,29 @@ static void update_shaper_elapsed_time(tm_system_t        *tm_system,
 	if (shaper_params->enabled == 0) {
 		shaper_obj->commit_cnt       = shaper_params->max_commit;
 		shaper_obj->peak_cnt         = shaper_params->max_peak;
-		shaper_obj->last_update_time = tm_system->current_time;
+		shaper_obj->last_update_time = tm_system->shaper_time;
 		return;
 	}
 
        /* If the time_delta is "too small" then we just exit without making
 	* any changes.  Too small is defined such that
 	* time_delta/ODP_TIME_SEC_IN_NS * MAX(commit_rate, peak_rate) is less
-	* than a byte.
+	* than a byte.  With time slotted shaping, time_delta is zero for all
+	* but the first update within a slot.
 	*/
-	time_delta = tm_system->current_time - shaper_obj->last_update_time;
+	time_delta = tm_system->shaper_time - shaper_obj->last_update_time;
 	if (time_delta < (uint64_t)shaper_params->min_time_delta)
 		return;
 
 	commit = shaper_obj->commit_cnt;
 	max_commit = shaper_params->max_commit;
 
+	/* Buckets must hold at least one slot worth of tokens, otherwise
+	 * slotted refill would lose tokens when the burst size is small */
+	if (tm_shaper_slot_ns)
+		max_commit = MAX(max_commit, (int64_t)(tm_shaper_slot_ns *
+					     shaper_params->commit_rate));
+
        /* If the time_delta is "too large" then we need to prevent overflow
 	* of the multiplications of time_delta and either commit_rate or
 	* peak_rate.
@@ -712,6 +775,11 @@ static void update_shaper_elapsed_time(tm_system_t        *tm_system,
 	if (shaper_params->peak_rate != 0) {
 		peak = shaper_obj->peak_cnt;
 		max_peak = shaper_params->max_peak;
+		if (tm_shaper_slot_ns)
+			max_peak = MAX(max_peak,
+				       (int64_t)(tm_shaper_slot_ns *
+						 shaper_params->peak_rate));
+
 		if (shaper_params->max_peak_time_delta <= time_delta)
 			peak_inc = max_peak;
 		else
@@ -720,7 +788,7 @@ static void update_shaper_elapsed_time(tm_system_t        *tm_system,
 		shaper_obj->peak_cnt = (int64_t)MIN(max_peak, peak + peak_inc);
 	}
 
-	shaper_obj->last_update_time = tm_system->current_time;
+	shaper_obj->last_update_time = tm_system->shaper_time;
 }
 
 static uint64_t time_till_not_red(tm_shaper_params_t *shaper_params,
@@ -845,6 +913,15 @@ static odp_bool_t delay_pkt(tm_system_t *tm_system,
 	delay_time  = time_till_not_red(shaper_obj->shaper_params, shaper_obj);
 	wakeup_time = tm_system->current_time + delay_time;
 
+	/* Token counters are up to date at the start of the current slot.
+	 * Wake up at the slot boundary where the pkt turns non-red, so that
+	 * the refill of that slot can release a burst of pkts. */
+	if (tm_shaper_slot_ns) {
+		wakeup_time = tm_system->shaper_time + delay_time +
+			      tm_shaper_slot_ns - 1;
+		wakeup_time -= wakeup_time % tm_shaper_slot_ns;
+	}
+
 	tm_queue_obj = get_tm_queue_obj(tm_system, pkt_desc);
 	if (!tm_queue_obj)
 		return false;
@@ -860,6 +937,7 @@ static odp_bool_t delay_pkt(tm_system_t *tm_system,
 		return false;
 	}
 
+	tm_system->shaper_delay_cnt++;
 	tm_queue_obj->delayed_cnt++;
 	tm_queue_obj->timer_seq++;
 	tm_queue_obj->timer_reason = UNDELAY_PKT;
@@ -1639,7 +1717,9 @@ static odp_bool_t tm_consume_sent_pkt(tm_system_t *tm_system,
 	tm_queue_cnts_decrement(tm_system, tm_queue_obj->tm_wred_node,
 				tm_queue_obj->priority, pkt_len);
 
-	/* Get the next pkt in the tm_queue, if there is one. */
+	/* Get the next pkt in the tm_queue, if there is one. A tm_queue has
+	 * only one pkt in the scheduler at a time, so pkts are removed one by
+	 * one. */
 	_odp_int_pkt_queue = tm_queue_obj->_odp_int_pkt_queue;
 	rc = _odp_pkt_queue_remove(tm_system->_odp_int_queue_pool,
 				   _odp_int_pkt_queue, &pkt);
@@ -1835,11 +1915,11 @@ static uint32_t tm_queue_cnts_increment(tm_system_t *tm_system,
 		tm_wred_node = tm_wred_node->next_tm_wred_node;
 	}
 
-	queue_cnts = &tm_system->total_info.queue_cnts;
+	queue_cnts = &tm_system->parent->total_info.queue_cnts;
 	odp_atomic_inc_u64(&queue_cnts->pkt_cnt);
 	odp_atomic_add_u64(&queue_cnts->byte_cnt, frame_len);
 
-	queue_cnts = &tm_system->priority_info[priority].queue_cnts;
+	queue_cnts = &tm_system->parent->priority_info[priority].queue_cnts;
 	odp_atomic_inc_u64(&queue_cnts->pkt_cnt);
 	odp_atomic_add_u64(&queue_cnts->byte_cnt, frame_len);
 
@@ -1872,48 +1952,76 @@ static void tm_queue_cnts_decrement(tm_system_t *tm_system,
 		tm_wred_node = tm_wred_node->next_tm_wred_node;
 	}
 
-	queue_cnts = &tm_system->total_info.queue_cnts;
+	queue_cnts = &tm_system->parent->total_info.queue_cnts;
 	odp_atomic_dec_u64(&queue_cnts->pkt_cnt);
 	odp_atomic_sub_u64(&queue_cnts->byte_cnt, frame_len);
 
-	queue_cnts = &tm_system->priority_info[priority].queue_cnts;
+	queue_cnts = &tm_system->parent->priority_info[priority].queue_cnts;
 	odp_atomic_dec_u64(&queue_cnts->pkt_cnt);
 	odp_atomic_sub_u64(&queue_cnts->byte_cnt, frame_len);
 }
 
-static int tm_enqueue(tm_system_t *tm_system,
-		      tm_queue_obj_t *tm_queue_obj,
-		      odp_packet_t pkt)
+static inline void tm_group_first_enq(tm_system_group_t *tm_group)
+{
+	uint32_t first_enq = 0;
+
+	/* The TM thread waits for the first enqueue. Only one producer may
+	 * pass the barrier with it. */
+	if (odp_likely(odp_atomic_load_u32(&tm_group->first_enq)))
+		return;
+
+	if (odp_atomic_cas_u32(&tm_group->first_enq, &first_enq, 1))
+		odp_barrier_wait(&tm_group->tm_group_barrier);
+}
+
+/* Enqueue up to num packets to a tm_queue. Stops at the first packet that is
+ * dropped by WRED. Returns the number of packets enqueued, or -1 if the first
+ * packet was not enqueued. Packet depth of the tm_queue after the last
+ * enqueue is written to pkt_depth. */
+static int tm_enqueue_multi(tm_system_t *tm_system,
+			    tm_queue_obj_t *tm_queue_obj,
+			    const odp_packet_t pkt[], int num,
+			    uint32_t *pkt_depth)
 {
 	tm_system_group_t *tm_group;
-	input_work_item_t work_item;
+	input_work_item_t work_item[TM_MAX_BURST];
 	odp_packet_color_t pkt_color;
 	tm_wred_node_t *initial_tm_wred_node;
 	odp_bool_t drop_eligible, drop;
-	uint32_t frame_len, pkt_depth;
-	int rc;
+	uint32_t frame_len;
+	int i, rc;
 
+	/* Packets are processed by the TM thread of the queue's partition */
+	tm_system = tm_system->partition[tm_queue_obj->partition];
 	tm_group = GET_TM_GROUP(tm_system->odp_tm_group);
-	if (tm_group->first_enq == 0) {
-		odp_barrier_wait(&tm_group->tm_group_barrier);
-		tm_group->first_enq = 1;
-	}
+	tm_group_first_enq(tm_group);
 
-	pkt_color = odp_packet_color(pkt);
-	drop_eligible = odp_packet_drop_eligible(pkt);
+	if (num > TM_MAX_BURST)
+		num = TM_MAX_BURST;
 
 	initial_tm_wred_node = tm_queue_obj->tm_wred_node;
-	if (drop_eligible) {
-		drop = random_early_discard(tm_system, tm_queue_obj,
-					    initial_tm_wred_node, pkt_color);
-		if (drop)
-			return -1;
+
+	for (i = 0; i < num; i++) {
+		pkt_color = odp_packet_color(pkt[i]);
+		drop_eligible = odp_packet_drop_eligible(pkt[i]);
+
+		if (drop_eligible) {
+			drop = random_early_discard(tm_system, tm_queue_obj,
+						    initial_tm_wred_node,
+						    pkt_color);
+			if (drop)
+				break;
+		}
+
+		work_item[i].queue_num = tm_queue_obj->queue_num;
+		work_item[i].pkt = pkt[i];
 	}
 
-	work_item.queue_num = tm_queue_obj->queue_num;
-	work_item.pkt = pkt;
+	if (i == 0)
+		return -1;
+
 	sched_fn->order_lock();
-	rc = input_work_queue_append(tm_system, &work_item);
+	rc = input_work_queue_append_multi(tm_system, work_item, i);
 	sched_fn->order_unlock();
 
 	if (rc < 0) {
@@ -1921,9 +2029,28 @@ static int tm_enqueue(tm_system_t *tm_system,
 		return rc;
 	}
 
-	frame_len = odp_packet_len(pkt);
-	pkt_depth = tm_queue_cnts_increment(tm_system, initial_tm_wred_node,
-					    tm_queue_obj->priority, frame_len);
+	for (i = 0; i < rc; i++) {
+		frame_len = odp_packet_len(pkt[i]);
+		*pkt_depth = tm_queue_cnts_increment(tm_system,
+						     initial_tm_wred_node,
+						     tm_queue_obj->priority,
+						     frame_len);
+	}
+
+	return rc;
+}
+
+static int tm_enqueue(tm_system_t *tm_system,
+		      tm_queue_obj_t *tm_queue_obj,
+		      odp_packet_t pkt)
+{
+	uint32_t pkt_depth;
+	int rc;
+
+	rc = tm_enqueue_multi(tm_system, tm_queue_obj, &pkt, 1, &pkt_depth);
+	if (rc < 0)
+		return rc;
+
 	return pkt_depth;
 }
 
@@ -2111,6 +2238,27 @@ static void tm_egress_marking(tm_system_t *tm_system, odp_packet_t odp_pkt)
 	}
 }
 
+static void tm_egress_flush(tm_system_t *tm_system)
+{
+	uint32_t num = tm_system->egress_burst_num;
+	int sent;
+
+	if (num == 0)
+		return;
+
+	sent = odp_pktout_send(tm_system->pktout, tm_system->egress_burst,
+			       num);
+	if (odp_unlikely(sent < 0))
+		sent = 0;
+
+	/* Pktout did not accept all packets, drop the rest */
+	if (odp_unlikely((uint32_t)sent < num))
+		odp_packet_free_multi(&tm_system->egress_burst[sent],
+				      num - sent);
+
+	tm_system->egress_burst_num = 0;
+}
+
 static void tm_send_pkt(tm_system_t *tm_system, uint32_t max_sends)
 {
 	tm_queue_obj_t *tm_queue_obj;
@@ -2130,16 +2278,22 @@ static void tm_send_pkt(tm_system_t *tm_system, uint32_t max_sends)
 			return;
 		}
 
-		if (tm_system->marking_enabled)
-			tm_egress_marking(tm_system, odp_pkt);
+		if (tm_system->parent->marking_enabled)
+			tm_egress_marking(tm_system->parent, odp_pkt);
 
 		tm_system->egress_pkt_desc = EMPTY_PKT_DESC;
-		if (tm_system->egress.egress_kind == ODP_TM_EGRESS_PKT_IO)
-			odp_pktout_send(tm_system->pktout, &odp_pkt, 1);
-		else if (tm_system->egress.egress_kind == ODP_TM_EGRESS_FN)
+		if (tm_system->egress.egress_kind == ODP_TM_EGRESS_PKT_IO) {
+			/* Packets are sent in bursts at the end of each TM
+			 * thread loop iteration */
+			tm_system->egress_burst[tm_system->egress_burst_num++] =
+				odp_pkt;
+			if (tm_system->egress_burst_num == tm_burst_size)
+				tm_egress_flush(tm_system);
+		} else if (tm_system->egress.egress_kind == ODP_TM_EGRESS_FN) {
 			tm_system->egress.egress_fcn(odp_pkt);
-		else
+		} else {
 			return;
+		}
 
 		tm_queue_obj->sent_pkt = tm_queue_obj->pkt;
 		tm_queue_obj->sent_pkt_desc = tm_queue_obj->in_pkt_desc;
@@ -2157,40 +2311,69 @@ static int tm_process_input_work_queue(tm_system_t *tm_system,
 				       input_work_queue_t *input_work_queue,
 				       uint32_t pkts_to_process)
 {
-	input_work_item_t work_item;
+	input_work_item_t work_item[TM_MAX_BURST];
+	odp_packet_t pkts[TM_MAX_BURST];
 	tm_queue_obj_t *tm_queue_obj;
 	tm_shaper_obj_t *shaper_obj;
 	odp_packet_t pkt;
 	pkt_desc_t *pkt_desc;
-	uint32_t cnt;
+	uint32_t i, j, num, num_pkts, queue_num;
 	int rc;
 
-	for (cnt = 1; cnt <= pkts_to_process; cnt++) {
-		rc = input_work_queue_remove(input_work_queue, &work_item);
-		if (rc < 0) {
-			ODP_DBG("%s input_work_queue_remove() failed\n",
-				__func__);
-			return rc;
-		}
+	if (pkts_to_process > TM_MAX_BURST)
+		pkts_to_process = TM_MAX_BURST;
+
+	num = input_work_queue_remove_multi(input_work_queue, work_item,
+					    pkts_to_process);
+	if (num == 0) {
+		ODP_DBG("%s input_work_queue_remove_multi() failed\n",
+			__func__);
+		return -1;
+	}
 
+	for (i = 0; i < num; i++) {
 		tm_queue_obj =
-			tm_system->queue_num_tbl[work_item.queue_num - 1];
-		pkt = work_item.pkt;
+			tm_system->queue_num_tbl[work_item[i].queue_num - 1];
+		pkt = work_item[i].pkt;
 		if (!tm_queue_obj) {
 			odp_packet_free(pkt);
-			return 0;
+			continue;
 		}
 
-		tm_queue_obj->pkts_rcvd_cnt++;
 		if (tm_queue_obj->pkt != ODP_PACKET_INVALID) {
 			/* If the tm_queue_obj already has a pkt to work with,
-			 * then just add this new pkt to the associated
-			 * _odp_int_pkt_queue. */
-			(void)_odp_pkt_queue_append(
+			 * then just add this new pkt - and all following pkts
+			 * to the same tm_queue - to the associated
+			 * _odp_int_pkt_queue in one go. */
+			queue_num = work_item[i].queue_num;
+			pkts[0] = pkt;
+			num_pkts = 1;
+			while (i + 1 < num &&
+			       work_item[i + 1].queue_num == queue_num) {
+				i++;
+				pkts[num_pkts++] = work_item[i].pkt;
+			}
+
+			tm_queue_obj->pkts_rcvd_cnt += num_pkts;
+			rc = _odp_pkt_queue_append_multi(
 				tm_system->_odp_int_queue_pool,
-				tm_queue_obj->_odp_int_pkt_queue, pkt);
-			tm_queue_obj->pkts_enqueued_cnt++;
+				tm_queue_obj->_odp_int_pkt_queue, pkts,
+				num_pkts);
+			if (rc < 0)
+				rc = 0;
+
+			tm_queue_obj->pkts_enqueued_cnt += rc;
+
+			/* Drop pkts that did not fit into the pkt queue */
+			for (j = rc; j < num_pkts; j++) {
+				tm_queue_cnts_decrement(tm_system,
+							tm_queue_obj->tm_wred_node,
+							tm_queue_obj->priority,
+							odp_packet_len(pkts[j]));
+				odp_packet_free(pkts[j]);
+			}
 		} else {
+			tm_queue_obj->pkts_rcvd_cnt++;
 			/* If the tm_queue_obj doesn't have a pkt to work
 			 * with, then make this one the head pkt. */
 			tm_queue_obj->pkt = pkt;
@@ -2201,37 +2384,38 @@ static int tm_process_input_work_queue(tm_system_t *tm_system,
 			rc = tm_propagate_pkt_desc(tm_system, shaper_obj,
 						   pkt_desc,
 						   tm_queue_obj->priority);
+			/* Send through spigot, together with all packets
+			 * that became eligible behind it */
 			if (0 < rc)
-				return 1;  /* Send through spigot */
+				tm_send_pkt(tm_system, tm_burst_size);
 		}
 	}
 
 	return 0;
 }
 
-static int tm_process_expired_timers(tm_system_t *tm_system,
-				     _odp_timer_wheel_t _odp_int_timer_wheel,
-				     uint64_t current_time ODP_UNUSED)
+static uint32_t tm_process_expired_timers(tm_system_t *tm_system,
+					  _odp_timer_wheel_t
+					  _odp_int_timer_wheel,
+					  uint64_t current_time)
 {
 	tm_shaper_obj_t *shaper_obj;
 	tm_queue_obj_t *tm_queue_obj;
 	pkt_desc_t *pkt_desc;
-	uint64_t timer_context;
-	uint32_t work_done, cnt, queue_num, timer_seq;
+	uint64_t timer_context[TM_MAX_BURST];
+	uint32_t work_done, i, num, queue_num, timer_seq, max_timers;
 	uint8_t priority;
 
+	max_timers = tm_burst_size > 2 ? tm_burst_size : 2;
+	num = _odp_timer_wheel_expired_get(_odp_int_timer_wheel, current_time,
+					   timer_context, max_timers);
 	work_done = 0;
-	for (cnt = 1; cnt <= 2; cnt++) {
-		timer_context =
-			_odp_timer_wheel_next_expired(_odp_int_timer_wheel);
-		if (!timer_context)
-			return work_done;
-
-		queue_num = (timer_context & 0xFFFFFFFF) >> 4;
-		timer_seq = timer_context >> 32;
+	for (i = 0; i < num; i++) {
+		queue_num = (timer_context[i] & 0xFFFFFFFF) >> 4;
+		timer_seq = timer_context[i] >> 32;
 		tm_queue_obj = tm_system->queue_num_tbl[queue_num - 1];
 		if (!tm_queue_obj)
-			return work_done;
+			continue;
 
 		if ((tm_queue_obj->timer_reason == NO_CALLBACK) ||
 		    (!tm_queue_obj->timer_shaper) ||
@@ -2241,7 +2425,7 @@ static int tm_process_expired_timers(tm_system_t *tm_system,
 			else
 				ODP_DBG("%s bad timer return\n", __func__);
 
-			return work_done;
+			continue;
 		}
 
 		shaper_obj = tm_queue_obj->timer_shaper;
@@ -2254,7 +2438,7 @@ static int tm_process_expired_timers(tm_system_t *tm_system,
 				      pkt_desc, priority);
 		work_done++;
 		if (tm_system->egress_pkt_desc.queue_num != 0)
-			tm_send_pkt(tm_system, 2);
+			tm_send_pkt(tm_system, max_timers);
 	}
 
 	return work_done;
@@ -2263,9 +2447,15 @@ static int tm_process_expired_timers(tm_system_t *tm_system,
 static volatile uint64_t busy_wait_counter;
 
 static odp_bool_t       main_loop_running;
-static odp_atomic_u64_t atomic_request_cnt;
-static odp_atomic_u64_t currently_serving_cnt;
-static odp_atomic_u64_t atomic_done_cnt;
+
+/* Configuration change requests. A requesting thread holds tm_request_lock
+ * and waits until every running TM thread has parked itself in
+ * check_for_request(), so that no TM thread touches profiles while they are
+ * being modified. */
+static odp_ticketlock_t tm_request_lock;
+static odp_atomic_u32_t tm_request;
+static odp_atomic_u32_t tm_threads_running;
+static odp_atomic_u32_t tm_threads_parked;
 
 static void busy_wait(uint32_t iterations)
 {
@@ -2277,41 +2467,46 @@ static void busy_wait(uint32_t iterations)
 
 static void signal_request(void)
 {
-	uint64_t my_request_num, serving_cnt;
+	odp_ticketlock_lock(&tm_request_lock);
+	odp_atomic_store_rel_u32(&tm_request, 1);
 
-	my_request_num = odp_atomic_fetch_inc_u64(&atomic_request_cnt) + 1;
-
-	serving_cnt = odp_atomic_load_u64(&currently_serving_cnt);
-	while (serving_cnt != my_request_num) {
+	while (odp_atomic_load_acq_u32(&tm_threads_parked) !=
+	       odp_atomic_load_u32(&tm_threads_running))
 		busy_wait(100);
-		serving_cnt = odp_atomic_load_u64(&currently_serving_cnt);
-	}
 }
 
 static void check_for_request(void)
 {
-	uint64_t request_num, serving_cnt, done_cnt;
-
-	request_num = odp_atomic_load_u64(&atomic_request_cnt);
-	serving_cnt = odp_atomic_load_u64(&currently_serving_cnt);
-	if (serving_cnt == request_num)
+	if (odp_likely(odp_atomic_load_u32(&tm_request) == 0))
 		return;
 
-	/* Signal the other requesting thread to proceed and then
-	 * wait for their done indication */
-	odp_atomic_inc_u64(&currently_serving_cnt);
-	busy_wait(100);
+	/* Signal the requesting thread to proceed and then wait for their
+	 * done indication */
+	odp_atomic_add_rel_u32(&tm_threads_parked, 1);
 
-	done_cnt = odp_atomic_load_u64(&atomic_done_cnt);
-	while (done_cnt != request_num) {
+	while (odp_atomic_load_acq_u32(&tm_request))
 		busy_wait(100);
-		done_cnt = odp_atomic_load_u64(&atomic_done_cnt);
-	}
+
+	odp_atomic_sub_u32(&tm_threads_parked, 1);
 }
 
 static void signal_request_done(void)
 {
-	odp_atomic_inc_u64(&atomic_done_cnt);
+	odp_atomic_store_rel_u32(&tm_request, 0);
+
+	/* Wait for all TM threads to leave before a new request may start */
+	while (odp_atomic_load_u32(&tm_threads_parked))
+		busy_wait(100);
+
+	odp_ticketlock_unlock(&tm_request_lock);
+}
+
+static void tm_thread_running(void)
+{
+	/* Does not start during a configuration change */
+	odp_ticketlock_lock(&tm_request_lock);
+	odp_atomic_inc_u32(&tm_threads_running);
+	odp_ticketlock_unlock(&tm_request_lock);
 }
 
 static int thread_affinity_get(odp_cpumask_t *odp_cpu_mask)
@@ -2357,6 +2552,7 @@ static void *tm_system_thread(void *arg)
 
 	/* Wait here until we have seen the first enqueue operation. */
 	odp_barrier_wait(&tm_group->tm_group_barrier);
+	tm_thread_running();
 	main_loop_running = true;
 
 	destroying = odp_atomic_load_u64(&tm_system->destroying);
@@ -2370,36 +2566,41 @@ static void *tm_system_thread(void *arg)
 		check_for_request();
 
 		current_ns = odp_time_to_ns(odp_time_local());
-		tm_system->current_time = current_ns;
-		rc = _odp_timer_wheel_curr_time_update(_odp_int_timer_wheel,
-						       current_ns);
-		if (0 < rc) {
-			/* Process a batch of expired timers - each of which
-			 * could cause a pkt to egress the tm system. */
-			timer_cnt = 1;
-			(void)tm_process_expired_timers(tm_system,
-							_odp_int_timer_wheel,
-							current_ns);
-		} else {
+		tm_time_update(tm_system, current_ns);
+
+		/* Process a batch of expired timers - each of which could
+		 * cause a pkt to egress the tm system. */
+		timer_cnt = tm_process_expired_timers(tm_system,
+						      _odp_int_timer_wheel,
+						      current_ns);
+		if (timer_cnt == 0)
 			timer_cnt =
 				_odp_timer_wheel_count(_odp_int_timer_wheel);
+
+		/* All work of this iteration is done at the same time
+		 * instant. When burst size is one, time is updated after each
+		 * step as input may have waited for timer processing. */
+		if (tm_burst_size == 1) {
+			current_ns = odp_time_to_ns(odp_time_local());
+			tm_time_update(tm_system, current_ns);
 		}
 
-		current_ns = odp_time_to_ns(odp_time_local());
-		tm_system->current_time = current_ns;
-		work_queue_cnt =
-			odp_atomic_load_u64(&input_work_queue->queue_cnt);
+		work_queue_cnt = input_work_queue_cnt(input_work_queue);
 
 		if (work_queue_cnt != 0) {
 			tm_process_input_work_queue(tm_system,
-						    input_work_queue, 1);
+						    input_work_queue,
+						    work_queue_cnt <
+						    tm_burst_size ?
+						    work_queue_cnt :
+						    tm_burst_size);
 		}
 
 		if (tm_system->egress_pkt_desc.queue_num != 0)
-			tm_send_pkt(tm_system, 1);
+			tm_send_pkt(tm_system, tm_burst_size);
+
+		tm_egress_flush(tm_system);
 
-		current_ns = odp_time_to_ns(odp_time_local());
-		tm_system->current_time = current_ns;
 		tm_system->is_idle = (timer_cnt == 0) &&
 			(work_queue_cnt == 0);
 		destroying = odp_atomic_load_u64(&tm_system->destroying);
@@ -2410,6 +2611,7 @@ static void *tm_system_thread(void *arg)
 		input_work_queue = tm_system->input_work_queue;
 	}
 
+	odp_atomic_dec_u32(&tm_threads_running);
 	odp_barrier_wait(&tm_system->tm_system_destroy_barrier);
 	odp_term_local();
 	return NULL;
@@ -2417,10 +2619,24 @@ static void *tm_system_thread(void *arg)
 
 odp_bool_t odp_tm_is_idle(odp_tm_t odp_tm)
 {
-	tm_system_t *tm_system;
+	tm_system_group_t *tm_group;
+	tm_system_t *tm_system, *partition;
+	uint32_t i;
 
 	tm_system = GET_TM_SYSTEM(odp_tm);
-	return tm_system->is_idle;
+	for (i = 0; i < tm_system->num_partitions; i++) {
+		partition = tm_system->partition[i];
+		tm_group = GET_TM_GROUP(partition->odp_tm_group);
+
+		/* Partition has not received any packets yet */
+		if (odp_atomic_load_u32(&tm_group->first_enq) == 0)
+			continue;
+
+		if (!partition->is_idle)
+			return false;
+	}
+
+	return true;
 }
 
 void odp_tm_requirements_init(odp_tm_requirements_t *requirements)
@@ -2656,6 +2872,7 @@ static _odp_tm_group_t _odp_tm_group_create(const char *name ODP_UNUSED)
 	tm_group = malloc(sizeof(tm_system_group_t));
 	memset(tm_group, 0, sizeof(tm_system_group_t));
 	odp_barrier_init(&tm_group->tm_group_barrier, 2);
+	odp_atomic_init_u32(&tm_group->first_enq, 0);
 
 	/* Add this group to the tm_group_list linked list. */
 	if (tm_group_list == NULL) {
@@ -2693,7 +2910,7 @@ static void _odp_tm_group_destroy(_odp_tm_group_t odp_tm_group)
 	 * when this is the last tm_group in the linked list. */
 	prev_tm_group = tm_group->prev;
 	next_tm_group = tm_group->next;
-	if (prev_tm_group == next_tm_group) {
+	if (next_tm_group == tm_group) {
 		ODP_ASSERT(tm_group_list == tm_group);
 		tm_group_list = NULL;
 	} else {
@@ -2833,6 +3050,151 @@ static int tm_group_attach(odp_tm_t odp_tm)
 	return 0;
 }
 
+/* Create the datapath resources of a TM system or partition */
+static int tm_system_resources_create(tm_system_t *tm_system,
+				      uint32_t max_tm_queues)
+{
+	uint32_t max_num_queues, max_queued_pkts, max_timers;
+	uint32_t max_sorted_lists;
+	odp_bool_t create_fail;
+
+	max_sorted_lists = 2 * max_tm_queues;
+	max_num_queues = max_tm_queues;
+	max_queued_pkts = 16 * max_tm_queues;
+	max_timers = 2 * max_tm_queues;
+	create_fail = 0;
+
+	tm_system->_odp_int_sorted_pool = _ODP_INT_SORTED_POOL_INVALID;
+	tm_system->_odp_int_queue_pool = _ODP_INT_QUEUE_POOL_INVALID;
+	tm_system->_odp_int_timer_wheel = _ODP_INT_TIMER_WHEEL_INVALID;
+	tm_system->input_work_queue = NULL;
+
+	tm_system->_odp_int_sorted_pool = _odp_sorted_pool_create(
+		max_sorted_lists);
+	create_fail |= tm_system->_odp_int_sorted_pool
+		== _ODP_INT_SORTED_POOL_INVALID;
+
+	if (create_fail == 0) {
+		tm_system->_odp_int_queue_pool = _odp_queue_pool_create(
+			max_num_queues, max_queued_pkts);
+		create_fail |= tm_system->_odp_int_queue_pool
+			== _ODP_INT_QUEUE_POOL_INVALID;
+	}
+
+	if (create_fail == 0) {
+		tm_system->_odp_int_timer_wheel = _odp_timer_wheel_create(
+			max_timers, tm_system);
+		create_fail |= tm_system->_odp_int_timer_wheel
+			== _ODP_INT_TIMER_WHEEL_INVALID;
+	}
+
+	if (create_fail == 0) {
+		tm_system->input_work_queue = input_work_queue_create();
+		create_fail |= !tm_system->input_work_queue;
+	}
+
+	return create_fail ? -1 : 0;
+}
+
+static void tm_system_resources_destroy(tm_system_t *tm_system)
+{
+	if (tm_system->input_work_queue)
+		input_work_queue_destroy(tm_system->input_work_queue);
+
+	if (tm_system->_odp_int_sorted_pool != _ODP_INT_SORTED_POOL_INVALID)
+		_odp_sorted_pool_destroy(tm_system->_odp_int_sorted_pool);
+
+	if (tm_system->_odp_int_queue_pool != _ODP_INT_QUEUE_POOL_INVALID)
+		_odp_queue_pool_destroy(tm_system->_odp_int_queue_pool);
+
+	if (tm_system->_odp_int_timer_wheel != _ODP_INT_TIMER_WHEEL_INVALID)
+		_odp_timer_wheel_destroy(tm_system->_odp_int_timer_wheel);
+}
+
+/* Stop the TM thread servicing this tm_system. Any new pkts are prevented
+ * from coming in first. */
+static void tm_system_thread_stop(tm_system_t *tm_system)
+{
+	tm_system_group_t *tm_group;
+
+	tm_group = GET_TM_GROUP(tm_system->odp_tm_group);
+	odp_barrier_init(&tm_system->tm_system_destroy_barrier, 2);
+	odp_atomic_inc_u64(&tm_system->destroying);
+
+	/* Release the thread also when it has not seen any enqueues */
+	tm_group_first_enq(tm_group);
+	odp_barrier_wait(&tm_system->tm_system_destroy_barrier);
+
+	/* Remove ourselves from the group.  If we are the last tm_system in
+	 * this group, odp_tm_group_remove will destroy any service threads
+	 * allocated by this group. */
+	_odp_tm_group_remove(tm_system->odp_tm_group,
+			     MAKE_ODP_TM_HANDLE(tm_system));
+}
+
+/* Create partitions 1 ... tm_num_threads - 1 of a TM system. Each one gets
+ * a tm_group, and thus a TM thread, of its own. Partitions share the queue
+ * table and root node of the parent and send to pktout queues round
+ * robin. A pktout queue is shared by several partitions only when it is
+ * multi-thread safe (checked in odp_tm_create()). */
+static int tm_partitions_create(tm_system_t *tm_system,
+				odp_pktout_queue_t pktout[], int num_pktout,
+				uint32_t max_tm_queues)
+{
+	_odp_tm_group_t odp_tm_group;
+	tm_system_t *partition;
+	uint32_t idx;
+
+	for (idx = 1; idx < tm_num_threads; idx++) {
+		partition = malloc(sizeof(tm_system_t));
+		if (!partition)
+			return -1;
+
+		memset(partition, 0, sizeof(tm_system_t));
+		partition->parent = tm_system;
+		partition->tm_idx = tm_system->tm_idx;
+		partition->name_tbl_id = ODP_INVALID_NAME;
+		partition->queue_num_tbl = tm_system->queue_num_tbl;
+		partition->root_node = tm_system->root_node;
+		memcpy(&partition->egress, &tm_system->egress,
+		       sizeof(odp_tm_egress_t));
+		if (num_pktout)
+			partition->pktout = pktout[idx % num_pktout];
+
+		tm_init_random_data(&partition->tm_random_data);
+		odp_ticketlock_init(&partition->tm_system_lock);
+		odp_atomic_init_u64(&partition->destroying, 0);
+
+		if (tm_system_resources_create(partition, max_tm_queues)) {
+			tm_system_resources_destroy(partition);
+			free(partition);
+			return -1;
+		}
+
+		tm_system->partition[idx] = partition;
+		tm_system->num_partitions++;
+
+		odp_tm_group = _odp_tm_group_create("");
+		_odp_tm_group_add(odp_tm_group, MAKE_ODP_TM_HANDLE(partition));
+	}
+
+	return 0;
+}
+
+static void tm_partitions_destroy(tm_system_t *tm_system)
+{
+	tm_system_t *partition;
+
+	while (tm_system->num_partitions > 1) {
+		partition = tm_system->partition[--tm_system->num_partitions];
+		tm_system->partition[tm_system->num_partitions] = NULL;
+
+		tm_system_thread_stop(partition);
+		tm_system_resources_destroy(partition);
+		free(partition);
+	}
+}
+
 odp_tm_t odp_tm_create(const char            *name,
 		       odp_tm_requirements_t *requirements,
 		       odp_tm_egress_t       *egress)
@@ -2841,17 +3203,31 @@ odp_tm_t odp_tm_create(const char            *name,
 	tm_system_t *tm_system;
 	odp_bool_t create_fail;
 	odp_tm_t odp_tm;
-	odp_pktout_queue_t pktout;
-	uint32_t malloc_len, max_num_queues, max_queued_pkts, max_timers;
-	uint32_t max_tm_queues, max_sorted_lists;
-	int rc;
+	odp_pktout_queue_t pktout[TM_MAX_PARTITIONS];
+	uint32_t malloc_len, max_tm_queues;
+	int rc, num_pktout = 0;
 
-	/* If we are using pktio output (usual case) get the first associated
-	 * pktout_queue for this pktio and fail if there isn't one.
+	/* If we are using pktio output (usual case) get the associated
+	 * pktout_queues for this pktio and fail if there isn't one.
 	 */
-	if (egress->egress_kind == ODP_TM_EGRESS_PKT_IO &&
-	    odp_pktout_queue(egress->pktio, &pktout, 1) != 1)
-		return ODP_TM_INVALID;
+	if (egress->egress_kind == ODP_TM_EGRESS_PKT_IO) {
+		num_pktout = odp_pktout_queue(egress->pktio, pktout,
+					      TM_MAX_PARTITIONS);
+		if (num_pktout < 1)
+			return ODP_TM_INVALID;
+
+		if (num_pktout > TM_MAX_PARTITIONS)
+			num_pktout = TM_MAX_PARTITIONS;
+
+		/* TM threads of partitions send concurrently */
+		if ((uint32_t)num_pktout < tm_num_threads &&
+		    get_pktio_entry(egress->pktio)->s.out_op_mode ==
+		    ODP_PKTIO_OP_MT_UNSAFE) {
+			ODP_ERR("%u TM threads need as many pktout queues, or "
+				"MT safe pktout queues\n", tm_num_threads);
+			return ODP_TM_INVALID;
+		}
+	}
 
 	/* Allocate tm_system_t record. */
 	odp_ticketlock_lock(&tm_create_lock);
@@ -2870,9 +3246,12 @@ odp_tm_t odp_tm_create(const char            *name,
 	}
 
 	if (egress->egress_kind == ODP_TM_EGRESS_PKT_IO)
-		tm_system->pktout = pktout;
+		tm_system->pktout = pktout[0];
 
 	tm_system->name_tbl_id = name_tbl_id;
+	tm_system->parent = tm_system;
+	tm_system->partition[0] = tm_system;
+	tm_system->num_partitions = 1;
 	max_tm_queues = requirements->max_tm_queues;
 	memcpy(&tm_system->egress, egress, sizeof(odp_tm_egress_t));
 	memcpy(&tm_system->requirements, requirements,
@@ -2888,48 +3267,17 @@ odp_tm_t odp_tm_create(const char            *name,
 
 	tm_init_random_data(&tm_system->tm_random_data);
 
-	max_sorted_lists = 2 * max_tm_queues;
-	max_num_queues = max_tm_queues;
-	max_queued_pkts = 16 * max_tm_queues;
-	max_timers = 2 * max_tm_queues;
-	create_fail = 0;
-
-	tm_system->_odp_int_sorted_pool = _ODP_INT_SORTED_POOL_INVALID;
-	tm_system->_odp_int_queue_pool = _ODP_INT_QUEUE_POOL_INVALID;
-	tm_system->_odp_int_timer_wheel = _ODP_INT_TIMER_WHEEL_INVALID;
-
 	odp_ticketlock_init(&tm_system->tm_system_lock);
 	odp_atomic_init_u64(&tm_system->destroying, 0);
 
-	tm_system->_odp_int_sorted_pool = _odp_sorted_pool_create(
-		max_sorted_lists);
-	create_fail |= tm_system->_odp_int_sorted_pool
-		== _ODP_INT_SORTED_POOL_INVALID;
-
-	if (create_fail == 0) {
-		tm_system->_odp_int_queue_pool = _odp_queue_pool_create(
-			max_num_queues, max_queued_pkts);
-		create_fail |= tm_system->_odp_int_queue_pool
-			== _ODP_INT_QUEUE_POOL_INVALID;
-	}
-
-	if (create_fail == 0) {
-		tm_system->_odp_int_timer_wheel = _odp_timer_wheel_create(
-			max_timers, tm_system);
-		create_fail |= tm_system->_odp_int_timer_wheel
-			== _ODP_INT_TIMER_WHEEL_INVALID;
-	}
+	create_fail = tm_system_resources_create(tm_system,
+						 max_tm_queues) < 0;
 
 	if (create_fail == 0) {
 		tm_system->root_node = create_dummy_root_node();
 		create_fail |= tm_system->root_node == NULL;
 	}
 
-	if (create_fail == 0) {
-		tm_system->input_work_queue = input_work_queue_create();
-		create_fail |= !tm_system->input_work_queue;
-	}
-
 	if (create_fail == 0) {
 		/* Pass any odp_groups or hints to tm_group_attach here. */
 		affinitize_main_thread();
@@ -2937,26 +3285,19 @@ odp_tm_t odp_tm_create(const char            *name,
 		create_fail |= rc < 0;
 	}
 
+	if (create_fail == 0) {
+		rc = tm_partitions_create(tm_system, pktout, num_pktout,
+					  max_tm_queues);
+		if (rc < 0) {
+			tm_partitions_destroy(tm_system);
+			tm_system_thread_stop(tm_system);
+			create_fail = 1;
+		}
+	}
+
 	if (create_fail) {
 		_odp_int_name_tbl_delete(name_tbl_id);
-		if (tm_system->input_work_queue)
-			input_work_queue_destroy(tm_system->input_work_queue);
-
-		if (tm_system->_odp_int_sorted_pool
-		    != _ODP_INT_SORTED_POOL_INVALID)
-			_odp_sorted_pool_destroy(
-				tm_system->_odp_int_sorted_pool);
-
-		if (tm_system->_odp_int_queue_pool !=
-		    _ODP_INT_QUEUE_POOL_INVALID)
-			_odp_queue_pool_destroy(
-				tm_system->_odp_int_queue_pool);
-
-		if (tm_system->_odp_int_timer_wheel
-		    != _ODP_INT_TIMER_WHEEL_INVALID)
-			_odp_timer_wheel_destroy(
-				tm_system->_odp_int_timer_wheel);
-
+		tm_system_resources_destroy(tm_system);
 		tm_system_free(tm_system);
 		odp_ticketlock_unlock(&tm_create_lock);
 		return ODP_TM_INVALID;
@@ -2996,23 +3337,12 @@ int odp_tm_destroy(odp_tm_t odp_tm)
 
 	tm_system = GET_TM_SYSTEM(odp_tm);
 
-	/* First mark the tm_system as being in the destroying state so that
-	 * all new pkts are prevented from coming in.
-	 */
-	odp_barrier_init(&tm_system->tm_system_destroy_barrier, 2);
-	odp_atomic_inc_u64(&tm_system->destroying);
-	odp_barrier_wait(&tm_system->tm_system_destroy_barrier);
-
-	/* Remove ourselves from the group.  If we are the last tm_system in
-	 * this group, odp_tm_group_remove will destroy any service threads
-	 * allocated by this group. */
-	_odp_tm_group_remove(tm_system->odp_tm_group, odp_tm);
-
-	input_work_queue_destroy(tm_system->input_work_queue);
-	_odp_sorted_pool_destroy(tm_system->_odp_int_sorted_pool);
-	_odp_queue_pool_destroy(tm_system->_odp_int_queue_pool);
-	_odp_timer_wheel_destroy(tm_system->_odp_int_timer_wheel);
+	/* The parent is stopped first, since enqueues check its destroying
+	 * state. */
+	tm_system_thread_stop(tm_system);
+	tm_partitions_destroy(tm_system);
 
+	tm_system_resources_destroy(tm_system);
 	tm_system_free(tm_system);
 	return 0;
 }
@@ -3584,6 +3914,96 @@ void odp_tm_node_params_init(odp_tm_node_params_t *params)
 	memset(params, 0, sizeof(odp_tm_node_params_t));
 }
 
+/* Sorted lists and pkt queues are created in the pools of every partition.
+ * Pools hand out handles in creation order, so the same handle is valid in
+ * all partitions and a tm_node or tm_queue can be serviced by any of them. */
+static _odp_int_sorted_list_t tm_sorted_list_create(tm_system_t *tm_system,
+						    uint32_t max_entries)
+{
+	_odp_int_sorted_list_t sorted_list, partition_list;
+	tm_system_t *partition;
+	uint32_t idx;
+
+	sorted_list = _odp_sorted_list_create(tm_system->_odp_int_sorted_pool,
+					      max_entries);
+	if (sorted_list == _ODP_INT_SORTED_LIST_INVALID)
+		return _ODP_INT_SORTED_LIST_INVALID;
+
+	for (idx = 1; idx < tm_system->num_partitions; idx++) {
+		partition = tm_system->partition[idx];
+		partition_list = _odp_sorted_list_create(
+			partition->_odp_int_sorted_pool, max_entries);
+		if (partition_list != sorted_list) {
+			if (partition_list != _ODP_INT_SORTED_LIST_INVALID)
+				_odp_sorted_list_destroy(
+					partition->_odp_int_sorted_pool,
+					partition_list);
+			while (idx--) {
+				partition = tm_system->partition[idx];
+				_odp_sorted_list_destroy(
+					partition->_odp_int_sorted_pool,
+					sorted_list);
+			}
+			return _ODP_INT_SORTED_LIST_INVALID;
+		}
+	}
+
+	return sorted_list;
+}
+
+static int tm_sorted_list_destroy(tm_system_t *tm_system,
+				  _odp_int_sorted_list_t sorted_list)
+{
+	tm_system_t *partition;
+	uint32_t idx;
+	int rc;
+
+	for (idx = 0; idx < tm_system->num_partitions; idx++) {
+		partition = tm_system->partition[idx];
+		rc = _odp_sorted_list_destroy(partition->_odp_int_sorted_pool,
+					      sorted_list);
+		if (rc != 0)
+			return rc;
+	}
+
+	return 0;
+}
+
+static _odp_int_pkt_queue_t tm_pkt_queue_create(tm_system_t *tm_system)
+{
+	_odp_int_pkt_queue_t pkt_queue, partition_queue;
+	tm_system_t *partition;
+	uint32_t idx;
+
+	pkt_queue = _odp_pkt_queue_create(tm_system->_odp_int_queue_pool);
+	if (pkt_queue == _ODP_INT_PKT_QUEUE_INVALID)
+		return _ODP_INT_PKT_QUEUE_INVALID;
+
+	for (idx = 1; idx < tm_system->num_partitions; idx++) {
+		partition = tm_system->partition[idx];
+		partition_queue = _odp_pkt_queue_create(
+			partition->_odp_int_queue_pool);
+		if (partition_queue != pkt_queue) {
+			if (partition_queue != _ODP_INT_PKT_QUEUE_INVALID)
+				_odp_pkt_queue_destroy(
+					partition->_odp_int_queue_pool,
+					partition_queue);
+
+			/* Return the queue number to pools of previous
+			 * partitions to keep them in sync */
+			while (idx--) {
+				partition = tm_system->partition[idx];
+				_odp_pkt_queue_destroy(
+					partition->_odp_int_queue_pool,
+					pkt_queue);
+			}
+			return _ODP_INT_PKT_QUEUE_INVALID;
+		}
+	}
+
+	return pkt_queue;
+}
+
 odp_tm_node_t odp_tm_node_create(odp_tm_t             odp_tm,
 				 const char           *name,
 				 odp_tm_node_params_t *params)
@@ -3652,9 +4072,23 @@ odp_tm_node_t odp_tm_node_create(odp_tm_t             odp_tm,
 
 	schedulers_obj->num_priorities = num_priorities;
 	for (priority = 0; priority < num_priorities; priority++) {
-		sorted_list = _odp_sorted_list_create(
-			tm_system->_odp_int_sorted_pool,
-			params->max_fanin);
+		sorted_list = tm_sorted_list_create(tm_system,
+						    params->max_fanin);
+		if (sorted_list == _ODP_INT_SORTED_LIST_INVALID) {
+			tm_sched_state_t *state = schedulers_obj->sched_states;
+
+			while (priority--) {
+				sorted_list = state[priority].sorted_list;
+				tm_sorted_list_destroy(tm_system, sorted_list);
+			}
+			if (name_tbl_id != ODP_INVALID_NAME)
+				_odp_int_name_tbl_delete(name_tbl_id);
+			free(schedulers_obj);
+			free(tm_wred_node);
+			free(tm_node_obj);
+			return ODP_TM_INVALID;
+		}
+
 		schedulers_obj->sched_states[priority].sorted_list =
 			sorted_list;
 	}
@@ -3686,7 +4120,6 @@ odp_tm_node_t odp_tm_node_create(odp_tm_t             odp_tm,
 int odp_tm_node_destroy(odp_tm_node_t tm_node)
 {
 	_odp_int_sorted_list_t sorted_list;
-	_odp_int_sorted_pool_t sorted_pool;
 	tm_schedulers_obj_t   *schedulers_obj;
 	tm_sched_state_t      *sched_state;
 	tm_wred_params_t      *wred_params;
@@ -3746,9 +4179,8 @@ int odp_tm_node_destroy(odp_tm_node_t tm_node)
 		for (priority = 0; priority < num_priorities; priority++) {
 			sched_state = &schedulers_obj->sched_states[priority];
 			sorted_list = sched_state->sorted_list;
-			sorted_pool = tm_system->_odp_int_sorted_pool;
-			rc          = _odp_sorted_list_destroy(sorted_pool,
-							       sorted_list);
+			rc          = tm_sorted_list_destroy(tm_system,
+							     sorted_list);
 			if (rc != 0)
 				return rc;
 		}
@@ -3910,8 +4342,7 @@ odp_tm_queue_t odp_tm_queue_create(odp_tm_t odp_tm,
 		return ODP_TM_INVALID;
 	}
 
-	_odp_int_pkt_queue = _odp_pkt_queue_create(
-		tm_system->_odp_int_queue_pool);
+	_odp_int_pkt_queue = tm_pkt_queue_create(tm_system);
 	if (_odp_int_pkt_queue == _ODP_INT_PKT_QUEUE_INVALID) {
 		free(tm_wred_node);
 		free(tm_queue_obj);
@@ -4164,6 +4595,66 @@ static int tm_remove_from_fanin_list(tm_node_obj_t   *tm_node_obj,
 	return 0;
 }
 
+static void tm_subtree_partition_set(tm_shaper_obj_t *shaper_obj,
+				     uint8_t partition)
+{
+	tm_queue_obj_t  *tm_queue_obj;
+	tm_node_obj_t   *tm_node_obj;
+	tm_shaper_obj_t *fanin;
+
+	if (!shaper_obj->in_tm_node_obj) {
+		tm_queue_obj = shaper_obj->enclosing_entity;
+		tm_queue_obj->partition = partition;
+		return;
+	}
+
+	tm_node_obj = shaper_obj->enclosing_entity;
+	tm_node_obj->partition = partition;
+	for (fanin = tm_node_obj->fanin_list_head; fanin != NULL;
+	     fanin = fanin->fanin_list_next)
+		tm_subtree_partition_set(fanin, partition);
+}
+
+/* All tm_nodes and tm_queues of a top-level subtree are serviced by the same
+ * partition. Subtrees connected to the root are assigned to partitions round
+ * robin, others inherit the partition of the destination node. A subtree
+ * with pkts in it cannot move to another partition. */
+static int tm_subtree_partition_bind(tm_system_t     *tm_system,
+				     tm_shaper_obj_t *src_shaper_obj,
+				     tm_wred_node_t  *src_tm_wred_node,
+				     tm_node_obj_t   *dst_tm_node_obj)
+{
+	tm_queue_obj_t *tm_queue_obj;
+	tm_node_obj_t  *tm_node_obj;
+	uint32_t        partition, current;
+
+	if (tm_system->num_partitions == 1)
+		return 0;
+
+	if (dst_tm_node_obj->is_root_node)
+		partition = tm_system->next_partition++ %
+			tm_system->num_partitions;
+	else
+		partition = dst_tm_node_obj->partition;
+
+	if (src_shaper_obj->in_tm_node_obj) {
+		tm_node_obj = src_shaper_obj->enclosing_entity;
+		current = tm_node_obj->partition;
+	} else {
+		tm_queue_obj = src_shaper_obj->enclosing_entity;
+		current = tm_queue_obj->partition;
+	}
+
+	if (partition == current)
+		return 0;
+
+	if (odp_atomic_load_u64(&src_tm_wred_node->queue_cnts.pkt_cnt) != 0)
+		return -1;
+
+	tm_subtree_partition_set(src_shaper_obj, partition);
+	return 0;
+}
+
 int odp_tm_node_connect(odp_tm_node_t src_tm_node, odp_tm_node_t dst_tm_node)
 {
 	tm_wred_node_t *src_tm_wred_node, *dst_tm_wred_node;
@@ -4184,6 +4675,12 @@ int odp_tm_node_connect(odp_tm_node_t src_tm_node, odp_tm_node_t dst_tm_node)
 
 	src_tm_wred_node = src_tm_node_obj->tm_wred_node;
 	if (dst_tm_node == ODP_TM_ROOT) {
+		if (tm_subtree_partition_bind(tm_system,
+					      &src_tm_node_obj->shaper_obj,
+					      src_tm_wred_node,
+					      tm_system->root_node))
+			return -1;
+
 		src_tm_node_obj->shaper_obj.next_tm_node = tm_system->root_node;
 		src_tm_wred_node->next_tm_wred_node = NULL;
 		return 0;
@@ -4197,6 +4694,10 @@ int odp_tm_node_connect(odp_tm_node_t src_tm_node, odp_tm_node_t dst_tm_node)
 	if (src_tm_node_obj->tm_idx != dst_tm_node_obj->tm_idx)
 		return -1;
 
+	if (tm_subtree_partition_bind(tm_system, &src_tm_node_obj->shaper_obj,
+				      src_tm_wred_node, dst_tm_node_obj))
+		return -1;
+
 	src_tm_wred_node->next_tm_wred_node      = dst_tm_wred_node;
 	src_tm_node_obj->shaper_obj.next_tm_node = dst_tm_node_obj;
 	dst_tm_node_obj->current_tm_node_fanin++;
@@ -4254,6 +4755,11 @@ int odp_tm_queue_connect(odp_tm_queue_t tm_queue, odp_tm_node_t dst_tm_node)
 	src_tm_wred_node = src_tm_queue_obj->tm_wred_node;
 	if (dst_tm_node == ODP_TM_ROOT) {
 		root_node = tm_system->root_node;
+		if (tm_subtree_partition_bind(tm_system,
+					      &src_tm_queue_obj->shaper_obj,
+					      src_tm_wred_node, root_node))
+			return -1;
+
 		src_tm_queue_obj->shaper_obj.next_tm_node = root_node;
 		src_tm_wred_node->next_tm_wred_node = NULL;
 		return 0;
@@ -4267,6 +4773,10 @@ int odp_tm_queue_connect(odp_tm_queue_t tm_queue, odp_tm_node_t dst_tm_node)
 	if (src_tm_queue_obj->tm_idx != dst_tm_node_obj->tm_idx)
 		return -1;
 
+	if (tm_subtree_partition_bind(tm_system, &src_tm_queue_obj->shaper_obj,
+				      src_tm_wred_node, dst_tm_node_obj))
+		return -1;
+
 	src_tm_wred_node->next_tm_wred_node       = dst_tm_wred_node;
 	src_tm_queue_obj->shaper_obj.next_tm_node = dst_tm_node_obj;
 	dst_tm_node_obj->current_tm_queue_fanin++;
@@ -4348,6 +4858,49 @@ int odp_tm_enq_with_cnt(odp_tm_queue_t tm_queue, odp_packet_t pkt)
 	return pkt_cnt;
 }
 
+int odp_tm_enq_multi(odp_tm_queue_t tm_queue, const odp_packet_t packets[],
+		     int num)
+{
+	tm_queue_obj_t *tm_queue_obj;
+	tm_system_t *tm_system;
+	uint32_t pkt_depth;
+	int num_enq = 0;
+	int burst, rc;
+
+	tm_queue_obj = GET_TM_QUEUE_OBJ(tm_queue);
+	if (!tm_queue_obj)
+		return -1;
+
+	tm_system = odp_tm_systems[tm_queue_obj->tm_idx];
+	if (!tm_system)
+		return -1;
+
+	if (odp_atomic_load_u64(&tm_system->destroying))
+		return -1;
+
+	while (num_enq < num) {
+		burst = num - num_enq;
+		if (burst > TM_MAX_BURST)
+			burst = TM_MAX_BURST;
+
+		rc = tm_enqueue_multi(tm_system, tm_queue_obj,
+				      &packets[num_enq], burst, &pkt_depth);
+		if (rc < 0)
+			break;
+
+		num_enq += rc;
+
+		/* WRED drop or input work queue full */
+		if (rc < burst)
+			break;
+	}
+
+	if (num_enq == 0 && num > 0)
+		return -1;
+
+	return num_enq;
+}
+
 int odp_tm_node_info(odp_tm_node_t tm_node, odp_tm_node_info_t *info)
 {
 	tm_queue_thresholds_t *threshold_params;
@@ -4631,29 +5184,44 @@ void odp_tm_stats_print(odp_tm_t odp_tm)
 {
 	input_work_queue_t *input_work_queue;
 	tm_queue_obj_t *tm_queue_obj;
-	tm_system_t *tm_system;
-	uint32_t queue_num, max_queue_num;
+	tm_system_t *tm_system, *partition;
+	uint32_t queue_num, max_queue_num, queue_cnt, idx;
 
 	tm_system = GET_TM_SYSTEM(odp_tm);
-	input_work_queue = tm_system->input_work_queue;
 
-	ODP_PRINT("odp_tm_stats_print - tm_system=0x%" PRIX64 " tm_idx=%u\n",
-		  odp_tm, tm_system->tm_idx);
-	ODP_PRINT("  input_work_queue size=%u current cnt=%u peak cnt=%u\n",
-		  INPUT_WORK_RING_SIZE, input_work_queue->queue_cnt,
-		  input_work_queue->peak_cnt);
-	ODP_PRINT("  input_work_queue enqueues=%" PRIu64 " dequeues=% " PRIu64
-		  " fail_cnt=%" PRIu64 "\n", input_work_queue->total_enqueues,
-		  input_work_queue->total_dequeues,
-		  input_work_queue->enqueue_fail_cnt);
-	ODP_PRINT("  green_cnt=%" PRIu64 " yellow_cnt=%" PRIu64 " red_cnt=%"
-		  PRIu64 "\n", tm_system->shaper_green_cnt,
-		  tm_system->shaper_yellow_cnt,
-		  tm_system->shaper_red_cnt);
-
-	_odp_pkt_queue_stats_print(tm_system->_odp_int_queue_pool);
-	_odp_timer_wheel_stats_print(tm_system->_odp_int_timer_wheel);
-	_odp_sorted_list_stats_print(tm_system->_odp_int_sorted_pool);
+	ODP_PRINT("odp_tm_stats_print - tm_system=0x%" PRIX64 " tm_idx=%u "
+		  "num_partitions=%u\n", odp_tm, tm_system->tm_idx,
+		  tm_system->num_partitions);
+
+	for (idx = 0; idx < tm_system->num_partitions; idx++) {
+		partition = tm_system->partition[idx];
+		input_work_queue = partition->input_work_queue;
+
+		if (tm_system->num_partitions > 1)
+			ODP_PRINT(" partition %u\n", idx);
+
+		queue_cnt = input_work_queue_cnt(input_work_queue);
+		ODP_PRINT("  input_work_queue size=%u current cnt=%u "
+			  "peak cnt=%u\n", INPUT_WORK_RING_SIZE, queue_cnt,
+			  input_work_queue->peak_cnt);
+		ODP_PRINT("  input_work_queue enqueues=%" PRIu64 " dequeues=% "
+			  PRIu64 " fail_cnt=%" PRIu64 "\n",
+			  input_work_queue->total_dequeues + queue_cnt,
+			  input_work_queue->total_dequeues,
+			  odp_atomic_load_u64(
+				&input_work_queue->enqueue_fail_cnt));
+		ODP_PRINT("  green_cnt=%" PRIu64 " yellow_cnt=%" PRIu64
+			  " red_cnt=%" PRIu64 "\n",
+			  partition->shaper_green_cnt,
+			  partition->shaper_yellow_cnt,
+			  partition->shaper_red_cnt);
+		ODP_PRINT("  shaper delays=%" PRIu64 "\n",
+			  partition->shaper_delay_cnt);
+
+		_odp_pkt_queue_stats_print(partition->_odp_int_queue_pool);
+		_odp_timer_wheel_stats_print(partition->_odp_int_timer_wheel);
+		_odp_sorted_list_stats_print(partition->_odp_int_sorted_pool);
+	}
 
 	max_queue_num = tm_system->next_queue_num;
 	for (queue_num = 1; queue_num < max_queue_num; queue_num++) {
@@ -4670,15 +5238,71 @@ void odp_tm_stats_print(odp_tm_t odp_tm)
 	}
 }
 
+static int read_config_file(void)
+{
+	const char *str;
+	int val = 0;
+
+	ODP_PRINT("Traffic manager config:\n");
+
+	str = "tm.burst_size";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1 || val > TM_MAX_BURST) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	tm_burst_size = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "tm.num_threads";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 1 || val > TM_MAX_PARTITIONS) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	tm_num_threads = val;
+	ODP_PRINT("  %s: %i\n", str, val);
+
+	str = "tm.shaper_slot_ns";
+	if (!_odp_libconfig_lookup_int(str, &val)) {
+		ODP_ERR("Config option '%s' not found.\n", str);
+		return -1;
+	}
+
+	if (val < 0 || val > TM_MAX_SHAPER_SLOT_NS) {
+		ODP_ERR("Bad value %s = %i\n", str, val);
+		return -1;
+	}
+
+	tm_shaper_slot_ns = val;
+	ODP_PRINT("  %s: %i\n\n", str, val);
+
+	return 0;
+}
+
 int odp_tm_init_global(void)
 {
+	if (read_config_file())
+		return -1;
+
 	odp_ticketlock_init(&tm_create_lock);
 	odp_ticketlock_init(&tm_profile_lock);
 	odp_barrier_init(&tm_first_enq, 2);
 
-	odp_atomic_init_u64(&atomic_request_cnt, 0);
-	odp_atomic_init_u64(&currently_serving_cnt, 0);
-	odp_atomic_init_u64(&atomic_done_cnt, 0);
+	odp_ticketlock_init(&tm_request_lock);
+	odp_atomic_init_u32(&tm_request, 0);
+	odp_atomic_init_u32(&tm_threads_running, 0);
+	odp_atomic_init_u32(&tm_threads_parked, 0);
 	return 0;
 }
 
@@ -65,12 +65,13 @@
 #define rte_log_set_global_level rte_set_log_level
 #endif
 
-#if ODP_DPDK_ZERO_COPY
-ODP_STATIC_ASSERT(CONFIG_PACKET_HEADROOM == RTE_PKTMBUF_HEADROOM,
-		  "ODP and DPDK headroom sizes not matching!");
-ODP_STATIC_ASSERT(PKT_EXTRA_LEN >= sizeof(struct rte_mbuf),
-		  "DPDK rte_mbuf won't fit in odp_packet_hdr_t.extra!");
-#endif
+/* Zero-copy mode stores rte_mbuf inside odp_packet_hdr_t.extra and requires
+ * matching ODP and DPDK headroom sizes */
+#define DPDK_ZERO_COPY_CAPA (CONFIG_PACKET_HEADROOM == RTE_PKTMBUF_HEADROOM && \
+			     PKT_EXTRA_LEN >= sizeof(struct rte_mbuf))
+
+/* Name of DPDK mempool operations for ODP pool backed mempools */
+#define DPDK_ODP_POOL_OPS "odp_pool"
 
 /* DPDK poll mode drivers requiring minimum RX burst size DPDK_MIN_RX_BURST */
 #define IXGBE_DRV_NAME "net_ixgbe"
@@ -94,6 +95,7 @@ typedef struct {
 	int num_rx_desc;
 	int num_tx_desc;
 	int rx_drop_en;
+	int zero_copy;
 } dpdk_opt_t;
 
 struct pkt_cache_t {
@@ -121,6 +123,7 @@ typedef struct ODP_ALIGNED_CACHE {
 	uint8_t vdev_sysc_promisc;
 	uint8_t lockless_rx;		  /**< no locking for rx */
 	uint8_t lockless_tx;		  /**< no locking for tx */
+	uint8_t zero_copy;		  /**< zero-copy mode in use */
 	  /** RX queue locks */
 	odp_ticketlock_t ODP_ALIGNED_CACHE rx_lock[PKTIO_MAX_QUEUES];
 	odp_ticketlock_t tx_lock[PKTIO_MAX_QUEUES];  /**< TX queue locks */
@@ -213,11 +216,17 @@ static int init_options(pktio_entry_t *pktio_entry,
 		return -1;
 	opt->rx_drop_en = !!opt->rx_drop_en;
 
+	if (!lookup_opt("zero_copy", dev_info->driver_name,
+			&opt->zero_copy))
+		return -1;
+	opt->zero_copy = !!opt->zero_copy;
+
 	ODP_PRINT("DPDK interface (%s): %" PRIu16 "\n", dev_info->driver_name,
 		  pkt_priv(pktio_entry)->port_id);
 	ODP_PRINT("  num_rx_desc: %d\n", opt->num_rx_desc);
 	ODP_PRINT("  num_tx_desc: %d\n", opt->num_tx_desc);
 	ODP_PRINT("  rx_drop_en: %d\n", opt->rx_drop_en);
+	ODP_PRINT("  zero_copy: %d\n", opt->zero_copy);
 
 	return 0;
 }
@@ -336,7 +345,7 @@ static struct rte_mempool *mbuf_pool_create(const char *name,
 		return NULL;
 	}
 
-	if (rte_mempool_set_ops_byname(mp, "odp_pool", pool_entry)) {
+	if (rte_mempool_set_ops_byname(mp, DPDK_ODP_POOL_OPS, pool_entry)) {
 		ODP_ERR("Failed setting mempool operations\n");
 		return NULL;
 	}
@@ -476,7 +485,7 @@ static struct rte_mempool *pool_create(pool_t *pool)
 }
 
 static struct rte_mempool_ops ops_stack = {
-	.name = "odp_pool",
+	.name = DPDK_ODP_POOL_OPS,
 	.alloc = pool_alloc,
 	.free = pool_free,
 	.enqueue = pool_enqueue,
@@ -486,6 +495,14 @@ static struct rte_mempool_ops ops_stack = {
 
 MEMPOOL_REGISTER_OPS(ops_stack);
 
+/* Prefetch data of a received mbuf and metadata of the packet it is converted
+ * into, PKTIN_PREFETCH_AHEAD packets ahead of the conversion loop */
+static inline void mbuf_prefetch(struct rte_mbuf *mbuf, odp_packet_t pkt)
+{
+	odp_prefetch(rte_pktmbuf_mtod(mbuf, char *));
+	odp_prefetch(packet_hdr(pkt));
+}
+
 static inline int mbuf_to_pkt(pktio_entry_t *pktio_entry,
 			      odp_packet_t pkt_table[],
 			      struct rte_mbuf *mbuf_table[],
@@ -515,9 +532,16 @@ static inline int mbuf_to_pkt(pktio_entry_t *pktio_entry,
 			rte_pktmbuf_free(mbuf_table[i]);
 	}
 
+	for (i = 0; i < num && i < PKTIN_PREFETCH_AHEAD; i++)
+		mbuf_prefetch(mbuf_table[i], pkt_table[i]);
+
 	for (i = 0; i < num; i++) {
 		odp_packet_hdr_t parsed_hdr;
 
+		if (i + PKTIN_PREFETCH_AHEAD < num)
+			mbuf_prefetch(mbuf_table[i + PKTIN_PREFETCH_AHEAD],
+				      pkt_table[i + PKTIN_PREFETCH_AHEAD]);
+
 		mbuf = mbuf_table[i];
 		if (odp_unlikely(mbuf->nb_segs != 1)) {
 			ODP_ERR("Segmented buffers not supported\n");
@@ -525,7 +549,6 @@ static inline int mbuf_to_pkt(pktio_entry_t *pktio_entry,
 		}
 
 		data = rte_pktmbuf_mtod(mbuf, char *);
-		odp_prefetch(data);
 
 		pkt_len = rte_pktmbuf_pkt_len(mbuf);
 
@@ -763,9 +786,18 @@ static inline int mbuf_to_pkt_zero(pktio_entry_t *pktio_entry,
 	odp_proto_layer_t parse_layer = pktio_entry->s.config.parser.layer;
 	odp_pktio_t input = pktio_entry->s.handle;
 
+	for (i = 0; i < mbuf_num && i < PKTIN_PREFETCH_AHEAD; i++)
+		mbuf_prefetch(mbuf_table[i],
+			      (odp_packet_t)mbuf_table[i]->userdata);
+
 	for (i = 0; i < mbuf_num; i++) {
 		odp_packet_hdr_t parsed_hdr;
 
+		if (i + PKTIN_PREFETCH_AHEAD < mbuf_num) {
+			mbuf = mbuf_table[i + PKTIN_PREFETCH_AHEAD];
+			mbuf_prefetch(mbuf, (odp_packet_t)mbuf->userdata);
+		}
+
 		mbuf = mbuf_table[i];
 		if (odp_unlikely(mbuf->nb_segs != 1)) {
 			ODP_ERR("Segmented buffers not supported\n");
@@ -774,7 +806,6 @@ static inline int mbuf_to_pkt_zero(pktio_entry_t *pktio_entry,
 		}
 
 		data = rte_pktmbuf_mtod(mbuf, char *);
-		odp_prefetch(data);
 
 		pkt_len = rte_pktmbuf_pkt_len(mbuf);
 
@@ -860,11 +891,6 @@ static inline int pkt_to_mbuf_zero(pktio_entry_t *pktio_entry,
 		} else {
 			pool_t *pool_entry = pkt_hdr->buf_hdr.pool_ptr;
 
-			if (odp_unlikely(pool_entry->ext_desc == NULL)) {
-				if (pool_create(pool_entry) == NULL)
-					ODP_ABORT("Creating DPDK pool failed");
-			}
-
 			if (pkt_hdr->buf_hdr.segcount != 1 ||
 			    !pool_entry->mem_from_huge_pages) {
 				/* Fall back to packet copy */
@@ -874,6 +900,10 @@ static inline int pkt_to_mbuf_zero(pktio_entry_t *pktio_entry,
 				(*copy_count)++;
 
 			} else {
+				if (odp_unlikely(pool_entry->ext_desc == NULL) &&
+				    pool_create(pool_entry) == NULL)
+					ODP_ABORT("Creating DPDK pool failed");
+
 				mbuf_init((struct rte_mempool *)
 					  pool_entry->ext_desc, mbuf, pkt_hdr);
 				mbuf_update(mbuf, pkt_hdr, pkt_len);
@@ -1234,6 +1264,11 @@ static int dpdk_pktio_init_local(void)
 
 static void dpdk_mempool_free(struct rte_mempool *mp, void *arg ODP_UNUSED)
 {
+	/* ODP pool backed mempools are freed when the ODP pool is destroyed */
+	if (!strcmp(rte_mempool_get_ops(mp->ops_index)->name,
+		    DPDK_ODP_POOL_OPS))
+		return;
+
 	rte_mempool_free(mp);
 }
 
@@ -1250,8 +1285,7 @@ static int dpdk_pktio_term(void)
 	}
 #endif
 
-	if (!ODP_DPDK_ZERO_COPY)
-		rte_mempool_walk(dpdk_mempool_free, NULL);
+	rte_mempool_walk(dpdk_mempool_free, NULL);
 
 	return 0;
 }
@@ -1460,7 +1494,20 @@ static int dpdk_open(odp_pktio_t id ODP_UNUSED,
 	else
 		pkt_dpdk->min_rx_burst = 0;
 
-	if (ODP_DPDK_ZERO_COPY) {
+	/* Zero-copy mode requires that the pool is allocated from huge pages.
+	 * Otherwise, fall back to copy mode. */
+	pkt_dpdk->zero_copy = pkt_dpdk->opt.zero_copy;
+	if (pkt_dpdk->zero_copy && !DPDK_ZERO_COPY_CAPA) {
+		ODP_PRINT("  zero-copy not supported by DPDK build, "
+			  "using copy mode\n");
+		pkt_dpdk->zero_copy = 0;
+	}
+	if (pkt_dpdk->zero_copy && !pool_entry->mem_from_huge_pages) {
+		ODP_PRINT("  pool not from huge pages, using copy mode\n");
+		pkt_dpdk->zero_copy = 0;
+	}
+
+	if (pkt_dpdk->zero_copy) {
 		if (pool_entry->ext_desc != NULL)
 			pkt_pool = (struct rte_mempool *)pool_entry->ext_desc;
 		else
@@ -1669,7 +1716,7 @@ static int dpdk_recv(pktio_entry_t *pktio_entry, int index,
 			ts_val = odp_time_global();
 			ts = &ts_val;
 		}
-		if (ODP_DPDK_ZERO_COPY)
+		if (pkt_dpdk->zero_copy)
 			nb_rx = mbuf_to_pkt_zero(pktio_entry, pkt_table,
 						 rx_mbufs, nb_rx, ts);
 		else
@@ -1693,7 +1740,7 @@ static int dpdk_send(pktio_entry_t *pktio_entry, int index,
 	if (odp_unlikely(pktio_entry->s.state != PKTIO_STATE_STARTED))
 		return 0;
 
-	if (ODP_DPDK_ZERO_COPY)
+	if (pkt_dpdk->zero_copy)
 		mbufs = pkt_to_mbuf_zero(pktio_entry, tx_mbufs, pkt_table, num,
 					 &copy_count);
 	else
@@ -1708,16 +1755,17 @@ static int dpdk_send(pktio_entry_t *pktio_entry, int index,
 	if (!pkt_dpdk->lockless_tx)
 		odp_ticketlock_unlock(&pkt_dpdk->tx_lock[index]);
 
-	if (ODP_DPDK_ZERO_COPY) {
+	if (pkt_dpdk->zero_copy) {
 		/* Free copied packets */
 		if (odp_unlikely(copy_count)) {
 			uint16_t freed = 0;
 
 			for (i = 0; i < mbufs && freed != copy_count; i++) {
 				odp_packet_t pkt = pkt_table[i];
-				odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
 
-				if (pkt_hdr->buf_hdr.segcount > 1) {
+				/* Copied packets are stored in mbufs of other
+				 * packets */
+				if ((odp_packet_t)tx_mbufs[i]->userdata != pkt) {
 					if (odp_likely(i < tx_pkts))
 						odp_packet_free(pkt);
 					else
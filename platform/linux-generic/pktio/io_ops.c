@@ -24,6 +24,7 @@ const pktio_if_ops_t * const pktio_if_ops[]  = {
 	&pcap_pktio_ops,
 #endif
 	&ipc_pktio_ops,
+	&memif_pktio_ops,
 	&tap_pktio_ops,
 	&null_pktio_ops,
 	&sock_mmap_pktio_ops,
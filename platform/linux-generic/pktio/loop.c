@@ -14,11 +14,13 @@
 #include <odp_ipsec_internal.h>
 #include <odp_debug_internal.h>
 #include <odp_errno_define.h>
+#include <odp_pool_internal.h>
+#include <odp_ring_spsc_internal.h>
 #include <odp/api/plat/packet_flag_inlines.h>
 #include <odp/api/hints.h>
 #include <odp/api/plat/byteorder_inlines.h>
+#include <odp/api/plat/ticketlock_inlines.h>
 #include <odp_queue_if.h>
-#include <odp/api/plat/queue_inlines.h>
 
 #include <protocols/eth.h>
 #include <protocols/ip.h>
@@ -31,8 +33,42 @@
 #define MAX_LOOP 16
 #define LOOP_MTU (64 * 1024)
 
+/* Maximum number of input and output queues */
+#define LOOP_MAX_QUEUES 16
+
+/* Number of packets per ring. Must be a power of two. */
+#define LOOP_RING_SIZE 4096
+#define LOOP_RING_MASK (LOOP_RING_SIZE - 1)
+
+/* Per queue state */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;		/**< queue lock, unless lockless */
+	uint32_t next;			/**< next ring to poll (input queue) */
+} loop_queue_t;
+
+/* SPSC ring from one output queue to one input queue */
+typedef struct ODP_ALIGNED_CACHE {
+	ring_spsc_t spsc;
+	uint32_t data[LOOP_RING_SIZE];
+} loop_ring_t;
+
+/* Packet rings are arranged as a matrix with one ring per output and input
+ * queue pair. The output queue is the only producer and the input queue the
+ * only consumer of a ring, so rings need no synchronization of their own. */
+typedef struct {
+	loop_queue_t in[LOOP_MAX_QUEUES];
+	loop_queue_t out[LOOP_MAX_QUEUES];
+	loop_ring_t ring[];		/**< [num_out][num_in] rings */
+} loop_rings_t;
+
 typedef struct {
-	odp_queue_t loopq;		/**< loopback queue for "loop" device */
+	loop_rings_t *rings;		/**< packet rings, NULL before start */
+	odp_shm_t shm;			/**< shm block of packet rings */
+	uint32_t num_in;		/**< number of input queues (rings) */
+	uint32_t num_out;		/**< number of output queues (rings) */
+	odp_bool_t lockless_rx;		/**< no locking for rx */
+	odp_bool_t lockless_tx;		/**< no locking for tx */
+	odp_cls_hash_proto_t hash_proto; /**< input queue hash protocols */
 	odp_bool_t promisc;		/**< promiscuous mode state */
 	uint8_t idx;			/**< index of "loop" device */
 } pkt_loop_t;
@@ -51,11 +87,11 @@ static const char pktio_loop_mac[] = {0x02, 0xe9, 0x34, 0x80, 0x73, 0x01};
 static int loopback_stats_reset(pktio_entry_t *pktio_entry);
 static int loopback_init_capability(pktio_entry_t *pktio_entry);
 
-static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
+static int loopback_open(odp_pktio_t id ODP_UNUSED, pktio_entry_t *pktio_entry,
 			 const char *devname, odp_pool_t pool ODP_UNUSED)
 {
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
 	long idx;
-	char loopq_name[ODP_QUEUE_NAME_LEN];
 
 	if (!strcmp(devname, "loop")) {
 		idx = 0;
@@ -69,14 +105,13 @@ static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
 		return -1;
 	}
 
-	snprintf(loopq_name, sizeof(loopq_name), "%" PRIu64 "-pktio_loopq",
-		 odp_pktio_to_u64(id));
-	pkt_priv(pktio_entry)->loopq =
-		odp_queue_create(loopq_name, NULL);
-	pkt_priv(pktio_entry)->idx = idx;
-
-	if (pkt_priv(pktio_entry)->loopq == ODP_QUEUE_INVALID)
-		return -1;
+	memset(pkt_loop, 0, sizeof(pkt_loop_t));
+	pkt_loop->shm = ODP_SHM_INVALID;
+	pkt_loop->idx = idx;
+	pkt_loop->hash_proto.ipv4 = 1;
+	pkt_loop->hash_proto.ipv6 = 1;
+	pkt_loop->hash_proto.udp = 1;
+	pkt_loop->hash_proto.tcp = 1;
 
 	loopback_stats_reset(pktio_entry);
 	loopback_init_capability(pktio_entry);
@@ -84,31 +119,164 @@ static int loopback_open(odp_pktio_t id, pktio_entry_t *pktio_entry,
 	return 0;
 }
 
+/* Free packets left in the rings and the rings */
+static int loopback_rings_free(pktio_entry_t *pktio_entry)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_rings_t *rings = pkt_loop->rings;
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	uint32_t i, j, num;
+
+	if (rings == NULL)
+		return 0;
+
+	for (i = 0; i < pkt_loop->num_out * pkt_loop->num_in; i++) {
+		while ((num = ring_spsc_deq_multi(&rings->ring[i].spsc,
+						  rings->ring[i].data,
+						  LOOP_RING_MASK, buf_idx,
+						  QUEUE_MULTI_MAX))) {
+			for (j = 0; j < num; j++)
+				odp_packet_free(packet_from_buf_hdr(
+					buf_hdr_from_index_u32(buf_idx[j])));
+		}
+	}
+
+	pkt_loop->rings = NULL;
+
+	if (odp_shm_free(pkt_loop->shm)) {
+		ODP_ERR("shm free failed\n");
+		return -1;
+	}
+
+	pkt_loop->shm = ODP_SHM_INVALID;
+
+	return 0;
+}
+
+static int loopback_rings_alloc(pktio_entry_t *pktio_entry, uint32_t num_in,
+				uint32_t num_out)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_rings_t *rings;
+	char name[ODP_SHM_NAME_LEN];
+	uint64_t size;
+	uint32_t i;
+
+	size = sizeof(loop_rings_t) +
+	       (uint64_t)num_in * num_out * sizeof(loop_ring_t);
+
+	snprintf(name, sizeof(name), "%" PRIu64 "-pktio_loop",
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+
+	pkt_loop->shm = odp_shm_reserve(name, size, ODP_CACHE_LINE_SIZE, 0);
+	if (pkt_loop->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	rings = odp_shm_addr(pkt_loop->shm);
+	memset(rings, 0, sizeof(loop_rings_t));
+
+	for (i = 0; i < LOOP_MAX_QUEUES; i++) {
+		odp_ticketlock_init(&rings->in[i].lock);
+		odp_ticketlock_init(&rings->out[i].lock);
+	}
+
+	for (i = 0; i < num_in * num_out; i++)
+		ring_spsc_init(&rings->ring[i].spsc);
+
+	pkt_loop->num_in = num_in;
+	pkt_loop->num_out = num_out;
+	pkt_loop->rings = rings;
+
+	return 0;
+}
+
 static int loopback_close(pktio_entry_t *pktio_entry)
 {
-	return odp_queue_destroy(pkt_priv(pktio_entry)->loopq);
+	return loopback_rings_free(pktio_entry);
+}
+
+static int loopback_start(pktio_entry_t *pktio_entry)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	uint32_t num_in = pktio_entry->s.num_in_queue;
+	uint32_t num_out = pktio_entry->s.num_out_queue;
+
+	/* Interface with disabled input or output (or output through TM)
+	 * still has one ring */
+	if (num_in == 0)
+		num_in = 1;
+	if (num_out == 0)
+		num_out = 1;
+
+	/* Packets stay in the rings over stop and start, unless the number
+	 * of queues was changed */
+	if (pkt_loop->rings != NULL) {
+		if (num_in == pkt_loop->num_in && num_out == pkt_loop->num_out)
+			return 0;
+
+		if (loopback_rings_free(pktio_entry))
+			return -1;
+	}
+
+	return loopback_rings_alloc(pktio_entry, num_in, num_out);
 }
 
-static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int loopback_recv(pktio_entry_t *pktio_entry, int index,
 			 odp_packet_t pkts[], int num)
 {
-	int nbr, i;
+	int i;
 	odp_buffer_hdr_t *hdr_tbl[QUEUE_MULTI_MAX];
-	odp_queue_t queue;
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_rings_t *rings = pkt_loop->rings;
+	loop_queue_t *queue;
+	odp_pktin_queue_stats_t *stats;
 	odp_packet_hdr_t *pkt_hdr;
 	odp_packet_t pkt;
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
+	uint32_t nbr = 0;
+	uint32_t r, num_out, out;
+	uint64_t octets = 0;
 	int num_rx = 0;
-	int failed = 0;
+	int cls_drops = 0;
+	int alloc_fails = 0;
+
+	if (odp_unlikely(rings == NULL))
+		return 0;
 
 	if (odp_unlikely(num > QUEUE_MULTI_MAX))
 		num = QUEUE_MULTI_MAX;
 
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
+	queue = &rings->in[index];
+	stats = pktio_in_stats(pktio_entry, index);
 
-	queue = pkt_priv(pktio_entry)->loopq;
-	nbr = odp_queue_deq_multi(queue, (odp_event_t *)hdr_tbl, num);
+	if (!pkt_loop->lockless_rx)
+		odp_ticketlock_lock(&queue->lock);
+
+	/* Poll rings from all output queues, starting from the one next to
+	 * the ring that was served first last time */
+	num_out = pkt_loop->num_out;
+	out = queue->next;
+
+	for (r = 0; r < num_out && nbr < (uint32_t)num; r++) {
+		loop_ring_t *ring = &rings->ring[out * pkt_loop->num_in +
+						 index];
+
+		nbr += ring_spsc_deq_multi(&ring->spsc, ring->data,
+					   LOOP_RING_MASK, &buf_idx[nbr],
+					   num - nbr);
+		if (++out == num_out)
+			out = 0;
+	}
+
+	if (++queue->next >= num_out)
+		queue->next = 0;
+
+	for (i = 0; i < (int)nbr; i++)
+		hdr_tbl[i] = buf_hdr_from_index_u32(buf_idx[i]);
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
 	    pktio_entry->s.config.pktin.bit.ts_ptp) {
@@ -116,7 +284,7 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 		ts = &ts_val;
 	}
 
-	for (i = 0; i < nbr; i++) {
+	for (i = 0; i < (int)nbr; i++) {
 		uint32_t pkt_len;
 
 		pkt = packet_from_buf_hdr(hdr_tbl[i]);
@@ -149,7 +317,7 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 						  pkt_len, seg_len,
 						  &new_pool, pkt_hdr, true);
 			if (ret) {
-				failed++;
+				cls_drops++;
 				odp_packet_free(pkt);
 				continue;
 			}
@@ -160,7 +328,7 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 				odp_packet_free(pkt);
 
 				if (new_pkt == ODP_PACKET_INVALID) {
-					failed++;
+					alloc_fails++;
 					continue;
 				}
 				pkt = new_pkt;
@@ -180,14 +348,20 @@ static int loopback_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 		    odp_packet_has_ipsec(pkt))
 			_odp_ipsec_try_inline(&pkt);
 
-		pktio_entry->s.stats.in_octets += pkt_len;
+		octets += pkt_len;
 		pkts[num_rx++] = pkt;
 	}
 
-	pktio_entry->s.stats.in_errors += failed;
-	pktio_entry->s.stats.in_ucast_pkts += num_rx - failed;
+	stats->octets += octets;
+	stats->packets += num_rx;
+	if (odp_unlikely(cls_drops || alloc_fails)) {
+		stats->cls_discards += cls_drops;
+		stats->alloc_fails += alloc_fails;
+		stats->discards += alloc_fails;
+	}
 
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
+	if (!pkt_loop->lockless_rx)
+		odp_ticketlock_unlock(&queue->lock);
 
 	return num_rx;
 }
@@ -280,11 +454,43 @@ static inline void loopback_fix_checksums(odp_packet_t pkt,
 		_odp_packet_sctp_chksum_insert(pkt);
 }
 
-static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+/* Select input queue by flow hash. Packets are parsed into a local header,
+ * since the application may still own the packets (e.g. references). */
+static inline uint32_t loopback_in_queue(pkt_loop_t *pkt_loop,
+					 odp_packet_hdr_t *pkt_hdr)
+{
+	odp_packet_hdr_t parsed_hdr;
+	odp_proto_chksums_t chksums;
+	const uint8_t *data = pkt_hdr->buf_hdr.seg[0].data;
+	uint32_t seg_len = pkt_hdr->buf_hdr.seg[0].len;
+	uint32_t frame_len = pkt_hdr->frame_len;
+
+	/* L3 and L4 headers must be in the first segment */
+	if (odp_unlikely(seg_len < PACKET_PARSE_SEG_LEN &&
+			 seg_len < frame_len))
+		return 0;
+
+	chksums.all_chksum = 0;
+	packet_parse_reset(&parsed_hdr);
+	packet_set_len(&parsed_hdr, frame_len);
+
+	if (packet_parse_common(&parsed_hdr.p, data, frame_len, seg_len,
+				ODP_PROTO_LAYER_L4, chksums) < 0)
+		return 0;
+
+	return packet_rss_hash(&parsed_hdr, pkt_loop->hash_proto, data) %
+	       pkt_loop->num_in;
+}
+
+static int loopback_send(pktio_entry_t *pktio_entry, int index,
 			 const odp_packet_t pkt_tbl[], int num)
 {
-	odp_buffer_hdr_t *hdr_tbl[QUEUE_MULTI_MAX];
-	odp_queue_t queue;
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	loop_rings_t *rings = pkt_loop->rings;
+	loop_queue_t *queue;
+	uint32_t buf_idx[QUEUE_MULTI_MAX];
+	uint32_t in_idx[QUEUE_MULTI_MAX];
+	uint32_t num_in;
 	int i;
 	int ret;
 	int nb_tx = 0;
@@ -294,6 +500,9 @@ static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 	odp_pktout_config_opt_t *pktout_capa =
 		&pktio_entry->s.capa.config.pktout;
 
+	if (odp_unlikely(rings == NULL))
+		return 0;
+
 	if (odp_unlikely(num > QUEUE_MULTI_MAX))
 		num = QUEUE_MULTI_MAX;
 
@@ -307,10 +516,10 @@ static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 			}
 			break;
 		}
-		hdr_tbl[i] = packet_to_buf_hdr(pkt_tbl[i]);
+		buf_idx[i] = packet_to_buf_hdr(pkt_tbl[i])->index.u32;
 		bytes += pkt_len;
 		/* Store cumulative byte counts to update 'stats.out_octets'
-		 * correctly in case enq_multi() fails to enqueue all packets.
+		 * correctly in case not all packets fit into the rings.
 		 */
 		out_octets_tbl[i] = bytes;
 		nb_tx++;
@@ -332,20 +541,55 @@ static int loopback_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 	for (i = 0; i < nb_tx; ++i)
 		loopback_fix_checksums(pkt_tbl[i], pktout_cfg, pktout_capa);
 
-	odp_ticketlock_lock(&pktio_entry->s.txl);
+	num_in = pkt_loop->num_in;
+
+	if (num_in > 1) {
+		for (i = 0; i < nb_tx; ++i)
+			in_idx[i] = loopback_in_queue(pkt_loop,
+						      packet_hdr(pkt_tbl[i]));
+	}
 
-	queue = pkt_priv(pktio_entry)->loopq;
-	ret = odp_queue_enq_multi(queue, (odp_event_t *)hdr_tbl, nb_tx);
+	queue = &rings->out[index];
 
-	if (ret > 0) {
-		pktio_entry->s.stats.out_ucast_pkts += ret;
-		pktio_entry->s.stats.out_octets += out_octets_tbl[ret - 1];
+	if (!pkt_loop->lockless_tx)
+		odp_ticketlock_lock(&queue->lock);
+
+	if (num_in == 1) {
+		loop_ring_t *ring = &rings->ring[index];
+
+		ret = ring_spsc_enq_multi(&ring->spsc, ring->data,
+					  LOOP_RING_MASK, buf_idx, nb_tx);
 	} else {
-		ODP_DBG("queue enqueue failed %i\n", ret);
-		ret = -1;
+		/* Enqueue packets in order, until the first full ring */
+		for (ret = 0; ret < nb_tx; ) {
+			loop_ring_t *ring;
+			uint32_t in = in_idx[ret];
+			int n = 1;
+
+			/* Burst of packets to the same input queue */
+			while (ret + n < nb_tx && in_idx[ret + n] == in)
+				n++;
+
+			ring = &rings->ring[index * num_in + in];
+			n = ring_spsc_enq_multi(&ring->spsc, ring->data,
+						LOOP_RING_MASK, &buf_idx[ret], n);
+			if (n == 0)
+				break;
+
+			ret += n;
+		}
 	}
 
-	odp_ticketlock_unlock(&pktio_entry->s.txl);
+	if (ret > 0) {
+		odp_pktout_queue_stats_t *stats = pktio_out_stats(pktio_entry,
+								  index);
+
+		stats->packets += ret;
+		stats->octets += out_octets_tbl[ret - 1];
+	}
+
+	if (!pkt_loop->lockless_tx)
+		odp_ticketlock_unlock(&queue->lock);
 
 	return ret;
 }
@@ -375,8 +619,8 @@ static int loopback_init_capability(pktio_entry_t *pktio_entry)
 
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
-	capa->max_output_queues = 1;
+	capa->max_input_queues  = LOOP_MAX_QUEUES;
+	capa->max_output_queues = LOOP_MAX_QUEUES;
 	capa->set_op.op.promisc_mode = 1;
 
 	odp_pktio_config_init(&capa->config);
@@ -428,15 +672,70 @@ static int loopback_stats(pktio_entry_t *pktio_entry,
 			  odp_pktio_stats_t *stats)
 {
 	memcpy(stats, &pktio_entry->s.stats, sizeof(odp_pktio_stats_t));
+	_odp_pktio_queue_stats_sum(pktio_entry, stats);
 	return 0;
 }
 
-static int loopback_stats_reset(pktio_entry_t *pktio_entry ODP_UNUSED)
+static int loopback_stats_reset(pktio_entry_t *pktio_entry)
 {
 	memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
 	return 0;
 }
 
+static int loopback_input_queues_config(pktio_entry_t *pktio_entry,
+					const odp_pktin_queue_param_t *param)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_loop->lockless_rx = 1;
+	else if (mode == ODP_PKTIN_MODE_DIRECT)
+		pkt_loop->lockless_rx =
+			(param->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+	else
+		pkt_loop->lockless_rx = 0;
+
+	pkt_loop->hash_proto.all = 0;
+
+	if (param->hash_enable) {
+		const odp_pktin_hash_proto_t *proto = &param->hash_proto;
+
+		pkt_loop->hash_proto.ipv4 = proto->proto.ipv4 ||
+					    proto->proto.ipv4_udp ||
+					    proto->proto.ipv4_tcp;
+		pkt_loop->hash_proto.ipv6 = proto->proto.ipv6 ||
+					    proto->proto.ipv6_udp ||
+					    proto->proto.ipv6_tcp;
+		pkt_loop->hash_proto.udp = proto->proto.ipv4_udp ||
+					   proto->proto.ipv6_udp;
+		pkt_loop->hash_proto.tcp = proto->proto.ipv4_tcp ||
+					   proto->proto.ipv6_tcp;
+	} else {
+		pkt_loop->hash_proto.ipv4 = 1;
+		pkt_loop->hash_proto.ipv6 = 1;
+		pkt_loop->hash_proto.udp = 1;
+		pkt_loop->hash_proto.tcp = 1;
+	}
+
+	return 0;
+}
+
+static int loopback_output_queues_config(pktio_entry_t *pktio_entry,
+					 const odp_pktout_queue_param_t *param)
+{
+	pkt_loop_t *pkt_loop = pkt_priv(pktio_entry);
+
+	/* Output queues in queue mode may be used by multiple threads */
+	pkt_loop->lockless_tx =
+		pktio_entry->s.param.out_mode == ODP_PKTOUT_MODE_DIRECT &&
+		param->op_mode == ODP_PKTIO_OP_MT_UNSAFE;
+
+	return 0;
+}
+
 static int loop_init_global(void)
 {
 	ODP_PRINT("PKTIO: initialized loop interface.\n");
@@ -451,7 +750,7 @@ const pktio_if_ops_t loopback_pktio_ops = {
 	.term = NULL,
 	.open = loopback_open,
 	.close = loopback_close,
-	.start = NULL,
+	.start = loopback_start,
 	.stop = NULL,
 	.stats = loopback_stats,
 	.stats_reset = loopback_stats_reset,
@@ -467,6 +766,6 @@ const pktio_if_ops_t loopback_pktio_ops = {
 	.pktin_ts_res = NULL,
 	.pktin_ts_from_ns = NULL,
 	.config = NULL,
-	.input_queues_config = NULL,
-	.output_queues_config = NULL,
+	.input_queues_config = loopback_input_queues_config,
+	.output_queues_config = loopback_output_queues_config,
 };
@@ -0,0 +1,1765 @@
+/* Copyright (c) 2018, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+/**
+ * @file
+ *
+ * Shared memory packet interface (memif) pktio
+ *
+ * Exchanges packets over shared memory rings with a memif peer on the same
+ * host: VPP, libmemif applications or another ODP process. The interface
+ * connects over a Unix domain control socket either as a master (listens
+ * the socket) or as a slave (connects to the socket). Device name format:
+ *
+ * memif[:socket=<path>][:id=<id>][:secret=<secret>][:master]
+ *
+ * e.g. "memif:socket=/run/vpp/memif.sock:id=1". The slave allocates rings
+ * and buffers into shared memory regions. A slave interface in zero-copy
+ * mode (see pktio_memif.zero_copy) shares its packet pool as a region and
+ * passes packets without copying. Master always copies packets.
+ *
+ * odp_pktio_start() connects the interface and fails until the peer is
+ * present, i.e. the application retries start. After disconnect, the
+ * interface is restarted with odp_pktio_stop() and odp_pktio_start().
+ */
+
+#include "config.h"
+
+#include <odp_posix_extensions.h>
+
+#include <odp_api.h>
+#include <odp_packet_internal.h>
+#include <odp_packet_io_internal.h>
+#include <odp_packet_io_memif_internal.h>
+#include <odp_classification_internal.h>
+#include <odp_debug_internal.h>
+#include <odp_errno_define.h>
+#include <odp_libconfig_internal.h>
+#include <odp_pool_internal.h>
+#include <odp_shm_internal.h>
+#include <odp/api/plat/ticketlock_inlines.h>
+
+#include <errno.h>
+#include <inttypes.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#define MEMIF_DEFAULT_SOCKET "/run/vpp/memif.sock"
+
+/* Name of this end of the connection, passed to the peer */
+#define MEMIF_APP_NAME "odp-linux"
+
+/* Maximum number of input and output queues (rings) */
+#define MEMIF_MAX_QUEUES 16
+
+/* Maximum number of memory regions accepted from a slave */
+#define MEMIF_MAX_REGIONS 4
+
+#define MEMIF_MAX_LOG2_RING_SIZE 14
+
+#define MEMIF_MTU 9216
+
+/* Minimum buffer size, and maximum number of descriptors in a packet */
+#define MEMIF_MIN_BUF_SIZE 128
+#define MEMIF_MAX_CHAIN (MEMIF_MTU / MEMIF_MIN_BUF_SIZE)
+
+/* Control message timeout during connection setup */
+#define MEMIF_MSG_TMO_MS 1000
+
+/* Region of buffers in slave zero-copy mode (the packet pool) */
+#define MEMIF_ZC_REGION 1
+
+/* Memory region shared with the peer */
+typedef struct {
+	uint8_t *addr;			/**< region address, NULL if unmapped */
+	uint64_t size;			/**< region size in bytes */
+} memif_region_t;
+
+/* Per ring state and statistics */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;		/**< queue lock, unless lockless */
+	memif_ring_t *ring;		/**< ring, NULL when not connected */
+	odp_packet_t *pkt;		/**< zero-copy packets of ring slots */
+	uint32_t mask;			/**< ring size - 1 */
+	uint32_t buf_offset;		/**< copy mode buffers of the ring */
+	uint16_t last;			/**< next descriptor to receive or to
+					     reclaim (slave transmit) */
+	int int_fd;			/**< ring interrupt eventfd */
+} memif_queue_t;
+
+typedef struct {
+	memif_queue_t rx[MEMIF_MAX_QUEUES];	/**< rings consumed */
+	memif_queue_t tx[MEMIF_MAX_QUEUES];	/**< rings produced */
+	memif_region_t region[MEMIF_MAX_REGIONS];
+} memif_ctx_t;
+
+typedef struct {
+	memif_ctx_t *ctx;		/**< rings and regions (shm) */
+	odp_shm_t shm;			/**< shm block of ctx */
+	odp_shm_t ring_shm;		/**< slave: region of rings */
+	odp_shm_t slot_shm;		/**< slave zero-copy: packets of ring
+					     slots */
+	odp_pool_t pool;		/**< pool to alloc packets from */
+	pool_t *pool_ptr;		/**< pool of the interface */
+	int listen_fd;			/**< master: listening socket */
+	int fd;				/**< control socket */
+	odp_atomic_u32_t connected;	/**< rings are connected */
+	uint32_t id;			/**< interface id */
+	uint32_t buffer_size;		/**< buffer size */
+	uint32_t num_rx;		/**< number of connected rx rings */
+	uint32_t num_tx;		/**< number of connected tx rings */
+	uint32_t num_regions;		/**< number of regions */
+	uint8_t log2_ring_size;		/**< ring size (config or connected) */
+	uint8_t master;			/**< master (1) or slave (0) */
+	uint8_t zero_copy;		/**< slave zero-copy mode */
+	uint8_t lockless_rx;		/**< no locking for rx */
+	uint8_t lockless_tx_cfg;	/**< output queues are MT unsafe */
+	uint8_t lockless_tx;		/**< no locking for tx */
+	uint8_t secret[MEMIF_SECRET_LEN]; /**< shared secret, zero padded */
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+} pkt_memif_t;
+
+ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_memif_t),
+		  "PKTIO_PRIVATE_SIZE too small");
+
+static inline pkt_memif_t *pkt_priv(pktio_entry_t *pktio_entry)
+{
+	return (pkt_memif_t *)(uintptr_t)(pktio_entry->s.pkt_priv);
+}
+
+/* Size of a ring with descriptors in bytes */
+static inline uint64_t memif_ring_bytes(uint32_t log2_ring_size)
+{
+	return sizeof(memif_ring_t) +
+	       ((uint64_t)sizeof(memif_desc_t) << log2_ring_size);
+}
+
+/* Copy a descriptor from a ring. Peer may rewrite ring descriptors at any
+ * time, so descriptor fields are read exactly once and only the validated
+ * copy is used. */
+static inline void memif_desc_read(const memif_desc_t *ring_desc,
+				   memif_desc_t *desc)
+{
+	const volatile memif_desc_t *src = ring_desc;
+
+	desc->flags = src->flags;
+	desc->region = src->region;
+	desc->length = src->length;
+	desc->offset = src->offset;
+	desc->metadata = src->metadata;
+}
+
+/* Buffer of a descriptor, or NULL if it is outside of the regions. Must be
+ * called with a local copy of a ring descriptor (see memif_desc_read()). */
+static inline uint8_t *memif_desc_buf(pkt_memif_t *memif,
+				      const memif_desc_t *desc)
+{
+	const memif_region_t *region;
+
+	if (odp_unlikely(desc->region >= memif->num_regions))
+		return NULL;
+
+	region = &memif->ctx->region[desc->region];
+
+	if (odp_unlikely((uint64_t)desc->offset + desc->length > region->size))
+		return NULL;
+
+	return region->addr + desc->offset;
+}
+
+static int memif_stats_reset(pktio_entry_t *pktio_entry);
+static int memif_init_capability(pktio_entry_t *pktio_entry);
+
+static int memif_parse_devname(pkt_memif_t *memif, const char *devname)
+{
+	char *tok;
+	char *save;
+	char in[PKTIO_NAME_LEN];
+
+	if (strcmp(devname, "memif") && strncmp(devname, "memif:", 6))
+		return -1;
+
+	snprintf(memif->path, sizeof(memif->path), "%s", MEMIF_DEFAULT_SOCKET);
+	snprintf(in, sizeof(in), "%s", devname);
+
+	for (tok = strtok_r(in + 5, ":", &save); tok;
+	     tok = strtok_r(NULL, ":", &save)) {
+		if (strncmp(tok, "socket=", 7) == 0) {
+			if (strlen(tok + 7) >= sizeof(memif->path)) {
+				ODP_ERR("memif socket path too long\n");
+				return -1;
+			}
+			strcpy(memif->path, tok + 7);
+		} else if (strncmp(tok, "id=", 3) == 0) {
+			memif->id = strtoul(tok + 3, NULL, 0);
+		} else if (strncmp(tok, "secret=", 7) == 0) {
+			if (strlen(tok + 7) > MEMIF_SECRET_LEN) {
+				ODP_ERR("memif secret too long\n");
+				return -1;
+			}
+			memcpy(memif->secret, tok + 7, strlen(tok + 7));
+		} else if (strcmp(tok, "master") == 0) {
+			memif->master = 1;
+		} else if (strcmp(tok, "slave") == 0) {
+			memif->master = 0;
+		} else {
+			ODP_ERR("memif: bad option %s\n", tok);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int memif_read_config(pkt_memif_t *memif)
+{
+	int log2_ring_size, buffer_size, zero_copy;
+
+	if (!_odp_libconfig_lookup_int("pktio_memif.log2_ring_size",
+				       &log2_ring_size) ||
+	    !_odp_libconfig_lookup_int("pktio_memif.buffer_size",
+				       &buffer_size) ||
+	    !_odp_libconfig_lookup_int("pktio_memif.zero_copy", &zero_copy)) {
+		ODP_ERR("Config options 'pktio_memif.*' not found\n");
+		return -1;
+	}
+
+	if (log2_ring_size < 1 || log2_ring_size > MEMIF_MAX_LOG2_RING_SIZE) {
+		ODP_ERR("Bad pktio_memif.log2_ring_size %i\n", log2_ring_size);
+		return -1;
+	}
+
+	if (buffer_size < MEMIF_MIN_BUF_SIZE || buffer_size > MEMIF_MTU) {
+		ODP_ERR("Bad pktio_memif.buffer_size %i\n", buffer_size);
+		return -1;
+	}
+
+	memif->log2_ring_size = log2_ring_size;
+	memif->buffer_size = ROUNDUP_CACHE_LINE(buffer_size);
+
+	/* Buffers of zero-copy mode are the first segments of packets in the
+	 * pool. Descriptor offsets are 32 bits. */
+	if (zero_copy && !memif->master &&
+	    memif->pool_ptr->shm_size <= UINT32_MAX &&
+	    _odp_shm_fd(memif->pool_ptr->shm) >= 0) {
+		memif->zero_copy = 1;
+		memif->buffer_size = memif->pool_ptr->seg_len;
+	}
+
+	return 0;
+}
+
+static int memif_listen(pkt_memif_t *memif)
+{
+	struct sockaddr_un addr;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+	if (fd < 0) {
+		ODP_ERR("socket(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, memif->path);
+
+	/* Remove socket file of a previous master */
+	unlink(memif->path);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+	    listen(fd, 1) < 0) {
+		ODP_ERR("memif socket %s: %s\n", memif->path, strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	memif->listen_fd = fd;
+
+	return 0;
+}
+
+static int memif_open(odp_pktio_t id ODP_UNUSED, pktio_entry_t *pktio_entry,
+		      const char *devname, odp_pool_t pool)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_ctx_t *ctx;
+	char name[ODP_SHM_NAME_LEN];
+	int i;
+
+	memset(memif, 0, sizeof(pkt_memif_t));
+	memif->listen_fd = -1;
+	memif->fd = -1;
+
+	if (memif_parse_devname(memif, devname))
+		return -1;
+
+	memif->pool = pool;
+	memif->pool_ptr = pool_entry_from_hdl(pool);
+	memif->ring_shm = ODP_SHM_INVALID;
+	memif->slot_shm = ODP_SHM_INVALID;
+	odp_atomic_init_u32(&memif->connected, 0);
+
+	if (memif_read_config(memif))
+		return -1;
+
+	snprintf(name, sizeof(name), "%" PRIu64 "-pktio_memif",
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+
+	memif->shm = odp_shm_reserve(name, sizeof(memif_ctx_t),
+				     ODP_CACHE_LINE_SIZE, 0);
+	if (memif->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	ctx = odp_shm_addr(memif->shm);
+	memset(ctx, 0, sizeof(memif_ctx_t));
+
+	for (i = 0; i < MEMIF_MAX_QUEUES; i++) {
+		odp_ticketlock_init(&ctx->rx[i].lock);
+		odp_ticketlock_init(&ctx->tx[i].lock);
+		ctx->rx[i].int_fd = -1;
+		ctx->tx[i].int_fd = -1;
+	}
+
+	memif->ctx = ctx;
+
+	if (memif->master && memif_listen(memif)) {
+		odp_shm_free(memif->shm);
+		return -1;
+	}
+
+	memif_stats_reset(pktio_entry);
+	memif_init_capability(pktio_entry);
+
+	ODP_DBG("memif %s: %s, id %" PRIu32 ", %s\n", memif->path,
+		memif->master ? "master" : "slave", memif->id,
+		memif->zero_copy ? "zero-copy" : "copy");
+
+	return 0;
+}
+
+/* Control message buffer for passing a file descriptor */
+typedef union {
+	char buf[CMSG_SPACE(sizeof(int))];
+	struct cmsghdr align;
+} memif_cmsg_buf_t;
+
+static int memif_msg_send(int fd, const memif_msg_t *msg, int afd)
+{
+	struct msghdr mh;
+	struct iovec iov;
+	memif_cmsg_buf_t ctl;
+
+	memset(&mh, 0, sizeof(mh));
+	iov.iov_base = (void *)(uintptr_t)msg;
+	iov.iov_len = sizeof(memif_msg_t);
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+
+	/* Pass file descriptor to the peer */
+	if (afd >= 0) {
+		struct cmsghdr *cmsg;
+
+		memset(&ctl, 0, sizeof(ctl));
+		mh.msg_control = ctl.buf;
+		mh.msg_controllen = sizeof(ctl);
+		cmsg = CMSG_FIRSTHDR(&mh);
+		cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+		cmsg->cmsg_level = SOL_SOCKET;
+		cmsg->cmsg_type = SCM_RIGHTS;
+		memcpy(CMSG_DATA(cmsg), &afd, sizeof(int));
+	}
+
+	if (sendmsg(fd, &mh, MSG_NOSIGNAL) != sizeof(memif_msg_t)) {
+		ODP_ERR("memif message send failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Receive a control message and the file descriptor passed with it (-1 if
+ * none). Waits up to MEMIF_MSG_TMO_MS. */
+static int memif_msg_recv(int fd, memif_msg_t *msg, int *afd)
+{
+	struct pollfd pfd = {.fd = fd, .events = POLLIN};
+	struct msghdr mh;
+	struct iovec iov;
+	struct cmsghdr *cmsg;
+	memif_cmsg_buf_t ctl;
+	ssize_t ret;
+
+	*afd = -1;
+
+	ret = poll(&pfd, 1, MEMIF_MSG_TMO_MS);
+	if (ret <= 0) {
+		ODP_ERR("memif message receive timeout\n");
+		return -1;
+	}
+
+	memset(&mh, 0, sizeof(mh));
+	iov.iov_base = msg;
+	iov.iov_len = sizeof(memif_msg_t);
+	mh.msg_iov = &iov;
+	mh.msg_iovlen = 1;
+	mh.msg_control = ctl.buf;
+	mh.msg_controllen = sizeof(ctl);
+
+	ret = recvmsg(fd, &mh, MSG_CMSG_CLOEXEC);
+
+	for (cmsg = CMSG_FIRSTHDR(&mh); cmsg; cmsg = CMSG_NXTHDR(&mh, cmsg)) {
+		if (cmsg->cmsg_level == SOL_SOCKET &&
+		    cmsg->cmsg_type == SCM_RIGHTS)
+			memcpy(afd, CMSG_DATA(cmsg), sizeof(int));
+	}
+
+	if (ret != sizeof(memif_msg_t)) {
+		if (ret)
+			ODP_ERR("memif message receive failed\n");
+		if (*afd >= 0)
+			close(*afd);
+		*afd = -1;
+		return -1;
+	}
+
+	if (msg->type == MEMIF_MSG_TYPE_DISCONNECT) {
+		msg->disconnect.string[MEMIF_ERR_STRING_LEN - 1] = 0;
+		ODP_DBG("memif peer disconnected: %s\n",
+			msg->disconnect.string);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int memif_msg_send_type(int fd, uint16_t type)
+{
+	memif_msg_t msg;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = type;
+
+	return memif_msg_send(fd, &msg, -1);
+}
+
+/* Receive a message of the given type without a file descriptor */
+static int memif_msg_recv_type(int fd, memif_msg_t *msg, uint16_t type)
+{
+	int afd;
+
+	if (memif_msg_recv(fd, msg, &afd))
+		return -1;
+
+	if (afd >= 0)
+		close(afd);
+
+	if (msg->type != type) {
+		ODP_ERR("memif: unexpected message %u\n", msg->type);
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Free packets held by a zero-copy ring between two descriptor indexes */
+static void memif_free_slots(memif_queue_t *q, uint16_t first, uint16_t end)
+{
+	odp_packet_t pkt[QUEUE_MULTI_MAX];
+	int num = 0;
+
+	for (; first != end; first++) {
+		uint32_t slot = first & q->mask;
+
+		if (q->pkt[slot] == ODP_PACKET_INVALID)
+			continue;
+
+		pkt[num++] = q->pkt[slot];
+		q->pkt[slot] = ODP_PACKET_INVALID;
+
+		if (num == QUEUE_MULTI_MAX) {
+			odp_packet_free_multi(pkt, num);
+			num = 0;
+		}
+	}
+
+	if (num)
+		odp_packet_free_multi(pkt, num);
+}
+
+/* Tear down connection: notify the peer, free packets held by the rings and
+ * release regions */
+static void memif_disconnect(pktio_entry_t *pktio_entry, const char *reason)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_ctx_t *ctx = memif->ctx;
+	uint32_t i;
+
+	odp_atomic_store_u32(&memif->connected, 0);
+
+	if (memif->fd >= 0) {
+		if (reason) {
+			memif_msg_t msg;
+
+			memset(&msg, 0, sizeof(msg));
+			msg.type = MEMIF_MSG_TYPE_DISCONNECT;
+			snprintf((char *)msg.disconnect.string,
+				 MEMIF_ERR_STRING_LEN, "%s", reason);
+			memif_msg_send(memif->fd, &msg, -1);
+		}
+		close(memif->fd);
+		memif->fd = -1;
+	}
+
+	for (i = 0; i < MEMIF_MAX_QUEUES; i++) {
+		memif_queue_t *rx = &ctx->rx[i];
+		memif_queue_t *tx = &ctx->tx[i];
+
+		if (memif->zero_copy && rx->ring)
+			memif_free_slots(rx, rx->last, rx->ring->head);
+		if (memif->zero_copy && tx->ring)
+			memif_free_slots(tx, tx->last, tx->ring->head);
+
+		if (rx->int_fd >= 0)
+			close(rx->int_fd);
+		if (tx->int_fd >= 0)
+			close(tx->int_fd);
+
+		rx->int_fd = -1;
+		tx->int_fd = -1;
+		rx->ring = NULL;
+		tx->ring = NULL;
+		rx->pkt = NULL;
+		tx->pkt = NULL;
+	}
+
+	if (memif->master) {
+		for (i = 0; i < memif->num_regions; i++) {
+			if (ctx->region[i].addr)
+				munmap(ctx->region[i].addr,
+				       ctx->region[i].size);
+		}
+	} else {
+		if (memif->ring_shm != ODP_SHM_INVALID)
+			odp_shm_free(memif->ring_shm);
+		if (memif->slot_shm != ODP_SHM_INVALID)
+			odp_shm_free(memif->slot_shm);
+		memif->ring_shm = ODP_SHM_INVALID;
+		memif->slot_shm = ODP_SHM_INVALID;
+	}
+
+	memset(ctx->region, 0, sizeof(ctx->region));
+	memif->num_regions = 0;
+	memif->num_rx = 0;
+	memif->num_tx = 0;
+}
+
+/* Number of rings in use for a number of queues */
+static inline uint32_t memif_num_rings(uint32_t num_queues, uint32_t max)
+{
+	if (num_queues == 0)
+		num_queues = 1;
+
+	return num_queues < max ? num_queues : max;
+}
+
+/* Fill slave rx (M2S) ring with empty buffers */
+/* Refill a ring with empty buffers. Returns -1 when zero-copy packet
+ * allocation failed, otherwise 0. */
+static int memif_refill(pkt_memif_t *memif, memif_queue_t *q)
+{
+	memif_ring_t *ring = q->ring;
+	uint16_t head = ring->head;
+	uint32_t num = q->mask + 1 - (uint16_t)(head - q->last);
+	uint32_t buffer_size = memif->buffer_size;
+	uint32_t i;
+	int ret = 0;
+
+	if (num == 0)
+		return 0;
+
+	if (memif->zero_copy) {
+		uint8_t *base = memif->ctx->region[MEMIF_ZC_REGION].addr;
+		odp_packet_t pkt[QUEUE_MULTI_MAX];
+		uint32_t req;
+		int num_alloc;
+
+		while (num) {
+			req = num < QUEUE_MULTI_MAX ? num : QUEUE_MULTI_MAX;
+			num_alloc = packet_alloc_multi(memif->pool, buffer_size,
+						       pkt, req);
+			if (num_alloc <= 0) {
+				ret = -1;
+				break;
+			}
+
+			for (i = 0; i < (uint32_t)num_alloc; i++, head++) {
+				memif_desc_t *desc = &ring->desc[head &
+								 q->mask];
+
+				q->pkt[head & q->mask] = pkt[i];
+				desc->flags = 0;
+				desc->region = MEMIF_ZC_REGION;
+				desc->length = buffer_size;
+				desc->offset =
+					(uint8_t *)odp_packet_data(pkt[i]) -
+					base;
+			}
+
+			if ((uint32_t)num_alloc < req) {
+				ret = -1;
+				break;
+			}
+
+			num -= num_alloc;
+		}
+	} else {
+		for (i = 0; i < num; i++, head++) {
+			memif_desc_t *desc = &ring->desc[head & q->mask];
+
+			desc->flags = 0;
+			desc->region = 0;
+			desc->length = buffer_size;
+			desc->offset = q->buf_offset +
+				       (head & q->mask) * buffer_size;
+		}
+	}
+
+	__atomic_store_n(&ring->head, head, __ATOMIC_RELEASE);
+
+	return ret;
+}
+
+static void memif_ring_init(pkt_memif_t *memif, memif_queue_t *q,
+			    uint8_t *base, uint64_t offset, uint16_t flags,
+			    uint32_t ring_idx, uint64_t buf_base,
+			    odp_packet_t *slot)
+{
+	uint32_t ring_size = 1 << memif->log2_ring_size;
+	uint32_t i;
+
+	q->ring = (memif_ring_t *)(uintptr_t)(base + offset);
+	q->ring->cookie = MEMIF_COOKIE;
+	q->ring->flags = flags;
+	q->ring->head = 0;
+	q->ring->tail = 0;
+	q->mask = ring_size - 1;
+	q->last = 0;
+	q->buf_offset = buf_base +
+			(uint64_t)ring_idx * ring_size * memif->buffer_size;
+	q->pkt = NULL;
+
+	if (slot) {
+		q->pkt = &slot[(uint64_t)ring_idx * ring_size];
+		for (i = 0; i < ring_size; i++)
+			q->pkt[i] = ODP_PACKET_INVALID;
+	}
+}
+
+/* Slave: allocate region of rings (and copy mode buffers) and initialize
+ * rings. Transmit (S2M) rings are placed before receive (M2S) rings. */
+static int memif_slave_alloc(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_ctx_t *ctx = memif->ctx;
+	uint32_t num_rings = memif->num_tx + memif->num_rx;
+	uint64_t ring_bytes = memif_ring_bytes(memif->log2_ring_size);
+	uint64_t buf_base = ROUNDUP_CACHE_LINE(num_rings * ring_bytes);
+	uint64_t size = buf_base;
+	odp_packet_t *slot = NULL;
+	char name[ODP_SHM_NAME_LEN];
+	uint8_t *base;
+	uint32_t i;
+
+	if (!memif->zero_copy)
+		size += ((uint64_t)num_rings << memif->log2_ring_size) *
+			memif->buffer_size;
+
+	if (size > UINT32_MAX) {
+		ODP_ERR("memif region too large\n");
+		return -1;
+	}
+
+	snprintf(name, sizeof(name), "%" PRIu64 "-memif_region",
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+
+	memif->ring_shm = odp_shm_reserve(name, size, ODP_PAGE_SIZE, 0);
+	if (memif->ring_shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	base = odp_shm_addr(memif->ring_shm);
+	ctx->region[0].addr = base;
+	ctx->region[0].size = size;
+	memif->num_regions = 1;
+
+	if (memif->zero_copy) {
+		snprintf(name, sizeof(name), "%" PRIu64 "-memif_slots",
+			 odp_pktio_to_u64(pktio_entry->s.handle));
+
+		memif->slot_shm = odp_shm_reserve(name,
+						  ((uint64_t)num_rings <<
+						   memif->log2_ring_size) *
+						  sizeof(odp_packet_t),
+						  ODP_CACHE_LINE_SIZE, 0);
+		if (memif->slot_shm == ODP_SHM_INVALID) {
+			ODP_ERR("shm reserve failed\n");
+			return -1;
+		}
+
+		slot = odp_shm_addr(memif->slot_shm);
+		ctx->region[MEMIF_ZC_REGION].addr = memif->pool_ptr->base_addr;
+		ctx->region[MEMIF_ZC_REGION].size = memif->pool_ptr->shm_size;
+		memif->num_regions = 2;
+	}
+
+	for (i = 0; i < memif->num_tx; i++)
+		memif_ring_init(memif, &ctx->tx[i], base, i * ring_bytes, 0,
+				i, buf_base, slot);
+
+	/* Receive rings are polled */
+	for (i = 0; i < memif->num_rx; i++)
+		memif_ring_init(memif, &ctx->rx[i], base,
+				(memif->num_tx + i) * ring_bytes,
+				MEMIF_RING_FLAG_MASK_INT, memif->num_tx + i,
+				buf_base, slot);
+
+	for (i = 0; i < num_rings; i++) {
+		memif_queue_t *q = i < memif->num_tx ? &ctx->tx[i] :
+				   &ctx->rx[i - memif->num_tx];
+
+		q->int_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if (q->int_fd < 0) {
+			ODP_ERR("eventfd(): %s\n", strerror(errno));
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int memif_slave_connect(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_ctx_t *ctx = memif->ctx;
+	struct sockaddr_un addr;
+	memif_msg_t msg;
+	uint32_t i;
+	int fd;
+
+	fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+	if (fd < 0) {
+		ODP_ERR("socket(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, memif->path);
+
+	/* Master is not there (yet) */
+	if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		ODP_DBG("memif connect %s: %s\n", memif->path,
+			strerror(errno));
+		close(fd);
+		return -1;
+	}
+
+	memif->fd = fd;
+
+	if (memif_msg_recv_type(fd, &msg, MEMIF_MSG_TYPE_HELLO))
+		return -1;
+
+	if (msg.hello.min_version > MEMIF_VERSION ||
+	    msg.hello.max_version < MEMIF_VERSION) {
+		ODP_ERR("memif: unsupported master version\n");
+		return -1;
+	}
+
+	memif->num_rx = memif_num_rings(pktio_entry->s.num_in_queue,
+					msg.hello.max_m2s_ring + 1);
+	memif->num_tx = memif_num_rings(pktio_entry->s.num_out_queue,
+					msg.hello.max_s2m_ring + 1);
+	if (memif->log2_ring_size > msg.hello.max_log2_ring_size)
+		memif->log2_ring_size = msg.hello.max_log2_ring_size;
+
+	if (memif->zero_copy && msg.hello.max_region < MEMIF_ZC_REGION) {
+		ODP_ERR("memif: master does not accept a zero-copy region\n");
+		return -1;
+	}
+
+	if (memif_slave_alloc(pktio_entry))
+		return -1;
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = MEMIF_MSG_TYPE_INIT;
+	msg.init.version = MEMIF_VERSION;
+	msg.init.id = memif->id;
+	msg.init.mode = MEMIF_INTERFACE_MODE_ETHERNET;
+	memcpy(msg.init.secret, memif->secret, MEMIF_SECRET_LEN);
+	strcpy((char *)msg.init.name, MEMIF_APP_NAME);
+
+	if (memif_msg_send(fd, &msg, -1) ||
+	    memif_msg_recv_type(fd, &msg, MEMIF_MSG_TYPE_ACK))
+		return -1;
+
+	for (i = 0; i < memif->num_regions; i++) {
+		odp_shm_t shm = i == 0 ? memif->ring_shm :
+				memif->pool_ptr->shm;
+
+		memset(&msg, 0, sizeof(msg));
+		msg.type = MEMIF_MSG_TYPE_ADD_REGION;
+		msg.add_region.index = i;
+		msg.add_region.size = ctx->region[i].size;
+
+		if (memif_msg_send(fd, &msg, _odp_shm_fd(shm)) ||
+		    memif_msg_recv_type(fd, &msg, MEMIF_MSG_TYPE_ACK))
+			return -1;
+	}
+
+	for (i = 0; i < memif->num_tx + memif->num_rx; i++) {
+		int s2m = i < memif->num_tx;
+		memif_queue_t *q = s2m ? &ctx->tx[i] :
+				   &ctx->rx[i - memif->num_tx];
+
+		memset(&msg, 0, sizeof(msg));
+		msg.type = MEMIF_MSG_TYPE_ADD_RING;
+		msg.add_ring.flags = s2m ? MEMIF_MSG_ADD_RING_FLAG_S2M : 0;
+		msg.add_ring.index = s2m ? i : i - memif->num_tx;
+		msg.add_ring.region = 0;
+		msg.add_ring.offset = (uint8_t *)q->ring -
+				      ctx->region[0].addr;
+		msg.add_ring.log2_ring_size = memif->log2_ring_size;
+
+		if (memif_msg_send(fd, &msg, q->int_fd) ||
+		    memif_msg_recv_type(fd, &msg, MEMIF_MSG_TYPE_ACK))
+			return -1;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = MEMIF_MSG_TYPE_CONNECT;
+	snprintf((char *)msg.connect.if_name, MEMIF_NAME_LEN, "%s",
+		 pktio_entry->s.name);
+
+	if (memif_msg_send(fd, &msg, -1) ||
+	    memif_msg_recv_type(fd, &msg, MEMIF_MSG_TYPE_CONNECTED))
+		return -1;
+
+	for (i = 0; i < memif->num_rx; i++)
+		(void)memif_refill(memif, &ctx->rx[i]);
+
+	return 0;
+}
+
+/* Master: handle a slave message during connection setup. Returns 1 when
+ * connected, 0 when more messages are expected and -1 on failure. Sets afd
+ * to -1 when the file descriptor is taken into use. */
+static int memif_master_msg(pktio_entry_t *pktio_entry, memif_msg_t *msg,
+			    int *afd, const char **err)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_ctx_t *ctx = memif->ctx;
+	memif_region_t *region;
+	memif_queue_t *q;
+	uint32_t num_in = memif_num_rings(pktio_entry->s.num_in_queue,
+					  MEMIF_MAX_QUEUES);
+	uint32_t num_out = memif_num_rings(pktio_entry->s.num_out_queue,
+					   MEMIF_MAX_QUEUES);
+	uint32_t i;
+
+	switch (msg->type) {
+	case MEMIF_MSG_TYPE_INIT:
+		if (msg->init.version != MEMIF_VERSION) {
+			*err = "Unsupported version";
+			return -1;
+		}
+		if (msg->init.id != memif->id) {
+			*err = "Unknown interface id";
+			return -1;
+		}
+		if (msg->init.mode != MEMIF_INTERFACE_MODE_ETHERNET) {
+			*err = "Unsupported interface mode";
+			return -1;
+		}
+		if (memcmp(msg->init.secret, memif->secret,
+			   MEMIF_SECRET_LEN)) {
+			*err = "Incorrect secret";
+			return -1;
+		}
+		return 0;
+
+	case MEMIF_MSG_TYPE_ADD_REGION:
+		if (*afd < 0 || msg->add_region.index != memif->num_regions ||
+		    msg->add_region.index >= MEMIF_MAX_REGIONS ||
+		    msg->add_region.size == 0) {
+			*err = "Bad region";
+			return -1;
+		}
+
+		region = &ctx->region[memif->num_regions];
+		region->addr = mmap(NULL, msg->add_region.size,
+				    PROT_READ | PROT_WRITE, MAP_SHARED,
+				    *afd, 0);
+		if (region->addr == MAP_FAILED) {
+			region->addr = NULL;
+			*err = "Region mmap failed";
+			return -1;
+		}
+
+		region->size = msg->add_region.size;
+		memif->num_regions++;
+		return 0;
+
+	case MEMIF_MSG_TYPE_ADD_RING:
+		if (msg->add_ring.flags & MEMIF_MSG_ADD_RING_FLAG_S2M) {
+			q = msg->add_ring.index < num_in ?
+			    &ctx->rx[msg->add_ring.index] : NULL;
+		} else {
+			q = msg->add_ring.index < num_out ?
+			    &ctx->tx[msg->add_ring.index] : NULL;
+		}
+
+		if (q == NULL || q->ring || *afd < 0 ||
+		    msg->add_ring.region >= memif->num_regions ||
+		    msg->add_ring.log2_ring_size > MEMIF_MAX_LOG2_RING_SIZE ||
+		    msg->add_ring.private_hdr_size ||
+		    msg->add_ring.offset +
+		    memif_ring_bytes(msg->add_ring.log2_ring_size) >
+		    ctx->region[msg->add_ring.region].size) {
+			*err = "Bad ring";
+			return -1;
+		}
+
+		q->ring = (memif_ring_t *)(uintptr_t)
+			  (ctx->region[msg->add_ring.region].addr +
+			   msg->add_ring.offset);
+		q->mask = (1 << msg->add_ring.log2_ring_size) - 1;
+		q->int_fd = *afd;
+		*afd = -1;
+
+		if (q->ring->cookie != MEMIF_COOKIE) {
+			*err = "Bad ring cookie";
+			return -1;
+		}
+		return 0;
+
+	case MEMIF_MSG_TYPE_CONNECT:
+		for (i = 0; i < num_in && ctx->rx[i].ring; i++)
+			;
+		memif->num_rx = i;
+
+		for (i = 0; i < num_out && ctx->tx[i].ring; i++)
+			;
+		memif->num_tx = i;
+
+		if (memif->num_rx == 0 || memif->num_tx == 0) {
+			*err = "Missing rings";
+			return -1;
+		}
+
+		/* Receive rings are polled */
+		for (i = 0; i < memif->num_rx; i++) {
+			q = &ctx->rx[i];
+			q->ring->flags |= MEMIF_RING_FLAG_MASK_INT;
+			q->last = q->ring->tail;
+		}
+
+		memset(msg, 0, sizeof(memif_msg_t));
+		msg->type = MEMIF_MSG_TYPE_CONNECTED;
+		snprintf((char *)msg->connected.if_name, MEMIF_NAME_LEN, "%s",
+			 pktio_entry->s.name);
+
+		if (memif_msg_send(memif->fd, msg, -1))
+			return -1;
+		return 1;
+
+	default:
+		*err = "Unexpected message";
+		return -1;
+	}
+}
+
+static int memif_master_connect(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	struct pollfd pfd = {.fd = memif->listen_fd, .events = POLLIN};
+	const char *err = NULL;
+	memif_msg_t msg;
+	int afd;
+	int ret;
+
+	/* Slave is not there (yet) */
+	if (poll(&pfd, 1, 0) <= 0)
+		return -1;
+
+	memif->fd = accept(memif->listen_fd, NULL, NULL);
+	if (memif->fd < 0) {
+		ODP_ERR("accept(): %s\n", strerror(errno));
+		return -1;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+	msg.type = MEMIF_MSG_TYPE_HELLO;
+	strcpy((char *)msg.hello.name, MEMIF_APP_NAME);
+	msg.hello.min_version = MEMIF_VERSION;
+	msg.hello.max_version = MEMIF_VERSION;
+	msg.hello.max_region = MEMIF_MAX_REGIONS - 1;
+	msg.hello.max_m2s_ring =
+		memif_num_rings(pktio_entry->s.num_out_queue,
+				MEMIF_MAX_QUEUES) - 1;
+	msg.hello.max_s2m_ring =
+		memif_num_rings(pktio_entry->s.num_in_queue,
+				MEMIF_MAX_QUEUES) - 1;
+	msg.hello.max_log2_ring_size = MEMIF_MAX_LOG2_RING_SIZE;
+
+	if (memif_msg_send(memif->fd, &msg, -1))
+		return -1;
+
+	do {
+		if (memif_msg_recv(memif->fd, &msg, &afd))
+			return -1;
+
+		ret = memif_master_msg(pktio_entry, &msg, &afd, &err);
+
+		/* Region is mapped, or descriptor was not expected */
+		if (afd >= 0)
+			close(afd);
+
+		if (ret < 0) {
+			if (err) {
+				ODP_ERR("memif: %s\n", err);
+				memif_disconnect(pktio_entry, err);
+			}
+			return -1;
+		}
+
+		if (ret == 0 &&
+		    memif_msg_send_type(memif->fd, MEMIF_MSG_TYPE_ACK))
+			return -1;
+	} while (ret == 0);
+
+	return 0;
+}
+
+static int memif_start(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	int ret;
+
+	if (odp_atomic_load_u32(&memif->connected))
+		return 0;
+
+	/* Clean up a connection lost while stopped */
+	memif_disconnect(pktio_entry, NULL);
+
+	if (memif->master)
+		ret = memif_master_connect(pktio_entry);
+	else
+		ret = memif_slave_connect(pktio_entry);
+
+	if (ret) {
+		memif_disconnect(pktio_entry, NULL);
+		return -1;
+	}
+
+	memif->lockless_tx = memif->lockless_tx_cfg &&
+			     pktio_entry->s.num_out_queue <= memif->num_tx;
+
+	odp_atomic_store_u32(&memif->connected, 1);
+
+	ODP_DBG("memif %s connected: %" PRIu32 " rx rings, %" PRIu32
+		" tx rings, %u descriptors\n", memif->path, memif->num_rx,
+		memif->num_tx, memif->ctx->rx[0].mask + 1);
+
+	return 0;
+}
+
+static int memif_stop(pktio_entry_t *pktio_entry)
+{
+	memif_disconnect(pktio_entry, "Interface stopped");
+
+	return 0;
+}
+
+static int memif_close(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	int ret = 0;
+
+	memif_disconnect(pktio_entry, "Interface closed");
+
+	if (memif->listen_fd >= 0) {
+		close(memif->listen_fd);
+		unlink(memif->path);
+	}
+
+	if (odp_shm_free(memif->shm)) {
+		ODP_ERR("shm free failed\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+/* Receive a packet from a chain of descriptors by copying */
+static odp_packet_t memif_rx_copy(pkt_memif_t *memif, memif_queue_t *q,
+				  uint16_t first, uint32_t num_desc,
+				  int *discard)
+{
+	memif_ring_t *ring = q->ring;
+	memif_desc_t desc[MEMIF_MAX_CHAIN];
+	uint8_t *buf[MEMIF_MAX_CHAIN];
+	odp_packet_t pkt;
+	uint32_t len = 0;
+	uint32_t offset = 0;
+	uint32_t i;
+
+	if (odp_unlikely(num_desc > MEMIF_MAX_CHAIN))
+		return ODP_PACKET_INVALID;
+
+	for (i = 0; i < num_desc; i++) {
+		memif_desc_read(&ring->desc[(uint16_t)(first + i) & q->mask],
+				&desc[i]);
+
+		buf[i] = memif_desc_buf(memif, &desc[i]);
+		if (odp_unlikely(buf[i] == NULL ||
+				 desc[i].length > MEMIF_MTU - len))
+			return ODP_PACKET_INVALID;
+
+		len += desc[i].length;
+	}
+
+	if (odp_unlikely(len == 0))
+		return ODP_PACKET_INVALID;
+
+	if (packet_alloc_multi(memif->pool, len, &pkt, 1) != 1) {
+		*discard = 1;
+		return ODP_PACKET_INVALID;
+	}
+
+	for (i = 0; i < num_desc; i++) {
+		if (odp_unlikely(odp_packet_copy_from_mem(pkt, offset,
+							  desc[i].length,
+							  buf[i]))) {
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+		offset += desc[i].length;
+	}
+
+	return pkt;
+}
+
+/* Receive a packet from a chain of pool buffers (slave zero-copy) */
+static odp_packet_t memif_rx_zc(pkt_memif_t *memif, memif_queue_t *q,
+				uint16_t first, uint32_t num_desc)
+{
+	memif_ring_t *ring = q->ring;
+	odp_packet_t pkt = ODP_PACKET_INVALID;
+	int err = 0;
+	uint32_t i;
+
+	for (i = 0; i < num_desc; i++) {
+		uint32_t slot = (uint16_t)(first + i) & q->mask;
+		odp_packet_t seg = q->pkt[slot];
+		uint32_t len = ring->desc[slot].length;
+
+		q->pkt[slot] = ODP_PACKET_INVALID;
+
+		if (odp_unlikely(seg == ODP_PACKET_INVALID))
+			continue;
+
+		if (odp_unlikely(err || len == 0 ||
+				 len > memif->buffer_size)) {
+			err = 1;
+			odp_packet_free(seg);
+			continue;
+		}
+
+		odp_packet_pull_tail(seg, memif->buffer_size - len);
+
+		if (pkt == ODP_PACKET_INVALID) {
+			pkt = seg;
+		} else if (odp_packet_concat(&pkt, seg) < 0) {
+			odp_packet_free(seg);
+			err = 1;
+		}
+	}
+
+	if (odp_unlikely(err || pkt == ODP_PACKET_INVALID)) {
+		if (pkt != ODP_PACKET_INVALID)
+			odp_packet_free(pkt);
+		return ODP_PACKET_INVALID;
+	}
+
+	return pkt;
+}
+
+/* Parse or classify a received packet */
+static odp_packet_t memif_pkt_input(pktio_entry_t *pktio_entry,
+				    odp_pktin_queue_stats_t *stats,
+				    odp_packet_t pkt, odp_time_t *ts)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t len = odp_packet_len(pkt);
+
+	if (pktio_cls_enabled(pktio_entry)) {
+		odp_packet_t new_pkt;
+		odp_pool_t new_pool;
+		uint8_t *pkt_addr;
+		uint8_t buf[PACKET_PARSE_SEG_LEN];
+		uint32_t seg_len = odp_packet_seg_len(pkt);
+
+		/* Make sure there is enough data for the packet
+		 * parser in the case of a segmented packet. */
+		if (odp_unlikely(seg_len < PACKET_PARSE_SEG_LEN &&
+				 len > PACKET_PARSE_SEG_LEN)) {
+			odp_packet_copy_to_mem(pkt, 0, PACKET_PARSE_SEG_LEN,
+					       buf);
+			seg_len = PACKET_PARSE_SEG_LEN;
+			pkt_addr = buf;
+		} else {
+			pkt_addr = odp_packet_data(pkt);
+		}
+
+		if (cls_classify_packet(pktio_entry, pkt_addr, len, seg_len,
+					&new_pool, pkt_hdr, true)) {
+			stats->cls_discards++;
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+
+		if (new_pool != odp_packet_pool(pkt)) {
+			new_pkt = odp_packet_copy(pkt, new_pool);
+
+			odp_packet_free(pkt);
+
+			if (new_pkt == ODP_PACKET_INVALID) {
+				stats->alloc_fails++;
+				stats->discards++;
+				return ODP_PACKET_INVALID;
+			}
+
+			pkt = new_pkt;
+			pkt_hdr = packet_hdr(pkt);
+		}
+	} else {
+		packet_parse_layer(pkt_hdr,
+				   pktio_entry->s.config.parser.layer,
+				   pktio_entry->s.in_chksums);
+	}
+
+	packet_set_ts(pkt_hdr, ts);
+	pkt_hdr->input = pktio_entry->s.handle;
+
+	return pkt;
+}
+
+static int memif_recv(pktio_entry_t *pktio_entry, int index,
+		      odp_packet_t pkts[], int num)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_queue_t *q = &memif->ctx->rx[index];
+	odp_pktin_queue_stats_t *stats = pktio_in_stats(pktio_entry, index);
+	memif_ring_t *ring;
+	odp_time_t ts_val;
+	odp_time_t *ts = NULL;
+	uint64_t octets = 0;
+	uint32_t errors = 0;
+	uint32_t discards = 0;
+	uint16_t last, end, avail;
+	int nb_rx = 0;
+
+	if (odp_unlikely(!odp_atomic_load_u32(&memif->connected)))
+		return 0;
+
+	if (!memif->lockless_rx)
+		odp_ticketlock_lock(&q->lock);
+
+	ring = q->ring;
+	if (odp_unlikely(ring == NULL))
+		goto out;
+
+	/* Slave receives from M2S rings that master fills (tail), master from
+	 * S2M rings that slave fills (head) */
+	last = q->last;
+	if (memif->master)
+		end = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+	else
+		end = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+	avail = end - last;
+	if (odp_unlikely(avail > q->mask + 1))
+		goto out;
+
+	if (pktio_entry->s.config.pktin.bit.ts_all ||
+	    pktio_entry->s.config.pktin.bit.ts_ptp) {
+		ts_val = odp_time_global();
+		ts = &ts_val;
+	}
+
+	while (avail && nb_rx < num) {
+		odp_packet_t pkt;
+		uint32_t num_desc = 1;
+		int discard = 0;
+
+		/* Wait until the whole chain is available */
+		while (num_desc <= avail &&
+		       (ring->desc[(uint16_t)(last + num_desc - 1) &
+				   q->mask].flags & MEMIF_DESC_FLAG_NEXT))
+			num_desc++;
+
+		if (num_desc > avail)
+			break;
+
+		if (memif->zero_copy)
+			pkt = memif_rx_zc(memif, q, last, num_desc);
+		else
+			pkt = memif_rx_copy(memif, q, last, num_desc,
+					    &discard);
+
+		last += num_desc;
+		avail -= num_desc;
+
+		if (odp_unlikely(pkt == ODP_PACKET_INVALID)) {
+			if (discard)
+				discards++;
+			else
+				errors++;
+			continue;
+		}
+
+		octets += odp_packet_len(pkt);
+
+		pkt = memif_pkt_input(pktio_entry, stats, pkt, ts);
+		if (odp_unlikely(pkt == ODP_PACKET_INVALID))
+			continue;
+
+		pkts[nb_rx++] = pkt;
+	}
+
+	q->last = last;
+
+	/* Return buffers to the slave */
+	if (memif->master)
+		__atomic_store_n(&ring->tail, last, __ATOMIC_RELEASE);
+	else if (odp_unlikely(memif_refill(memif, q)))
+		stats->alloc_fails++;
+
+	stats->octets += octets;
+	stats->packets += nb_rx;
+	if (odp_unlikely(errors || discards)) {
+		stats->errors += errors;
+		stats->discards += discards;
+		stats->alloc_fails += discards;
+	}
+
+out:
+	if (!memif->lockless_rx)
+		odp_ticketlock_unlock(&q->lock);
+
+	return nb_rx;
+}
+
+/* Slave zero-copy transmit: pass packet segments in pool buffers. Returns
+ * number of descriptors used, or 0 when the packet does not fit. */
+static uint32_t memif_tx_zc(pkt_memif_t *memif, memif_queue_t *q,
+			    uint16_t slot, uint32_t free, odp_packet_t *pkt_ptr)
+{
+	memif_ring_t *ring = q->ring;
+	uint8_t *base = memif->ctx->region[MEMIF_ZC_REGION].addr;
+	odp_packet_t pkt = *pkt_ptr;
+	odp_packet_seg_t seg;
+	uint32_t num_seg, i;
+
+	/* Packets of other pools are copied into the shared pool */
+	if (odp_unlikely(odp_packet_pool(pkt) != memif->pool)) {
+		pkt = odp_packet_copy(pkt, memif->pool);
+		if (pkt == ODP_PACKET_INVALID)
+			return 0;
+	}
+
+	num_seg = odp_packet_num_segs(pkt);
+	if (odp_unlikely(num_seg > free)) {
+		if (pkt != *pkt_ptr)
+			odp_packet_free(pkt);
+		return 0;
+	}
+
+	seg = odp_packet_first_seg(pkt);
+
+	for (i = 0; i < num_seg; i++, seg = odp_packet_next_seg(pkt, seg)) {
+		uint32_t s = (uint16_t)(slot + i) & q->mask;
+		memif_desc_t *desc = &ring->desc[s];
+
+		desc->flags = i < num_seg - 1 ? MEMIF_DESC_FLAG_NEXT : 0;
+		desc->region = MEMIF_ZC_REGION;
+		desc->length = odp_packet_seg_data_len(pkt, seg);
+		desc->offset = (uint8_t *)odp_packet_seg_data(pkt, seg) - base;
+
+		/* Packet is freed when the last descriptor is released */
+		q->pkt[s] = i < num_seg - 1 ? ODP_PACKET_INVALID : pkt;
+	}
+
+	if (pkt != *pkt_ptr)
+		odp_packet_free(*pkt_ptr);
+
+	return num_seg;
+}
+
+/* Copy a packet into the buffers of descriptors. Slave uses its own buffers
+ * of the ring, master the buffers (and sizes) that slave passed in the
+ * descriptors. Returns number of descriptors used, or 0 when the packet does
+ * not fit. */
+static uint32_t memif_tx_copy(pkt_memif_t *memif, memif_queue_t *q,
+			      uint16_t slot, uint32_t free, odp_packet_t pkt)
+{
+	memif_ring_t *ring = q->ring;
+	memif_desc_t desc[MEMIF_MAX_CHAIN];
+	uint8_t *buf[MEMIF_MAX_CHAIN];
+	uint32_t len = odp_packet_len(pkt);
+	uint32_t num_desc, offset, i;
+	uint64_t size;
+
+	if (memif->master) {
+		for (num_desc = 0, size = 0; size < len || num_desc == 0;
+		     num_desc++) {
+			uint32_t s = (uint16_t)(slot + num_desc) & q->mask;
+
+			if (num_desc == free || num_desc == MEMIF_MAX_CHAIN)
+				return 0;
+
+			memif_desc_read(&ring->desc[s], &desc[num_desc]);
+
+			buf[num_desc] = memif_desc_buf(memif, &desc[num_desc]);
+			if (odp_unlikely(desc[num_desc].length == 0 ||
+					 buf[num_desc] == NULL))
+				return 0;
+
+			size += desc[num_desc].length;
+		}
+	} else {
+		num_desc = len ? (len + memif->buffer_size - 1) /
+				 memif->buffer_size : 1;
+		if (num_desc > free || num_desc > MEMIF_MAX_CHAIN)
+			return 0;
+
+		for (i = 0; i < num_desc; i++) {
+			uint32_t s = (uint16_t)(slot + i) & q->mask;
+
+			desc[i].region = 0;
+			desc[i].offset = q->buf_offset + s * memif->buffer_size;
+			desc[i].length = memif->buffer_size;
+			buf[i] = memif_desc_buf(memif, &desc[i]);
+			if (odp_unlikely(buf[i] == NULL))
+				return 0;
+		}
+	}
+
+	for (i = 0, offset = 0; i < num_desc; i++) {
+		memif_desc_t *ring_desc = &ring->desc[(uint16_t)(slot + i) &
+						      q->mask];
+		uint32_t seg_len;
+
+		seg_len = len - offset < desc[i].length ? len - offset :
+			  desc[i].length;
+
+		if (odp_unlikely(odp_packet_copy_to_mem(pkt, offset, seg_len,
+							buf[i])))
+			return 0;
+
+		if (!memif->master) {
+			ring_desc->region = desc[i].region;
+			ring_desc->offset = desc[i].offset;
+		}
+		ring_desc->length = seg_len;
+		ring_desc->flags = i < num_desc - 1 ? MEMIF_DESC_FLAG_NEXT : 0;
+		offset += seg_len;
+	}
+
+	return num_desc;
+}
+
+static int memif_send(pktio_entry_t *pktio_entry, int index,
+		      const odp_packet_t pkt_tbl[], int num)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	memif_queue_t *q;
+	memif_ring_t *ring;
+	odp_packet_t pkt[num];
+	uint64_t octets = 0;
+	uint16_t slot, tail;
+	uint32_t free;
+	int nb_tx;
+
+	if (odp_unlikely(!odp_atomic_load_u32(&memif->connected)))
+		return 0;
+
+	q = &memif->ctx->tx[index % memif->num_tx];
+
+	if (!memif->lockless_tx)
+		odp_ticketlock_lock(&q->lock);
+
+	ring = q->ring;
+
+	/* Master fills empty buffers that slave has produced (head) and
+	 * slave produces into free descriptors that master has released
+	 * (tail) */
+	if (memif->master) {
+		slot = ring->tail;
+		free = (uint16_t)(__atomic_load_n(&ring->head,
+						  __ATOMIC_ACQUIRE) - slot);
+	} else {
+		tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+		if (memif->zero_copy) {
+			memif_free_slots(q, q->last, tail);
+			q->last = tail;
+		}
+		slot = ring->head;
+		free = q->mask + 1 - (uint16_t)(slot - tail);
+	}
+
+	if (odp_unlikely(free > q->mask + 1))
+		free = 0;
+
+	for (nb_tx = 0; nb_tx < num; nb_tx++) {
+		uint32_t len = odp_packet_len(pkt_tbl[nb_tx]);
+		uint32_t num_desc;
+
+		if (odp_unlikely(len > MEMIF_MTU)) {
+			if (nb_tx == 0) {
+				if (!memif->lockless_tx)
+					odp_ticketlock_unlock(&q->lock);
+				__odp_errno = EMSGSIZE;
+				return -1;
+			}
+			break;
+		}
+
+		pkt[nb_tx] = pkt_tbl[nb_tx];
+
+		if (memif->zero_copy)
+			num_desc = memif_tx_zc(memif, q, slot, free,
+					       &pkt[nb_tx]);
+		else
+			num_desc = memif_tx_copy(memif, q, slot, free,
+						 pkt[nb_tx]);
+
+		if (num_desc == 0)
+			break;
+
+		slot += num_desc;
+		free -= num_desc;
+		octets += len;
+	}
+
+	if (nb_tx) {
+		if (memif->master)
+			__atomic_store_n(&ring->tail, slot, __ATOMIC_RELEASE);
+		else
+			__atomic_store_n(&ring->head, slot, __ATOMIC_RELEASE);
+
+		/* Wake up the peer, unless it polls the ring */
+		if (!(ring->flags & MEMIF_RING_FLAG_MASK_INT)) {
+			uint64_t one = 1;
+
+			if (write(q->int_fd, &one, sizeof(one)) < 0)
+				ODP_DBG("memif interrupt failed\n");
+		}
+
+		odp_pktout_queue_stats_t *stats = pktio_out_stats(pktio_entry,
+								  index);
+
+		stats->packets += nb_tx;
+		stats->octets += octets;
+	}
+
+	if (!memif->lockless_tx)
+		odp_ticketlock_unlock(&q->lock);
+
+	/* Zero-copy packets are freed when the master releases them */
+	if (!memif->zero_copy && nb_tx)
+		odp_packet_free_multi(pkt, nb_tx);
+
+	return nb_tx;
+}
+
+static uint32_t memif_mtu_get(pktio_entry_t *pktio_entry ODP_UNUSED)
+{
+	return MEMIF_MTU;
+}
+
+static int memif_mac_addr_get(pktio_entry_t *pktio_entry, void *mac_addr)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	uint8_t *mac = mac_addr;
+
+	/* Locally administered address from the interface id */
+	mac[0] = 0x02;
+	mac[1] = 0xfe;
+	mac[2] = memif->master;
+	mac[3] = memif->id >> 16;
+	mac[4] = memif->id >> 8;
+	mac[5] = memif->id;
+
+	return ETH_ALEN;
+}
+
+static int memif_link_status(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	struct pollfd pfd = {.fd = memif->fd, .events = POLLIN};
+	memif_msg_t msg;
+	int afd;
+
+	if (!odp_atomic_load_u32(&memif->connected))
+		return 0;
+
+	/* Any message or hang up of the peer means disconnect. Rings stay
+	 * mapped until the interface is stopped. */
+	if (poll(&pfd, 1, 0) > 0) {
+		if (memif_msg_recv(memif->fd, &msg, &afd) == 0 && afd >= 0)
+			close(afd);
+		odp_atomic_store_u32(&memif->connected, 0);
+		close(memif->fd);
+		memif->fd = -1;
+		return 0;
+	}
+
+	return 1;
+}
+
+static int memif_init_capability(pktio_entry_t *pktio_entry)
+{
+	odp_pktio_capability_t *capa = &pktio_entry->s.capa;
+
+	memset(capa, 0, sizeof(odp_pktio_capability_t));
+
+	capa->max_input_queues  = MEMIF_MAX_QUEUES;
+	capa->max_output_queues = MEMIF_MAX_QUEUES;
+
+	odp_pktio_config_init(&capa->config);
+	capa->config.pktin.bit.ts_all = 1;
+	capa->config.pktin.bit.ts_ptp = 1;
+	capa->config.pktin.bit.ipv4_chksum = 1;
+	capa->config.pktin.bit.tcp_chksum = 1;
+	capa->config.pktin.bit.udp_chksum = 1;
+	capa->config.pktin.bit.sctp_chksum = 1;
+
+	return 0;
+}
+
+static int memif_capability(pktio_entry_t *pktio_entry,
+			    odp_pktio_capability_t *capa)
+{
+	*capa = pktio_entry->s.capa;
+	return 0;
+}
+
+static int memif_stats(pktio_entry_t *pktio_entry, odp_pktio_stats_t *stats)
+{
+	memcpy(stats, &pktio_entry->s.stats, sizeof(odp_pktio_stats_t));
+	_odp_pktio_queue_stats_sum(pktio_entry, stats);
+	return 0;
+}
+
+static int memif_stats_reset(pktio_entry_t *pktio_entry)
+{
+	memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
+	return 0;
+}
+
+static int memif_input_queues_config(pktio_entry_t *pktio_entry,
+				     const odp_pktin_queue_param_t *param)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		memif->lockless_rx = 1;
+	else if (mode == ODP_PKTIN_MODE_DIRECT)
+		memif->lockless_rx = (param->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+	else
+		memif->lockless_rx = 0;
+
+	return 0;
+}
+
+static int memif_output_queues_config(pktio_entry_t *pktio_entry,
+				      const odp_pktout_queue_param_t *param)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+
+	/* Output queues in queue mode may be used by multiple threads. Queues
+	 * share rings when master provides less rings than there are queues
+	 * (see memif_start()). */
+	memif->lockless_tx_cfg =
+		pktio_entry->s.param.out_mode == ODP_PKTOUT_MODE_DIRECT &&
+		param->op_mode == ODP_PKTIO_OP_MT_UNSAFE;
+
+	return 0;
+}
+
+static void memif_print(pktio_entry_t *pktio_entry)
+{
+	pkt_memif_t *memif = pkt_priv(pktio_entry);
+
+	ODP_PRINT("  socket          %s\n", memif->path);
+	ODP_PRINT("  role            %s\n", memif->master ? "master" : "slave");
+	ODP_PRINT("  id              %" PRIu32 "\n", memif->id);
+	ODP_PRINT("  mode            %s\n",
+		  memif->zero_copy ? "zero-copy" : "copy");
+	ODP_PRINT("  buffer size     %" PRIu32 "\n", memif->buffer_size);
+	ODP_PRINT("  connected       %" PRIu32 "\n",
+		  odp_atomic_load_u32(&memif->connected));
+	ODP_PRINT("  rx rings        %" PRIu32 "\n", memif->num_rx);
+	ODP_PRINT("  tx rings        %" PRIu32 "\n", memif->num_tx);
+}
+
+static int memif_init_global(void)
+{
+	ODP_PRINT("PKTIO: initialized memif interface.\n");
+	return 0;
+}
+
+const pktio_if_ops_t memif_pktio_ops = {
+	.name = "memif",
+	.print = memif_print,
+	.init_global = memif_init_global,
+	.init_local = NULL,
+	.term = NULL,
+	.open = memif_open,
+	.close = memif_close,
+	.start = memif_start,
+	.stop = memif_stop,
+	.stats = memif_stats,
+	.stats_reset = memif_stats_reset,
+	.recv = memif_recv,
+	.send = memif_send,
+	.mtu_get = memif_mtu_get,
+	.promisc_mode_set = NULL,
+	.promisc_mode_get = NULL,
+	.mac_get = memif_mac_addr_get,
+	.mac_set = NULL,
+	.link_status = memif_link_status,
+	.capability = memif_capability,
+	.pktin_ts_res = NULL,
+	.pktin_ts_from_ns = NULL,
+	.config = NULL,
+	.input_queues_config = memif_input_queues_config,
+	.output_queues_config = memif_output_queues_config,
+};
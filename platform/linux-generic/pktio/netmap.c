@@ -759,15 +759,25 @@ static inline int netmap_pkt_to_odp(pktio_entry_t *pktio_entry,
 
 	num = packet_alloc_multi(pool, alloc_len, pkt_tbl, slot_num);
 
+	for (i = 0; i < num && i < PKTIN_PREFETCH_AHEAD; i++) {
+		odp_prefetch(slot_tbl[i].buf);
+		odp_prefetch(packet_hdr(pkt_tbl[i]));
+	}
+
 	for (i = 0; i < num; i++) {
 		netmap_slot_t slot;
 		uint16_t len;
 
+		if (i + PKTIN_PREFETCH_AHEAD < num) {
+			int ahead = i + PKTIN_PREFETCH_AHEAD;
+
+			odp_prefetch(slot_tbl[ahead].buf);
+			odp_prefetch(packet_hdr(pkt_tbl[ahead]));
+		}
+
 		slot = slot_tbl[i];
 		len = slot.len;
 
-		odp_prefetch(slot.buf);
-
 		if (pktio_cls_enabled(pktio_entry)) {
 			if (cls_classify_packet(pktio_entry,
 						(const uint8_t *)slot.buf, len,
@@ -895,6 +905,30 @@ static int netmap_fd_set(pktio_entry_t *pktio_entry, int index, fd_set *readfds)
 	return max_fd;
 }
 
+static int netmap_pktin_fds(pktio_entry_t *pktio_entry, int index, int fds[],
+			    int num)
+{
+	pkt_netmap_t *pkt_nm = pkt_priv(pktio_entry);
+	uint32_t first_desc_id = pkt_nm->rx_desc_ring[index].s.first;
+	int num_desc = pkt_nm->rx_desc_ring[index].s.num;
+	struct nm_desc **desc;
+	int i;
+
+	if (odp_unlikely(pktio_entry->s.state != PKTIO_STATE_STARTED))
+		return 0;
+
+	if (num_desc > num)
+		return -1;
+
+	desc = &pkt_nm->rx_desc_ring[index].s.desc[first_desc_id];
+
+	/* Descriptors are opened on start and closed on stop */
+	for (i = 0; i < num_desc; i++)
+		fds[i] = desc[i]->fd;
+
+	return num_desc;
+}
+
 static int netmap_recv(pktio_entry_t *pktio_entry, int index,
 		       odp_packet_t pkt_table[], int num)
 {
@@ -1211,7 +1245,7 @@ const pktio_if_ops_t netmap_pktio_ops = {
 	.recv_tmo = netmap_recv_tmo,
 	.recv_mq_tmo = netmap_recv_mq_tmo,
 	.send = netmap_send,
-	.fd_set = netmap_fd_set
+	.pktin_fds = netmap_pktin_fds
 };
 
 #endif /* ODP_NETMAP */
@@ -20,6 +20,7 @@
  * with "pcap:" and be in the format;
  *
  * pcap:in=test.pcap:out=test_out.pcap:loops=10
+ * pcap:in=trace.pcap:preload=1:speed=2.5:loops=0
  *
  *   in      the name of the input pcap file. If no input file is given
  *           attempts to receive from the pktio will just return no
@@ -32,6 +33,19 @@
  *           be overwritten.
  *   loops   the number of times to iterate through the input file, set
  *           to 0 to loop indefinitely. The default value is 1.
+ *   preload set to 1 to read the whole input file into memory when the
+ *           pktio is opened (replay mode). Packets are then received in
+ *           bursts without file I/O, and the interface supports multiple
+ *           input queues. Packets are distributed to input queues by flow
+ *           hash (IPv4/IPv6 addresses and TCP/UDP ports by default, or the
+ *           protocols of odp_pktin_queue_param_t hash_proto), so that
+ *           packets of a flow are received in order from one queue. Each
+ *           queue loops through its own packets. Promiscuous mode changes
+ *           take effect on the next start.
+ *   speed   in replay mode, pace packet delivery by the capture
+ *           timestamps, scaled by this speed factor (e.g. 2.0 replays the
+ *           trace twice as fast as it was captured). The default value 0
+ *           delivers packets as fast as they are received.
  *
  * The total length of the string is limited by PKTIO_NAME_LEN.
  */
@@ -45,10 +59,48 @@
 
 #include <protocols/eth.h>
 
+#include <odp_classification_internal.h>
+#include <odp_pool_internal.h>
+
 #include <errno.h>
+#include <inttypes.h>
+#include <stdlib.h>
 #include <pcap/pcap.h>
 #include <pcap/bpf.h>
 
+/* Preloaded packet of a replay mode trace */
+typedef struct {
+	uint64_t ts_ns;		/**< capture time relative to first packet */
+	uint64_t offset;	/**< offset of packet data in replay buffer */
+	uint32_t len;		/**< packet data length */
+	uint32_t flow_hash;	/**< flow hash of the packet */
+} pcap_rec_t;
+
+/* Replay mode input queue */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;	/**< rx lock, when not lockless */
+	uint32_t *rec_idx;	/**< records of this queue in trace order */
+	uint32_t num_rec;	/**< number of records */
+	uint32_t next;		/**< next record to receive */
+	int loop_cnt;		/**< number of loops completed */
+} pcap_queue_t;
+
+/* Replay mode state */
+typedef struct {
+	uint8_t *data;		/**< packet data of all records */
+	pcap_rec_t *rec;	/**< records in trace order */
+	uint32_t num_rec;	/**< number of records */
+	uint32_t max_len;	/**< largest packet data length */
+	uint64_t loop_ns;	/**< trace time advance per loop */
+	uint64_t start_ns;	/**< local time at pktio start */
+	double ns_scale;	/**< 1 / speed, 0 when not paced */
+	uint32_t seg_len;	/**< pool segment length */
+	uint32_t num_queues;	/**< number of input queues */
+	odp_bool_t lockless;	/**< no locking for rx */
+	odp_cls_hash_proto_t hash_proto; /**< flow hash protocols */
+	pcap_queue_t queue[PKTIO_MAX_QUEUES];
+} pcap_replay_t;
+
 typedef struct {
 	char *fname_rx;		/**< name of pcap file for rx */
 	char *fname_tx;		/**< name of pcap file for tx */
@@ -60,6 +112,9 @@ typedef struct {
 	int loops;		/**< number of times to loop rx pcap */
 	int loop_cnt;		/**< number of loops completed */
 	odp_bool_t promisc;	/**< promiscuous mode state */
+	odp_bool_t preload;	/**< replay mode */
+	double speed;		/**< replay speed factor */
+	pcap_replay_t *replay;	/**< replay mode state */
 } pkt_pcap_t;
 
 ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_pcap_t),
@@ -98,9 +153,22 @@ static int _pcapif_parse_devname(pkt_pcap_t *pcap, const char *devname)
 				ODP_ERR("invalid loop count\n");
 				return -1;
 			}
+		} else if (strncmp(tok, "preload=", 8) == 0) {
+			pcap->preload = atoi(tok + 8) != 0;
+		} else if (strncmp(tok, "speed=", 6) == 0) {
+			pcap->speed = atof(tok + 6);
+			if (pcap->speed < 0) {
+				ODP_ERR("invalid speed\n");
+				return -1;
+			}
 		}
 	}
 
+	if (pcap->speed > 0 && !pcap->preload) {
+		ODP_ERR("speed requires preload=1\n");
+		return -1;
+	}
+
 	return 0;
 }
 
@@ -125,6 +193,106 @@ static int _pcapif_init_rx(pkt_pcap_t *pcap)
 	return 0;
 }
 
+/* Read all packets of the input file into memory */
+static int _pcapif_preload(pkt_pcap_t *pcap)
+{
+	pcap_replay_t *replay;
+	struct pcap_pkthdr *hdr;
+	const u_char *data;
+	pcap_rec_t *rec;
+	uint64_t first_ns = 0, ts_ns, data_size = 0, data_max = 0;
+	uint32_t rec_max = 0;
+	void *tmp;
+	int ret;
+
+	replay = calloc(1, sizeof(pcap_replay_t));
+	if (!replay) {
+		ODP_ERR("failed to malloc replay state\n");
+		return -1;
+	}
+
+	pcap->replay = replay;
+
+	while ((ret = pcap_next_ex(pcap->rx, &hdr, &data)) == 1) {
+		if (replay->num_rec == rec_max) {
+			rec_max = rec_max ? 2 * rec_max : 1024;
+			tmp = realloc(replay->rec, rec_max * sizeof(pcap_rec_t));
+			if (!tmp)
+				goto nomem;
+			replay->rec = tmp;
+		}
+
+		if (data_size + hdr->caplen > data_max) {
+			data_max = data_max ? 2 * data_max : 1024 * 1024;
+			while (data_size + hdr->caplen > data_max)
+				data_max *= 2;
+			tmp = realloc(replay->data, data_max);
+			if (!tmp)
+				goto nomem;
+			replay->data = tmp;
+		}
+
+		ts_ns = hdr->ts.tv_sec * ODP_TIME_SEC_IN_NS +
+			hdr->ts.tv_usec * ODP_TIME_USEC_IN_NS;
+		if (replay->num_rec == 0)
+			first_ns = ts_ns;
+
+		rec = &replay->rec[replay->num_rec++];
+		/* Clamp out of order timestamps */
+		rec->ts_ns = ts_ns > first_ns ? ts_ns - first_ns : 0;
+		if (replay->num_rec > 1 && rec->ts_ns < rec[-1].ts_ns)
+			rec->ts_ns = rec[-1].ts_ns;
+		rec->offset = data_size;
+		rec->len = hdr->caplen;
+		memcpy(&replay->data[data_size], data, hdr->caplen);
+		data_size += hdr->caplen;
+
+		if (hdr->caplen > replay->max_len)
+			replay->max_len = hdr->caplen;
+	}
+
+	if (ret != -2) {
+		ODP_ERR("failed to read pcap file %s (%s)\n",
+			pcap->fname_rx, pcap_geterr(pcap->rx));
+		return -1;
+	}
+
+	/* Next loop starts one average packet gap after the last packet */
+	if (replay->num_rec > 1) {
+		rec = &replay->rec[replay->num_rec - 1];
+		replay->loop_ns = rec->ts_ns +
+				  rec->ts_ns / (replay->num_rec - 1);
+	}
+
+	replay->ns_scale = pcap->speed > 0 ? 1.0 / pcap->speed : 0;
+	replay->seg_len = pool_entry_from_hdl(pcap->pool)->seg_len;
+	replay->num_queues = 1;
+	replay->hash_proto.ipv4 = 1;
+	replay->hash_proto.ipv6 = 1;
+	replay->hash_proto.udp = 1;
+	replay->hash_proto.tcp = 1;
+
+	ODP_DBG("preloaded %u packets (%" PRIu64 " bytes) from %s\n",
+		replay->num_rec, data_size, pcap->fname_rx);
+	return 0;
+
+nomem:
+	ODP_ERR("failed to malloc replay buffer\n");
+	return -1;
+}
+
+static void _pcapif_replay_free(pcap_replay_t *replay)
+{
+	uint32_t i;
+
+	for (i = 0; i < PKTIO_MAX_QUEUES; i++)
+		free(replay->queue[i].rec_idx);
+
+	free(replay->rec);
+	free(replay->data);
+	free(replay);
+}
+
 static int _pcapif_init_tx(pkt_pcap_t *pcap)
 {
 	pcap_t *tx = pcap->rx;
@@ -174,6 +342,9 @@ static int pcapif_init(odp_pktio_t id ODP_UNUSED, pktio_entry_t *pktio_entry,
 	if (ret == 0 && pcap->fname_rx)
 		ret = _pcapif_init_rx(pcap);
 
+	if (ret == 0 && pcap->rx && pcap->preload)
+		ret = _pcapif_preload(pcap);
+
 	if (ret == 0 && pcap->fname_tx)
 		ret = _pcapif_init_tx(pcap);
 
@@ -198,6 +369,9 @@ static int pcapif_close(pktio_entry_t *pktio_entry)
 	if (pcap->rx)
 		pcap_close(pcap->rx);
 
+	if (pcap->replay)
+		_pcapif_replay_free(pcap->replay);
+
 	free(pcap->buf);
 	free(pcap->fname_rx);
 	free(pcap->fname_tx);
@@ -225,7 +399,130 @@ static int _pcapif_reopen(pkt_pcap_t *pcap)
 	return 0;
 }
 
-static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+/* Get the next packet of a replay queue. Returns NULL at the end of the last
+ * loop. */
+static inline pcap_rec_t *_pcapif_replay_next(pkt_pcap_t *pcap,
+					      pcap_queue_t *queue,
+					      uint32_t *next, int *loop_cnt)
+{
+	if (odp_unlikely(*next == queue->num_rec)) {
+		if (queue->num_rec == 0 ||
+		    (pcap->loops != 0 && *loop_cnt + 1 >= pcap->loops))
+			return NULL;
+
+		(*loop_cnt)++;
+		*next = 0;
+	}
+
+	return &pcap->replay->rec[queue->rec_idx[(*next)++]];
+}
+
+static int pcapif_replay_recv(pktio_entry_t *pktio_entry, int index,
+			      odp_packet_t pkts[], int num)
+{
+	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
+	pcap_replay_t *replay = pcap->replay;
+	pcap_queue_t *queue = &replay->queue[index];
+	pcap_rec_t *rec[num];
+	odp_packet_hdr_t *pkt_hdr;
+	odp_time_t ts_val;
+	odp_time_t *ts = NULL;
+	uint64_t now_ns = 0, octets = 0;
+	uint32_t next, alloc_len = 0;
+	int i, n, loop_cnt;
+
+	if (!replay->lockless)
+		odp_ticketlock_lock(&queue->lock);
+
+	if (odp_unlikely(pktio_entry->s.state != PKTIO_STATE_STARTED)) {
+		n = 0;
+		goto unlock;
+	}
+
+	if (replay->ns_scale != 0)
+		now_ns = odp_time_to_ns(odp_time_local()) - replay->start_ns;
+
+	/* Pick packets that are due, without consuming them yet */
+	next = queue->next;
+	loop_cnt = queue->loop_cnt;
+	for (n = 0; n < num; n++) {
+		rec[n] = _pcapif_replay_next(pcap, queue, &next, &loop_cnt);
+		if (rec[n] == NULL)
+			break;
+
+		if (replay->ns_scale != 0 &&
+		    (uint64_t)((loop_cnt * replay->loop_ns + rec[n]->ts_ns) *
+			       replay->ns_scale) > now_ns)
+			break;
+
+		if (rec[n]->len > alloc_len)
+			alloc_len = rec[n]->len;
+	}
+
+	if (n == 0)
+		goto unlock;
+
+	/* Allocate the whole burst with the largest length and trim packets
+	 * afterwards, unless that would need more than one segment */
+	if (alloc_len <= replay->seg_len) {
+		n = packet_alloc_multi(pcap->pool, alloc_len, pkts, n);
+	} else {
+		for (i = 0; i < n; i++)
+			if (packet_alloc_multi(pcap->pool, rec[i]->len,
+					       &pkts[i], 1) != 1)
+				break;
+		n = i;
+	}
+
+	if (odp_unlikely(n <= 0)) {
+		pktio_in_stats(pktio_entry, index)->alloc_fails++;
+		n = 0;
+		goto unlock;
+	}
+
+	if (pktio_entry->s.config.pktin.bit.ts_all ||
+	    pktio_entry->s.config.pktin.bit.ts_ptp) {
+		ts_val = odp_time_global();
+		ts = &ts_val;
+	}
+
+	for (i = 0; i < n; i++) {
+		pkt_hdr = packet_hdr(pkts[i]);
+
+		if (alloc_len <= replay->seg_len) {
+			pull_tail(pkt_hdr, alloc_len - rec[i]->len);
+			memcpy(odp_packet_data(pkts[i]),
+			       &replay->data[rec[i]->offset], rec[i]->len);
+		} else {
+			odp_packet_copy_from_mem(pkts[i], 0, rec[i]->len,
+						 &replay->data[rec[i]->offset]);
+		}
+
+		packet_parse_layer(pkt_hdr,
+				   pktio_entry->s.config.parser.layer,
+				   pktio_entry->s.in_chksums);
+		packet_set_flow_hash(pkt_hdr, rec[i]->flow_hash);
+		packet_set_ts(pkt_hdr, ts);
+		pkt_hdr->input = pktio_entry->s.handle;
+		octets += rec[i]->len;
+	}
+
+	/* Consume received packets */
+	for (i = 0; i < n; i++)
+		_pcapif_replay_next(pcap, queue, &queue->next,
+				    &queue->loop_cnt);
+
+	pktio_in_stats(pktio_entry, index)->octets += octets;
+	pktio_in_stats(pktio_entry, index)->packets += n;
+
+unlock:
+	if (!replay->lockless)
+		odp_ticketlock_unlock(&queue->lock);
+
+	return n;
+}
+
+static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index,
 			   odp_packet_t pkts[], int num)
 {
 	int i;
@@ -235,9 +532,13 @@ static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 	odp_packet_hdr_t *pkt_hdr;
 	uint32_t pkt_len;
 	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
+	odp_pktin_queue_stats_t *stats = pktio_in_stats(pktio_entry, index);
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
 
+	if (pcap->replay)
+		return pcapif_replay_recv(pktio_entry, index, pkts, num);
+
 	odp_ticketlock_lock(&pktio_entry->s.rxl);
 
 	if (pktio_entry->s.state != PKTIO_STATE_STARTED || !pcap->rx) {
@@ -263,8 +564,11 @@ static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 		pkt_len = hdr->caplen;
 
 		ret = packet_alloc_multi(pcap->pool, pkt_len, &pkt, 1);
-		if (odp_unlikely(ret != 1))
+		if (odp_unlikely(ret != 1)) {
+			stats->alloc_fails++;
+			stats->discards++;
 			break;
+		}
 
 		if (ts != NULL)
 			ts_val = odp_time_global();
@@ -279,7 +583,7 @@ static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 		packet_parse_layer(pkt_hdr,
 				   pktio_entry->s.config.parser.layer,
 				   pktio_entry->s.in_chksums);
-		pktio_entry->s.stats.in_octets += pkt_hdr->frame_len;
+		stats->octets += pkt_hdr->frame_len;
 
 		packet_set_ts(pkt_hdr, ts);
 		pkt_hdr->input = pktio_entry->s.handle;
@@ -288,7 +592,7 @@ static int pcapif_recv_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 
 		i++;
 	}
-	pktio_entry->s.stats.in_ucast_pkts += i;
+	stats->packets += i;
 
 	odp_ticketlock_unlock(&pktio_entry->s.rxl);
 
@@ -315,10 +619,11 @@ static int _pcapif_dump_pkt(pkt_pcap_t *pcap, odp_packet_t pkt)
 	return 0;
 }
 
-static int pcapif_send_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int pcapif_send_pkt(pktio_entry_t *pktio_entry, int index,
 			   const odp_packet_t pkts[], int num)
 {
 	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
+	odp_pktout_queue_stats_t *stats = pktio_out_stats(pktio_entry, index);
 	int i;
 
 	odp_ticketlock_lock(&pktio_entry->s.txl);
@@ -339,14 +644,16 @@ static int pcapif_send_pkt(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 			break;
 		}
 
-		if (_pcapif_dump_pkt(pcap, pkts[i]) != 0)
+		if (_pcapif_dump_pkt(pcap, pkts[i]) != 0) {
+			stats->errors++;
 			break;
+		}
 
-		pktio_entry->s.stats.out_octets += pkt_len;
+		stats->octets += pkt_len;
 		odp_packet_free(pkts[i]);
 	}
 
-	pktio_entry->s.stats.out_ucast_pkts += i;
+	stats->packets += i;
 
 	odp_ticketlock_unlock(&pktio_entry->s.txl);
 
@@ -366,12 +673,13 @@ static int pcapif_mac_addr_get(pktio_entry_t *pktio_entry ODP_UNUSED,
 	return _ODP_ETHADDR_LEN;
 }
 
-static int pcapif_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
+static int pcapif_capability(pktio_entry_t *pktio_entry,
 			     odp_pktio_capability_t *capa)
 {
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
+	capa->max_input_queues  = pkt_priv(pktio_entry)->replay ?
+				  PKTIO_MAX_QUEUES : 1;
 	capa->max_output_queues = 1;
 	capa->set_op.op.promisc_mode = 1;
 
@@ -381,19 +689,12 @@ static int pcapif_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
 	return 0;
 }
 
-static int pcapif_promisc_mode_set(pktio_entry_t *pktio_entry,
-				   odp_bool_t enable)
+static int _pcapif_filter_compile(pkt_pcap_t *pcap, struct bpf_program *bpf,
+				  odp_bool_t promisc)
 {
 	char filter_exp[64] = {0};
-	struct bpf_program bpf;
-	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
-
-	if (!pcap->rx) {
-		pcap->promisc = enable;
-		return 0;
-	}
 
-	if (!enable) {
+	if (!promisc) {
 		char mac_str[18];
 
 		snprintf(mac_str, sizeof(mac_str),
@@ -406,19 +707,40 @@ static int pcapif_promisc_mode_set(pktio_entry_t *pktio_entry,
 			 mac_str);
 	}
 
-	if (pcap_compile(pcap->rx, &bpf, filter_exp,
+	if (pcap_compile(pcap->rx, bpf, filter_exp,
 			 0, PCAP_NETMASK_UNKNOWN) != 0) {
 		ODP_ERR("failed to compile promisc mode filter: %s\n",
 			pcap_geterr(pcap->rx));
 		return -1;
 	}
 
+	return 0;
+}
+
+static int pcapif_promisc_mode_set(pktio_entry_t *pktio_entry,
+				   odp_bool_t enable)
+{
+	struct bpf_program bpf;
+	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
+
+	/* Replay mode filters packets when the pktio is started */
+	if (!pcap->rx || pcap->replay) {
+		pcap->promisc = enable;
+		return 0;
+	}
+
+	if (_pcapif_filter_compile(pcap, &bpf, enable))
+		return -1;
+
 	if (pcap_setfilter(pcap->rx, &bpf) != 0) {
 		ODP_ERR("failed to set promisc mode filter: %s\n",
 			pcap_geterr(pcap->rx));
+		pcap_freecode(&bpf);
 		return -1;
 	}
 
+	pcap_freecode(&bpf);
+
 	pcap->promisc = enable;
 
 	return 0;
@@ -439,6 +761,146 @@ static int pcapif_stats(pktio_entry_t *pktio_entry,
 			odp_pktio_stats_t *stats)
 {
 	memcpy(stats, &pktio_entry->s.stats, sizeof(odp_pktio_stats_t));
+	_odp_pktio_queue_stats_sum(pktio_entry, stats);
+	return 0;
+}
+
+static int pcapif_input_queues_config(pktio_entry_t *pktio_entry,
+				      const odp_pktin_queue_param_t *param)
+{
+	pcap_replay_t *replay = pkt_priv(pktio_entry)->replay;
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+
+	if (!replay)
+		return 0;
+
+	replay->num_queues = param->num_queues ? param->num_queues : 1;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		replay->lockless = 1;
+	else
+		replay->lockless = (param->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+
+	replay->hash_proto.all = 0;
+	if (param->hash_enable) {
+		replay->hash_proto.ipv4 = param->hash_proto.proto.ipv4 ||
+					  param->hash_proto.proto.ipv4_udp ||
+					  param->hash_proto.proto.ipv4_tcp;
+		replay->hash_proto.ipv6 = param->hash_proto.proto.ipv6 ||
+					  param->hash_proto.proto.ipv6_udp ||
+					  param->hash_proto.proto.ipv6_tcp;
+		replay->hash_proto.udp = param->hash_proto.proto.ipv4_udp ||
+					 param->hash_proto.proto.ipv6_udp;
+		replay->hash_proto.tcp = param->hash_proto.proto.ipv4_tcp ||
+					 param->hash_proto.proto.ipv6_tcp;
+	} else {
+		replay->hash_proto.ipv4 = 1;
+		replay->hash_proto.ipv6 = 1;
+		replay->hash_proto.udp = 1;
+		replay->hash_proto.tcp = 1;
+	}
+
+	return 0;
+}
+
+/* Distribute preloaded packets to input queues by flow hash and apply the
+ * promiscuous mode filter. Receive starts again from the beginning of the
+ * trace. */
+static int pcapif_start(pktio_entry_t *pktio_entry)
+{
+	pkt_pcap_t *pcap = pkt_priv(pktio_entry);
+	pcap_replay_t *replay = pcap->replay;
+	odp_packet_hdr_t parsed_hdr;
+	odp_proto_chksums_t chksums;
+	struct bpf_program bpf;
+	struct pcap_pkthdr hdr;
+	pcap_queue_t *queue;
+	pcap_rec_t *rec;
+	const uint8_t *data;
+	uint8_t *rec_queue;
+	uint32_t i, q;
+
+	if (!replay)
+		return 0;
+
+	rec_queue = malloc(replay->num_rec ? replay->num_rec : 1);
+	if (!rec_queue) {
+		ODP_ERR("failed to malloc queue map\n");
+		return -1;
+	}
+
+	if (!pcap->promisc && _pcapif_filter_compile(pcap, &bpf, 0)) {
+		free(rec_queue);
+		return -1;
+	}
+
+	for (q = 0; q < PKTIO_MAX_QUEUES; q++) {
+		queue = &replay->queue[q];
+		free(queue->rec_idx);
+		queue->rec_idx = NULL;
+		queue->num_rec = 0;
+		queue->next = 0;
+		queue->loop_cnt = 0;
+		odp_ticketlock_init(&queue->lock);
+	}
+
+	chksums.all_chksum = 0;
+
+	for (i = 0; i < replay->num_rec; i++) {
+		rec = &replay->rec[i];
+		data = &replay->data[rec->offset];
+
+		if (!pcap->promisc) {
+			memset(&hdr, 0, sizeof(hdr));
+			hdr.caplen = rec->len;
+			hdr.len = rec->len;
+			if (!pcap_offline_filter(&bpf, &hdr, data)) {
+				rec_queue[i] = UINT8_MAX;
+				continue;
+			}
+		}
+
+		packet_parse_reset(&parsed_hdr);
+		packet_set_len(&parsed_hdr, rec->len);
+		packet_parse_common(&parsed_hdr.p, data, rec->len, rec->len,
+				    ODP_PROTO_LAYER_L4, chksums);
+		rec->flow_hash = packet_rss_hash(&parsed_hdr,
+						 replay->hash_proto, data);
+
+		q = rec->flow_hash % replay->num_queues;
+		rec_queue[i] = q;
+		replay->queue[q].num_rec++;
+	}
+
+	if (!pcap->promisc)
+		pcap_freecode(&bpf);
+
+	for (q = 0; q < replay->num_queues; q++) {
+		queue = &replay->queue[q];
+		queue->rec_idx = malloc((queue->num_rec ? queue->num_rec : 1) *
+					sizeof(uint32_t));
+		if (!queue->rec_idx) {
+			ODP_ERR("failed to malloc queue records\n");
+			free(rec_queue);
+			return -1;
+		}
+
+		queue->num_rec = 0;
+	}
+
+	for (i = 0; i < replay->num_rec; i++) {
+		if (rec_queue[i] == UINT8_MAX)
+			continue;
+
+		queue = &replay->queue[rec_queue[i]];
+		queue->rec_idx[queue->num_rec++] = i;
+	}
+
+	free(rec_queue);
+	replay->start_ns = odp_time_to_ns(odp_time_local());
+
 	return 0;
 }
 
@@ -455,6 +917,8 @@ const pktio_if_ops_t pcap_pktio_ops = {
 	.init_local = NULL,
 	.open = pcapif_init,
 	.close = pcapif_close,
+	.start = pcapif_start,
+	.stop = NULL,
 	.stats = pcapif_stats,
 	.stats_reset = pcapif_stats_reset,
 	.recv = pcapif_recv_pkt,
@@ -468,6 +932,6 @@ const pktio_if_ops_t pcap_pktio_ops = {
 	.pktin_ts_res = NULL,
 	.pktin_ts_from_ns = NULL,
 	.config = NULL,
-	.input_queues_config = NULL,
+	.input_queues_config = pcapif_input_queues_config,
 	.output_queues_config = NULL,
 };
@@ -7,47 +7,163 @@
 
 #include "config.h"
 
+#include <odp_posix_extensions.h>
+
 #include <odp_packet_io_internal.h>
+#include <odp_debug_internal.h>
+#include <odp/api/time.h>
+
 #include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <time.h>
+#include <unistd.h>
+
+/* Max number of file descriptors a thread waits on */
+#define PKTIN_WAIT_MAX_FD 64
+
+/* Max time to block at once. Callers poll the queues between waits, which
+ * bounds the delay in noticing e.g. a restarted interface. */
+#define PKTIN_WAIT_MAX_NS (100 * ODP_TIME_MSEC_IN_NS)
+
+/* Epoll set of the queues this thread waited on last. Applications typically
+ * wait on the same queues repeatedly, so the set is rebuilt only when queues
+ * or their file descriptors change. */
+typedef struct {
+	int epfd;
+	uint32_t num_q;
+	uint32_t num_fd;
+	struct {
+		pktio_entry_t *entry;
+		int index;
+		uint32_t fd_gen;
+	} queue[PKTIN_WAIT_MAX_FD];
+	int fd[PKTIN_WAIT_MAX_FD];
+} pktin_wait_set_t;
+
+static __thread pktin_wait_set_t wait_set = { .epfd = -1 };
+
+static int wait_set_build(pktin_wait_set_t *ws, pktio_entry_t *entry[],
+			  const int index[], uint32_t num_q,
+			  const int fd[], uint32_t num_fd)
+{
+	struct epoll_event ev;
+	uint32_t i;
+
+	if (ws->epfd >= 0)
+		close(ws->epfd);
+
+	ws->num_q = 0;
+	ws->num_fd = 0;
+	ws->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (ws->epfd < 0) {
+		ODP_ERR("epoll_create1() failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	for (i = 0; i < num_fd; i++) {
+		memset(&ev, 0, sizeof(ev));
+		ev.events = EPOLLIN;
+		ev.data.fd = fd[i];
+
+		/* Queues may share a file descriptor */
+		if (epoll_ctl(ws->epfd, EPOLL_CTL_ADD, fd[i], &ev) &&
+		    errno != EEXIST) {
+			ODP_ERR("epoll_ctl() failed: %s\n", strerror(errno));
+			close(ws->epfd);
+			ws->epfd = -1;
+			return -1;
+		}
+		ws->fd[i] = fd[i];
+	}
+
+	for (i = 0; i < num_q; i++) {
+		ws->queue[i].entry = entry[i];
+		ws->queue[i].index = index[i];
+		ws->queue[i].fd_gen = entry[i]->s.fd_gen;
+	}
 
-static int sock_recv_mq_tmo_select(pktio_entry_t * const *entry,
-				   const int index[],
-				   unsigned num_q, unsigned *from,
-				   odp_packet_t packets[], int num,
-				   uint64_t usecs, fd_set *readfds,
-				   int maxfd)
+	ws->num_q = num_q;
+	ws->num_fd = num_fd;
+
+	return 0;
+}
+
+int _odp_pktin_fd_wait(pktio_entry_t *entry[], const int index[],
+		       uint32_t num_q, uint64_t nsec)
 {
-	struct timeval timeout;
-	unsigned i;
+	pktin_wait_set_t *ws = &wait_set;
+	int fd[PKTIN_WAIT_MAX_FD];
+	uint32_t num_fd = 0;
+	uint32_t i;
+	int changed;
 	int ret;
+	struct pollfd pfd;
+	struct timespec ts;
+
+	if (num_q > PKTIN_WAIT_MAX_FD)
+		return -1;
+
+	changed = ws->epfd < 0 || num_q != ws->num_q;
 
 	for (i = 0; i < num_q; i++) {
-		ret = entry[i]->s.ops->recv(entry[i], index[i], packets, num);
+		const pktio_if_ops_t *ops = entry[i]->s.ops;
+
+		if (ops->pktin_fds == NULL)
+			return -1;
+
+		ret = ops->pktin_fds(entry[i], index[i], &fd[num_fd],
+				     PKTIN_WAIT_MAX_FD - num_fd);
+		if (ret <= 0)
+			return -1;
 
-		if (ret > 0 && from)
-			*from = i;
+		num_fd += ret;
 
-		if (ret != 0)
-			return ret;
+		if (!changed && (ws->queue[i].entry != entry[i] ||
+				 ws->queue[i].index != index[i] ||
+				 ws->queue[i].fd_gen != entry[i]->s.fd_gen))
+			changed = 1;
 	}
 
-	timeout.tv_sec = usecs / (1000 * 1000);
-	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
+	if (changed || num_fd != ws->num_fd ||
+	    memcmp(fd, ws->fd, num_fd * sizeof(int))) {
+		if (wait_set_build(ws, entry, index, num_q, fd, num_fd))
+			return -1;
+	}
 
-	if (select(maxfd + 1, readfds, NULL, NULL, &timeout) == 0)
-		return 0;
+	if (nsec > PKTIN_WAIT_MAX_NS)
+		nsec = PKTIN_WAIT_MAX_NS;
 
-	for (i = 0; i < num_q; i++) {
-		ret = entry[i]->s.ops->recv(entry[i], index[i], packets, num);
+	ts.tv_sec = nsec / ODP_TIME_SEC_IN_NS;
+	ts.tv_nsec = nsec - ts.tv_sec * ODP_TIME_SEC_IN_NS;
 
-		if (ret > 0 && from)
-			*from = i;
+	/* Epoll fd is readable when any of the fds in the set is. Use ppoll()
+	 * on it for a nanosecond resolution timeout. */
+	pfd.fd = ws->epfd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
 
-		if (ret != 0)
-			return ret;
+	ret = ppoll(&pfd, 1, &ts, NULL);
+	if (ret < 0) {
+		if (errno == EINTR)
+			return 0;
+
+		ODP_ERR("ppoll() failed: %s\n", strerror(errno));
+		return -1;
 	}
 
-	return 0;
+	return ret > 0;
+}
+
+void _odp_pktin_fd_wait_term_local(void)
+{
+	if (wait_set.epfd >= 0)
+		close(wait_set.epfd);
+
+	wait_set.epfd = -1;
+	wait_set.num_q = 0;
+	wait_set.num_fd = 0;
 }
 
 int sock_recv_mq_tmo_try_int_driven(const struct odp_pktin_queue_t queues[],
@@ -58,16 +174,13 @@ int sock_recv_mq_tmo_try_int_driven(const struct odp_pktin_queue_t queues[],
 	unsigned i;
 	pktio_entry_t *entry[num_q];
 	int index[num_q];
-	fd_set readfds;
-	int maxfd = -1;
 	int (*impl)(pktio_entry_t *entry[], int index[], int num_q,
 		    odp_packet_t packets[], int num, unsigned *from,
 		    uint64_t wait_usecs) = NULL;
-	int impl_set = 0;
 
 	/* First, we get pktio entries and queue indices. We then see if the
-	   implementation function pointers are the same. If they are the
-	   same, impl will be set to non-NULL; otherwise it will be NULL. */
+	   implementation function pointers are the same. If they are not, the
+	   caller waits on queue file descriptors or polls. */
 
 	for (i = 0; i < num_q; i++) {
 		entry[i] = get_pktio_entry(queues[i].pktio);
@@ -78,58 +191,19 @@ int sock_recv_mq_tmo_try_int_driven(const struct odp_pktin_queue_t queues[],
 			*trial_successful = 0;
 			return -1;
 		}
-		if (entry[i]->s.ops->recv_mq_tmo == NULL &&
-		    entry[i]->s.ops->fd_set == NULL) {
+		if (entry[i]->s.ops->recv_mq_tmo == NULL ||
+		    (impl != NULL && impl != entry[i]->s.ops->recv_mq_tmo)) {
 			*trial_successful = 0;
 			return 0;
 		}
-		if (!impl_set) {
-			impl = entry[i]->s.ops->recv_mq_tmo;
-			impl_set = 1;
-		} else {
-			if (impl != entry[i]->s.ops->recv_mq_tmo) {
-				impl = NULL;
-				break;
-			}
-		}
-	}
-
-	/* Check whether we can call the compatible implementation */
-	if (impl != NULL) {
-		*trial_successful = 1;
-		return impl(entry, index, num_q, packets, num, from, usecs);
-	}
-
-	/* Get file descriptor sets of devices. maxfd will be -1 if this
-	   fails. */
-	FD_ZERO(&readfds);
-	for (i = 0; i < num_q; i++) {
-		if (entry[i]->s.ops->fd_set) {
-			int maxfd2;
-
-			maxfd2 = entry[i]->s.ops->fd_set(
-				entry[i], queues[i].index, &readfds);
-			if (maxfd2 < 0) {
-				maxfd = -1;
-				break;
-			}
-			if (maxfd2 > maxfd)
-				maxfd = maxfd2;
-		} else {
-			maxfd = -1;
-		}
+		impl = entry[i]->s.ops->recv_mq_tmo;
 	}
 
-	/* Check whether we can call the select() implementation */
-	if (maxfd >= 0) {
-		*trial_successful = 1;
-		return sock_recv_mq_tmo_select(entry, index, num_q, from,
-					       packets, num, usecs,
-					       &readfds, maxfd);
+	if (impl == NULL) {
+		*trial_successful = 0;
+		return 0;
 	}
 
-	/* No mechanism worked. Set trial_successful to 0 so that polling will
-	   be used by the main implementation. */
-	*trial_successful = 0;
-	return 0;
+	*trial_successful = 1;
+	return impl(entry, index, num_q, packets, num, from, usecs);
 }
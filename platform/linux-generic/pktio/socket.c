@@ -33,6 +33,7 @@
 #include <sys/syscall.h>
 #include <linux/ethtool.h>
 #include <linux/sockios.h>
+#include <linux/virtio_net.h>
 
 #include <odp_api.h>
 #include <odp_packet_socket.h>
@@ -46,6 +47,7 @@
 #include <odp_classification_datamodel.h>
 #include <odp_classification_inlines.h>
 #include <odp_classification_internal.h>
+#include <odp_queue_if.h>
 #include <odp/api/hints.h>
 
 #include <protocols/eth.h>
@@ -54,11 +56,64 @@
 #define MAX_SEGS          CONFIG_PACKET_MAX_SEGS
 #define PACKET_JUMBO_LEN  (9 * 1024)
 
+/* Maximum number of input and output queues */
+#define SOCK_MAX_QUEUES   16
+
+/* Maximum number of messages per recvmmsg()/sendmmsg() call */
+#define SOCK_MMSG_BURST   QUEUE_MULTI_MAX
+
+/* Maximum number of iovecs per message: virtio net header, segments and
+ * receive overflow buffer or transmit header copy */
+#define SOCK_MAX_IOV      (MAX_SEGS + 2)
+
+/* Length of the virtio net header in front of packet data */
+#define VNET_HDR_LEN      sizeof(struct virtio_net_hdr)
+
+/* Maximum received packet length, when the kernel passes GSO packets */
+#define SOCK_GSO_LEN      (64 * 1024)
+
+/* Maximum number of received packets stored for the next call. Packets are
+ * stashed only from a burst received into an empty stash. */
+#define SOCK_STASH_SIZE   SOCK_MMSG_BURST
+
+/* Message headers of a queue. Headers are linked to the iovecs once, only
+ * iovecs of packet data are filled in per call. */
+typedef struct ODP_ALIGNED_CACHE {
+	odp_ticketlock_t lock;		/**< queue lock, unless lockless */
+	int stash_num;			/**< number of stashed packets */
+	uint32_t stash_seg;		/**< number of TCP segments already
+					     returned from the first stashed
+					     packet */
+	odp_packet_t stash[SOCK_STASH_SIZE]; /**< received GSO packets and
+						  packets following them */
+	uint8_t *overflow;		/**< receive overflow buffers */
+	struct mmsghdr msgvec[SOCK_MMSG_BURST];
+	struct virtio_net_hdr vnet[SOCK_MMSG_BURST];
+	struct iovec iovecs[SOCK_MMSG_BURST][SOCK_MAX_IOV];
+	/* Headers of transmitted TCP packets segmented by the kernel */
+	uint8_t tcp_hdr[SOCK_MMSG_BURST][VNET_TCP_HDR_MAX];
+} sock_queue_t;
+
 typedef struct {
-	int sockfd; /**< socket descriptor */
+	int sockfd[SOCK_MAX_QUEUES]; /**< socket descriptors, one per input
+					  queue */
+	int num_fd;      /**< number of sockets */
+	int if_idx;      /**< interface index */
+	int fanout;      /**< sockets are members of a fanout group */
+	int fanout_id;   /**< fanout group id */
 	odp_pool_t pool; /**< pool to alloc packets from */
 	uint32_t mtu;    /**< maximum transmission unit */
 	unsigned char if_mac[ETH_ALEN];	/**< IF eth mac addr */
+	int vnet_hdr;    /**< virtio net header in use */
+	int rx_gso;      /**< GSO packets are received as such */
+	int rx_overflow; /**< GSO packets may be received, overflow buffers
+			      in use */
+	odp_bool_t lockless_rx; /**< no locking for rx */
+	odp_bool_t lockless_tx; /**< no locking for tx */
+	odp_shm_t shm;   /**< shm block of queues */
+	sock_queue_t *queue; /**< input queues followed by output queues */
+	uint32_t num_in; /**< number of input queues */
+	uint32_t num_out; /**< number of output queues */
 } pkt_sock_t;
 
 ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_sock_t),
@@ -121,16 +176,158 @@ int sendmmsg(int fd, struct mmsghdr *vmessages, unsigned int vlen, int flags)
 /*
  * ODP_PACKET_SOCKET_MMSG:
  */
+static int sock_queues_free(pktio_entry_t *pktio_entry)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	sock_queue_t *queue = pkt_sock->queue;
+	uint32_t i;
+
+	if (queue == NULL)
+		return 0;
+
+	for (i = 0; i < pkt_sock->num_in; i++)
+		if (queue[i].stash_num)
+			odp_packet_free_multi(queue[i].stash,
+					      queue[i].stash_num);
+
+	pkt_sock->queue = NULL;
+
+	if (odp_shm_free(pkt_sock->shm)) {
+		ODP_ERR("shm free failed\n");
+		return -1;
+	}
+
+	pkt_sock->shm = ODP_SHM_INVALID;
+
+	return 0;
+}
+
 static int sock_close(pktio_entry_t *pktio_entry)
 {
 	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	int ret = 0;
+	int i;
+
+	for (i = 0; i < pkt_sock->num_fd; i++) {
+		if (close(pkt_sock->sockfd[i]) != 0) {
+			__odp_errno = errno;
+			ODP_ERR("close(sockfd): %s\n", strerror(errno));
+			ret = -1;
+		}
+	}
+
+	pkt_sock->num_fd = 0;
+
+	if (sock_queues_free(pktio_entry))
+		ret = -1;
+
+	return ret;
+}
+
+/* Join socket into the fanout group of the interface. Group id is allocated
+ * by the kernel when the first socket joins. */
+static int sock_fanout_join(pkt_sock_t *pkt_sock, int sockfd)
+{
+	socklen_t len = sizeof(int);
+	int val;
+
+	if (pkt_sock->fanout_id < 0)
+		val = (PACKET_FANOUT_HASH | PACKET_FANOUT_FLAG_UNIQUEID) << 16;
+	else
+		val = (PACKET_FANOUT_HASH << 16) | pkt_sock->fanout_id;
+
+	if (setsockopt(sockfd, SOL_PACKET, PACKET_FANOUT, &val,
+		       sizeof(val)) != 0) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(PACKET_FANOUT): %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (pkt_sock->fanout_id < 0) {
+		if (getsockopt(sockfd, SOL_PACKET, PACKET_FANOUT, &val,
+			       &len) != 0) {
+			__odp_errno = errno;
+			ODP_ERR("getsockopt(PACKET_FANOUT): %s\n",
+				strerror(errno));
+			return -1;
+		}
+
+		pkt_sock->fanout_id = val & 0xffff;
+	}
+
+	return 0;
+}
 
-	if (pkt_sock->sockfd != -1 && close(pkt_sock->sockfd) != 0) {
+/* Open a packet socket bound to the interface */
+static int sock_open_fd(pkt_sock_t *pkt_sock)
+{
+	struct sockaddr_ll sa_ll;
+	int val = 1;
+	int sockfd;
+
+	/* Socket does not receive packets before bind() */
+	sockfd = socket(AF_PACKET, SOCK_RAW, 0);
+	if (sockfd == -1) {
 		__odp_errno = errno;
-		ODP_ERR("close(sockfd): %s\n", strerror(errno));
+		ODP_ERR("socket(): %s\n", strerror(errno));
 		return -1;
 	}
 
+	if (pkt_sock->vnet_hdr &&
+	    setsockopt(sockfd, SOL_PACKET, PACKET_VNET_HDR, &val,
+		       sizeof(val)) != 0) {
+		__odp_errno = errno;
+		ODP_ERR("setsockopt(PACKET_VNET_HDR): %s\n", strerror(errno));
+		goto error;
+	}
+
+	/* bind socket to if */
+	memset(&sa_ll, 0, sizeof(sa_ll));
+	sa_ll.sll_family = AF_PACKET;
+	sa_ll.sll_ifindex = pkt_sock->if_idx;
+	sa_ll.sll_protocol = htons(ETH_P_ALL);
+	if (bind(sockfd, (struct sockaddr *)&sa_ll, sizeof(sa_ll)) < 0) {
+		__odp_errno = errno;
+		ODP_ERR("bind(to IF): %s\n", strerror(errno));
+		goto error;
+	}
+
+	if (pkt_sock->fanout && sock_fanout_join(pkt_sock, sockfd))
+		goto error;
+
+	return sockfd;
+
+error:
+	close(sockfd);
+	return -1;
+}
+
+/* Kernel passes GSO packets to packet sockets when it coalesces received
+ * packets (GRO, LRO) on the interface, or when local senders transmit through
+ * a virtual interface (e.g. veth or bridge), which has no parent device.
+ * Interface features are checked only at open. */
+static int sock_gso_rx_possible(int fd, const char *name)
+{
+	struct ifreq ifr;
+	struct ethtool_value eval;
+	char path[64 + IF_NAMESIZE];
+
+	snprintf(path, sizeof(path), "/sys/class/net/%s/device", name);
+	if (access(path, F_OK))
+		return 1;
+
+	memset(&ifr, 0, sizeof(ifr));
+	snprintf(ifr.ifr_name, IF_NAMESIZE, "%s", name);
+	ifr.ifr_data = (void *)&eval;
+
+	eval.cmd = ETHTOOL_GGRO;
+	if (ioctl(fd, SIOCETHTOOL, &ifr) || eval.data)
+		return 1;
+
+	eval.cmd = ETHTOOL_GFLAGS;
+	if (ioctl(fd, SIOCETHTOOL, &ifr) || (eval.data & ETH_FLAG_LRO))
+		return 1;
+
 	return 0;
 }
 
@@ -142,30 +339,25 @@ static int sock_setup_pkt(pktio_entry_t *pktio_entry, const char *netdev,
 {
 	int sockfd;
 	int err;
-	unsigned int if_idx;
+	int val = 1;
 	struct ifreq ethreq;
-	struct sockaddr_ll sa_ll;
-	char shm_name[ODP_SHM_NAME_LEN];
 	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
 
 	/* Init pktio entry */
 	memset(pkt_sock, 0, sizeof(*pkt_sock));
-	/* set sockfd to -1, because a valid socked might be initialized to 0 */
-	pkt_sock->sockfd = -1;
+	pkt_sock->fanout_id = -1;
+	pkt_sock->shm = ODP_SHM_INVALID;
 
 	if (pool == ODP_POOL_INVALID)
 		return -1;
 	pkt_sock->pool = pool;
-	snprintf(shm_name, ODP_SHM_NAME_LEN, "%s-%s", "pktio", netdev);
-	shm_name[ODP_SHM_NAME_LEN - 1] = '\0';
 
-	sockfd = socket(AF_PACKET, SOCK_RAW, htons(ETH_P_ALL));
+	sockfd = socket(AF_PACKET, SOCK_RAW, 0);
 	if (sockfd == -1) {
 		__odp_errno = errno;
 		ODP_ERR("socket(): %s\n", strerror(errno));
-		goto error;
+		return -1;
 	}
-	pkt_sock->sockfd = sockfd;
 
 	/* get if index */
 	memset(&ethreq, 0, sizeof(struct ifreq));
@@ -177,7 +369,7 @@ static int sock_setup_pkt(pktio_entry_t *pktio_entry, const char *netdev,
 			ethreq.ifr_name);
 		goto error;
 	}
-	if_idx = ethreq.ifr_ifindex;
+	pkt_sock->if_idx = ethreq.ifr_ifindex;
 
 	err = mac_addr_get_fd(sockfd, netdev, pkt_sock->if_mac);
 	if (err != 0)
@@ -187,34 +379,152 @@ static int sock_setup_pkt(pktio_entry_t *pktio_entry, const char *netdev,
 	if (!pkt_sock->mtu)
 		goto error;
 
-	/* bind socket to if */
-	memset(&sa_ll, 0, sizeof(sa_ll));
-	sa_ll.sll_family = AF_PACKET;
-	sa_ll.sll_ifindex = if_idx;
-	sa_ll.sll_protocol = htons(ETH_P_ALL);
-	if (bind(sockfd, (struct sockaddr *)&sa_ll, sizeof(sa_ll)) < 0) {
-		__odp_errno = errno;
-		ODP_ERR("bind(to IF): %s\n", strerror(errno));
-		goto error;
-	}
+	/* Virtio net header enables kernel to segment TCP packets and to pass
+	 * checksum status and GSO info of received packets. GSO packets may be
+	 * received from local senders (e.g. over veth) also when TCP receive
+	 * offload is not enabled. */
+	pkt_sock->vnet_hdr = setsockopt(sockfd, SOL_PACKET, PACKET_VNET_HDR,
+					&val, sizeof(val)) == 0;
+	pkt_sock->rx_overflow = pkt_sock->vnet_hdr &&
+				sock_gso_rx_possible(sockfd, netdev);
+	close(sockfd);
+
+	sockfd = sock_open_fd(pkt_sock);
+	if (sockfd < 0)
+		return -1;
 
-	pktio_entry->s.stats_type = sock_stats_type_fd(pktio_entry,
-						       pkt_sock->sockfd);
+	pkt_sock->sockfd[0] = sockfd;
+	pkt_sock->num_fd = 1;
+
+	if (pkt_sock->vnet_hdr)
+		pktio_entry->s.tcp_seg_drv = 1;
+
+	pktio_entry->s.stats_type = sock_stats_type_fd(pktio_entry, sockfd);
 	if (pktio_entry->s.stats_type == STATS_UNSUPPORTED)
 		ODP_DBG("pktio: %s unsupported stats\n", pktio_entry->s.name);
 
 	err = sock_stats_reset(pktio_entry);
-	if (err != 0)
-		goto error;
+	if (err != 0) {
+		sock_close(pktio_entry);
+		return -1;
+	}
 
 	return 0;
 
 error:
-	sock_close(pktio_entry);
+	close(sockfd);
 
 	return -1;
 }
 
+/* Open or close sockets so that there is one per input queue. Multiple
+ * sockets share packets of the interface as a fanout group. */
+static int sock_fds_set(pktio_entry_t *pktio_entry, int num)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	int sockfd;
+
+	while (pkt_sock->num_fd > num) {
+		pkt_sock->num_fd--;
+		close(pkt_sock->sockfd[pkt_sock->num_fd]);
+	}
+
+	if (num > 1 && !pkt_sock->fanout) {
+		if (sock_fanout_join(pkt_sock, pkt_sock->sockfd[0]))
+			return -1;
+
+		pkt_sock->fanout = 1;
+	}
+
+	while (pkt_sock->num_fd < num) {
+		sockfd = sock_open_fd(pkt_sock);
+		if (sockfd < 0)
+			return -1;
+
+		pkt_sock->sockfd[pkt_sock->num_fd++] = sockfd;
+	}
+
+	return 0;
+}
+
+static int sock_queues_alloc(pktio_entry_t *pktio_entry, uint32_t num_in,
+			     uint32_t num_out)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	sock_queue_t *queue;
+	uint8_t *overflow;
+	char name[ODP_SHM_NAME_LEN];
+	uint32_t num = num_in + num_out;
+	uint64_t size, overflow_size = 0;
+	uint32_t i, j;
+
+	/* With virtio net header, the kernel may pass GSO packets longer than
+	 * packet buffers. Data that does not fit into a packet is received
+	 * into an overflow buffer. */
+	if (pkt_sock->rx_overflow)
+		overflow_size = (uint64_t)SOCK_MMSG_BURST * SOCK_GSO_LEN;
+
+	size = num * sizeof(sock_queue_t) + num_in * overflow_size;
+
+	snprintf(name, sizeof(name), "%" PRIu64 "-pktio_sock",
+		 odp_pktio_to_u64(pktio_entry->s.handle));
+
+	pkt_sock->shm = odp_shm_reserve(name, size, ODP_CACHE_LINE_SIZE, 0);
+	if (pkt_sock->shm == ODP_SHM_INVALID) {
+		ODP_ERR("shm reserve failed\n");
+		return -1;
+	}
+
+	queue = odp_shm_addr(pkt_sock->shm);
+	overflow = (uint8_t *)&queue[num];
+
+	for (i = 0; i < num; i++) {
+		odp_ticketlock_init(&queue[i].lock);
+		queue[i].stash_num = 0;
+		queue[i].stash_seg = 0;
+		queue[i].overflow = NULL;
+		memset(queue[i].msgvec, 0, sizeof(queue[i].msgvec));
+
+		if (i < num_in && overflow_size)
+			queue[i].overflow = overflow + i * overflow_size;
+
+		for (j = 0; j < SOCK_MMSG_BURST; j++) {
+			queue[i].iovecs[j][0].iov_base = &queue[i].vnet[j];
+			queue[i].iovecs[j][0].iov_len = VNET_HDR_LEN;
+		}
+	}
+
+	pkt_sock->num_in = num_in;
+	pkt_sock->num_out = num_out;
+	pkt_sock->queue = queue;
+
+	return 0;
+}
+
+static int sock_start(pktio_entry_t *pktio_entry)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	uint32_t num_in = pktio_entry->s.num_in_queue;
+	uint32_t num_out = pktio_entry->s.num_out_queue;
+
+	/* Interface with disabled input or output (or output through TM)
+	 * still has one queue */
+	if (num_in == 0)
+		num_in = 1;
+	if (num_out == 0)
+		num_out = 1;
+
+	if (pkt_sock->queue != NULL) {
+		if (num_in == pkt_sock->num_in && num_out == pkt_sock->num_out)
+			return 0;
+
+		if (sock_queues_free(pktio_entry))
+			return -1;
+	}
+
+	return sock_queues_alloc(pktio_entry, num_in, num_out);
+}
+
 /*
  * ODP_PACKET_SOCKET_MMSG:
  */
@@ -252,195 +562,354 @@ static uint32_t _rx_pkt_to_iovec(odp_packet_t pkt,
 	return iov_count;
 }
 
+static odp_packet_t sock_pkt_process(pktio_entry_t *pktio_entry, int index,
+				     odp_pktin_queue_stats_t *stats,
+				     odp_packet_t pkt, uint32_t pkt_len,
+				     const struct virtio_net_hdr *vnet,
+				     odp_time_t *ts)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	odp_proto_chksums_t chksums = pktio_entry->s.in_chksums;
+	struct ethhdr *eth_hdr = odp_packet_data(pkt);
+	int data_valid = 0;
+
+	/* Don't receive packets sent by ourselves */
+	if (odp_unlikely(ethaddrs_equal(pkt_sock->if_mac,
+					eth_hdr->h_source))) {
+		odp_packet_free(pkt);
+		return ODP_PACKET_INVALID;
+	}
+
+	if (odp_packet_trunc_tail(&pkt, odp_packet_len(pkt) - pkt_len,
+				  NULL, NULL) < 0) {
+		ODP_ERR("trunk_tail failed");
+		stats->errors++;
+		odp_packet_free(pkt);
+		return ODP_PACKET_INVALID;
+	}
+
+	if (vnet != NULL) {
+		/* Locally generated packets have only partial checksum */
+		if (odp_unlikely(vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) &&
+		    vnet_hdr_csum_complete(pkt, vnet)) {
+			stats->errors++;
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+
+		/* Kernel has already validated L4 checksum */
+		if (vnet->flags & VIRTIO_NET_HDR_F_DATA_VALID) {
+			data_valid = 1;
+			chksums.chksum.udp = 0;
+			chksums.chksum.tcp = 0;
+			chksums.chksum.sctp = 0;
+		}
+	}
+
+	if (pktio_cls_enabled(pktio_entry)) {
+		odp_pool_t new_pool;
+		odp_packet_t new_pkt;
+		uint32_t seg_len = odp_packet_seg_len(pkt);
+
+		if (cls_classify_packet(pktio_entry, (uint8_t *)eth_hdr,
+					pkt_len, seg_len, &new_pool, pkt_hdr,
+					true)) {
+			stats->cls_discards++;
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+
+		if (new_pool != pkt_sock->pool) {
+			new_pkt = odp_packet_copy(pkt, new_pool);
+
+			odp_packet_free(pkt);
+
+			if (new_pkt == ODP_PACKET_INVALID) {
+				stats->alloc_fails++;
+				stats->discards++;
+				return ODP_PACKET_INVALID;
+			}
+
+			pkt = new_pkt;
+			pkt_hdr = packet_hdr(pkt);
+		}
+	} else {
+		packet_parse_layer(pkt_hdr,
+				   pktio_entry->s.config.parser.layer,
+				   chksums);
+	}
+
+	if (data_valid && (pkt_hdr->p.input_flags.udp ||
+			   pkt_hdr->p.input_flags.tcp ||
+			   pkt_hdr->p.input_flags.sctp))
+		pkt_hdr->p.input_flags.l4_chksum_done = 1;
+
+	/* TCP segments coalesced by the kernel are accounted as merged by GRO,
+	 * or split back into segments when TCP receive offload is disabled */
+	if (vnet != NULL && vnet->gso_size &&
+	    (vnet->gso_type & ~VIRTIO_NET_HDR_GSO_ECN) !=
+	    VIRTIO_NET_HDR_GSO_NONE) {
+		uint32_t segs = vnet_hdr_gso_segs(pkt, vnet->gso_size);
+
+		if (segs > 1 && pkt_sock->rx_gso)
+			pktio_gro_stats_add(pktio_entry, index, 1, segs);
+	}
+
+	pkt_hdr->input = pktio_entry->s.handle;
+	packet_set_ts(pkt_hdr, ts);
+
+	return pkt;
+}
+
+/* Append received packet data from the overflow buffer into the packet */
+static odp_packet_t sock_overflow_copy(odp_packet_t pkt, uint32_t pkt_len,
+				       const uint8_t *overflow)
+{
+	uint32_t buf_len = odp_packet_len(pkt);
+	uint32_t len = pkt_len - buf_len;
+
+	if (odp_packet_extend_tail(&pkt, len, NULL, NULL) < 0 ||
+	    odp_packet_copy_from_mem(pkt, buf_len, len, overflow)) {
+		odp_packet_free(pkt);
+		return ODP_PACKET_INVALID;
+	}
+
+	return pkt;
+}
+
+/* Move packets from the stash to the packet table in receive order. GSO
+ * packets are split into TCP segments a table full at a time, when TCP receive
+ * offload is not enabled. */
+static int sock_stash_get(pktio_entry_t *pktio_entry, sock_queue_t *queue,
+			  odp_pktin_queue_stats_t *stats,
+			  odp_packet_t pkt_table[], int num)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	odp_packet_t pkt;
+	uint32_t segs;
+	int nb_rx = 0;
+	int i, ret;
+
+	while (nb_rx < num && queue->stash_num) {
+		pkt = queue->stash[0];
+
+		if (pkt_sock->rx_gso || !packet_hdr(pkt)->p.flags.tcp_seg) {
+			pkt_table[nb_rx++] = pkt;
+			goto next;
+		}
+
+		ret = _odp_packet_tcp_seg(pkt, queue->stash_seg,
+					  &pkt_table[nb_rx], num - nb_rx);
+
+		if (odp_unlikely(ret < 0)) {
+			ODP_DBG("pktio %s: TCP segmentation failed\n",
+				pktio_entry->s.name);
+			segs = vnet_hdr_gso_segs(pkt, packet_hdr(pkt)->tcp_mss);
+			stats->discards += segs > queue->stash_seg ?
+					   segs - queue->stash_seg : 1;
+			odp_packet_free(pkt);
+			goto next;
+		}
+
+		if (ret == 0) {
+			/* Not segmented, or all segments already returned */
+			if (queue->stash_seg == 0)
+				pkt_table[nb_rx++] = pkt;
+			else
+				odp_packet_free(pkt);
+			goto next;
+		}
+
+		/* Segments carry the same metadata as the received packet */
+		for (i = nb_rx; i < nb_rx + ret; i++) {
+			odp_packet_hdr_t *seg_hdr = packet_hdr(pkt_table[i]);
+
+			seg_hdr->p.flags.l3_chksum_set = 0;
+			seg_hdr->p.flags.l4_chksum_set = 0;
+		}
+
+		nb_rx += ret;
+		queue->stash_seg += ret;
+
+		/* Packet is freed when its last segment has been created */
+		if (nb_rx == num)
+			break;
+
+		odp_packet_free(pkt);
+next:
+		queue->stash_seg = 0;
+		queue->stash_num--;
+		memmove(queue->stash, &queue->stash[1],
+			queue->stash_num * sizeof(odp_packet_t));
+	}
+
+	return nb_rx;
+}
+
+/* Update input queue statistics with packets returned to the caller */
+static inline void sock_rx_stats(odp_pktin_queue_stats_t *stats,
+				 odp_packet_t pkt_table[], int num)
+{
+	int i;
+
+	for (i = 0; i < num; i++)
+		stats->octets += odp_packet_len(pkt_table[i]);
+
+	stats->packets += num;
+}
+
 /*
  * ODP_PACKET_SOCKET_MMSG:
  */
-static int sock_mmsg_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmsg_recv(pktio_entry_t *pktio_entry, int index,
 			  odp_packet_t pkt_table[], int num)
 {
 	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
-	odp_pool_t pool = pkt_sock->pool;
+	sock_queue_t *queue = pkt_sock->queue;
+	odp_pktin_queue_stats_t *stats = pktio_in_stats(pktio_entry, index);
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
-	const int sockfd = pkt_sock->sockfd;
-	struct mmsghdr msgvec[num];
-	struct iovec iovecs[num][MAX_SEGS];
+	const int sockfd = pkt_sock->sockfd[index];
+	const uint32_t hdr_len = pkt_sock->vnet_hdr ? VNET_HDR_LEN : 0;
 	int nb_rx = 0;
 	int nb_pkts;
 	int recv_msgs;
 	int i;
 
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
+	if (odp_unlikely(queue == NULL))
+		return 0;
+
+	queue = &queue[index];
+
+	if (odp_unlikely(num > SOCK_MMSG_BURST))
+		num = SOCK_MMSG_BURST;
+
+	if (!pkt_sock->lockless_rx)
+		odp_ticketlock_lock(&queue->lock);
+
+	/* Segments of a GSO packet are returned before new packets */
+	if (odp_unlikely(queue->stash_num)) {
+		nb_rx = sock_stash_get(pktio_entry, queue, stats, pkt_table,
+				       num);
+		sock_rx_stats(stats, pkt_table, nb_rx);
+
+		if (!pkt_sock->lockless_rx)
+			odp_ticketlock_unlock(&queue->lock);
+
+		return nb_rx;
+	}
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
 	    pktio_entry->s.config.pktin.bit.ts_ptp)
 		ts = &ts_val;
 
-	memset(msgvec, 0, sizeof(msgvec));
+	nb_pkts = packet_alloc_multi(pkt_sock->pool, pkt_sock->mtu, pkt_table,
+				     num);
+	if (odp_unlikely(nb_pkts < num))
+		stats->alloc_fails++;
 
-	nb_pkts = packet_alloc_multi(pool, pkt_sock->mtu, pkt_table, num);
 	for (i = 0; i < nb_pkts; i++) {
-		msgvec[i].msg_hdr.msg_iovlen =
-			_rx_pkt_to_iovec(pkt_table[i], iovecs[i]);
-		msgvec[i].msg_hdr.msg_iov = iovecs[i];
+		struct iovec *iov = queue->iovecs[i];
+		uint32_t num_iov = _rx_pkt_to_iovec(pkt_table[i], &iov[1]);
+
+		if (hdr_len) {
+			if (queue->overflow) {
+				iov[num_iov + 1].iov_base = queue->overflow +
+							    i * SOCK_GSO_LEN;
+				iov[num_iov + 1].iov_len = SOCK_GSO_LEN;
+				num_iov++;
+			}
+			queue->msgvec[i].msg_hdr.msg_iov = iov;
+			queue->msgvec[i].msg_hdr.msg_iovlen = num_iov + 1;
+		} else {
+			queue->msgvec[i].msg_hdr.msg_iov = &iov[1];
+			queue->msgvec[i].msg_hdr.msg_iovlen = num_iov;
+		}
 	}
 
-	recv_msgs = recvmmsg(sockfd, msgvec, nb_pkts, MSG_DONTWAIT, NULL);
+	recv_msgs = recvmmsg(sockfd, queue->msgvec, nb_pkts, MSG_DONTWAIT,
+			     NULL);
 
 	if (ts != NULL)
 		ts_val = odp_time_global();
 
 	for (i = 0; i < recv_msgs; i++) {
-		void *base = msgvec[i].msg_hdr.msg_iov->iov_base;
-		struct ethhdr *eth_hdr = base;
+		struct msghdr *msg_hdr = &queue->msgvec[i].msg_hdr;
+		uint32_t pkt_len = queue->msgvec[i].msg_len;
 		odp_packet_t pkt = pkt_table[i];
-		odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
-		uint16_t pkt_len = msgvec[i].msg_len;
-		int ret;
 
-		if (odp_unlikely(msgvec[i].msg_hdr.msg_flags & MSG_TRUNC)) {
+		if (odp_unlikely(msg_hdr->msg_flags & MSG_TRUNC ||
+				 pkt_len < hdr_len + _ODP_ETHHDR_LEN)) {
 			odp_packet_free(pkt);
 			ODP_DBG("dropped truncated packet\n");
+			stats->errors++;
 			continue;
 		}
-		if (pktio_cls_enabled(pktio_entry)) {
-			uint16_t seg_len =  pkt_len;
 
-			if (msgvec[i].msg_hdr.msg_iov->iov_len < pkt_len)
-				seg_len = msgvec[i].msg_hdr.msg_iov->iov_len;
+		pkt_len -= hdr_len;
 
-			if (cls_classify_packet(pktio_entry, base, pkt_len,
-						seg_len, &pool, pkt_hdr,
-						true)) {
-				ODP_ERR("cls_classify_packet failed");
-				odp_packet_free(pkt);
+		if (odp_unlikely(pkt_len > odp_packet_len(pkt))) {
+			pkt = sock_overflow_copy(pkt, pkt_len,
+						 queue->overflow +
+						 i * SOCK_GSO_LEN);
+			if (pkt == ODP_PACKET_INVALID) {
+				stats->alloc_fails++;
+				stats->discards++;
 				continue;
 			}
 		}
 
-		/* Don't receive packets sent by ourselves */
-		if (odp_unlikely(ethaddrs_equal(pkt_sock->if_mac,
-						eth_hdr->h_source))) {
-			odp_packet_free(pkt);
+		pkt = sock_pkt_process(pktio_entry, index, stats, pkt, pkt_len,
+				       hdr_len ? &queue->vnet[i] : NULL, ts);
+		if (pkt == ODP_PACKET_INVALID)
 			continue;
-		}
 
-		ret = odp_packet_trunc_tail(&pkt, odp_packet_len(pkt) - pkt_len,
-					    NULL, NULL);
-		if (ret < 0) {
-			ODP_ERR("trunk_tail failed");
-			odp_packet_free(pkt);
+		/* Packets following a GSO packet are stashed to maintain
+		 * packet order */
+		if (odp_unlikely(queue->stash_num ||
+				 (packet_hdr(pkt)->p.flags.tcp_seg &&
+				  !pkt_sock->rx_gso))) {
+			queue->stash[queue->stash_num++] = pkt;
 			continue;
 		}
 
-		pkt_hdr->input = pktio_entry->s.handle;
-
-		if (!pktio_cls_enabled(pktio_entry))
-			packet_parse_layer(pkt_hdr,
-					   pktio_entry->s.config.parser.layer,
-					   pktio_entry->s.in_chksums);
-
-		pkt_hdr->input = pktio_entry->s.handle;
-		packet_set_ts(pkt_hdr, ts);
-
 		pkt_table[nb_rx++] = pkt;
 	}
 
 	/* Free unused pkt buffers */
-	for (; i < nb_pkts; i++)
-		odp_packet_free(pkt_table[i]);
-
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
-
-	return nb_rx;
-}
-
-static int sock_fd_set(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
-		       fd_set *readfds)
-{
-	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
-	const int sockfd = pkt_sock->sockfd;
+	if (recv_msgs < 0)
+		recv_msgs = 0;
 
-	FD_SET(sockfd, readfds);
-	return sockfd;
-}
+	if (recv_msgs < nb_pkts)
+		odp_packet_free_multi(&pkt_table[recv_msgs],
+				      nb_pkts - recv_msgs);
 
-static int sock_recv_tmo(pktio_entry_t *pktio_entry, int index,
-			 odp_packet_t pkt_table[], int num, uint64_t usecs)
-{
-	struct timeval timeout;
-	int ret;
-	int maxfd;
-	fd_set readfds;
+	if (odp_unlikely(queue->stash_num))
+		nb_rx += sock_stash_get(pktio_entry, queue, stats,
+					&pkt_table[nb_rx], num - nb_rx);
 
-	ret = sock_mmsg_recv(pktio_entry, index, pkt_table, num);
-	if (ret != 0)
-		return ret;
+	sock_rx_stats(stats, pkt_table, nb_rx);
 
-	timeout.tv_sec = usecs / (1000 * 1000);
-	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
+	if (!pkt_sock->lockless_rx)
+		odp_ticketlock_unlock(&queue->lock);
 
-	FD_ZERO(&readfds);
-	maxfd = sock_fd_set(pktio_entry, index, &readfds);
-
-	if (select(maxfd + 1, &readfds, NULL, NULL, &timeout) == 0)
-		return 0;
-
-	return sock_mmsg_recv(pktio_entry, index, pkt_table, num);
+	return nb_rx;
 }
 
-static int sock_recv_mq_tmo(pktio_entry_t *pktio_entry[], int index[],
-			    int num_q, odp_packet_t pkt_table[], int num,
-			    unsigned *from, uint64_t usecs)
+static int sock_pktin_fds(pktio_entry_t *pktio_entry, int index, int fds[],
+			  int num ODP_UNUSED)
 {
-	struct timeval timeout;
-	int i;
-	int ret;
-	int maxfd = -1, maxfd2;
-	fd_set readfds;
-
-	for (i = 0; i < num_q; i++) {
-		ret = sock_mmsg_recv(pktio_entry[i], index[i], pkt_table, num);
-
-		if (ret > 0 && from)
-			*from = i;
-
-		if (ret != 0)
-			return ret;
-	}
-
-	timeout.tv_sec = usecs / (1000 * 1000);
-	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
-
-	FD_ZERO(&readfds);
-
-	for (i = 0; i < num_q; i++) {
-		maxfd2 = sock_fd_set(pktio_entry[i], index[i], &readfds);
-		if (maxfd2 > maxfd)
-			maxfd = maxfd2;
-	}
-
-	if (select(maxfd + 1, &readfds, NULL, NULL, &timeout) == 0)
-		return 0;
-
-	for (i = 0; i < num_q; i++) {
-		ret = sock_mmsg_recv(pktio_entry[i], index[i], pkt_table, num);
-
-		if (ret > 0 && from)
-			*from = i;
-
-		if (ret != 0)
-			return ret;
-	}
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
 
-	return 0;
+	fds[0] = pkt_sock->sockfd[index];
+	return 1;
 }
 
-static uint32_t _tx_pkt_to_iovec(odp_packet_t pkt,
+static uint32_t _tx_pkt_to_iovec(odp_packet_t pkt, uint32_t offset,
 				 struct iovec iovecs[MAX_SEGS])
 {
 	uint32_t pkt_len = odp_packet_len(pkt);
-	uint32_t offset = 0;
 	uint32_t iov_count = 0;
 
 	while (offset < pkt_len) {
@@ -458,43 +927,93 @@ static uint32_t _tx_pkt_to_iovec(odp_packet_t pkt,
 /*
  * ODP_PACKET_SOCKET_MMSG:
  */
-static int sock_mmsg_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmsg_send(pktio_entry_t *pktio_entry, int index,
 			  const odp_packet_t pkt_table[], int num)
 {
 	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
-	struct mmsghdr msgvec[num];
-	struct iovec iovecs[num][MAX_SEGS];
+	sock_queue_t *queue = pkt_sock->queue;
+	odp_pktout_queue_stats_t *stats = pktio_out_stats(pktio_entry, index);
+	const uint32_t hdr_len = pkt_sock->vnet_hdr ? VNET_HDR_LEN : 0;
+	uint64_t octets = 0;
 	int ret;
 	int sockfd;
 	int n, i;
 
-	odp_ticketlock_lock(&pktio_entry->s.txl);
+	if (odp_unlikely(queue == NULL))
+		return 0;
+
+	/* Output queues share sockets of input queues */
+	queue = &queue[pkt_sock->num_in + index];
+	sockfd = pkt_sock->sockfd[index % pkt_sock->num_fd];
 
-	sockfd = pkt_sock->sockfd;
-	memset(msgvec, 0, sizeof(msgvec));
+	if (odp_unlikely(num > SOCK_MMSG_BURST))
+		num = SOCK_MMSG_BURST;
+
+	if (!pkt_sock->lockless_tx)
+		odp_ticketlock_lock(&queue->lock);
 
 	for (i = 0; i < num; i++) {
-		msgvec[i].msg_hdr.msg_iov = iovecs[i];
-		msgvec[i].msg_hdr.msg_iovlen = _tx_pkt_to_iovec(pkt_table[i],
-				iovecs[i]);
+		odp_packet_t pkt = pkt_table[i];
+		struct iovec *iov = queue->iovecs[i];
+		uint32_t len = odp_packet_len(pkt);
+		uint32_t tcp_hdr = 0;
+		uint32_t num_iov = 0;
+
+		if (hdr_len) {
+			memset(&queue->vnet[i], 0, VNET_HDR_LEN);
+
+			/* Kernel segments TCP packets */
+			if (odp_unlikely(pktio_entry->s.tcp_seg_ena &&
+					 packet_hdr(pkt)->p.flags.tcp_seg))
+				tcp_hdr = vnet_hdr_tcp_seg(pkt, len,
+							   &queue->vnet[i],
+							   queue->tcp_hdr[i]);
+		}
+
+		/* Headers are sent from a copy with updated checksum field */
+		if (odp_unlikely(tcp_hdr)) {
+			iov[1].iov_base = queue->tcp_hdr[i];
+			iov[1].iov_len = tcp_hdr;
+			num_iov = 1;
+		}
+
+		num_iov += _tx_pkt_to_iovec(pkt, tcp_hdr, &iov[1 + num_iov]);
+
+		queue->msgvec[i].msg_hdr.msg_iov = hdr_len ? iov : &iov[1];
+		queue->msgvec[i].msg_hdr.msg_iovlen = hdr_len ? num_iov + 1 :
+						      num_iov;
 	}
 
 	for (i = 0; i < num; ) {
-		ret = sendmmsg(sockfd, &msgvec[i], num - i, MSG_DONTWAIT);
+		ret = sendmmsg(sockfd, &queue->msgvec[i], num - i,
+			       MSG_DONTWAIT);
 		if (odp_unlikely(ret <= -1)) {
 			if (i == 0 && SOCK_ERR_REPORT(errno)) {
 				__odp_errno = errno;
 				ODP_ERR("sendmmsg(): %s\n", strerror(errno));
-				odp_ticketlock_unlock(&pktio_entry->s.txl);
-				return -1;
+				stats->errors++;
+				i = -1;
 			}
 			break;
 		}
 
 		i += ret;
+
+		/* Partial send, socket buffer is full */
+		if (odp_unlikely(i < num))
+			stats->retries++;
+	}
+
+	for (n = 0; n < i; n++)
+		octets += odp_packet_len(pkt_table[n]);
+
+	if (i > 0) {
+		stats->packets += i;
+		stats->octets += octets;
 	}
 
-	odp_ticketlock_unlock(&pktio_entry->s.txl);
+	if (!pkt_sock->lockless_tx)
+		odp_ticketlock_unlock(&queue->lock);
 
 	for (n = 0; n < i; ++n)
 		odp_packet_free(pkt_table[n]);
@@ -526,7 +1045,7 @@ static int sock_mac_addr_get(pktio_entry_t *pktio_entry,
 static int sock_promisc_mode_set(pktio_entry_t *pktio_entry,
 				 odp_bool_t enable)
 {
-	return promisc_mode_set_fd(pkt_priv(pktio_entry)->sockfd,
+	return promisc_mode_set_fd(pkt_priv(pktio_entry)->sockfd[0],
 				   pktio_entry->s.name, enable);
 }
 
@@ -535,13 +1054,13 @@ static int sock_promisc_mode_set(pktio_entry_t *pktio_entry,
  */
 static int sock_promisc_mode_get(pktio_entry_t *pktio_entry)
 {
-	return promisc_mode_get_fd(pkt_priv(pktio_entry)->sockfd,
+	return promisc_mode_get_fd(pkt_priv(pktio_entry)->sockfd[0],
 				   pktio_entry->s.name);
 }
 
 static int sock_link_status(pktio_entry_t *pktio_entry)
 {
-	return link_status_fd(pkt_priv(pktio_entry)->sockfd,
+	return link_status_fd(pkt_priv(pktio_entry)->sockfd[0],
 			      pktio_entry->s.name);
 }
 
@@ -550,8 +1069,8 @@ static int sock_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
 {
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
-	capa->max_output_queues = 1;
+	capa->max_input_queues  = SOCK_MAX_QUEUES;
+	capa->max_output_queues = SOCK_MAX_QUEUES;
 	capa->set_op.op.promisc_mode = 1;
 
 	odp_pktio_config_init(&capa->config);
@@ -560,6 +1079,65 @@ static int sock_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
 	return 0;
 }
 
+static int sock_config(pktio_entry_t *pktio_entry,
+		       const odp_pktio_config_t *config)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+
+	/* With TCP receive offload enabled, TCP segments coalesced by the
+	 * kernel (GRO) are passed to the application as such */
+	pkt_sock->rx_gso = pkt_sock->vnet_hdr && config->pktin.bit.tcp_gro;
+
+	return 0;
+}
+
+static int sock_input_queues_config(pktio_entry_t *pktio_entry,
+				    const odp_pktin_queue_param_t *param)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+	int num = pktio_entry->s.num_in_queue;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		pkt_sock->lockless_rx = 1;
+	else if (mode == ODP_PKTIN_MODE_DIRECT)
+		pkt_sock->lockless_rx =
+			(param->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+	else
+		pkt_sock->lockless_rx = 0;
+
+	/* Kernel fanout hash includes TCP and UDP ports. Hashing only on IP
+	 * addresses cannot be provided for those. */
+	if (num > 1 && param->hash_enable &&
+	    ((param->hash_proto.proto.ipv4 &&
+	      !(param->hash_proto.proto.ipv4_udp &&
+		param->hash_proto.proto.ipv4_tcp)) ||
+	     (param->hash_proto.proto.ipv6 &&
+	      !(param->hash_proto.proto.ipv6_udp &&
+		param->hash_proto.proto.ipv6_tcp)))) {
+		ODP_ERR("pktio %s: unsupported hash protocols\n",
+			pktio_entry->s.name);
+		return -1;
+	}
+
+	return sock_fds_set(pktio_entry, num > 0 ? num : 1);
+}
+
+static int sock_output_queues_config(pktio_entry_t *pktio_entry,
+				     const odp_pktout_queue_param_t *param)
+{
+	pkt_sock_t *pkt_sock = pkt_priv(pktio_entry);
+
+	/* Output queues in queue mode may be used by multiple threads */
+	pkt_sock->lockless_tx =
+		pktio_entry->s.param.out_mode == ODP_PKTOUT_MODE_DIRECT &&
+		param->op_mode == ODP_PKTIO_OP_MT_UNSAFE;
+
+	return 0;
+}
+
 static int sock_stats(pktio_entry_t *pktio_entry,
 		      odp_pktio_stats_t *stats)
 {
@@ -570,7 +1148,7 @@ static int sock_stats(pktio_entry_t *pktio_entry,
 
 	return sock_stats_fd(pktio_entry,
 			     stats,
-			     pkt_priv(pktio_entry)->sockfd);
+			     pkt_priv(pktio_entry)->sockfd[0]);
 }
 
 static int sock_stats_reset(pktio_entry_t *pktio_entry)
@@ -582,7 +1160,7 @@ static int sock_stats_reset(pktio_entry_t *pktio_entry)
 	}
 
 	return sock_stats_reset_fd(pktio_entry,
-				   pkt_priv(pktio_entry)->sockfd);
+				   pkt_priv(pktio_entry)->sockfd[0]);
 }
 
 static int sock_init_global(void)
@@ -606,14 +1184,12 @@ const pktio_if_ops_t sock_mmsg_pktio_ops = {
 	.term = NULL,
 	.open = sock_mmsg_open,
 	.close = sock_close,
-	.start = NULL,
+	.start = sock_start,
 	.stop = NULL,
 	.stats = sock_stats,
 	.stats_reset = sock_stats_reset,
 	.recv = sock_mmsg_recv,
-	.recv_tmo = sock_recv_tmo,
-	.recv_mq_tmo = sock_recv_mq_tmo,
-	.fd_set = sock_fd_set,
+	.pktin_fds = sock_pktin_fds,
 	.send = sock_mmsg_send,
 	.mtu_get = sock_mtu_get,
 	.promisc_mode_set = sock_promisc_mode_set,
@@ -624,7 +1200,7 @@ const pktio_if_ops_t sock_mmsg_pktio_ops = {
 	.capability = sock_capability,
 	.pktin_ts_res = NULL,
 	.pktin_ts_from_ns = NULL,
-	.config = NULL,
-	.input_queues_config = NULL,
-	.output_queues_config = NULL,
+	.config = sock_config,
+	.input_queues_config = sock_input_queues_config,
+	.output_queues_config = sock_output_queues_config,
 };
@@ -15,10 +15,15 @@
 #include <net/if.h>
 #include <linux/if_packet.h>
 #include <errno.h>
+#include <linux/virtio_net.h>
+#include <odp_api.h>
 #include <odp_debug_internal.h>
 #include <odp_errno_define.h>
+#include <odp_packet_internal.h>
 #include <odp_socket_common.h>
 #include <protocols/eth.h>
+#include <protocols/ip.h>
+#include <protocols/tcp.h>
 
 /**
  * ODP_PACKET_SOCKET_MMSG:
@@ -138,3 +143,142 @@ int link_status_fd(int fd, const char *name)
 
 	return !!(ifr.ifr_flags & IFF_RUNNING);
 }
+
+/*
+ * ODP_PACKET_SOCKET_MMSG:
+ * ODP_PACKET_TAP:
+ *
+ * Checksum field contains the pseudo header sum, which is included in the sum
+ * from 'csum_start' to the end of the packet.
+ */
+int vnet_hdr_csum_complete(odp_packet_t pkt,
+			   const struct virtio_net_hdr *vnet)
+{
+	uint32_t pkt_len = odp_packet_len(pkt);
+	uint32_t offset = vnet->csum_start;
+	uint32_t sum = 0;
+	uint16_t chksum;
+
+	if (offset + vnet->csum_offset + 2 > pkt_len)
+		return -1;
+
+	while (offset < pkt_len) {
+		uint32_t seglen;
+		uint8_t *data = odp_packet_offset(pkt, offset, &seglen, NULL);
+		uint16_t seg_sum;
+
+		if (seglen > pkt_len - offset)
+			seglen = pkt_len - offset;
+
+		seg_sum = odp_chksum_ones_comp16(data, seglen);
+
+		/* Sum of data starting from an odd offset is byte swapped */
+		if ((offset - vnet->csum_start) & 1)
+			seg_sum = (seg_sum << 8) | (seg_sum >> 8);
+
+		sum += seg_sum;
+		offset += seglen;
+	}
+
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	chksum = ~sum;
+
+	return odp_packet_copy_from_mem(pkt, vnet->csum_start +
+					vnet->csum_offset, 2, &chksum);
+}
+
+/*
+ * ODP_PACKET_SOCKET_MMSG:
+ * ODP_PACKET_TAP:
+ */
+uint32_t vnet_hdr_gso_segs(odp_packet_t pkt, uint32_t gso_size)
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint32_t l4_offset = pkt_hdr->p.l4_offset;
+	uint32_t len = odp_packet_len(pkt);
+	uint32_t payload;
+	_odp_tcphdr_t tcp;
+
+	odp_packet_tcp_mss_set(pkt, gso_size);
+
+	if (!pkt_hdr->p.input_flags.tcp ||
+	    l4_offset == ODP_PACKET_OFFSET_INVALID ||
+	    odp_packet_copy_to_mem(pkt, l4_offset, _ODP_TCPHDR_LEN, &tcp))
+		return 0;
+
+	payload = len - l4_offset - tcp.hl * 4;
+
+	return (payload + gso_size - 1) / gso_size;
+}
+
+/*
+ * ODP_PACKET_SOCKET_MMSG:
+ * ODP_PACKET_TAP:
+ *
+ * Partial checksum offload requires pseudo header checksum in the TCP checksum
+ * field. It is written into a private copy of the headers, since packet data
+ * may be shared (packet references) and must be returned to the application
+ * unmodified on send failure.
+ */
+uint32_t vnet_hdr_tcp_seg(odp_packet_t pkt, uint32_t len,
+			  struct virtio_net_hdr *vnet, uint8_t hdr[])
+{
+	odp_packet_hdr_t *pkt_hdr = packet_hdr(pkt);
+	uint8_t *data = odp_packet_data(pkt);
+	uint32_t seg_len = odp_packet_seg_len(pkt);
+	uint32_t l3_offset = pkt_hdr->p.l3_offset;
+	uint32_t l4_offset = pkt_hdr->p.l4_offset;
+	uint32_t mss = odp_packet_tcp_mss(pkt);
+	_odp_tcphdr_t *tcp;
+	uint32_t hdr_len, sum;
+
+	if (l3_offset == ODP_PACKET_OFFSET_INVALID ||
+	    l4_offset == ODP_PACKET_OFFSET_INVALID ||
+	    l4_offset + _ODP_TCPHDR_LEN > seg_len)
+		return 0;
+
+	tcp = (_odp_tcphdr_t *)(uintptr_t)(data + l4_offset);
+	hdr_len = l4_offset + tcp->hl * 4;
+
+	if (hdr_len > seg_len || hdr_len > VNET_TCP_HDR_MAX ||
+	    len - hdr_len <= mss)
+		return 0;
+
+	if ((data[l3_offset] >> 4) == _ODP_IPV4) {
+		_odp_ipv4hdr_t *ipv4 = (_odp_ipv4hdr_t *)(uintptr_t)
+				       (data + l3_offset);
+
+		if (ipv4->proto != _ODP_IPPROTO_TCP)
+			return 0;
+
+		vnet->gso_type = VIRTIO_NET_HDR_GSO_TCPV4;
+		sum = odp_chksum_ones_comp16(&ipv4->src_addr,
+					     2 * _ODP_IPV4ADDR_LEN);
+	} else if ((data[l3_offset] >> 4) == _ODP_IPV6) {
+		_odp_ipv6hdr_t *ipv6 = (_odp_ipv6hdr_t *)(uintptr_t)
+				       (data + l3_offset);
+
+		vnet->gso_type = VIRTIO_NET_HDR_GSO_TCPV6;
+		sum = odp_chksum_ones_comp16(&ipv6->src_addr,
+					     2 * _ODP_IPV6ADDR_LEN);
+	} else {
+		return 0;
+	}
+
+	sum += odp_cpu_to_be_16(_ODP_IPPROTO_TCP);
+	sum += odp_cpu_to_be_16(len - l4_offset);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	memcpy(hdr, data, hdr_len);
+	tcp = (_odp_tcphdr_t *)(uintptr_t)(hdr + l4_offset);
+	tcp->cksm = sum;
+
+	vnet->flags = VIRTIO_NET_HDR_F_NEEDS_CSUM;
+	vnet->hdr_len = hdr_len;
+	vnet->gso_size = mss;
+	vnet->csum_start = l4_offset;
+	vnet->csum_offset = offsetof(_odp_tcphdr_t, cksm);
+
+	return hdr_len;
+}
@@ -191,8 +191,32 @@ static inline unsigned next_frame(unsigned cur_frame, unsigned frame_count)
 	return odp_unlikely(cur_frame + 1 >= frame_count) ? 0 : cur_frame + 1;
 }
 
+/* Pipeline frame accesses of the receive loop. While frame N is processed,
+ * the header of frame N + 2 * PKTIN_PREFETCH_AHEAD and the packet data of
+ * frame N + PKTIN_PREFETCH_AHEAD are prefetched. Data offset of a frame is
+ * read from its header, which has been prefetched on an earlier round. */
+static inline void mmap_rx_prefetch(struct ring *ring, uint32_t frame_num)
+{
+	uint32_t frame_count = ring->rd_num;
+	uint32_t hdr_frame = frame_num + 2 * PKTIN_PREFETCH_AHEAD;
+	uint32_t data_frame = frame_num + PKTIN_PREFETCH_AHEAD;
+	union frame_map ppd;
+
+	if (odp_unlikely(hdr_frame >= frame_count)) {
+		hdr_frame %= frame_count;
+		data_frame %= frame_count;
+	}
+
+	odp_prefetch(ring->rd[hdr_frame].iov_base);
+
+	ppd.raw = ring->rd[data_frame].iov_base;
+	if (mmap_rx_kernel_ready(ppd.raw))
+		odp_prefetch((uint8_t *)ppd.raw + ppd.v2->tp_h.tp_mac);
+}
+
 static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 				      pkt_sock_mmap_t *pkt_sock,
+				      odp_pktin_queue_stats_t *stats,
 				      odp_packet_t pkt_table[], unsigned num,
 				      unsigned char if_mac[])
 {
@@ -206,6 +230,7 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 	unsigned i;
 	unsigned nb_rx;
 	struct ring *ring;
+	uint64_t octets = 0;
 	int ret;
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
@@ -224,6 +249,8 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 		if (!mmap_rx_kernel_ready(ring->rd[frame_num].iov_base))
 			break;
 
+		mmap_rx_prefetch(ring, frame_num);
+
 		if (ts != NULL)
 			ts_val = odp_time_global();
 
@@ -237,6 +264,7 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 			mmap_rx_user_ready(ppd.raw);
 			frame_num = next_frame_num;
 			ODP_DBG("dropped oversized packet\n");
+			stats->errors++;
 			continue;
 		}
 
@@ -261,6 +289,7 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 						true)) {
 				mmap_rx_user_ready(ppd.raw); /* drop */
 				frame_num = next_frame_num;
+				stats->cls_discards++;
 				continue;
 			}
 		}
@@ -271,6 +300,8 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 			pkt_table[nb_rx] = ODP_PACKET_INVALID;
 			mmap_rx_user_ready(ppd.raw); /* drop */
 			frame_num = next_frame_num;
+			stats->alloc_fails++;
+			stats->discards++;
 			continue;
 		}
 		hdr = packet_hdr(pkt_table[nb_rx]);
@@ -280,6 +311,7 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 			odp_packet_free(pkt_table[nb_rx]);
 			mmap_rx_user_ready(ppd.raw); /* drop */
 			frame_num = next_frame_num;
+			stats->errors++;
 			continue;
 		}
 		hdr->input = pktio_entry->s.handle;
@@ -296,14 +328,19 @@ static inline unsigned pkt_mmap_v2_rx(pktio_entry_t *pktio_entry,
 		mmap_rx_user_ready(ppd.raw);
 		frame_num = next_frame_num;
 
+		octets += pkt_len;
 		nb_rx++;
 	}
 
 	ring->frame_num = frame_num;
+	stats->octets += octets;
+	stats->packets += nb_rx;
 	return nb_rx;
 }
 
-static unsigned handle_pending_frames(int sock, struct ring *ring, int frames)
+static unsigned handle_pending_frames(int sock, struct ring *ring,
+				      odp_pktout_queue_stats_t *stats,
+				      int frames)
 {
 	int i;
 	int retry = 0;
@@ -325,6 +362,7 @@ static unsigned handle_pending_frames(int sock, struct ring *ring, int frames)
 
 				sendto(sock, NULL, 0, MSG_DONTWAIT, NULL, 0);
 				nanosleep(&ts, NULL);
+				stats->retries++;
 				i--;
 				continue;
 			} else {
@@ -332,6 +370,7 @@ static unsigned handle_pending_frames(int sock, struct ring *ring, int frames)
 			}
 		} else { /* TP_STATUS_WRONG_FORMAT */
 			/* Don't try re-sending frames after failure */
+			stats->errors++;
 			for (; i < frames; i++) {
 				hdr = ring->rd[frame_num].iov_base;
 				hdr->tp_status = TP_STATUS_AVAILABLE;
@@ -348,6 +387,7 @@ static unsigned handle_pending_frames(int sock, struct ring *ring, int frames)
 }
 
 static inline unsigned pkt_mmap_v2_tx(int sock, struct ring *ring,
+				      odp_pktout_queue_stats_t *stats,
 				      const odp_packet_t pkt_table[],
 				      unsigned num)
 {
@@ -360,6 +400,7 @@ static inline unsigned pkt_mmap_v2_tx(int sock, struct ring *ring,
 	unsigned nb_tx = 0;
 	int send_errno;
 	int total_len = 0;
+	uint64_t octets = 0;
 
 	first_frame_num = ring->frame_num;
 	frame_num = first_frame_num;
@@ -396,7 +437,7 @@ static inline unsigned pkt_mmap_v2_tx(int sock, struct ring *ring,
 		nb_tx = i;
 		ring->frame_num = frame_num;
 	} else {
-		nb_tx = handle_pending_frames(sock, ring, i);
+		nb_tx = handle_pending_frames(sock, ring, stats, i);
 
 		if (odp_unlikely(ret == -1 && nb_tx == 0 &&
 				 SOCK_ERR_REPORT(send_errno))) {
@@ -407,10 +448,17 @@ static inline unsigned pkt_mmap_v2_tx(int sock, struct ring *ring,
 			if (errno != ENOBUFS)
 				ODP_ERR("sendto(pkt mmap): %s\n",
 					strerror(send_errno));
+			stats->errors++;
 			return -1;
 		}
 	}
 
+	for (i = 0; i < nb_tx; ++i)
+		octets += odp_packet_len(pkt_table[i]);
+
+	stats->packets += nb_tx;
+	stats->octets += octets;
+
 	for (i = 0; i < nb_tx; ++i)
 		odp_packet_free(pkt_table[i]);
 
@@ -666,120 +714,33 @@ error:
 	return -1;
 }
 
-static int sock_mmap_fd_set(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
-			    fd_set *readfds)
+static int sock_mmap_pktin_fds(pktio_entry_t *pktio_entry,
+			       int index ODP_UNUSED, int fds[],
+			       int num ODP_UNUSED)
 {
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
-	int fd;
 
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
-	fd = pkt_sock->sockfd;
-	FD_SET(fd, readfds);
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
-
-	return fd;
+	/* Socket is created on open and closed on close */
+	fds[0] = pkt_sock->sockfd;
+	return 1;
 }
 
-static int sock_mmap_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmap_recv(pktio_entry_t *pktio_entry, int index,
 			  odp_packet_t pkt_table[], int num)
 {
 	pkt_sock_mmap_t *const pkt_sock = pkt_priv(pktio_entry);
 	int ret;
 
 	odp_ticketlock_lock(&pktio_entry->s.rxl);
-	ret = pkt_mmap_v2_rx(pktio_entry, pkt_sock, pkt_table, num,
+	ret = pkt_mmap_v2_rx(pktio_entry, pkt_sock,
+			     pktio_in_stats(pktio_entry, index), pkt_table, num,
 			     pkt_sock->if_mac);
 	odp_ticketlock_unlock(&pktio_entry->s.rxl);
 
 	return ret;
 }
 
-static int sock_mmap_recv_tmo(pktio_entry_t *pktio_entry, int index,
-			      odp_packet_t pkt_table[], int num, uint64_t usecs)
-{
-	struct timeval timeout;
-	int ret;
-	int maxfd;
-	fd_set readfds;
-
-	ret = sock_mmap_recv(pktio_entry, index, pkt_table, num);
-	if (ret != 0)
-		return ret;
-
-	timeout.tv_sec = usecs / (1000 * 1000);
-	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
-
-	FD_ZERO(&readfds);
-	maxfd = sock_mmap_fd_set(pktio_entry, index, &readfds);
-
-	while (1) {
-		ret = select(maxfd + 1, &readfds, NULL, NULL, &timeout);
-
-		if (ret <= 0)
-			return ret;
-
-		ret = sock_mmap_recv(pktio_entry, index, pkt_table, num);
-
-		if (ret)
-			return ret;
-
-		/* If no packets, continue wait until timeout expires */
-	}
-}
-
-static int sock_mmap_recv_mq_tmo(pktio_entry_t *pktio_entry[], int index[],
-				 int num_q, odp_packet_t pkt_table[], int num,
-				 unsigned *from, uint64_t usecs)
-{
-	struct timeval timeout;
-	int i;
-	int ret;
-	int maxfd = -1, maxfd2;
-	fd_set readfds;
-
-	for (i = 0; i < num_q; i++) {
-		ret = sock_mmap_recv(pktio_entry[i], index[i], pkt_table, num);
-
-		if (ret > 0 && from)
-			*from = i;
-
-		if (ret != 0)
-			return ret;
-	}
-
-	FD_ZERO(&readfds);
-
-	for (i = 0; i < num_q; i++) {
-		maxfd2 = sock_mmap_fd_set(pktio_entry[i], index[i], &readfds);
-		if (maxfd2 > maxfd)
-			maxfd = maxfd2;
-	}
-
-	timeout.tv_sec = usecs / (1000 * 1000);
-	timeout.tv_usec = usecs - timeout.tv_sec * (1000ULL * 1000ULL);
-
-	while (1) {
-		ret = select(maxfd + 1, &readfds, NULL, NULL, &timeout);
-
-		if (ret <= 0)
-			return ret;
-
-		for (i = 0; i < num_q; i++) {
-			ret = sock_mmap_recv(pktio_entry[i], index[i],
-					     pkt_table, num);
-
-			if (ret > 0 && from)
-				*from = i;
-
-			if (ret)
-				return ret;
-		}
-
-		/* If no packets, continue wait until timeout expires */
-	}
-}
-
-static int sock_mmap_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int sock_mmap_send(pktio_entry_t *pktio_entry, int index,
 			  const odp_packet_t pkt_table[], int num)
 {
 	int ret;
@@ -787,7 +748,8 @@ static int sock_mmap_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 
 	odp_ticketlock_lock(&pktio_entry->s.txl);
 	ret = pkt_mmap_v2_tx(pkt_sock->tx_ring.sock, &pkt_sock->tx_ring,
-			     pkt_table, num);
+			     pktio_out_stats(pktio_entry, index), pkt_table,
+			     num);
 	odp_ticketlock_unlock(&pktio_entry->s.txl);
 
 	return ret;
@@ -890,10 +852,8 @@ const pktio_if_ops_t sock_mmap_pktio_ops = {
 	.stats = sock_mmap_stats,
 	.stats_reset = sock_mmap_stats_reset,
 	.recv = sock_mmap_recv,
-	.recv_tmo = sock_mmap_recv_tmo,
-	.recv_mq_tmo = sock_mmap_recv_mq_tmo,
 	.send = sock_mmap_send,
-	.fd_set = sock_mmap_fd_set,
+	.pktin_fds = sock_mmap_pktin_fds,
 	.mtu_get = sock_mmap_mtu_get,
 	.promisc_mode_set = sock_mmap_promisc_mode_set,
 	.promisc_mode_get = sock_mmap_promisc_mode_get,
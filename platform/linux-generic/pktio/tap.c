@@ -25,8 +25,17 @@
  *   iface   the name of TAP device to be created.
  *
  * TUN/TAP kernel module should be loaded to use this pktio.
- * There should be no device named 'iface' in the system.
- * The total length of the 'iface' is limited by IF_NAMESIZE.
+ * There should be no device named 'iface' in the system, or it should be a
+ * persistent TAP device (e.g. created with 'ip tuntap add mode tap'). The
+ * total length of the 'iface' is limited by IF_NAMESIZE.
+ *
+ * Packet data is read and written directly from/to packet segments
+ * (readv/writev). When supported by the kernel, the device is opened with
+ * a virtio net header (IFF_VNET_HDR) and as a multi-queue device
+ * (IFF_MULTI_QUEUE). A persistent device must have been created with the
+ * multi_queue option for the latter. Each input queue has its own TAP queue
+ * file descriptor, the kernel distributes packets to those by flow. Output
+ * queues share the same file descriptors.
  */
 
 #include <odp_posix_extensions.h>
@@ -39,7 +48,9 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <linux/if_tun.h>
+#include <linux/virtio_net.h>
 
 #include <odp_api.h>
 #include <odp/api/plat/packet_inlines.h>
@@ -48,16 +59,41 @@
 #include <odp_packet_io_internal.h>
 #include <odp_classification_internal.h>
 #include <odp_errno_define.h>
+#include <protocols/eth.h>
+#include <protocols/ip.h>
+#include <protocols/tcp.h>
 
 #define BUF_SIZE 65536
 
+/* Length of the virtio net header in front of packet data */
+#define VNET_HDR_LEN sizeof(struct virtio_net_hdr)
+
+/* Maximum number of TAP queues */
+#define TAP_MAX_QUEUES 16
+
+/* Maximum number of iovecs per packet: virtio net header, header copy and
+ * segments */
+#define TAP_MAX_IOV (CONFIG_PACKET_MAX_SEGS + 2)
+
+/* Received frame length on top of MTU: Ethernet header and two VLAN tags */
+#define TAP_FRAME_OVERHEAD (_ODP_ETHHDR_LEN + 2 * _ODP_VLANHDR_LEN)
+
 typedef struct {
-	int fd;				/**< file descriptor for tap interface*/
+	int fd[TAP_MAX_QUEUES];		/**< file descriptors of tap queues */
+	odp_packet_t spare[TAP_MAX_QUEUES]; /**< receive packets left unused by
+						 previous polls */
+	int num_fd;			/**< number of tap queues */
 	int skfd;			/**< socket descriptor */
 	uint32_t mtu;			/**< cached mtu */
 	unsigned char if_mac[ETH_ALEN];	/**< MAC address of pktio side (not a
 					     MAC address of kernel interface)*/
 	odp_pool_t pool;		/**< pool to alloc packets from */
+	uint32_t pool_max_len;		/**< maximum packet length of pool */
+	int vnet_hdr;			/**< virtio net header in use */
+	int multi_queue;		/**< multi-queue device */
+	int rx_gso;			/**< kernel may send GSO packets */
+	odp_bool_t lockless_rx;		/**< no locking for rx statistics */
+	odp_bool_t lockless_tx;		/**< no locking for tx statistics */
 } pkt_tap_t;
 
 ODP_STATIC_ASSERT(PKTIO_PRIVATE_SIZE >= sizeof(pkt_tap_t),
@@ -101,13 +137,89 @@ static int mac_addr_set_fd(int fd, const char *name,
 	return 0;
 }
 
+/* Attach file descriptor to a tap device queue and set it nonblocking */
+static int tap_queue_attach(pkt_tap_t *tap, int fd, const char *name)
+{
+	struct ifreq ifr;
+	int flags;
+
+	memset(&ifr, 0, sizeof(ifr));
+	/* Flags: IFF_TUN   - TUN device (no Ethernet headers)
+	 *        IFF_TAP   - TAP device
+	 *
+	 *        IFF_NO_PI - Do not provide packet information
+	 *        IFF_VNET_HDR - Packet data is preceded by virtio net header
+	 *        IFF_MULTI_QUEUE - Create a queue of multiqueue device
+	 */
+	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
+	if (tap->vnet_hdr)
+		ifr.ifr_flags |= IFF_VNET_HDR;
+	if (tap->multi_queue)
+		ifr.ifr_flags |= IFF_MULTI_QUEUE;
+	snprintf(ifr.ifr_name, IF_NAMESIZE, "%s", name);
+
+	if (ioctl(fd, TUNSETIFF, (void *)&ifr) < 0)
+		return -1;
+
+	/* Set nonblocking mode on interface. */
+	flags = fcntl(fd, F_GETFL, 0);
+	if (flags < 0) {
+		ODP_ERR("fcntl(F_GETFL) failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+		ODP_ERR("fcntl(F_SETFL) failed: %s\n", strerror(errno));
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Open or close tap queues so that there is one per input queue */
+static int tap_queues_set(pktio_entry_t *pktio_entry, int num)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	const char *name = pktio_entry->s.name + 4;
+	int fd;
+
+	while (tap->num_fd > num) {
+		tap->num_fd--;
+		close(tap->fd[tap->num_fd]);
+		tap->fd[tap->num_fd] = -1;
+	}
+
+	while (tap->num_fd < num) {
+		fd = open("/dev/net/tun", O_RDWR);
+		if (fd < 0) {
+			__odp_errno = errno;
+			ODP_ERR("failed to open /dev/net/tun: %s\n",
+				strerror(errno));
+			return -1;
+		}
+
+		if (tap_queue_attach(tap, fd, name)) {
+			__odp_errno = errno;
+			ODP_ERR("%s: tap queue attach failed: %s\n", name,
+				strerror(errno));
+			close(fd);
+			return -1;
+		}
+
+		tap->fd[tap->num_fd++] = fd;
+	}
+
+	return 0;
+}
+
 static int tap_pktio_open(odp_pktio_t id ODP_UNUSED,
 			  pktio_entry_t *pktio_entry,
 			  const char *devname, odp_pool_t pool)
 {
-	int fd, skfd, flags;
+	int fd, skfd, i, ret;
 	uint32_t mtu;
-	struct ifreq ifr;
+	unsigned int features = 0;
+	odp_pool_info_t pool_info;
 	pkt_tap_t *tap = pkt_priv(pktio_entry);
 
 	if (strncmp(devname, "tap:", 4) != 0)
@@ -115,10 +227,13 @@ static int tap_pktio_open(odp_pktio_t id ODP_UNUSED,
 
 	/* Init pktio entry */
 	memset(tap, 0, sizeof(*tap));
-	tap->fd = -1;
+	for (i = 0; i < TAP_MAX_QUEUES; i++) {
+		tap->fd[i] = -1;
+		tap->spare[i] = ODP_PACKET_INVALID;
+	}
 	tap->skfd = -1;
 
-	if (pool == ODP_POOL_INVALID)
+	if (pool == ODP_POOL_INVALID || odp_pool_info(pool, &pool_info))
 		return -1;
 
 	fd = open("/dev/net/tun", O_RDWR);
@@ -128,33 +243,25 @@ static int tap_pktio_open(odp_pktio_t id ODP_UNUSED,
 		return -1;
 	}
 
-	memset(&ifr, 0, sizeof(ifr));
-	/* Flags: IFF_TUN   - TUN device (no Ethernet headers)
-	 *        IFF_TAP   - TAP device
-	 *
-	 *        IFF_NO_PI - Do not provide packet information
-	 */
-	ifr.ifr_flags = IFF_TAP | IFF_NO_PI;
-	snprintf(ifr.ifr_name, IF_NAMESIZE, "%s", devname + 4);
-
-	if (ioctl(fd, TUNSETIFF, (void *)&ifr) < 0) {
-		__odp_errno = errno;
-		ODP_ERR("%s: creating tap device failed: %s\n",
-			ifr.ifr_name, strerror(errno));
-		goto tap_err;
+	/* Virtio net header enables kernel to segment TCP packets, and
+	 * passes checksum status of received packets */
+	if (ioctl(fd, TUNGETFEATURES, &features) == 0) {
+		tap->vnet_hdr = !!(features & IFF_VNET_HDR);
+		tap->multi_queue = !!(features & IFF_MULTI_QUEUE);
 	}
 
-	/* Set nonblocking mode on interface. */
-	flags = fcntl(fd, F_GETFL, 0);
-	if (flags < 0) {
-		__odp_errno = errno;
-		ODP_ERR("fcntl(F_GETFL) failed: %s\n", strerror(errno));
-		goto tap_err;
+	ret = tap_queue_attach(tap, fd, devname + 4);
+
+	/* Persistent single queue device cannot be attached as multi-queue */
+	if (ret && errno == EINVAL && tap->multi_queue) {
+		tap->multi_queue = 0;
+		ret = tap_queue_attach(tap, fd, devname + 4);
 	}
 
-	if (fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0) {
+	if (ret) {
 		__odp_errno = errno;
-		ODP_ERR("fcntl(F_SETFL) failed: %s\n", strerror(errno));
+		ODP_ERR("%s: creating tap device failed: %s\n",
+			devname + 4, strerror(errno));
 		goto tap_err;
 	}
 
@@ -176,10 +283,18 @@ static int tap_pktio_open(odp_pktio_t id ODP_UNUSED,
 		goto sock_err;
 	}
 
-	tap->fd = fd;
+	tap->fd[0] = fd;
+	tap->num_fd = 1;
 	tap->skfd = skfd;
 	tap->mtu = mtu;
 	tap->pool = pool;
+	tap->pool_max_len = pool_info.params.pkt.max_len;
+	if (tap->pool_max_len == 0 || tap->pool_max_len > BUF_SIZE)
+		tap->pool_max_len = BUF_SIZE;
+
+	if (tap->vnet_hdr)
+		pktio_entry->s.tcp_seg_drv = 1;
+
 	return 0;
 sock_err:
 	close(skfd);
@@ -189,6 +304,19 @@ tap_err:
 	return -1;
 }
 
+static void tap_spare_free(pkt_tap_t *tap)
+{
+	odp_packet_t pkt;
+	int i;
+
+	for (i = 0; i < TAP_MAX_QUEUES; i++) {
+		pkt = __atomic_exchange_n(&tap->spare[i], ODP_PACKET_INVALID,
+					  __ATOMIC_ACQUIRE);
+		if (pkt != ODP_PACKET_INVALID)
+			odp_packet_free(pkt);
+	}
+}
+
 static int tap_pktio_start(pktio_entry_t *pktio_entry)
 {
 	struct ifreq ifr;
@@ -225,6 +353,8 @@ static int tap_pktio_stop(pktio_entry_t *pktio_entry)
 	struct ifreq ifr;
 	pkt_tap_t *tap = pkt_priv(pktio_entry);
 
+	tap_spare_free(tap);
+
 	odp_memset(&ifr, 0, sizeof(ifr));
 	snprintf(ifr.ifr_name, IF_NAMESIZE, "%s",
 		 (char *)pktio_entry->s.name + 4);
@@ -254,12 +384,17 @@ sock_err:
 static int tap_pktio_close(pktio_entry_t *pktio_entry)
 {
 	int ret = 0;
+	int i;
 	pkt_tap_t *tap = pkt_priv(pktio_entry);
 
-	if (tap->fd != -1 && close(tap->fd) != 0) {
-		__odp_errno = errno;
-		ODP_ERR("close(tap->fd): %s\n", strerror(errno));
-		ret = -1;
+	tap_spare_free(tap);
+
+	for (i = 0; i < tap->num_fd; i++) {
+		if (close(tap->fd[i]) != 0) {
+			__odp_errno = errno;
+			ODP_ERR("close(tap->fd): %s\n", strerror(errno));
+			ret = -1;
+		}
 	}
 
 	if (tap->skfd != -1 && close(tap->skfd) != 0) {
@@ -271,41 +406,125 @@ static int tap_pktio_close(pktio_entry_t *pktio_entry)
 	return ret;
 }
 
-static odp_packet_t pack_odp_pkt(pktio_entry_t *pktio_entry, const void *data,
-				 unsigned int len, odp_time_t *ts)
+static uint32_t tap_pkt_to_iovec(odp_packet_t pkt, uint32_t offset,
+				 struct iovec iovecs[])
 {
-	odp_packet_t pkt;
-	odp_packet_hdr_t *pkt_hdr;
-	odp_packet_hdr_t parsed_hdr;
-	int num;
+	uint32_t pkt_len = odp_packet_len(pkt);
+	uint32_t iov_count = 0;
 
-	if (pktio_cls_enabled(pktio_entry)) {
-		if (cls_classify_packet(pktio_entry, data, len, len,
-					&pkt_priv(pktio_entry)->pool,
-					&parsed_hdr, true)) {
-			return ODP_PACKET_INVALID;
-		}
+	while (offset < pkt_len) {
+		uint32_t seglen;
+
+		iovecs[iov_count].iov_base = odp_packet_offset(pkt, offset,
+							       &seglen, NULL);
+		iovecs[iov_count].iov_len = seglen;
+		iov_count++;
+		offset += seglen;
 	}
 
-	num = packet_alloc_multi(pkt_priv(pktio_entry)->pool, len, &pkt, 1);
+	return iov_count;
+}
 
-	if (num != 1)
-		return ODP_PACKET_INVALID;
+static odp_packet_t pack_odp_pkt(pktio_entry_t *pktio_entry, int index,
+				 odp_pktin_queue_stats_t *stats,
+				 odp_packet_t pkt, uint32_t len,
+				 const struct virtio_net_hdr *vnet,
+				 odp_time_t *ts)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	odp_packet_hdr_t *pkt_hdr;
+	odp_proto_chksums_t chksums = pktio_entry->s.in_chksums;
+	int data_valid = 0;
 
-	if (odp_packet_copy_from_mem(pkt, 0, len, data) < 0) {
-		ODP_ERR("failed to copy packet data\n");
+	if (odp_packet_trunc_tail(&pkt, odp_packet_len(pkt) - len,
+				  NULL, NULL) < 0) {
+		ODP_ERR("trunc_tail failed\n");
+		stats->errors++;
 		odp_packet_free(pkt);
 		return ODP_PACKET_INVALID;
 	}
 
+	if (vnet != NULL) {
+		if (odp_unlikely(vnet->flags & VIRTIO_NET_HDR_F_NEEDS_CSUM) &&
+		    vnet_hdr_csum_complete(pkt, vnet)) {
+			stats->errors++;
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+
+		/* Kernel has already validated L4 checksum */
+		if (vnet->flags & VIRTIO_NET_HDR_F_DATA_VALID) {
+			data_valid = 1;
+			chksums.chksum.udp = 0;
+			chksums.chksum.tcp = 0;
+			chksums.chksum.sctp = 0;
+		}
+	}
+
 	pkt_hdr = packet_hdr(pkt);
 
-	if (pktio_cls_enabled(pktio_entry))
-		copy_packet_cls_metadata(&parsed_hdr, pkt_hdr);
-	else
+	if (pktio_cls_enabled(pktio_entry)) {
+		odp_packet_t new_pkt;
+		odp_pool_t new_pool;
+		uint8_t *pkt_addr;
+		uint8_t buf[PACKET_PARSE_SEG_LEN];
+		uint32_t seg_len = odp_packet_seg_len(pkt);
+
+		/* Make sure there is enough data for the packet
+		 * parser in the case of a segmented packet. */
+		if (odp_unlikely(seg_len < PACKET_PARSE_SEG_LEN &&
+				 len > PACKET_PARSE_SEG_LEN)) {
+			odp_packet_copy_to_mem(pkt, 0, PACKET_PARSE_SEG_LEN,
+					       buf);
+			seg_len = PACKET_PARSE_SEG_LEN;
+			pkt_addr = buf;
+		} else {
+			pkt_addr = odp_packet_data(pkt);
+		}
+
+		if (cls_classify_packet(pktio_entry, pkt_addr, len, seg_len,
+					&new_pool, pkt_hdr, true)) {
+			stats->cls_discards++;
+			odp_packet_free(pkt);
+			return ODP_PACKET_INVALID;
+		}
+
+		if (new_pool != tap->pool) {
+			new_pkt = odp_packet_copy(pkt, new_pool);
+
+			odp_packet_free(pkt);
+
+			if (new_pkt == ODP_PACKET_INVALID) {
+				stats->alloc_fails++;
+				stats->discards++;
+				return ODP_PACKET_INVALID;
+			}
+
+			pkt = new_pkt;
+			pkt_hdr = packet_hdr(pkt);
+		}
+	} else {
 		packet_parse_layer(pkt_hdr,
 				   pktio_entry->s.config.parser.layer,
-				   pktio_entry->s.in_chksums);
+				   chksums);
+	}
+
+	if (data_valid && (pkt_hdr->p.input_flags.udp ||
+			   pkt_hdr->p.input_flags.tcp ||
+			   pkt_hdr->p.input_flags.sctp))
+		pkt_hdr->p.input_flags.l4_chksum_done = 1;
+
+	/* TCP segments coalesced by the kernel are split back to segments of
+	 * the original size on output (see odp_packet_tcp_mss()), and are
+	 * accounted as merged by GRO */
+	if (vnet != NULL && vnet->gso_size &&
+	    (vnet->gso_type & ~VIRTIO_NET_HDR_GSO_ECN) !=
+	    VIRTIO_NET_HDR_GSO_NONE) {
+		uint32_t segs = vnet_hdr_gso_segs(pkt, vnet->gso_size);
+
+		if (segs > 1)
+			pktio_gro_stats_add(pktio_entry, index, 1, segs);
+	}
 
 	packet_set_ts(pkt_hdr, ts);
 	pkt_hdr->input = pktio_entry->s.handle;
@@ -313,25 +532,60 @@ static odp_packet_t pack_odp_pkt(pktio_entry_t *pktio_entry, const void *data,
 	return pkt;
 }
 
-static int tap_pktio_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
+static int tap_pktio_recv(pktio_entry_t *pktio_entry, int index,
 			  odp_packet_t pkts[], int num)
 {
 	ssize_t retval;
-	int i;
-	uint8_t buf[BUF_SIZE];
+	int i = 0;
 	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	int fd = tap->fd[index];
+	struct virtio_net_hdr vnet;
+	struct iovec iov[TAP_MAX_IOV];
+	uint32_t hdr_len = tap->vnet_hdr ? VNET_HDR_LEN : 0;
+	uint32_t max_len;
 	odp_time_t ts_val;
 	odp_time_t *ts = NULL;
-
-	odp_ticketlock_lock(&pktio_entry->s.rxl);
+	odp_pktin_queue_stats_t burst;
+	odp_pktin_queue_stats_t *stats;
+	odp_packet_t spare;
 
 	if (pktio_entry->s.config.pktin.bit.ts_all ||
 	    pktio_entry->s.config.pktin.bit.ts_ptp)
 		ts = &ts_val;
 
-	for (i = 0; i < num; i++) {
+	max_len = tap->rx_gso ? tap->pool_max_len :
+		  tap->mtu + TAP_FRAME_OVERHEAD;
+
+	iov[0].iov_base = &vnet;
+	iov[0].iov_len = hdr_len;
+
+	memset(&burst, 0, sizeof(burst));
+
+	/* A packet allocated but not filled by the previous poll is used
+	 * first, so that polling an idle queue does not allocate packets */
+	spare = __atomic_exchange_n(&tap->spare[index], ODP_PACKET_INVALID,
+				    __ATOMIC_ACQUIRE);
+
+	/* Packet data is read directly into packet segments. No lock is
+	 * needed, as each read returns a single whole packet. */
+	while (i < num) {
+		odp_packet_t pkt = spare;
+		uint32_t num_iov;
+
+		spare = ODP_PACKET_INVALID;
+
+		if (pkt == ODP_PACKET_INVALID &&
+		    odp_unlikely(packet_alloc_multi(tap->pool, max_len,
+						    &pkt, 1) != 1)) {
+			burst.alloc_fails++;
+			break;
+		}
+
+		num_iov = tap_pkt_to_iovec(pkt, 0, &iov[1]);
+
 		do {
-			retval = read(tap->fd, buf, BUF_SIZE);
+			retval = readv(fd, hdr_len ? iov : &iov[1],
+				       hdr_len ? num_iov + 1 : num_iov);
 		} while (retval < 0 && errno == EINTR);
 
 		if (ts != NULL)
@@ -339,32 +593,111 @@ static int tap_pktio_recv(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
 
 		if (retval < 0) {
 			__odp_errno = errno;
+			spare = pkt;
 			break;
 		}
 
-		pkts[i] = pack_odp_pkt(pktio_entry, buf, retval, ts);
-		if (pkts[i] == ODP_PACKET_INVALID)
+		if (odp_unlikely((uint32_t)retval <= hdr_len)) {
+			spare = pkt;
 			break;
+		}
+
+		pkt = pack_odp_pkt(pktio_entry, index, &burst, pkt,
+				   retval - hdr_len, hdr_len ? &vnet : NULL,
+				   ts);
+		if (pkt == ODP_PACKET_INVALID)
+			continue;
+
+		burst.octets += odp_packet_len(pkt);
+		pkts[i++] = pkt;
 	}
 
-	odp_ticketlock_unlock(&pktio_entry->s.rxl);
+	burst.packets = i;
+
+	if (spare != ODP_PACKET_INVALID) {
+		odp_packet_t empty = ODP_PACKET_INVALID;
+
+		if (!__atomic_compare_exchange_n(&tap->spare[index], &empty,
+						 spare, 0, __ATOMIC_RELEASE,
+						 __ATOMIC_RELAXED))
+			odp_packet_free(spare);
+	}
+
+	/* Statistics are updated once per burst */
+	stats = pktio_in_stats(pktio_entry, index);
+
+	if (!tap->lockless_rx)
+		odp_ticketlock_lock(&pktio_entry->s.rxl);
+
+	stats->octets += burst.octets;
+	stats->packets += burst.packets;
+	stats->discards += burst.discards;
+	stats->errors += burst.errors;
+	stats->alloc_fails += burst.alloc_fails;
+	stats->cls_discards += burst.cls_discards;
+
+	if (!tap->lockless_rx)
+		odp_ticketlock_unlock(&pktio_entry->s.rxl);
 
 	return i;
 }
 
-static int tap_pktio_send_lockless(pktio_entry_t *pktio_entry,
-				   const odp_packet_t pkts[], int num)
+static int tap_pktin_fds(pktio_entry_t *pktio_entry, int index, int fds[],
+			 int num ODP_UNUSED)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+
+	fds[0] = tap->fd[index];
+	return 1;
+}
+
+/* Update output queue statistics once per burst */
+static inline void tap_tx_stats(pktio_entry_t *pktio_entry, int index,
+				int packets, uint64_t octets, int errors)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	odp_pktout_queue_stats_t *stats = pktio_out_stats(pktio_entry, index);
+
+	if (!tap->lockless_tx)
+		odp_ticketlock_lock(&pktio_entry->s.txl);
+
+	stats->packets += packets;
+	stats->octets += octets;
+	stats->errors += errors;
+
+	if (!tap->lockless_tx)
+		odp_ticketlock_unlock(&pktio_entry->s.txl);
+}
+
+static int tap_pktio_send(pktio_entry_t *pktio_entry, int index,
+			  const odp_packet_t pkts[], int num)
 {
 	ssize_t retval;
 	int i, n;
 	uint32_t pkt_len;
-	uint8_t buf[BUF_SIZE];
 	pkt_tap_t *tap = pkt_priv(pktio_entry);
-
+	int fd = tap->fd[index % tap->num_fd];
+	uint32_t hdr_len = tap->vnet_hdr ? VNET_HDR_LEN : 0;
+	struct virtio_net_hdr vnet;
+	struct iovec iov[TAP_MAX_IOV];
+	uint32_t num_iov;
+	uint32_t tcp_hdr;
+	uint8_t tcp_hdr_copy[VNET_TCP_HDR_MAX];
+	uint64_t octets = 0;
+	int tcp_seg;
+
+	iov[0].iov_base = &vnet;
+	iov[0].iov_len = hdr_len;
+
+	/* Packet data is written directly from packet segments. No lock is
+	 * needed, as each write sends a single whole packet. */
 	for (i = 0; i < num; i++) {
 		pkt_len = odp_packet_len(pkts[i]);
+		tcp_seg = tap->vnet_hdr && pktio_entry->s.tcp_seg_ena &&
+			  odp_unlikely(packet_hdr(pkts[i])->p.flags.tcp_seg);
+		tcp_hdr = 0;
 
-		if (pkt_len > tap->mtu) {
+		if (pkt_len > (tcp_seg ? BUF_SIZE : tap->mtu)) {
 			if (i == 0) {
 				__odp_errno = EMSGSIZE;
 				return -1;
@@ -372,52 +705,68 @@ static int tap_pktio_send_lockless(pktio_entry_t *pktio_entry,
 			break;
 		}
 
-		if (odp_packet_copy_to_mem(pkts[i], 0, pkt_len, buf) < 0) {
-			ODP_ERR("failed to copy packet data\n");
-			break;
+		if (tap->vnet_hdr) {
+			memset(&vnet, 0, VNET_HDR_LEN);
+
+			if (tcp_seg)
+				tcp_hdr = vnet_hdr_tcp_seg(pkts[i], pkt_len,
+							   &vnet, tcp_hdr_copy);
+
+			if (tcp_seg && tcp_hdr == 0 && pkt_len > tap->mtu) {
+				if (i == 0) {
+					__odp_errno = EMSGSIZE;
+					return -1;
+				}
+				break;
+			}
+		}
+
+		num_iov = 0;
+
+		/* Headers are sent from a copy with updated checksum field */
+		if (odp_unlikely(tcp_hdr)) {
+			iov[1].iov_base = tcp_hdr_copy;
+			iov[1].iov_len = tcp_hdr;
+			num_iov = 1;
 		}
 
+		num_iov += tap_pkt_to_iovec(pkts[i], tcp_hdr,
+					    &iov[1 + num_iov]);
+
 		do {
-			retval = write(tap->fd, buf, pkt_len);
+			retval = writev(fd, hdr_len ? iov : &iov[1],
+					hdr_len ? num_iov + 1 : num_iov);
 		} while (retval < 0 && errno == EINTR);
 
 		if (retval < 0) {
 			if (i == 0 && SOCK_ERR_REPORT(errno)) {
 				__odp_errno = errno;
-				ODP_ERR("write(): %s\n", strerror(errno));
+				ODP_ERR("writev(): %s\n", strerror(errno));
+				tap_tx_stats(pktio_entry, index, 0, 0, 1);
 				return -1;
 			}
 			break;
-		} else if ((uint32_t)retval != pkt_len) {
+		} else if ((uint32_t)retval != hdr_len + pkt_len) {
 			ODP_ERR("sent partial ethernet packet\n");
 			if (i == 0) {
 				__odp_errno = EMSGSIZE;
+				tap_tx_stats(pktio_entry, index, 0, 0, 1);
 				return -1;
 			}
 			break;
 		}
+
+		octets += pkt_len;
 	}
 
+	tap_tx_stats(pktio_entry, index, i, octets, 0);
+
 	for (n = 0; n < i; n++)
 		odp_packet_free(pkts[n]);
 
 	return i;
 }
 
-static int tap_pktio_send(pktio_entry_t *pktio_entry, int index ODP_UNUSED,
-			  const odp_packet_t pkts[], int num)
-{
-	int ret;
-
-	odp_ticketlock_lock(&pktio_entry->s.txl);
-
-	ret = tap_pktio_send_lockless(pktio_entry, pkts, num);
-
-	odp_ticketlock_unlock(&pktio_entry->s.txl);
-
-	return ret;
-}
-
 static uint32_t tap_mtu_get(pktio_entry_t *pktio_entry)
 {
 	uint32_t ret;
@@ -455,7 +804,7 @@ static int tap_mac_addr_set(pktio_entry_t *pktio_entry, const void *mac_addr)
 
 	memcpy(tap->if_mac, mac_addr, ETH_ALEN);
 
-	return mac_addr_set_fd(tap->fd, (char *)pktio_entry->s.name + 4,
+	return mac_addr_set_fd(tap->fd[0], (char *)pktio_entry->s.name + 4,
 			  tap->if_mac);
 }
 
@@ -465,13 +814,15 @@ static int tap_link_status(pktio_entry_t *pktio_entry)
 			      pktio_entry->s.name + 4);
 }
 
-static int tap_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
+static int tap_capability(pktio_entry_t *pktio_entry,
 			  odp_pktio_capability_t *capa)
 {
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+
 	memset(capa, 0, sizeof(odp_pktio_capability_t));
 
-	capa->max_input_queues  = 1;
-	capa->max_output_queues = 1;
+	capa->max_input_queues  = tap->multi_queue ? TAP_MAX_QUEUES : 1;
+	capa->max_output_queues = tap->multi_queue ? TAP_MAX_QUEUES : 1;
 	capa->set_op.op.promisc_mode = 1;
 	capa->set_op.op.mac_addr = 1;
 
@@ -481,6 +832,76 @@ static int tap_capability(pktio_entry_t *pktio_entry ODP_UNUSED,
 	return 0;
 }
 
+static int tap_config(pktio_entry_t *pktio_entry,
+		      const odp_pktio_config_t *config)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	unsigned int offload = 0;
+
+	if (!tap->vnet_hdr)
+		return 0;
+
+	/* With TCP receive offload enabled, let the kernel pass packets with
+	 * partial checksums and coalesced TCP segments (GSO) */
+	if (config->pktin.bit.tcp_gro)
+		offload = TUN_F_CSUM | TUN_F_TSO4 | TUN_F_TSO6;
+
+	if (ioctl(tap->fd[0], TUNSETOFFLOAD, offload) < 0) {
+		__odp_errno = errno;
+		ODP_ERR("ioctl(TUNSETOFFLOAD): %s\n", strerror(errno));
+		return -1;
+	}
+
+	tap->rx_gso = !!offload;
+
+	return 0;
+}
+
+static int tap_input_queues_config(pktio_entry_t *pktio_entry,
+				   const odp_pktin_queue_param_t *param)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+	odp_pktin_mode_t mode = pktio_entry->s.param.in_mode;
+	int num = pktio_entry->s.num_in_queue;
+
+	/* Scheduler synchronizes input queue polls. Only single thread
+	 * at a time polls a queue */
+	if (mode == ODP_PKTIN_MODE_SCHED)
+		tap->lockless_rx = 1;
+	else if (mode == ODP_PKTIN_MODE_DIRECT)
+		tap->lockless_rx = (param->op_mode == ODP_PKTIO_OP_MT_UNSAFE);
+	else
+		tap->lockless_rx = 0;
+
+	return tap_queues_set(pktio_entry, num > 0 ? num : 1);
+}
+
+static int tap_output_queues_config(pktio_entry_t *pktio_entry,
+				    const odp_pktout_queue_param_t *param)
+{
+	pkt_tap_t *tap = pkt_priv(pktio_entry);
+
+	/* Output queues in queue mode may be used by multiple threads */
+	tap->lockless_tx =
+		pktio_entry->s.param.out_mode == ODP_PKTOUT_MODE_DIRECT &&
+		param->op_mode == ODP_PKTIO_OP_MT_UNSAFE;
+
+	return 0;
+}
+
+static int tap_stats(pktio_entry_t *pktio_entry, odp_pktio_stats_t *stats)
+{
+	memcpy(stats, &pktio_entry->s.stats, sizeof(odp_pktio_stats_t));
+	_odp_pktio_queue_stats_sum(pktio_entry, stats);
+	return 0;
+}
+
+static int tap_stats_reset(pktio_entry_t *pktio_entry)
+{
+	memset(&pktio_entry->s.stats, 0, sizeof(odp_pktio_stats_t));
+	return 0;
+}
+
 const pktio_if_ops_t tap_pktio_ops = {
 	.name = "tap",
 	.print = NULL,
@@ -491,8 +912,11 @@ const pktio_if_ops_t tap_pktio_ops = {
 	.close = tap_pktio_close,
 	.start = tap_pktio_start,
 	.stop = tap_pktio_stop,
+	.stats = tap_stats,
+	.stats_reset = tap_stats_reset,
 	.recv = tap_pktio_recv,
 	.send = tap_pktio_send,
+	.pktin_fds = tap_pktin_fds,
 	.mtu_get = tap_mtu_get,
 	.promisc_mode_set = tap_promisc_mode_set,
 	.promisc_mode_get = tap_promisc_mode_get,
@@ -502,5 +926,7 @@ const pktio_if_ops_t tap_pktio_ops = {
 	.capability = tap_capability,
 	.pktin_ts_res = NULL,
 	.pktin_ts_from_ns = NULL,
-	.config = NULL
+	.config = tap_config,
+	.input_queues_config = tap_input_queues_config,
+	.output_queues_config = tap_output_queues_config
 };
@@ -0,0 +1,261 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include "config.h"
+
+/**
+ * @file
+ *
+ * Name table (internal) concurrent lookup benchmark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <pthread.h>
+
+#include <odp_api.h>
+#include <odp_name_table_internal.h>
+
+/* Names that stay in the table during the test */
+#define NUM_NAMES      (64 * 1024)
+/* Names that the writer thread adds and deletes during the test */
+#define NUM_CHURN      1024
+#define NUM_LOOKUPS    (256 * 1024)
+#define MAX_READERS    8
+#define NAME_KIND      ODP_TM_NODE_HANDLE
+
+typedef struct {
+	char name[_ODP_INT_NAME_LEN + 1];
+} test_name_t;
+
+typedef struct {
+	pthread_t thread;
+	uint64_t  seed;
+	uint64_t  num_error;
+} test_reader_t;
+
+typedef struct {
+	test_name_t      *names;
+	test_name_t      *churn_names;
+	_odp_int_name_t  *churn_id;
+	odp_barrier_t     barrier;
+	odp_atomic_u32_t  readers_done;
+	uint32_t          num_readers;
+	uint64_t          num_churn_ops;
+	uint64_t          num_churn_error;
+	test_reader_t     reader[MAX_READERS];
+} test_global_t;
+
+static test_global_t test_global;
+
+static uint64_t rand_u64(uint64_t *state)
+{
+	/* xorshift64 */
+	*state ^= *state << 13;
+	*state ^= *state >> 7;
+	*state ^= *state << 17;
+	return *state;
+}
+
+static void *reader_thread(void *arg)
+{
+	test_reader_t *reader = arg;
+	_odp_int_name_t odp_name;
+	uint64_t idx;
+	uint32_t i;
+
+	odp_barrier_wait(&test_global.barrier);
+
+	for (i = 0; i < NUM_LOOKUPS; i++) {
+		idx = rand_u64(&reader->seed) % NUM_NAMES;
+		odp_name = _odp_int_name_tbl_lookup(test_global.names[idx].name,
+						    NAME_KIND);
+
+		/* Stable names must always be found, also when a writer
+		 * modifies the table concurrently */
+		if (odp_name == ODP_INVALID_NAME ||
+		    _odp_int_name_tbl_user_data(odp_name) != idx)
+			reader->num_error++;
+	}
+
+	odp_atomic_inc_u32(&test_global.readers_done);
+	return NULL;
+}
+
+static void *writer_thread(void *arg)
+{
+	_odp_int_name_t *churn_id = test_global.churn_id;
+	uint32_t i = 0;
+
+	(void)arg;
+
+	odp_barrier_wait(&test_global.barrier);
+
+	while (odp_atomic_load_u32(&test_global.readers_done) <
+	       test_global.num_readers) {
+		if (churn_id[i] == ODP_INVALID_NAME) {
+			churn_id[i] = _odp_int_name_tbl_add(
+				test_global.churn_names[i].name, NAME_KIND,
+				NUM_NAMES + i);
+			if (churn_id[i] == ODP_INVALID_NAME)
+				test_global.num_churn_error++;
+		} else {
+			if (_odp_int_name_tbl_delete(churn_id[i]) < 0)
+				test_global.num_churn_error++;
+			churn_id[i] = ODP_INVALID_NAME;
+		}
+
+		test_global.num_churn_ops++;
+		i = (i + 1) % NUM_CHURN;
+	}
+
+	return NULL;
+}
+
+static int run_test(uint32_t num_readers, int writer)
+{
+	pthread_t writer_thr;
+	odp_time_t t1, t2;
+	uint64_t nsec, num_error = 0;
+	uint32_t i;
+
+	test_global.num_readers = num_readers;
+	test_global.num_churn_ops = 0;
+	odp_atomic_store_u32(&test_global.readers_done, 0);
+	odp_barrier_init(&test_global.barrier, num_readers + writer + 1);
+
+	for (i = 0; i < num_readers; i++) {
+		test_global.reader[i].seed = i + 1;
+		test_global.reader[i].num_error = 0;
+
+		if (pthread_create(&test_global.reader[i].thread, NULL,
+				   reader_thread, &test_global.reader[i])) {
+			printf("Error: thread create failed\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	if (writer && pthread_create(&writer_thr, NULL, writer_thread, NULL)) {
+		printf("Error: thread create failed\n");
+		exit(EXIT_FAILURE);
+	}
+
+	odp_barrier_wait(&test_global.barrier);
+	t1 = odp_time_local();
+
+	for (i = 0; i < num_readers; i++) {
+		pthread_join(test_global.reader[i].thread, NULL);
+		num_error += test_global.reader[i].num_error;
+	}
+
+	t2 = odp_time_local();
+
+	if (writer)
+		pthread_join(writer_thr, NULL);
+
+	nsec = odp_time_diff_ns(t2, t1);
+
+	printf("%8u %7s %14.1f %12.1f %12" PRIu64 "\n", num_readers,
+	       writer ? "yes" : "no",
+	       (1000.0 * num_readers * NUM_LOOKUPS) / nsec,
+	       (double)nsec / NUM_LOOKUPS, test_global.num_churn_ops);
+
+	if (num_error || test_global.num_churn_error) {
+		printf("Error: %" PRIu64 " failed lookups, %" PRIu64
+		       " failed add/delete\n", num_error,
+		       test_global.num_churn_error);
+		return -1;
+	}
+
+	return 0;
+}
+
+int main(void)
+{
+	odp_instance_t instance;
+	_odp_int_name_t odp_name;
+	uint32_t i, num_readers;
+	int writer, ret = 0;
+
+	if (odp_init_global(&instance, NULL, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	test_global.names = malloc(NUM_NAMES * sizeof(test_name_t));
+	test_global.churn_names = malloc(NUM_CHURN * sizeof(test_name_t));
+	test_global.churn_id = malloc(NUM_CHURN * sizeof(_odp_int_name_t));
+	odp_atomic_init_u32(&test_global.readers_done, 0);
+
+	if (test_global.names == NULL || test_global.churn_names == NULL ||
+	    test_global.churn_id == NULL) {
+		printf("Error: malloc failed.\n");
+		return -1;
+	}
+
+	for (i = 0; i < NUM_NAMES; i++) {
+		snprintf(test_global.names[i].name, _ODP_INT_NAME_LEN + 1,
+			 "name_table_perf_%u", i);
+		odp_name = _odp_int_name_tbl_add(test_global.names[i].name,
+						 NAME_KIND, i);
+		if (odp_name == ODP_INVALID_NAME) {
+			printf("Error: name add failed\n");
+			return -1;
+		}
+	}
+
+	for (i = 0; i < NUM_CHURN; i++) {
+		snprintf(test_global.churn_names[i].name, _ODP_INT_NAME_LEN + 1,
+			 "name_table_churn_%u", i);
+		test_global.churn_id[i] = ODP_INVALID_NAME;
+	}
+
+	printf("\nName table lookup performance test (%u names)\n\n",
+	       NUM_NAMES);
+	printf(" readers  writer  Mlookups/sec  nsec/lookup  add/deletes\n");
+
+	for (num_readers = 1; num_readers <= MAX_READERS; num_readers *= 2) {
+		for (writer = 0; writer < 2; writer++) {
+			if (run_test(num_readers, writer)) {
+				ret = -1;
+				break;
+			}
+		}
+
+		if (ret)
+			break;
+	}
+
+	printf("\n");
+
+	for (i = 0; i < NUM_CHURN; i++)
+		if (test_global.churn_id[i] != ODP_INVALID_NAME)
+			_odp_int_name_tbl_delete(test_global.churn_id[i]);
+
+	free(test_global.names);
+	free(test_global.churn_names);
+	free(test_global.churn_id);
+
+	if (odp_term_local()) {
+		printf("Error: Term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: Term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+# Copyright (c) 2019, Linaro Limited
+# All rights reserved.
+#
+# SPDX-License-Identifier:	BSD-3-Clause
+#
+# Script that runs odp_tm_perf with shaped top-level TM nodes and an
+# increasing number of TM threads (tm.num_threads config option), when
+# launched by 'make check'
+
+TEST_DIR="${TEST_DIR:-$(dirname $0)}"
+TEST_SRC_DIR="${srcdir:-$(dirname $0)}"
+PERFORMANCE="$TEST_DIR/../../../../test/performance"
+DEFAULT_CONF="$TEST_SRC_DIR/../../../../config/odp-linux-generic.conf"
+CONF_FILE=$(mktemp /tmp/odp_tm_perf_XXXXXX)
+ret=0
+
+run()
+{
+	echo odp_tm_perf_run starts with $1 TM threads
+	echo =========================================
+
+	sed "s/num_threads = [0-9]*/num_threads = $1/" $DEFAULT_CONF \
+		> $CONF_FILE
+
+	ODP_CONFIG_FILE=$CONF_FILE $PERFORMANCE/odp_tm_perf${EXEEXT} \
+		-t 8 -q 64 -r 1000 -n 50000 || ret=1
+}
+
+run 1
+run 2
+run 4
+
+rm -f $CONF_FILE
+
+exit $ret
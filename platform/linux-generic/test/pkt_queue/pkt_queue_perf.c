@@ -0,0 +1,255 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include "config.h"
+
+/**
+ * @file
+ *
+ * Packet queue (traffic manager internal) micro benchmark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <odp_api.h>
+#include <odp_pkt_queue_internal.h>
+
+#define NUM_QUEUES  1024
+#define MAX_DEPTH   128
+#define MAX_BURST   32
+#define NUM_ROUNDS  (256 * 1024)
+
+/* Packet queues do not touch packets, so tests use fake packet handles that
+ * encode the queue index and a per queue sequence number */
+#define SEQ_BITS    20
+#define SEQ_MASK    ((1 << SEQ_BITS) - 1)
+
+typedef struct {
+	_odp_int_pkt_queue_t pkt_queue;
+	uint32_t next_in;
+	uint32_t next_out;
+} test_queue_t;
+
+static test_queue_t test_queue[NUM_QUEUES];
+static uint64_t rand_state = 1;
+
+static uint64_t rand_u64(void)
+{
+	/* xorshift64 */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+static inline odp_packet_t make_pkt(uint32_t q)
+{
+	uint32_t seq = test_queue[q].next_in++ & SEQ_MASK;
+
+	return (odp_packet_t)(uintptr_t)(((q + 1) << SEQ_BITS) | seq);
+}
+
+static inline int check_pkt(uint32_t q, odp_packet_t pkt)
+{
+	uint32_t seq = test_queue[q].next_out++ & SEQ_MASK;
+
+	if ((uintptr_t)pkt != ((uintptr_t)(q + 1) << SEQ_BITS | seq)) {
+		printf("Error: bad pkt on queue %u\n", q);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int append_burst(_odp_int_queue_pool_t pool, uint32_t q, int num,
+			int multi)
+{
+	odp_packet_t pkts[MAX_BURST];
+	int i;
+
+	for (i = 0; i < num; i++)
+		pkts[i] = make_pkt(q);
+
+	if (multi) {
+		if (_odp_pkt_queue_append_multi(pool, test_queue[q].pkt_queue,
+						pkts, num) != num)
+			return -1;
+		return 0;
+	}
+
+	for (i = 0; i < num; i++)
+		if (_odp_pkt_queue_append(pool, test_queue[q].pkt_queue,
+					  pkts[i]))
+			return -1;
+
+	return 0;
+}
+
+static int remove_burst(_odp_int_queue_pool_t pool, uint32_t q, int num,
+			int multi)
+{
+	odp_packet_t pkts[MAX_BURST];
+	int i, ret;
+
+	if (multi) {
+		ret = _odp_pkt_queue_remove_multi(pool, test_queue[q].pkt_queue,
+						  pkts, num);
+	} else {
+		for (ret = 0; ret < num; ret++)
+			if (_odp_pkt_queue_remove(pool, test_queue[q].pkt_queue,
+						  &pkts[ret]) != 1)
+				break;
+	}
+
+	if (ret < 0)
+		return -1;
+
+	for (i = 0; i < ret; i++)
+		if (check_pkt(q, pkts[i]))
+			return -1;
+
+	return ret;
+}
+
+static int run_test(int burst, int multi)
+{
+	_odp_int_queue_pool_t pool;
+	uint64_t c1, c2, num_pkts = 0;
+	uint32_t i, q, depth;
+	int ret;
+
+	pool = _odp_queue_pool_create(NUM_QUEUES, NUM_QUEUES * MAX_DEPTH);
+	if (pool == _ODP_INT_QUEUE_POOL_INVALID) {
+		printf("Error: pool create failed\n");
+		return -1;
+	}
+
+	memset(test_queue, 0, sizeof(test_queue));
+	for (q = 0; q < NUM_QUEUES; q++) {
+		test_queue[q].pkt_queue = _odp_pkt_queue_create(pool);
+		if (test_queue[q].pkt_queue == _ODP_INT_PKT_QUEUE_INVALID) {
+			printf("Error: queue create failed\n");
+			return -1;
+		}
+	}
+
+	/* Append to and remove from random queues, so that queue depths keep
+	 * changing and blocks get recycled between queues */
+	c1 = odp_cpu_cycles();
+	for (i = 0; i < NUM_ROUNDS; i++) {
+		q = rand_u64() % NUM_QUEUES;
+		depth = test_queue[q].next_in - test_queue[q].next_out;
+		if (depth + burst <= MAX_DEPTH) {
+			if (append_burst(pool, q, burst, multi)) {
+				printf("Error: append failed\n");
+				return -1;
+			}
+			num_pkts += burst;
+		}
+
+		q = rand_u64() % NUM_QUEUES;
+		ret = remove_burst(pool, q, burst, multi);
+		if (ret < 0)
+			return -1;
+		num_pkts += ret;
+	}
+	c2 = odp_cpu_cycles();
+
+	/* Drain and check that all queues are empty */
+	for (q = 0; q < NUM_QUEUES; q++) {
+		while ((ret = remove_burst(pool, q, MAX_BURST, multi)) > 0)
+			;
+
+		if (ret < 0 || test_queue[q].next_in != test_queue[q].next_out) {
+			printf("Error: queue %u not drained\n", q);
+			return -1;
+		}
+	}
+
+	printf("%8i %8s %20.1f\n", burst, multi ? "yes" : "no",
+	       (double)odp_cpu_cycles_diff(c2, c1) / num_pkts);
+
+	_odp_queue_pool_destroy(pool);
+	return 0;
+}
+
+/* Pkts appended after a partial remove from a single block queue must stay
+ * behind the remaining pkts */
+static int fifo_test(void)
+{
+	_odp_int_queue_pool_t pool;
+	uint32_t q = 0;
+	int i, ret = 0;
+
+	pool = _odp_queue_pool_create(1, 64);
+	memset(test_queue, 0, sizeof(test_queue));
+	test_queue[q].pkt_queue = _odp_pkt_queue_create(pool);
+
+	for (i = 0; i < 20 && ret == 0; i++) {
+		if (append_burst(pool, q, 3, i & 1) ||
+		    remove_burst(pool, q, 2, i & 2) != 2)
+			ret = -1;
+	}
+
+	while (ret == 0 && (i = remove_burst(pool, q, MAX_BURST, 1)) > 0)
+		;
+
+	if (ret || i < 0 || test_queue[q].next_in != test_queue[q].next_out) {
+		printf("Error: FIFO test failed\n");
+		ret = -1;
+	}
+
+	_odp_queue_pool_destroy(pool);
+	return ret;
+}
+
+int main(void)
+{
+	odp_instance_t instance;
+	int burst, multi, ret = 0;
+
+	if (odp_init_global(&instance, NULL, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	printf("\nPacket queue performance test (%i queues)\n\n", NUM_QUEUES);
+	printf("   burst    multi  CPU cycles per pkt\n");
+
+	ret = fifo_test();
+
+	for (burst = 1; burst <= MAX_BURST && ret == 0; burst *= 2) {
+		for (multi = 0; multi < 2; multi++) {
+			if (run_test(burst, multi)) {
+				ret = -1;
+				break;
+			}
+		}
+	}
+
+	printf("\n");
+
+	if (odp_term_local()) {
+		printf("Error: Term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: Term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,442 @@
+/* Copyright (c) 2018, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include "config.h"
+
+/**
+ * @file
+ *
+ * @example pktio_memif.c  ODP memif pktio test application.
+ *		Two instances of this application are connected over a memif
+ *		socket. Master instance returns all received packets back to
+ *		the same queue. Slave instance sends numbered packets of
+ *		various sizes to all queues and checks that all of them are
+ *		received back intact.
+ */
+
+#include <stdlib.h>
+#include <inttypes.h>
+#include <string.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include <test_debug.h>
+
+#include <odp_api.h>
+#include <odp/helper/odph_api.h>
+
+#define POOL_NUM_PKT	8192
+#define POOL_PKT_LEN	1536
+#define MAX_PKT_BURST	32
+#define MAX_QUEUES	4
+
+#define TEST_MAGIC	0x6d656d69
+
+/** Get rid of path in filename - only for unix-type paths using '/' */
+#define NO_PATH(file_name) (strrchr((file_name), '/') ? \
+			    strrchr((file_name), '/') + 1 : (file_name))
+
+/* Packet lengths: larger packets span multiple memif buffers */
+static const uint32_t pkt_len[] = {64, 1500, 60, 3000, 128, 9000};
+
+#define NUM_PKT_LEN (sizeof(pkt_len) / sizeof(pkt_len[0]))
+
+/** Packet header in payload */
+typedef struct ODP_PACKED {
+	odp_u32be_t magic;
+	odp_u32be_t seq;
+	odp_u32be_t queue;
+} pkt_head_t;
+
+static struct {
+	char socket[256];
+	int master;
+	int run_time_sec;
+	int num_queues;
+	int num_pkts;
+} args;
+
+static void usage(char *progname)
+{
+	printf("\n"
+	       "Usage: %s OPTIONS\n"
+	       "  E.g. %s -m -s /tmp/memif.sock\n"
+	       "\n"
+	       "OpenDataPlane memif pktio test application.\n"
+	       "\n"
+	       "Optional OPTIONS\n"
+	       "  -s, --socket         Control socket path.\n"
+	       "  -m, --master         Run as master (echo packets back).\n"
+	       "  -q, --queues         Number of queues (default 1).\n"
+	       "  -n, --num            Packets to send per queue (default 10000).\n"
+	       "  -t, --time           Time to run in seconds.\n"
+	       "  -h, --help           Display help and exit.\n"
+	       "\n", NO_PATH(progname), NO_PATH(progname));
+}
+
+static void parse_args(int argc, char *argv[])
+{
+	int opt;
+	int long_index;
+	static struct option longopts[] = {
+		{"socket", required_argument, NULL, 's'},
+		{"master", no_argument, NULL, 'm'},
+		{"queues", required_argument, NULL, 'q'},
+		{"num", required_argument, NULL, 'n'},
+		{"time", required_argument, NULL, 't'},
+		{"help", no_argument, NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	strcpy(args.socket, "/tmp/odp_memif.sock");
+	args.run_time_sec = 10;
+	args.num_queues = 1;
+	args.num_pkts = 10000;
+
+	while (1) {
+		opt = getopt_long(argc, argv, "+s:mq:n:t:h",
+				  longopts, &long_index);
+
+		if (opt == -1)
+			break;	/* No more options */
+
+		switch (opt) {
+		case 's':
+			snprintf(args.socket, sizeof(args.socket), "%s",
+				 optarg);
+			break;
+		case 'm':
+			args.master = 1;
+			break;
+		case 'q':
+			args.num_queues = atoi(optarg);
+			break;
+		case 'n':
+			args.num_pkts = atoi(optarg);
+			break;
+		case 't':
+			args.run_time_sec = atoi(optarg);
+			break;
+		case 'h':
+		default:
+			usage(argv[0]);
+			exit(EXIT_SUCCESS);
+			break;
+		}
+	}
+
+	if (args.num_queues < 1 || args.num_queues > MAX_QUEUES) {
+		usage(argv[0]);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static odp_pktio_t create_pktio(odp_pool_t pool)
+{
+	odp_pktio_param_t pktio_param;
+	odp_pktin_queue_param_t pktin_param;
+	odp_pktout_queue_param_t pktout_param;
+	odp_pktio_t pktio;
+	char name[300];
+
+	snprintf(name, sizeof(name), "memif:socket=%s%s", args.socket,
+		 args.master ? ":master" : "");
+
+	odp_pktio_param_init(&pktio_param);
+
+	pktio = odp_pktio_open(name, pool, &pktio_param);
+	if (pktio == ODP_PKTIO_INVALID) {
+		LOG_ERR("Error: pktio %s open failed.\n", name);
+		return ODP_PKTIO_INVALID;
+	}
+
+	odp_pktin_queue_param_init(&pktin_param);
+	pktin_param.op_mode = ODP_PKTIO_OP_MT_UNSAFE;
+	pktin_param.num_queues = args.num_queues;
+
+	odp_pktout_queue_param_init(&pktout_param);
+	pktout_param.op_mode = ODP_PKTIO_OP_MT_UNSAFE;
+	pktout_param.num_queues = args.num_queues;
+
+	if (odp_pktin_queue_config(pktio, &pktin_param) ||
+	    odp_pktout_queue_config(pktio, &pktout_param)) {
+		LOG_ERR("Error: queue config failed.\n");
+		odp_pktio_close(pktio);
+		return ODP_PKTIO_INVALID;
+	}
+
+	return pktio;
+}
+
+/* Retry start until the peer is connected */
+static int start_pktio(odp_pktio_t pktio, odp_time_t end)
+{
+	while (odp_pktio_start(pktio)) {
+		if (odp_time_cmp(odp_time_local(), end) > 0) {
+			LOG_ERR("Error: peer did not connect\n");
+			return -1;
+		}
+		usleep(10000);
+	}
+
+	printf("%s connected\n", args.master ? "master" : "slave");
+	odp_pktio_print(pktio);
+	return 0;
+}
+
+/* Send all packets back to the same queue, until slave disconnects */
+static int run_master(odp_pktio_t pktio, odp_time_t end)
+{
+	odp_pktin_queue_t pktin[MAX_QUEUES];
+	odp_pktout_queue_t pktout[MAX_QUEUES];
+	odp_packet_t pkt_tbl[MAX_PKT_BURST];
+	uint64_t echoed = 0;
+	int q, num, sent;
+
+	if (odp_pktin_queue(pktio, pktin, MAX_QUEUES) != args.num_queues ||
+	    odp_pktout_queue(pktio, pktout, MAX_QUEUES) != args.num_queues) {
+		LOG_ERR("Error: no queues\n");
+		return -1;
+	}
+
+	while (odp_pktio_link_status(pktio) == 1) {
+		if (odp_time_cmp(odp_time_local(), end) > 0) {
+			LOG_ERR("Error: timeout, %" PRIu64 " packets echoed\n",
+				echoed);
+			return -1;
+		}
+
+		for (q = 0; q < args.num_queues; q++) {
+			num = odp_pktin_recv(pktin[q], pkt_tbl, MAX_PKT_BURST);
+			if (num <= 0)
+				continue;
+
+			sent = 0;
+			while (sent < num &&
+			       odp_time_cmp(odp_time_local(), end) < 0) {
+				int ret = odp_pktout_send(pktout[q],
+							  &pkt_tbl[sent],
+							  num - sent);
+
+				if (ret < 0)
+					break;
+				sent += ret;
+			}
+
+			if (sent < num)
+				odp_packet_free_multi(&pkt_tbl[sent],
+						      num - sent);
+			echoed += sent;
+		}
+	}
+
+	printf("master: slave disconnected, %" PRIu64 " packets echoed\n",
+	       echoed);
+
+	return echoed ? 0 : -1;
+}
+
+static odp_packet_t alloc_test_packet(odp_pool_t pool, uint32_t seq,
+				      uint32_t queue)
+{
+	uint32_t len = pkt_len[seq % NUM_PKT_LEN];
+	odp_packet_t pkt;
+	pkt_head_t head;
+	uint8_t data[9000];
+	uint32_t i;
+
+	pkt = odp_packet_alloc(pool, len);
+	if (pkt == ODP_PACKET_INVALID)
+		return pkt;
+
+	for (i = 0; i < len; i++)
+		data[i] = seq + i;
+
+	head.magic = odp_cpu_to_be_32(TEST_MAGIC);
+	head.seq = odp_cpu_to_be_32(seq);
+	head.queue = odp_cpu_to_be_32(queue);
+	memcpy(data, &head, sizeof(head));
+
+	odp_packet_copy_from_mem(pkt, 0, len, data);
+
+	return pkt;
+}
+
+static int check_test_packet(odp_packet_t pkt, uint32_t queue,
+			     uint32_t *next_seq)
+{
+	uint32_t len = odp_packet_len(pkt);
+	uint8_t data[9000];
+	pkt_head_t head;
+	uint32_t seq, i;
+
+	if (len < sizeof(head) || len > sizeof(data)) {
+		LOG_ERR("Error: bad packet length %" PRIu32 "\n", len);
+		return -1;
+	}
+
+	odp_packet_copy_to_mem(pkt, 0, len, data);
+	memcpy(&head, data, sizeof(head));
+	seq = odp_be_to_cpu_32(head.seq);
+
+	if (odp_be_to_cpu_32(head.magic) != TEST_MAGIC ||
+	    odp_be_to_cpu_32(head.queue) != queue) {
+		LOG_ERR("Error: bad packet header\n");
+		return -1;
+	}
+
+	/* Packets are passed in order through a queue */
+	if (seq != *next_seq || len != pkt_len[seq % NUM_PKT_LEN]) {
+		LOG_ERR("Error: packet %" PRIu32 " (len %" PRIu32 "), "
+			"expected %" PRIu32 "\n", seq, len, *next_seq);
+		return -1;
+	}
+
+	for (i = sizeof(head); i < len; i++) {
+		if (data[i] != (uint8_t)(seq + i)) {
+			LOG_ERR("Error: packet %" PRIu32 " data at %" PRIu32
+				"\n", seq, i);
+			return -1;
+		}
+	}
+
+	(*next_seq)++;
+	return 0;
+}
+
+/* Send numbered packets to all queues and check that they come back */
+static int run_slave(odp_pktio_t pktio, odp_pool_t pool, odp_time_t end)
+{
+	odp_pktin_queue_t pktin[MAX_QUEUES];
+	odp_pktout_queue_t pktout[MAX_QUEUES];
+	odp_packet_t pkt_tbl[MAX_PKT_BURST];
+	uint32_t tx_seq[MAX_QUEUES] = {0};
+	uint32_t rx_seq[MAX_QUEUES] = {0};
+	uint32_t num_pkts = args.num_pkts;
+	uint32_t received = 0;
+	int q, i, num, ret;
+
+	if (odp_pktin_queue(pktio, pktin, MAX_QUEUES) != args.num_queues ||
+	    odp_pktout_queue(pktio, pktout, MAX_QUEUES) != args.num_queues) {
+		LOG_ERR("Error: no queues\n");
+		return -1;
+	}
+
+	while (received < num_pkts * args.num_queues) {
+		if (odp_time_cmp(odp_time_local(), end) > 0) {
+			LOG_ERR("Error: timeout, %" PRIu32 " packets "
+				"received\n", received);
+			return -1;
+		}
+
+		for (q = 0; q < args.num_queues; q++) {
+			/* Keep a limited number of packets in flight */
+			for (num = 0; num < MAX_PKT_BURST &&
+			     tx_seq[q] + num < num_pkts &&
+			     tx_seq[q] + num - rx_seq[q] < 256; num++) {
+				pkt_tbl[num] = alloc_test_packet(pool,
+								 tx_seq[q] +
+								 num, q);
+				if (pkt_tbl[num] == ODP_PACKET_INVALID)
+					break;
+			}
+
+			ret = num ? odp_pktout_send(pktout[q], pkt_tbl, num) :
+			      0;
+			if (ret < 0)
+				ret = 0;
+			if (ret < num)
+				odp_packet_free_multi(&pkt_tbl[ret], num - ret);
+			tx_seq[q] += ret;
+
+			num = odp_pktin_recv(pktin[q], pkt_tbl, MAX_PKT_BURST);
+			for (i = 0; i < num; i++) {
+				ret = check_test_packet(pkt_tbl[i], q,
+							&rx_seq[q]);
+				odp_packet_free(pkt_tbl[i]);
+				if (ret) {
+					odp_packet_free_multi(&pkt_tbl[i + 1],
+							      num - i - 1);
+					return -1;
+				}
+			}
+
+			if (num > 0)
+				received += num;
+		}
+	}
+
+	printf("slave: %" PRIu32 " packets received\n", received);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	odp_instance_t instance;
+	odp_pool_param_t params;
+	odp_pool_t pool;
+	odp_pktio_t pktio;
+	odp_time_t end;
+	int ret = -1;
+
+	parse_args(argc, argv);
+
+	if (odp_init_global(&instance, NULL, NULL)) {
+		LOG_ERR("Error: ODP global init failed.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	if (odp_init_local(instance, ODP_THREAD_WORKER)) {
+		LOG_ERR("Error: ODP local init failed.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	odp_pool_param_init(&params);
+	params.pkt.len = POOL_PKT_LEN;
+	params.pkt.num = POOL_NUM_PKT;
+	params.type = ODP_POOL_PACKET;
+
+	pool = odp_pool_create("memif_pool", &params);
+	if (pool == ODP_POOL_INVALID) {
+		LOG_ERR("Error: packet pool create failed.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	pktio = create_pktio(pool);
+	if (pktio == ODP_PKTIO_INVALID)
+		exit(EXIT_FAILURE);
+
+	end = odp_time_sum(odp_time_local(),
+			   odp_time_local_from_ns(args.run_time_sec *
+						  ODP_TIME_SEC_IN_NS));
+
+	if (start_pktio(pktio, end) == 0) {
+		if (args.master)
+			ret = run_master(pktio, end);
+		else
+			ret = run_slave(pktio, pool, end);
+
+		odp_pktio_stop(pktio);
+	}
+
+	if (odp_pktio_close(pktio)) {
+		LOG_ERR("Error: pktio close failed.\n");
+		ret = -1;
+	}
+
+	if (odp_pool_destroy(pool)) {
+		LOG_ERR("Error: pool destroy failed.\n");
+		ret = -1;
+	}
+
+	if (odp_term_local() || odp_term_global(instance)) {
+		LOG_ERR("Error: ODP term failed.\n");
+		ret = -1;
+	}
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,72 @@
+#!/bin/sh
+#
+# Copyright (c) 2018, Linaro Limited
+# All rights reserved.
+#
+# SPDX-License-Identifier:	BSD-3-Clause
+#
+
+# directories where test binary can be found:
+# -in the validation dir when running make check (intree or out of tree)
+# -in the script directory, when running after 'make install', or
+# -in the validation when running standalone (./pktio_memif_run) intree.
+# -in the current directory.
+# running stand alone out of tree requires setting PATH
+PATH=./pktio_memif:$PATH
+PATH=$(dirname $0):$PATH
+PATH=$(dirname $0)/../../../../platform/linux-generic/test/pktio_memif:$PATH
+PATH=.:$PATH
+
+TIMEOUT=30
+NUM_PKTS=10000
+SOCKET=/tmp/odp_memif_test_$$.sock
+
+# run_stage <description> <number of queues>
+run_stage()
+{
+	echo "==== $1, $2 queue(s) ===="
+	pktio_memif${EXEEXT} -m -s ${SOCKET} -q $2 -t ${TIMEOUT} &
+	MASTER_PID=$!
+
+	pktio_memif${EXEEXT} -s ${SOCKET} -q $2 -n ${NUM_PKTS} -t ${TIMEOUT}
+	ret=$?
+
+	# master exits when slave disconnects
+	wait ${MASTER_PID}
+	master_ret=$?
+
+	if [ $ret -ne 0 ] || [ ${master_ret} -ne 0 ]; then
+		echo "!!! FAILED: slave $ret, master ${master_ret} !!!"
+		rm -f ${SOCKET}
+		exit 1
+	fi
+
+	echo "PASSED"
+}
+
+run()
+{
+	run_stage "slave zero-copy" 1
+	run_stage "slave zero-copy" 2
+
+	# Both ends copy packets
+	CONF=$(mktemp)
+	cat > ${CONF} <<EOC
+odp_implementation = "linux-generic"
+config_file_version = "0.1.0"
+pktio_memif: {
+	zero_copy = 0
+}
+EOC
+	export ODP_CONFIG_FILE=${CONF}
+	run_stage "slave copy" 2
+	unset ODP_CONFIG_FILE
+	rm -f ${CONF}
+
+	echo "!!!PASSED!!!"
+	exit 0
+}
+
+case "$1" in
+	*)       run ;;
+esac
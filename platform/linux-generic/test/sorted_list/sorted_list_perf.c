@@ -0,0 +1,313 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include "config.h"
+
+/**
+ * @file
+ *
+ * Sorted list (traffic manager internal) micro benchmark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <odp_api.h>
+#include <odp_sorted_list_internal.h>
+
+#define MIN_LEN    8
+#define MAX_LEN    (64 * 1024)
+#define NUM_ROUNDS (32 * 1024)
+
+/* Number of entries in the find and delete check */
+#define NUM_CHECK  5
+
+/* Sort keys are drawn from a small range relative to list length, so that
+ * lists contain plenty of equal keys */
+#define KEY_RANGE(len) (4 * (len))
+
+static uint64_t rand_state = 1;
+
+static uint64_t rand_u64(void)
+{
+	/* xorshift64 */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+/* Drain the list and check that entries come out sorted by sort_key, and by
+ * insertion order (user_data) when sort keys are equal */
+static int check_and_drain(_odp_int_sorted_pool_t pool,
+			   _odp_int_sorted_list_t list, uint32_t len)
+{
+	uint64_t sort_key, user_data, prev_key = 0, prev_data = 0;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		if (_odp_sorted_list_remove(pool, list, &sort_key,
+					    &user_data) != 1) {
+			printf("Error: remove failed at %u/%u\n", i, len);
+			return -1;
+		}
+
+		if (i && (sort_key < prev_key ||
+			  (sort_key == prev_key && user_data < prev_data))) {
+			printf("Error: bad order at %u/%u\n", i, len);
+			return -1;
+		}
+
+		prev_key  = sort_key;
+		prev_data = user_data;
+	}
+
+	if (_odp_sorted_list_remove(pool, list, &sort_key, &user_data) >= 0) {
+		printf("Error: list not empty\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* Insert len entries with random sort keys and user data 0 ... len - 1 */
+static void fill(_odp_int_sorted_pool_t pool, _odp_int_sorted_list_t list,
+		 uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		_odp_sorted_list_insert(pool, list, rand_u64() % KEY_RANGE(len),
+					i);
+}
+
+static int drain(_odp_int_sorted_pool_t pool, _odp_int_sorted_list_t list,
+		 uint32_t len)
+{
+	uint64_t sort_key, user_data;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		if (_odp_sorted_list_remove(pool, list, &sort_key,
+					    &user_data) != 1) {
+			printf("Error: remove failed\n");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int run_test(uint32_t len)
+{
+	_odp_int_sorted_pool_t pool;
+	_odp_int_sorted_list_t list;
+	uint64_t c1, c2, sort_key, user_data, key_range;
+	uint64_t insert_cycles, cycles, delete_cycles, num_delete;
+	uint64_t next_data = 0;
+	uint32_t i, rounds;
+	int ret = 0;
+
+	pool = _odp_sorted_pool_create(2);
+	list = _odp_sorted_list_create(pool, len);
+	key_range = KEY_RANGE(len);
+
+	/* Fill the list */
+	c1 = odp_cpu_cycles();
+	for (i = 0; i < len; i++) {
+		if (_odp_sorted_list_insert(pool, list,
+					    rand_u64() % key_range,
+					    next_data++)) {
+			printf("Error: insert failed\n");
+			ret = -1;
+			goto destroy;
+		}
+	}
+	c2 = odp_cpu_cycles();
+	insert_cycles = odp_cpu_cycles_diff(c2, c1);
+
+	/* Steady state: remove the smallest entry and insert a new one with
+	 * a larger sort key, like TM schedulers do with virtual finish
+	 * times */
+	rounds = NUM_ROUNDS;
+	c1 = odp_cpu_cycles();
+	for (i = 0; i < rounds; i++) {
+		if (_odp_sorted_list_remove(pool, list, &sort_key,
+					    &user_data) != 1) {
+			printf("Error: remove failed\n");
+			ret = -1;
+			goto destroy;
+		}
+
+		_odp_sorted_list_insert(pool, list,
+					sort_key + rand_u64() % key_range,
+					next_data++);
+	}
+	c2 = odp_cpu_cycles();
+	cycles = odp_cpu_cycles_diff(c2, c1);
+
+	if (drain(pool, list, len)) {
+		ret = -1;
+		goto destroy;
+	}
+
+	/* Delete and re-insert entries found by user data */
+	fill(pool, list, len);
+	num_delete = len < 1024 ? len : 1024;
+	c1 = odp_cpu_cycles();
+	for (i = 0; i < num_delete; i++) {
+		user_data = rand_u64() % len;
+
+		if (_odp_sorted_list_find(pool, list, user_data,
+					  &sort_key) != 1 ||
+		    _odp_sorted_list_delete(pool, list, user_data)) {
+			printf("Error: find/delete failed\n");
+			ret = -1;
+			goto destroy;
+		}
+
+		_odp_sorted_list_insert(pool, list, sort_key, user_data);
+	}
+	c2 = odp_cpu_cycles();
+	delete_cycles = odp_cpu_cycles_diff(c2, c1);
+
+	printf("%8u %14.1f %16.1f %18.1f\n", len,
+	       (double)insert_cycles / len, (double)cycles / rounds,
+	       (double)delete_cycles / num_delete);
+
+	/* Re-inserted entries are out of user data order */
+	if (drain(pool, list, len)) {
+		ret = -1;
+		goto destroy;
+	}
+
+	/* Check ordering with a fresh fill */
+	fill(pool, list, len);
+	ret = check_and_drain(pool, list, len);
+
+destroy:
+	if (_odp_sorted_list_destroy(pool, list) && ret == 0) {
+		printf("Error: list destroy failed\n");
+		ret = -1;
+	}
+
+	_odp_sorted_pool_destroy(pool);
+	return ret;
+}
+
+/* Find and delete pick the entry with the lowest sort key (the oldest one on
+ * equal keys) among entries with the same user data. Indexes of destroyed
+ * lists are reused. */
+static int run_check(void)
+{
+	static const uint64_t sort_key[NUM_CHECK]  = {50, 30, 90, 30, 70};
+	static const uint64_t user_data[NUM_CHECK] = {1, 1, 1, 2, 1};
+	/* Sort keys of user data 1 entries in the order they are found */
+	static const uint64_t expected[NUM_CHECK - 1] = {30, 50, 70, 90};
+	_odp_int_sorted_pool_t pool;
+	_odp_int_sorted_list_t list, list2;
+	uint64_t key, data;
+	uint32_t i;
+	int ret = -1;
+
+	pool = _odp_sorted_pool_create(3);
+	if (pool == _ODP_INT_SORTED_POOL_INVALID) {
+		printf("Error: pool create failed\n");
+		return -1;
+	}
+
+	list = _odp_sorted_list_create(pool, NUM_CHECK);
+
+	for (i = 0; i < NUM_CHECK; i++)
+		_odp_sorted_list_insert(pool, list, sort_key[i], user_data[i]);
+
+	for (i = 0; i < NUM_CHECK - 1; i++) {
+		if (_odp_sorted_list_find(pool, list, 1, &key) != 1 ||
+		    key != expected[i]) {
+			printf("Error: find returned a wrong entry\n");
+			goto destroy;
+		}
+
+		if (_odp_sorted_list_delete(pool, list, 1)) {
+			printf("Error: delete failed\n");
+			goto destroy;
+		}
+	}
+
+	if (_odp_sorted_list_find(pool, list, 1, NULL) != 0 ||
+	    _odp_sorted_list_remove(pool, list, &key, &data) != 1 ||
+	    key != 30 || data != 2) {
+		printf("Error: wrong entries left\n");
+		goto destroy;
+	}
+
+	if (_odp_sorted_list_destroy(pool, list)) {
+		printf("Error: list destroy failed\n");
+		goto destroy;
+	}
+
+	list2 = _odp_sorted_list_create(pool, NUM_CHECK);
+	if (list2 != list) {
+		printf("Error: list index not reused\n");
+		goto destroy;
+	}
+
+	ret = 0;
+
+destroy:
+	_odp_sorted_list_destroy(pool, list);
+	_odp_sorted_pool_destroy(pool);
+	return ret;
+}
+
+int main(void)
+{
+	odp_instance_t instance;
+	uint32_t len;
+	int ret = 0;
+
+	if (odp_init_global(&instance, NULL, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	if (run_check()) {
+		printf("Error: sorted list check failed\n");
+		ret = -1;
+	}
+
+	printf("\nSorted list performance test (CPU cycles per operation)\n\n");
+	printf("     len         insert  remove + insert  find/delete/insert\n");
+
+	for (len = MIN_LEN; len <= MAX_LEN; len *= 2) {
+		if (run_test(len)) {
+			ret = -1;
+			break;
+		}
+	}
+
+	printf("\n");
+
+	if (odp_term_local()) {
+		printf("Error: Term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: Term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,308 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include "config.h"
+
+/**
+ * @file
+ *
+ * Timer wheel (traffic manager internal) micro benchmark
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+
+#include <odp_api.h>
+#include <odp_timer_wheel_internal.h>
+
+/* Simulated time in nsec. Timer wheel time does not need to be real time. */
+#define START_TIME   ODP_TIME_SEC_IN_NS
+#define STEP_TIME    (10 * ODP_TIME_USEC_IN_NS)
+#define BATCH_SIZE   32
+
+typedef struct {
+	uint32_t num_timers;
+	uint64_t range;
+} test_config_t;
+
+static const test_config_t test_config[] = {
+	{1024,        ODP_TIME_MSEC_IN_NS},
+	{1024,        100 * ODP_TIME_MSEC_IN_NS},
+	{16 * 1024,   ODP_TIME_MSEC_IN_NS},
+	{16 * 1024,   100 * ODP_TIME_MSEC_IN_NS},
+	{128 * 1024,  10 * ODP_TIME_MSEC_IN_NS},
+	{128 * 1024,  ODP_TIME_SEC_IN_NS}
+};
+
+#define NUM_CONFIGS (sizeof(test_config) / sizeof(test_config[0]))
+
+static uint64_t rand_state = 1;
+
+static uint64_t rand_u64(void)
+{
+	/* xorshift64 */
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state;
+}
+
+typedef struct {
+	uint64_t *wakeup;
+	uint8_t  *expired;
+	uint32_t  num_timers;
+	uint32_t  num_expired;
+} test_state_t;
+
+/* Timer context must be non-zero and 4-byte aligned */
+static inline uint64_t timer_context(uint32_t idx)
+{
+	return ((uint64_t)idx + 1) << 2;
+}
+
+static int check_expired(test_state_t *state, uint64_t context, uint64_t now)
+{
+	uint64_t idx = (context >> 2) - 1;
+
+	if (context == 0 || idx >= state->num_timers) {
+		printf("Error: bad timer context 0x%" PRIx64 "\n", context);
+		return -1;
+	}
+
+	if (state->expired[idx]) {
+		printf("Error: timer %" PRIu64 " expired twice\n", idx);
+		return -1;
+	}
+
+	if (state->wakeup[idx] > now) {
+		printf("Error: timer %" PRIu64 " expired %" PRIu64 " ns early\n",
+		       idx, state->wakeup[idx] - now);
+		return -1;
+	}
+
+	state->expired[idx] = 1;
+	state->num_expired++;
+	return 0;
+}
+
+static _odp_timer_wheel_t create_timers(test_state_t *state, uint64_t range,
+					uint64_t *cycles)
+{
+	_odp_timer_wheel_t timer_wheel;
+	uint64_t c1, c2;
+	uint32_t i;
+
+	timer_wheel = _odp_timer_wheel_create(state->num_timers, NULL);
+	if (timer_wheel == _ODP_INT_TIMER_WHEEL_INVALID) {
+		printf("Error: timer wheel create failed\n");
+		return _ODP_INT_TIMER_WHEEL_INVALID;
+	}
+
+	_odp_timer_wheel_start(timer_wheel, START_TIME);
+
+	for (i = 0; i < state->num_timers; i++)
+		state->wakeup[i] = START_TIME + 1 + rand_u64() % range;
+
+	memset(state->expired, 0, state->num_timers);
+	state->num_expired = 0;
+
+	c1 = odp_cpu_cycles();
+	for (i = 0; i < state->num_timers; i++) {
+		if (_odp_timer_wheel_insert(timer_wheel, state->wakeup[i],
+					    timer_context(i))) {
+			printf("Error: timer insert failed\n");
+			_odp_timer_wheel_destroy(timer_wheel);
+			return _ODP_INT_TIMER_WHEEL_INVALID;
+		}
+	}
+	c2 = odp_cpu_cycles();
+	*cycles = odp_cpu_cycles_diff(c2, c1);
+
+	return timer_wheel;
+}
+
+/* Expire all timers one at a time with _odp_timer_wheel_next_expired() */
+static int expire_single(_odp_timer_wheel_t timer_wheel, test_state_t *state,
+			 uint64_t end_time, uint64_t *cycles)
+{
+	uint64_t c1, c2, context, now;
+
+	*cycles = 0;
+	now = START_TIME;
+
+	while (state->num_expired < state->num_timers && now < end_time) {
+		now += STEP_TIME;
+
+		c1 = odp_cpu_cycles();
+		if (_odp_timer_wheel_curr_time_update(timer_wheel, now) == 0) {
+			c2 = odp_cpu_cycles();
+			*cycles += odp_cpu_cycles_diff(c2, c1);
+			continue;
+		}
+
+		while ((context = _odp_timer_wheel_next_expired(timer_wheel))) {
+			c2 = odp_cpu_cycles();
+			*cycles += odp_cpu_cycles_diff(c2, c1);
+
+			if (check_expired(state, context, now))
+				return -1;
+
+			c1 = odp_cpu_cycles();
+		}
+	}
+
+	return 0;
+}
+
+/* Expire all timers in batches with _odp_timer_wheel_expired_get() */
+static int expire_batch(_odp_timer_wheel_t timer_wheel, test_state_t *state,
+			uint64_t end_time, uint64_t *cycles)
+{
+	uint64_t c1, c2, now;
+	uint64_t context[BATCH_SIZE];
+	uint32_t i, num;
+
+	*cycles = 0;
+	now = START_TIME;
+
+	while (state->num_expired < state->num_timers && now < end_time) {
+		now += STEP_TIME;
+
+		do {
+			c1 = odp_cpu_cycles();
+			num = _odp_timer_wheel_expired_get(timer_wheel, now,
+							   context,
+							   BATCH_SIZE);
+			c2 = odp_cpu_cycles();
+			*cycles += odp_cpu_cycles_diff(c2, c1);
+
+			for (i = 0; i < num; i++)
+				if (check_expired(state, context[i], now))
+					return -1;
+		} while (num == BATCH_SIZE);
+	}
+
+	return 0;
+}
+
+static int run_test(const test_config_t *config, test_state_t *state,
+		    int print_stats)
+{
+	_odp_timer_wheel_t timer_wheel;
+	uint64_t insert_cycles, single_cycles, batch_cycles, end_time;
+	uint32_t num_timers = config->num_timers;
+	int ret;
+
+	state->num_timers = num_timers;
+	end_time = START_TIME + config->range + 10 * ODP_TIME_MSEC_IN_NS;
+
+	timer_wheel = create_timers(state, config->range, &insert_cycles);
+	if (timer_wheel == _ODP_INT_TIMER_WHEEL_INVALID)
+		return -1;
+
+	ret = expire_single(timer_wheel, state, end_time, &single_cycles);
+	_odp_timer_wheel_destroy(timer_wheel);
+	if (ret)
+		return -1;
+
+	if (state->num_expired != num_timers) {
+		printf("Error: %u timers did not expire\n",
+		       num_timers - state->num_expired);
+		return -1;
+	}
+
+	timer_wheel = create_timers(state, config->range, &insert_cycles);
+	if (timer_wheel == _ODP_INT_TIMER_WHEEL_INVALID)
+		return -1;
+
+	ret = expire_batch(timer_wheel, state, end_time, &batch_cycles);
+	if (ret == 0 && state->num_expired != num_timers) {
+		printf("Error: %u timers did not expire\n",
+		       num_timers - state->num_expired);
+		ret = -1;
+	}
+
+	if (ret == 0 && _odp_timer_wheel_count(timer_wheel) != 0) {
+		printf("Error: timer count %u after all expired\n",
+		       _odp_timer_wheel_count(timer_wheel));
+		ret = -1;
+	}
+
+	if (ret == 0) {
+		printf("%8u %10" PRIu64 " %10.1f %10.1f %10.1f\n", num_timers,
+		       config->range / (uint64_t)ODP_TIME_USEC_IN_NS,
+		       (double)insert_cycles / num_timers,
+		       (double)single_cycles / num_timers,
+		       (double)batch_cycles / num_timers);
+
+		if (print_stats) {
+			printf("\n");
+			_odp_timer_wheel_stats_print(timer_wheel);
+		}
+	}
+
+	_odp_timer_wheel_destroy(timer_wheel);
+	return ret;
+}
+
+int main(void)
+{
+	odp_instance_t instance;
+	test_state_t state;
+	uint32_t i, max_timers = 0;
+	int ret = 0;
+
+	if (odp_init_global(&instance, NULL, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	for (i = 0; i < NUM_CONFIGS; i++)
+		if (test_config[i].num_timers > max_timers)
+			max_timers = test_config[i].num_timers;
+
+	state.wakeup  = malloc(max_timers * sizeof(uint64_t));
+	state.expired = malloc(max_timers);
+	if (state.wakeup == NULL || state.expired == NULL) {
+		printf("Error: malloc failed.\n");
+		return -1;
+	}
+
+	printf("\nTimer wheel performance test (CPU cycles per timer)\n\n");
+	printf("  timers   range_us     insert     single      batch\n");
+
+	for (i = 0; i < NUM_CONFIGS; i++) {
+		if (run_test(&test_config[i], &state, i == NUM_CONFIGS - 1)) {
+			ret = -1;
+			break;
+		}
+	}
+
+	printf("\n");
+
+	free(state.wakeup);
+	free(state.expired);
+
+	if (odp_term_local()) {
+		printf("Error: Term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: Term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
@@ -37,7 +37,7 @@
 #define TEST_MIN_PKT_SIZE 64
 
 /** Maximum test packet size */
-#define TEST_MAX_PKT_SIZE 2048
+#define TEST_MAX_PKT_SIZE 9000
 
 /** Number of test runs per individual benchmark */
 #define TEST_REPEAT_COUNT 1000
@@ -57,6 +57,9 @@
 /** Minimum byte alignment of contiguous area */
 #define TEST_ALIGN 32
 
+/** Length of header added/removed in the middle of a packet */
+#define TEST_HDR_LEN (TEST_MIN_PKT_SIZE / 2)
+
 /** Test packet offsets */
 #define TEST_L2_OFFSET 0
 #define TEST_L3_OFFSET (TEST_MIN_PKT_SIZE / 4)
@@ -75,12 +78,15 @@
 ODP_STATIC_ASSERT((TEST_ALIGN_OFFSET + TEST_ALIGN_LEN) <= TEST_MIN_PKT_SIZE,
 		  "Invalid_alignment");
 
+ODP_STATIC_ASSERT((TEST_L3_OFFSET + TEST_HDR_LEN) <= TEST_MIN_PKT_SIZE,
+		  "Invalid_header_length");
+
 /** Warm up round packet size */
 #define WARM_UP TEST_MIN_PKT_SIZE
 
 /** Test packet sizes */
 const uint32_t test_packet_len[] = {WARM_UP, TEST_MIN_PKT_SIZE, 128, 256, 512,
-				    1024, 1518, TEST_MAX_PKT_SIZE};
+				    1024, 1518, 2048, 4096, TEST_MAX_PKT_SIZE};
 
 /**
  * Parsed command line arguments
@@ -355,6 +361,28 @@ static void alloc_ref_packets(void)
 	}
 }
 
+/* Base packets for replication benchmarks. Each base packet is replicated
+ * into 'burst_size' references. */
+static int num_ref_base(void)
+{
+	return TEST_REPEAT_COUNT / gbl_args->appl.burst_size;
+}
+
+static void alloc_ref_base_packets(void)
+{
+	allocate_test_packets(gbl_args->pkt.len, gbl_args->pkt2_tbl,
+			      num_ref_base());
+}
+
+static void free_ref_base_packets(void)
+{
+	int num_base = num_ref_base();
+
+	odp_packet_free_multi(gbl_args->pkt_tbl,
+			      num_base * gbl_args->appl.burst_size);
+	odp_packet_free_multi(gbl_args->pkt2_tbl, num_base);
+}
+
 static void alloc_packets_twice(void)
 {
 	allocate_test_packets(gbl_args->pkt.len, gbl_args->pkt_tbl,
@@ -799,6 +827,58 @@ static int bench_packet_rem_data(void)
 	return ret >= 0;
 }
 
+static int bench_packet_add_data_head(void)
+{
+	int i;
+	int ret = 0;
+	odp_packet_t *pkt_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < TEST_REPEAT_COUNT; i++)
+		ret += odp_packet_add_data(&pkt_tbl[i], TEST_L3_OFFSET,
+					   TEST_HDR_LEN);
+
+	return ret >= 0;
+}
+
+static int bench_packet_add_data_tail(void)
+{
+	int i;
+	int ret = 0;
+	odp_packet_t *pkt_tbl = gbl_args->pkt_tbl;
+	uint32_t offset = gbl_args->pkt.len - TEST_L3_OFFSET;
+
+	for (i = 0; i < TEST_REPEAT_COUNT; i++)
+		ret += odp_packet_add_data(&pkt_tbl[i], offset, TEST_HDR_LEN);
+
+	return ret >= 0;
+}
+
+static int bench_packet_rem_data_head(void)
+{
+	int i;
+	int ret = 0;
+	odp_packet_t *pkt_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < TEST_REPEAT_COUNT; i++)
+		ret += odp_packet_rem_data(&pkt_tbl[i], TEST_L3_OFFSET,
+					   TEST_HDR_LEN);
+
+	return ret >= 0;
+}
+
+static int bench_packet_rem_data_tail(void)
+{
+	int i;
+	int ret = 0;
+	odp_packet_t *pkt_tbl = gbl_args->pkt_tbl;
+	uint32_t offset = gbl_args->pkt.len - TEST_L3_OFFSET - TEST_HDR_LEN;
+
+	for (i = 0; i < TEST_REPEAT_COUNT; i++)
+		ret += odp_packet_rem_data(&pkt_tbl[i], offset, TEST_HDR_LEN);
+
+	return ret >= 0;
+}
+
 static int bench_packet_align(void)
 {
 	int i;
@@ -1267,6 +1347,72 @@ static int bench_packet_ref_pkt(void)
 	return i;
 }
 
+static int bench_packet_ref_static_burst(void)
+{
+	int i, j;
+	int burst = gbl_args->appl.burst_size;
+	int num_base = num_ref_base();
+	odp_packet_t *base_tbl = gbl_args->pkt2_tbl;
+	odp_packet_t *ref_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < num_base; i++)
+		for (j = 0; j < burst; j++)
+			ref_tbl[i * burst + j] =
+				odp_packet_ref_static(base_tbl[i]);
+
+	return i * burst;
+}
+
+static int bench_packet_ref_static_multi(void)
+{
+	int i;
+	int burst = gbl_args->appl.burst_size;
+	int num_base = num_ref_base();
+	int refs = 0;
+	odp_packet_t *base_tbl = gbl_args->pkt2_tbl;
+	odp_packet_t *ref_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < num_base; i++)
+		refs += odp_packet_ref_static_multi(base_tbl[i],
+						    &ref_tbl[i * burst], burst);
+
+	return refs;
+}
+
+static int bench_packet_ref_burst(void)
+{
+	int i, j;
+	uint32_t offset = TEST_MIN_PKT_SIZE / 2;
+	int burst = gbl_args->appl.burst_size;
+	int num_base = num_ref_base();
+	odp_packet_t *base_tbl = gbl_args->pkt2_tbl;
+	odp_packet_t *ref_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < num_base; i++)
+		for (j = 0; j < burst; j++)
+			ref_tbl[i * burst + j] = odp_packet_ref(base_tbl[i],
+								offset);
+
+	return i * burst;
+}
+
+static int bench_packet_ref_multi(void)
+{
+	int i;
+	uint32_t offset = TEST_MIN_PKT_SIZE / 2;
+	int burst = gbl_args->appl.burst_size;
+	int num_base = num_ref_base();
+	int refs = 0;
+	odp_packet_t *base_tbl = gbl_args->pkt2_tbl;
+	odp_packet_t *ref_tbl = gbl_args->pkt_tbl;
+
+	for (i = 0; i < num_base; i++)
+		refs += odp_packet_ref_multi(base_tbl[i], offset,
+					     &ref_tbl[i * burst], burst);
+
+	return refs;
+}
+
 static int bench_packet_has_ref(void)
 {
 	int i;
@@ -1425,6 +1571,14 @@ bench_info_t test_suite[] = {
 			   free_packets, NULL),
 		BENCH_INFO(bench_packet_rem_data, create_packets, free_packets,
 			   NULL),
+		BENCH_INFO(bench_packet_add_data_head, create_packets,
+			   free_packets, NULL),
+		BENCH_INFO(bench_packet_add_data_tail, create_packets,
+			   free_packets, NULL),
+		BENCH_INFO(bench_packet_rem_data_head, create_packets,
+			   free_packets, NULL),
+		BENCH_INFO(bench_packet_rem_data_tail, create_packets,
+			   free_packets, NULL),
 		BENCH_INFO(bench_packet_align, create_packets, free_packets,
 			   NULL),
 		BENCH_INFO(bench_packet_is_segmented, create_packets,
@@ -1506,6 +1660,14 @@ bench_info_t test_suite[] = {
 			   free_packets_twice, NULL),
 		BENCH_INFO(bench_packet_has_ref, alloc_ref_packets,
 			   free_packets_twice, NULL),
+		BENCH_INFO(bench_packet_ref_static_burst,
+			   alloc_ref_base_packets, free_ref_base_packets, NULL),
+		BENCH_INFO(bench_packet_ref_static_multi,
+			   alloc_ref_base_packets, free_ref_base_packets, NULL),
+		BENCH_INFO(bench_packet_ref_burst, alloc_ref_base_packets,
+			   free_ref_base_packets, NULL),
+		BENCH_INFO(bench_packet_ref_multi, alloc_ref_base_packets,
+			   free_ref_base_packets, NULL),
 };
 
 /**
@@ -1582,6 +1744,10 @@ int main(int argc, char *argv[])
 			gbl_args->appl.burst_size * TEST_REPEAT_COUNT :
 			2 * TEST_REPEAT_COUNT;
 
+	/* Jumbo test packets may span several segments and grow by half of
+	 * their length during the tests */
+	pkt_num *= 3;
+
 	if (capa.pkt.max_num && capa.pkt.max_num < pkt_num) {
 		LOG_ERR("Error: packet pool size not supported.\n");
 		printf("MAX: %" PRIu32 "\n", capa.pkt.max_num);
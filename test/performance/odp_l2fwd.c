@@ -45,6 +45,12 @@
 /* Maximum pktio index table size */
 #define MAX_PKTIO_INDEXES      1024
 
+/* Per thread flow state table size. Must be power of two. */
+#define FLOW_TBL_SIZE          256
+
+/* Maximum number of flow table entries probed per lookup */
+#define FLOW_TBL_MAX_PROBE     8
+
 /* Packet input mode */
 typedef enum pktin_mode_t {
 	DIRECT_RECV,
@@ -60,6 +66,13 @@ typedef enum pktout_mode_t {
 	PKTOUT_QUEUE
 } pktout_mode_t;
 
+/* Per-flow state lookup modes */
+typedef enum flow_mode_t {
+	FLOW_NONE,
+	FLOW_PER_PKT,
+	FLOW_GROUPED
+} flow_mode_t;
+
 static inline int sched_mode(pktin_mode_t in_mode)
 {
 	return (in_mode == SCHED_PARALLEL) ||
@@ -92,6 +105,7 @@ typedef struct {
 	int chksum;             /* Checksum offload */
 	int sched_mode;         /* Scheduler mode */
 	int num_groups;         /* Number of scheduling groups */
+	flow_mode_t flow_mode;  /* Per-flow state lookup mode */
 	int verbose;		/* Verbose output */
 } appl_args_t;
 
@@ -111,15 +125,27 @@ typedef union ODP_ALIGNED_CACHE {
 		uint64_t rx_drops;
 		/* Packets dropped due to transmit error */
 		uint64_t tx_drops;
+		/* Number of per-flow state lookups */
+		uint64_t flow_lookups;
 	} s;
 
 	uint8_t padding[ODP_CACHE_LINE_SIZE];
 } stats_t;
 
+/* Per-flow state */
+typedef struct {
+	uint32_t hash;
+	uint32_t used;
+	uint64_t packets;
+} flow_state_t;
+
 /* Thread specific data */
 typedef struct thread_args_t {
 	stats_t stats;
 
+	/* Per-flow state table */
+	flow_state_t flow_tbl[FLOW_TBL_SIZE];
+
 	struct {
 		odp_pktin_queue_t pktin;
 		odp_pktout_queue_t pktout;
@@ -244,6 +270,74 @@ static inline void fill_eth_addrs(odp_packet_t pkt_tbl[],
 	}
 }
 
+/*
+ * Look up (or create) flow state for a flow hash
+ *
+ * tbl   Flow state table
+ * hash  Flow hash
+ */
+static inline flow_state_t *flow_lookup(flow_state_t tbl[], uint32_t hash)
+{
+	flow_state_t *flow;
+	uint32_t idx = hash & (FLOW_TBL_SIZE - 1);
+	int i;
+
+	for (i = 0; i < FLOW_TBL_MAX_PROBE; i++) {
+		flow = &tbl[(idx + i) & (FLOW_TBL_SIZE - 1)];
+
+		if (flow->used && flow->hash == hash)
+			return flow;
+
+		if (!flow->used) {
+			flow->used    = 1;
+			flow->hash    = hash;
+			flow->packets = 0;
+			return flow;
+		}
+	}
+
+	/* No free entry, replace the first one */
+	flow = &tbl[idx];
+	flow->hash    = hash;
+	flow->packets = 0;
+
+	return flow;
+}
+
+/*
+ * Update per-flow state of received packets
+ *
+ * Simulates an application that keeps state per flow. When packet input groups
+ * packets by flow, state is looked up only once per group of adjacent packets
+ * of the same flow. Otherwise, it is looked up for every packet.
+ *
+ * thr_args Thread arguments
+ * pkt_tbl  Array of packets
+ * num      Number of packets in the array
+ */
+static inline void update_flow_state(thread_args_t *thr_args,
+				     odp_packet_t pkt_tbl[], unsigned num)
+{
+	flow_state_t *flow = NULL;
+	uint32_t hash;
+	uint64_t lookups = 0;
+	int grouped = gbl_args->appl.flow_mode == FLOW_GROUPED;
+	unsigned i;
+
+	for (i = 0; i < num; i++) {
+		hash = odp_packet_flow_hash(pkt_tbl[i]);
+
+		if (!grouped || flow == NULL || flow->hash != hash) {
+			flow = flow_lookup(thr_args->flow_tbl, hash);
+			lookups++;
+		}
+
+		flow->packets++;
+	}
+
+	thr_args->stats.s.flow_lookups += lookups;
+}
+
 static inline int event_queue_send(odp_queue_t queue, odp_packet_t *pkt_tbl,
 				   unsigned pkts)
 {
@@ -371,6 +465,9 @@ static int run_worker_sched_mode(void *arg)
 			}
 		}
 
+		if (gbl_args->appl.flow_mode)
+			update_flow_state(thr_args, pkt_tbl, pkts);
+
 		/* packets from the same queue are from the same interface */
 		src_idx = odp_packet_input_index(pkt_tbl[0]);
 		assert(src_idx >= 0);
@@ -496,6 +593,9 @@ static int run_worker_plain_queue_mode(void *arg)
 			}
 		}
 
+		if (gbl_args->appl.flow_mode)
+			update_flow_state(thr_args, pkt_tbl, pkts);
+
 		fill_eth_addrs(pkt_tbl, pkts, dst_idx);
 
 		if (odp_unlikely(use_event_queue))
@@ -619,6 +719,9 @@ static int run_worker_direct_mode(void *arg)
 			}
 		}
 
+		if (gbl_args->appl.flow_mode)
+			update_flow_state(thr_args, pkt_tbl, pkts);
+
 		fill_eth_addrs(pkt_tbl, pkts, dst_idx);
 
 		if (odp_unlikely(use_event_queue))
@@ -709,6 +812,28 @@ static int create_pktio(const char *dev, int idx, int num_rx, int num_tx,
 			ODP_PROTO_LAYER_ALL :
 			ODP_PROTO_LAYER_NONE;
 
+	if (gbl_args->appl.flow_mode) {
+		if (!pktio_capa.config.pktin.bit.flow_hash) {
+			LOG_ERR("Error: flow hash not supported %s\n", dev);
+			return -1;
+		}
+
+		if (config.parser.layer < ODP_PROTO_LAYER_L4)
+			config.parser.layer = ODP_PROTO_LAYER_L4;
+
+		config.pktin.bit.flow_hash = 1;
+
+		if (gbl_args->appl.flow_mode == FLOW_GROUPED) {
+			if (!pktio_capa.config.pktin.bit.flow_group) {
+				LOG_ERR("Error: flow grouping not supported "
+					"%s\n", dev);
+				return -1;
+			}
+
+			config.pktin.bit.flow_group = 1;
+		}
+	}
+
 	if (gbl_args->appl.chksum) {
 		printf("Checksum offload enabled\n");
 		config.pktout.bit.ipv4_chksum_ena = 1;
@@ -716,7 +841,10 @@ static int create_pktio(const char *dev, int idx, int num_rx, int num_tx,
 		config.pktout.bit.tcp_chksum_ena  = 1;
 	}
 
-	odp_pktio_config(pktio, &config);
+	if (odp_pktio_config(pktio, &config)) {
+		LOG_ERR("Error: pktio config failed %s\n", dev);
+		return -1;
+	}
 
 	odp_pktin_queue_param_init(&pktin_param);
 	odp_pktout_queue_param_init(&pktout_param);
@@ -829,6 +957,8 @@ static int print_speed_stats(int num_workers, stats_t **thr_stats,
 	uint64_t pkts_prev = 0;
 	uint64_t pps;
 	uint64_t rx_drops, tx_drops;
+	uint64_t lookups = 0;
+	uint64_t lookups_prev = 0;
 	uint64_t maximum_pps = 0;
 	int i;
 	int elapsed = 0;
@@ -849,10 +979,13 @@ static int print_speed_stats(int num_workers, stats_t **thr_stats,
 
 		sleep(timeout);
 
+		lookups = 0;
+
 		for (i = 0; i < num_workers; i++) {
 			pkts += thr_stats[i]->s.packets;
 			rx_drops += thr_stats[i]->s.rx_drops;
 			tx_drops += thr_stats[i]->s.tx_drops;
+			lookups += thr_stats[i]->s.flow_lookups;
 		}
 		if (stats_enabled) {
 			pps = (pkts - pkts_prev) / timeout;
@@ -861,10 +994,23 @@ static int print_speed_stats(int num_workers, stats_t **thr_stats,
 			printf("%" PRIu64 " pps, %" PRIu64 " max pps, ",  pps,
 			       maximum_pps);
 
-			printf(" %" PRIu64 " rx drops, %" PRIu64 " tx drops\n",
+			printf(" %" PRIu64 " rx drops, %" PRIu64 " tx drops",
 			       rx_drops, tx_drops);
 
+			if (gbl_args->appl.flow_mode) {
+				uint64_t num_pkts = pkts - pkts_prev;
+				uint64_t num_lookups = lookups - lookups_prev;
+
+				printf(", %" PRIu64 " flow lookups/s (%.2f per "
+				       "pkt)", num_lookups / timeout,
+				       num_pkts ? (double)num_lookups /
+				       num_pkts : 0.0);
+			}
+
+			printf("\n");
+
 			pkts_prev = pkts;
+			lookups_prev = lookups;
 		}
 		elapsed += timeout;
 	} while (!exit_threads && (loop_forever || (elapsed < duration)));
@@ -1142,6 +1288,11 @@ static void usage(char *progname)
 	       "  -g, --groups <num>      Number of groups to use: 0 ... num\n"
 	       "                          0: SCHED_GROUP_ALL (default)\n"
 	       "                          num: must not exceed number of interfaces or workers\n"
+	       "  -f, --flow <arg>        Per-flow state lookup mode\n"
+	       "                          0: No flow state lookup (default)\n"
+	       "                          1: Look up flow state for every packet\n"
+	       "                          2: Request packet input to group packets by\n"
+	       "                             flow and look up flow state once per group\n"
 	       "  -v, --verbose           Verbose output.\n"
 	       "  -h, --help              Display help and exit.\n\n"
 	       "\n", NO_PATH(progname), NO_PATH(progname), MAX_PKTIOS
@@ -1176,12 +1327,13 @@ static void parse_args(int argc, char *argv[], appl_args_t *appl_args)
 		{"error_check", required_argument, NULL, 'e'},
 		{"chksum", required_argument, NULL, 'k'},
 		{"groups", required_argument, NULL, 'g'},
+		{"flow", required_argument, NULL, 'f'},
 		{"verbose", no_argument, NULL, 'v'},
 		{"help", no_argument, NULL, 'h'},
 		{NULL, 0, NULL, 0}
 	};
 
-	static const char *shortopts =  "+c:+t:+a:i:m:o:r:d:s:e:k:g:vh";
+	static const char *shortopts =  "+c:+t:+a:i:m:o:r:d:s:e:k:g:f:vh";
 
 	/* let helper collect its own arguments (e.g. --odph_proc) */
 	argc = odph_parse_options(argc, argv);
@@ -1195,6 +1347,7 @@ static void parse_args(int argc, char *argv[], appl_args_t *appl_args)
 	appl_args->error_check = 0; /* don't check packet errors by default */
 	appl_args->verbose = 0;
 	appl_args->chksum = 0; /* don't use checksum offload by default */
+	appl_args->flow_mode = FLOW_NONE; /* no flow state by default */
 
 	while (1) {
 		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
@@ -1323,6 +1476,15 @@ static void parse_args(int argc, char *argv[], appl_args_t *appl_args)
 		case 'g':
 			appl_args->num_groups = atoi(optarg);
 			break;
+		case 'f':
+			i = atoi(optarg);
+			if (i == 1)
+				appl_args->flow_mode = FLOW_PER_PKT;
+			else if (i == 2)
+				appl_args->flow_mode = FLOW_GROUPED;
+			else
+				appl_args->flow_mode = FLOW_NONE;
+			break;
 		case 'v':
 			appl_args->verbose = 1;
 			break;
@@ -1690,6 +1852,11 @@ int main(int argc, char *argv[])
 	for (i = 0; i < num_workers; ++i)
 		odph_odpthreads_join(&thread_tbl[i]);
 
+	/* Interface information includes queue statistics */
+	if (gbl_args->appl.verbose)
+		for (i = 0; i < if_count; ++i)
+			odp_pktio_print(gbl_args->pktios[i].pktio);
+
 	for (i = 0; i < if_count; ++i) {
 		if (odp_pktio_close(gbl_args->pktios[i].pktio)) {
 			LOG_ERR("Error: unable to close %s\n",
@@ -0,0 +1,559 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <odp_api.h>
+#include <odp/helper/odph_api.h>
+
+#define MAX_SEGS    256
+#define HDR_LEN     (ODPH_ETHHDR_LEN + ODPH_IPV4HDR_LEN + ODPH_TCPHDR_LEN)
+
+/* Test modes */
+#define MODE_ALL    0
+#define MODE_PKTOUT 1
+#define MODE_APPL   2
+
+typedef struct test_options_t {
+	const char *if_name;
+	uint32_t payload_len;
+	uint32_t mss;
+	uint32_t num_round;
+	int      mode;
+
+} test_options_t;
+
+typedef struct test_stat_t {
+	uint64_t rounds;
+	uint64_t tx_pkts;
+	uint64_t rx_pkts;
+	uint64_t bytes;
+	uint64_t nsec;
+	uint64_t cycles;
+
+} test_stat_t;
+
+typedef struct test_global_t {
+	test_options_t test_options;
+
+	odp_pool_t pool;
+	odp_pktio_t pktio;
+	odp_pktin_queue_t pktin;
+	odp_pktout_queue_t pktout;
+	odp_packet_t pkt;
+
+} test_global_t;
+
+test_global_t test_global;
+
+static void print_usage(void)
+{
+	printf("\n"
+	       "TCP segmentation performance test\n"
+	       "\n"
+	       "Compares TCP segmentation done by pktout (tcp_seg_ena) to\n"
+	       "segmentation done by the application. Packets are sent and\n"
+	       "received through a single interface.\n"
+	       "\n"
+	       "Usage: odp_tcp_seg_perf [options]\n"
+	       "\n"
+	       "  -i, --interface        Interface name. Default: loop\n"
+	       "  -l, --payload_len      TCP payload length of sent packets. Default: 64000\n"
+	       "  -s, --mss              TCP maximum segment size. Default: 1448\n"
+	       "  -r, --num_round        Number of rounds (packets sent). Default: 1000\n"
+	       "  -m, --mode             Test mode:\n"
+	       "                           0: All modes (default)\n"
+	       "                           1: Segmentation by pktout\n"
+	       "                           2: Segmentation by application\n"
+	       "  -h, --help             This help\n"
+	       "\n");
+}
+
+static int parse_options(int argc, char *argv[], test_options_t *test_options)
+{
+	int opt;
+	int long_index;
+	int ret = 0;
+
+	static const struct option longopts[] = {
+		{"interface",   required_argument, NULL, 'i'},
+		{"payload_len", required_argument, NULL, 'l'},
+		{"mss",         required_argument, NULL, 's'},
+		{"num_round",   required_argument, NULL, 'r'},
+		{"mode",        required_argument, NULL, 'm'},
+		{"help",        no_argument,       NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	static const char *shortopts = "+i:l:s:r:m:h";
+
+	test_options->if_name     = "loop";
+	test_options->payload_len = 64000;
+	test_options->mss         = 1448;
+	test_options->num_round   = 1000;
+	test_options->mode        = MODE_ALL;
+
+	while (1) {
+		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
+
+		if (opt == -1)
+			break;
+
+		switch (opt) {
+		case 'i':
+			test_options->if_name = optarg;
+			break;
+		case 'l':
+			test_options->payload_len = atoi(optarg);
+			break;
+		case 's':
+			test_options->mss = atoi(optarg);
+			break;
+		case 'r':
+			test_options->num_round = atoi(optarg);
+			break;
+		case 'm':
+			test_options->mode = atoi(optarg);
+			break;
+		case 'h':
+			/* fall through */
+		default:
+			print_usage();
+			ret = -1;
+			break;
+		}
+	}
+
+	if (test_options->mss == 0 ||
+	    test_options->payload_len / test_options->mss >= MAX_SEGS) {
+		printf("Error: Too many segments per packet. Max %i.\n",
+		       MAX_SEGS);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+static int open_pktio(test_global_t *global)
+{
+	odp_pool_capability_t pool_capa;
+	odp_pool_param_t pool_param;
+	odp_pktio_param_t pktio_param;
+	odp_pktio_capability_t pktio_capa;
+	odp_pktio_config_t config;
+	odp_pktio_t pktio;
+	test_options_t *test_options = &global->test_options;
+	uint32_t len = HDR_LEN + test_options->payload_len;
+
+	printf("\nTCP segmentation performance test\n");
+	printf("  interface   %s\n", test_options->if_name);
+	printf("  payload len %u\n", test_options->payload_len);
+	printf("  mss         %u\n", test_options->mss);
+	printf("  num rounds  %u\n\n", test_options->num_round);
+
+	if (odp_pool_capability(&pool_capa)) {
+		printf("Error: Pool capa failed.\n");
+		return -1;
+	}
+
+	if (pool_capa.pkt.max_len && len > pool_capa.pkt.max_len) {
+		printf("Error: Max packet length supported %u\n",
+		       pool_capa.pkt.max_len);
+		return -1;
+	}
+
+	odp_pool_param_init(&pool_param);
+	pool_param.type    = ODP_POOL_PACKET;
+	pool_param.pkt.len = len;
+	pool_param.pkt.num = 4 * MAX_SEGS;
+
+	global->pool = odp_pool_create("tcp seg perf", &pool_param);
+
+	if (global->pool == ODP_POOL_INVALID) {
+		printf("Error: Pool create failed.\n");
+		return -1;
+	}
+
+	odp_pktio_param_init(&pktio_param);
+	pktio_param.in_mode  = ODP_PKTIN_MODE_DIRECT;
+	pktio_param.out_mode = ODP_PKTOUT_MODE_DIRECT;
+
+	pktio = odp_pktio_open(test_options->if_name, global->pool,
+			       &pktio_param);
+
+	if (pktio == ODP_PKTIO_INVALID) {
+		printf("Error: Pktio open failed.\n");
+		return -1;
+	}
+
+	global->pktio = pktio;
+
+	if (odp_pktio_capability(pktio, &pktio_capa)) {
+		printf("Error: Pktio capa failed.\n");
+		return -1;
+	}
+
+	if (!pktio_capa.config.pktout.bit.tcp_seg_ena) {
+		printf("Error: TCP segmentation not supported.\n");
+		return -1;
+	}
+
+	odp_pktio_config_init(&config);
+	config.parser.layer = ODP_PROTO_LAYER_NONE;
+	config.pktout.bit.tcp_seg_ena = 1;
+
+	if (odp_pktio_config(pktio, &config)) {
+		printf("Error: Pktio config failed.\n");
+		return -1;
+	}
+
+	if (odp_pktin_queue_config(pktio, NULL) ||
+	    odp_pktout_queue_config(pktio, NULL)) {
+		printf("Error: Pktio queue config failed.\n");
+		return -1;
+	}
+
+	if (odp_pktin_queue(pktio, &global->pktin, 1) != 1 ||
+	    odp_pktout_queue(pktio, &global->pktout, 1) != 1) {
+		printf("Error: Pktio queue query failed.\n");
+		return -1;
+	}
+
+	if (odp_pktio_start(pktio)) {
+		printf("Error: Pktio start failed.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int create_packet(test_global_t *global)
+{
+	odph_ethhdr_t *eth;
+	odph_ipv4hdr_t *ip;
+	odph_tcphdr_t *tcp;
+	odp_packet_t pkt;
+	test_options_t *test_options = &global->test_options;
+	uint32_t len = HDR_LEN + test_options->payload_len;
+	uint32_t i;
+	uint8_t *data;
+
+	pkt = odp_packet_alloc(global->pool, len);
+	if (pkt == ODP_PACKET_INVALID) {
+		printf("Error: Packet alloc failed.\n");
+		return -1;
+	}
+
+	eth = odp_packet_data(pkt);
+	memset(eth, 0, HDR_LEN);
+	odp_pktio_mac_addr(global->pktio, eth->src.addr, ODPH_ETHADDR_LEN);
+	odp_pktio_mac_addr(global->pktio, eth->dst.addr, ODPH_ETHADDR_LEN);
+	eth->type = odp_cpu_to_be_16(ODPH_ETHTYPE_IPV4);
+
+	ip = (odph_ipv4hdr_t *)(eth + 1);
+	ip->ver_ihl  = ODPH_IPV4 << 4 | ODPH_IPV4HDR_IHL_MIN;
+	ip->tot_len  = odp_cpu_to_be_16(len - ODPH_ETHHDR_LEN);
+	ip->ttl      = 64;
+	ip->proto    = ODPH_IPPROTO_TCP;
+	ip->src_addr = odp_cpu_to_be_32(0x0a000001);
+	ip->dst_addr = odp_cpu_to_be_32(0x0a000002);
+
+	tcp = (odph_tcphdr_t *)(ip + 1);
+	tcp->src_port = odp_cpu_to_be_16(10000);
+	tcp->dst_port = odp_cpu_to_be_16(20000);
+	tcp->hl       = ODPH_TCPHDR_LEN / 4;
+	tcp->ack      = 1;
+	tcp->window   = odp_cpu_to_be_16(0xffff);
+
+	for (i = 0; i < test_options->payload_len; i++) {
+		data = odp_packet_offset(pkt, HDR_LEN + i, NULL, NULL);
+		*data = i;
+	}
+
+	odp_packet_l2_offset_set(pkt, 0);
+	odp_packet_l3_offset_set(pkt, ODPH_ETHHDR_LEN);
+	odp_packet_l4_offset_set(pkt, ODPH_ETHHDR_LEN + ODPH_IPV4HDR_LEN);
+
+	global->pkt = pkt;
+
+	return 0;
+}
+
+/* Segment a packet in the application, recalculating all checksums */
+static int appl_segment(test_global_t *global, odp_packet_t pkt,
+			odp_packet_t seg[])
+{
+	odph_ipv4hdr_t *ip;
+	odph_tcphdr_t *tcp;
+	test_options_t *test_options = &global->test_options;
+	uint32_t payload_len = odp_packet_len(pkt) - HDR_LEN;
+	uint32_t mss = test_options->mss;
+	uint32_t offset, len, seq;
+	int i, num;
+
+	tcp = odp_packet_l4_ptr(pkt, NULL);
+	seq = odp_be_to_cpu_32(tcp->seq_no);
+	num = (payload_len + mss - 1) / mss;
+
+	for (i = 0, offset = 0; i < num; i++, offset += len) {
+		len = payload_len - offset < mss ? payload_len - offset : mss;
+
+		seg[i] = odp_packet_alloc(global->pool, HDR_LEN + len);
+		if (seg[i] == ODP_PACKET_INVALID) {
+			odp_packet_free_multi(seg, i);
+			return -1;
+		}
+
+		odp_packet_copy_from_pkt(seg[i], 0, pkt, 0, HDR_LEN);
+		odp_packet_copy_from_pkt(seg[i], HDR_LEN, pkt,
+					 HDR_LEN + offset, len);
+		odp_packet_l2_offset_set(seg[i], 0);
+		odp_packet_l3_offset_set(seg[i], ODPH_ETHHDR_LEN);
+		odp_packet_l4_offset_set(seg[i], ODPH_ETHHDR_LEN +
+					 ODPH_IPV4HDR_LEN);
+		odp_packet_has_ipv4_set(seg[i], 1);
+		odp_packet_has_tcp_set(seg[i], 1);
+
+		ip = odp_packet_l3_ptr(seg[i], NULL);
+		ip->tot_len = odp_cpu_to_be_16(HDR_LEN - ODPH_ETHHDR_LEN +
+					       len);
+		ip->id = odp_cpu_to_be_16(odp_be_to_cpu_16(ip->id) + i);
+		odph_ipv4_csum_update(seg[i]);
+
+		tcp = odp_packet_l4_ptr(seg[i], NULL);
+		tcp->seq_no = odp_cpu_to_be_32(seq + offset);
+		if (i < num - 1) {
+			tcp->fin = 0;
+			tcp->psh = 0;
+		}
+		odph_tcp_chksum_set(seg[i]);
+	}
+
+	return num;
+}
+
+static int send_packet(test_global_t *global, int mode, uint64_t *tx_pkts)
+{
+	odp_packet_t seg[MAX_SEGS];
+	odp_packet_t pkt;
+	int num, sent, ret;
+
+	pkt = odp_packet_copy(global->pkt, global->pool);
+	if (pkt == ODP_PACKET_INVALID) {
+		printf("Error: Packet copy failed.\n");
+		return -1;
+	}
+
+	if (mode == MODE_PKTOUT) {
+		odp_packet_tcp_mss_set(pkt, global->test_options.mss);
+
+		if (odp_pktout_send(global->pktout, &pkt, 1) != 1) {
+			printf("Error: Send failed.\n");
+			odp_packet_free(pkt);
+			return -1;
+		}
+
+		*tx_pkts += 1;
+		return 0;
+	}
+
+	num = appl_segment(global, pkt, seg);
+	odp_packet_free(pkt);
+
+	if (num < 0) {
+		printf("Error: Segmentation failed.\n");
+		return -1;
+	}
+
+	for (sent = 0; sent < num; sent += ret) {
+		ret = odp_pktout_send(global->pktout, &seg[sent], num - sent);
+		if (ret <= 0) {
+			printf("Error: Send failed.\n");
+			odp_packet_free_multi(&seg[sent], num - sent);
+			return -1;
+		}
+	}
+
+	*tx_pkts += num;
+	return 0;
+}
+
+static uint64_t recv_packets(test_global_t *global)
+{
+	odp_packet_t pkt[MAX_SEGS];
+	uint64_t rx_pkts = 0;
+	int num;
+
+	while ((num = odp_pktin_recv(global->pktin, pkt, MAX_SEGS)) > 0) {
+		odp_packet_free_multi(pkt, num);
+		rx_pkts += num;
+	}
+
+	return rx_pkts;
+}
+
+static int test_tcp_seg(test_global_t *global, int mode, test_stat_t *stat)
+{
+	uint32_t rounds;
+	uint64_t c1, c2;
+	uint64_t tx_pkts = 0;
+	uint64_t rx_pkts = 0;
+	odp_time_t t1, t2;
+	test_options_t *test_options = &global->test_options;
+	int ret = 0;
+
+	t1 = odp_time_local();
+	c1 = odp_cpu_cycles();
+
+	for (rounds = 0; rounds < test_options->num_round; rounds++) {
+		if (send_packet(global, mode, &tx_pkts)) {
+			ret = -1;
+			break;
+		}
+
+		rx_pkts += recv_packets(global);
+	}
+
+	c2 = odp_cpu_cycles();
+	t2 = odp_time_local();
+
+	rx_pkts += recv_packets(global);
+
+	stat->rounds  = rounds;
+	stat->tx_pkts = tx_pkts;
+	stat->rx_pkts = rx_pkts;
+	stat->bytes   = (uint64_t)rounds * test_options->payload_len;
+	stat->nsec    = odp_time_diff_ns(t2, t1);
+	stat->cycles  = odp_cpu_cycles_diff(c2, c1);
+
+	return ret;
+}
+
+static void print_stat(const char *name, test_stat_t *stat)
+{
+	if (stat->rounds == 0 || stat->nsec == 0) {
+		printf("%s: no results.\n", name);
+		return;
+	}
+
+	printf("RESULTS - %s:\n", name);
+	printf("  packets sent:         %" PRIu64 "\n", stat->rounds);
+	printf("  packets transmitted:  %" PRIu64 "\n", stat->tx_pkts);
+	printf("  packets received:     %" PRIu64 "\n", stat->rx_pkts);
+	printf("  duration:             %.3f msec\n",
+	       (double)stat->nsec / 1000000);
+	printf("  cycles per packet:    %.3f\n",
+	       (double)stat->cycles / stat->rounds);
+	printf("  cycles per byte:      %.3f\n",
+	       (double)stat->cycles / stat->bytes);
+	printf("  payload bytes per sec: %.3f MB\n\n",
+	       (1000.0 * stat->bytes) / stat->nsec);
+}
+
+static int close_pktio(test_global_t *global)
+{
+	int ret = 0;
+
+	if (global->pkt != ODP_PACKET_INVALID)
+		odp_packet_free(global->pkt);
+
+	if (global->pktio != ODP_PKTIO_INVALID) {
+		if (odp_pktio_stop(global->pktio) ||
+		    odp_pktio_close(global->pktio)) {
+			printf("Error: Pktio close failed.\n");
+			ret = -1;
+		}
+	}
+
+	if (global->pool != ODP_POOL_INVALID &&
+	    odp_pool_destroy(global->pool)) {
+		printf("Error: Pool destroy failed.\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	odp_instance_t instance;
+	odp_init_t init;
+	test_global_t *global;
+	test_stat_t stat;
+	int mode;
+	int ret = 0;
+
+	global = &test_global;
+	memset(global, 0, sizeof(test_global_t));
+	global->pool  = ODP_POOL_INVALID;
+	global->pktio = ODP_PKTIO_INVALID;
+	global->pkt   = ODP_PACKET_INVALID;
+
+	if (parse_options(argc, argv, &global->test_options))
+		return -1;
+
+	/* List features not to be used */
+	odp_init_param_init(&init);
+	init.not_used.feat.cls      = 1;
+	init.not_used.feat.crypto   = 1;
+	init.not_used.feat.ipsec    = 1;
+	init.not_used.feat.timer    = 1;
+	init.not_used.feat.tm       = 1;
+
+	/* Init ODP before calling anything else */
+	if (odp_init_global(&instance, &init, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	/* Init this thread */
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	if (open_pktio(global) || create_packet(global)) {
+		ret = -1;
+		goto term;
+	}
+
+	for (mode = MODE_PKTOUT; mode <= MODE_APPL; mode++) {
+		const char *name = mode == MODE_PKTOUT ? "pktout segmentation" :
+				   "application segmentation";
+
+		if (global->test_options.mode != MODE_ALL &&
+		    global->test_options.mode != mode)
+			continue;
+
+		memset(&stat, 0, sizeof(stat));
+
+		if (test_tcp_seg(global, mode, &stat))
+			ret = -1;
+
+		print_stat(name, &stat);
+	}
+
+term:
+	if (close_pktio(global))
+		ret = -1;
+
+	if (odp_term_local()) {
+		printf("Error: term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
@@ -0,0 +1,803 @@
+/* Copyright (c) 2019, Linaro Limited
+ * All rights reserved.
+ *
+ * SPDX-License-Identifier:     BSD-3-Clause
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <getopt.h>
+
+#include <odp_api.h>
+#include <odp/helper/odph_api.h>
+
+#define MAX_QUEUES  1024
+#define MAX_NODES   64
+#define MAX_BURST   64
+
+/* Maximum number of packets enqueued but not yet received. Keeps egress
+ * interface queue from overflowing. */
+#define MAX_INFLIGHT 1024
+
+/* Stop waiting for packets after this long without progress */
+#define IDLE_TIMEOUT_NS ODP_TIME_SEC_IN_NS
+
+typedef struct test_options_t {
+	const char *if_name;
+	uint32_t num_cpu;
+	uint32_t num_queue;
+	uint32_t num_node;
+	uint32_t rate;
+	uint32_t num_pkt;
+	uint32_t pkt_len;
+	uint32_t burst_size;
+	int      enq_multi;
+
+} test_options_t;
+
+typedef struct test_stat_t {
+	uint64_t enq_pkts;
+	uint64_t enq_fails;
+	uint64_t enq_cycles;
+	uint64_t rx_pkts;
+	uint64_t nsec;
+	uint64_t cycles;
+
+} test_stat_t;
+
+typedef struct test_global_t {
+	test_options_t test_options;
+
+	odp_barrier_t barrier;
+	odp_cpumask_t cpumask;
+	odph_odpthread_t thread_tbl[ODP_THREAD_COUNT_MAX];
+	test_stat_t stat[ODP_THREAD_COUNT_MAX];
+
+	/* Packets enqueued and received by all workers */
+	odp_atomic_u64_t enq_pkts;
+	odp_atomic_u64_t rx_pkts;
+	/* Number of workers that have enqueued all their packets */
+	odp_atomic_u32_t enq_done;
+	odp_atomic_u32_t worker_idx;
+
+	odp_pool_t pool;
+	odp_pktio_t pktio;
+	odp_pktin_queue_t pktin;
+	odp_tm_t tm;
+	odp_tm_shaper_t shaper;
+	odp_tm_node_t tm_node[MAX_NODES];
+	odp_tm_queue_t tm_queue[MAX_QUEUES];
+
+} test_global_t;
+
+test_global_t test_global;
+
+static void print_usage(void)
+{
+	printf("\n"
+	       "Traffic manager throughput test\n"
+	       "\n"
+	       "Worker threads enqueue packets into TM queues and receive them back\n"
+	       "from the egress interface. TM queues are divided evenly between\n"
+	       "top-level TM nodes, which are optionally shaped. The number of TM\n"
+	       "threads is set by the implementation (see odp_tm_perf_run.sh for\n"
+	       "linux-generic).\n"
+	       "\n"
+	       "Usage: odp_tm_perf [options]\n"
+	       "\n"
+	       "  -i, --interface        Interface name. Default: loop\n"
+	       "  -c, --num_cpu          Number of CPUs (worker threads). 0: all available CPUs. Default 1.\n"
+	       "  -q, --num_queue        Number of TM queues. Default: 8\n"
+	       "  -t, --num_node         Number of top-level TM nodes. Default: 1\n"
+	       "  -r, --rate             Shaper commit rate per TM node in Mbps. 0: no shaping. Default: 0\n"
+	       "  -n, --num_pkt          Number of packets (total over all workers). Default: 100000\n"
+	       "  -l, --pkt_len          Packet length. Default: 64\n"
+	       "  -b, --burst_size       Number of packets enqueued per round. Default: 32\n"
+	       "  -m, --enq_multi        Enqueue mode:\n"
+	       "                         0: Enqueue packets one by one with odp_tm_enq()\n"
+	       "                         1: Enqueue a round with odp_tm_enq_multi() (default)\n"
+	       "  -h, --help             This help\n"
+	       "\n");
+}
+
+static int parse_options(int argc, char *argv[], test_options_t *test_options)
+{
+	int opt;
+	int long_index;
+	int ret = 0;
+
+	static const struct option longopts[] = {
+		{"interface",  required_argument, NULL, 'i'},
+		{"num_cpu",    required_argument, NULL, 'c'},
+		{"num_queue",  required_argument, NULL, 'q'},
+		{"num_node",   required_argument, NULL, 't'},
+		{"rate",       required_argument, NULL, 'r'},
+		{"num_pkt",    required_argument, NULL, 'n'},
+		{"pkt_len",    required_argument, NULL, 'l'},
+		{"burst_size", required_argument, NULL, 'b'},
+		{"enq_multi",  required_argument, NULL, 'm'},
+		{"help",       no_argument,       NULL, 'h'},
+		{NULL, 0, NULL, 0}
+	};
+
+	static const char *shortopts = "+i:c:q:t:r:n:l:b:m:h";
+
+	test_options->if_name    = "loop";
+	test_options->num_cpu    = 1;
+	test_options->num_queue  = 8;
+	test_options->num_node   = 1;
+	test_options->rate       = 0;
+	test_options->num_pkt    = 100000;
+	test_options->pkt_len    = 64;
+	test_options->burst_size = 32;
+	test_options->enq_multi  = 1;
+
+	while (1) {
+		opt = getopt_long(argc, argv, shortopts, longopts, &long_index);
+
+		if (opt == -1)
+			break;
+
+		switch (opt) {
+		case 'i':
+			test_options->if_name = optarg;
+			break;
+		case 'c':
+			test_options->num_cpu = atoi(optarg);
+			break;
+		case 'q':
+			test_options->num_queue = atoi(optarg);
+			break;
+		case 't':
+			test_options->num_node = atoi(optarg);
+			break;
+		case 'r':
+			test_options->rate = atoi(optarg);
+			break;
+		case 'n':
+			test_options->num_pkt = atoi(optarg);
+			break;
+		case 'l':
+			test_options->pkt_len = atoi(optarg);
+			break;
+		case 'b':
+			test_options->burst_size = atoi(optarg);
+			break;
+		case 'm':
+			test_options->enq_multi = atoi(optarg);
+			break;
+		case 'h':
+			/* fall through */
+		default:
+			print_usage();
+			ret = -1;
+			break;
+		}
+	}
+
+	if (test_options->num_queue == 0 ||
+	    test_options->num_queue > MAX_QUEUES) {
+		printf("Error: Bad number of queues. Max %i.\n", MAX_QUEUES);
+		ret = -1;
+	}
+
+	if (test_options->num_node == 0 ||
+	    test_options->num_node > MAX_NODES ||
+	    test_options->num_node > test_options->num_queue) {
+		printf("Error: Bad number of TM nodes. Max %i, and not more "
+		       "than queues.\n", MAX_NODES);
+		ret = -1;
+	}
+
+	if (test_options->burst_size == 0 ||
+	    test_options->burst_size > MAX_BURST) {
+		printf("Error: Bad burst size. Max %i.\n", MAX_BURST);
+		ret = -1;
+	}
+
+	if (test_options->pkt_len < ODPH_ETHHDR_LEN) {
+		printf("Error: Too short packets. Min %i.\n", ODPH_ETHHDR_LEN);
+		ret = -1;
+	}
+
+	return ret;
+}
+
+static int set_num_cpu(test_global_t *global)
+{
+	int ret;
+	test_options_t *test_options = &global->test_options;
+	int num_cpu = test_options->num_cpu;
+
+	/* One thread used for the main thread */
+	if (num_cpu > ODP_THREAD_COUNT_MAX - 1) {
+		printf("Error: Too many workers. Maximum is %i.\n",
+		       ODP_THREAD_COUNT_MAX - 1);
+		return -1;
+	}
+
+	ret = odp_cpumask_default_worker(&global->cpumask, num_cpu);
+
+	if (num_cpu && ret != num_cpu) {
+		printf("Error: Too many workers. Max supported %i.\n", ret);
+		return -1;
+	}
+
+	/* Zero: all available workers */
+	if (num_cpu == 0) {
+		num_cpu = ret;
+		test_options->num_cpu = num_cpu;
+	}
+
+	odp_barrier_init(&global->barrier, num_cpu);
+
+	return 0;
+}
+
+static int open_pktio(test_global_t *global)
+{
+	odp_pool_capability_t pool_capa;
+	odp_pool_param_t pool_param;
+	odp_pktio_param_t pktio_param;
+	odp_pktio_config_t config;
+	odp_pktio_t pktio;
+	odp_pktout_queue_t pktout;
+	test_options_t *test_options = &global->test_options;
+
+	printf("\nTraffic manager throughput test\n");
+	printf("  interface   %s\n", test_options->if_name);
+	printf("  num cpu     %u\n", test_options->num_cpu);
+	printf("  num queues  %u\n", test_options->num_queue);
+	printf("  num nodes   %u\n", test_options->num_node);
+	if (test_options->rate)
+		printf("  shaper rate %u Mbps per node\n", test_options->rate);
+	else
+		printf("  shaper rate no shaping\n");
+	printf("  num packets %u\n", test_options->num_pkt);
+	printf("  packet len  %u\n", test_options->pkt_len);
+	printf("  burst size  %u\n", test_options->burst_size);
+	printf("  enqueue     %s\n\n", test_options->enq_multi ?
+	       "odp_tm_enq_multi" : "odp_tm_enq");
+
+	if (odp_pool_capability(&pool_capa)) {
+		printf("Error: Pool capa failed.\n");
+		return -1;
+	}
+
+	if (pool_capa.pkt.max_len &&
+	    test_options->pkt_len > pool_capa.pkt.max_len) {
+		printf("Error: Max packet length supported %u\n",
+		       pool_capa.pkt.max_len);
+		return -1;
+	}
+
+	odp_pool_param_init(&pool_param);
+	pool_param.type    = ODP_POOL_PACKET;
+	pool_param.pkt.len = test_options->pkt_len;
+	pool_param.pkt.num = 8 * 1024;
+
+	if (pool_capa.pkt.max_num && pool_param.pkt.num > pool_capa.pkt.max_num)
+		pool_param.pkt.num = pool_capa.pkt.max_num;
+
+	global->pool = odp_pool_create("tm perf", &pool_param);
+
+	if (global->pool == ODP_POOL_INVALID) {
+		printf("Error: Pool create failed.\n");
+		return -1;
+	}
+
+	odp_pktio_param_init(&pktio_param);
+	pktio_param.in_mode  = ODP_PKTIN_MODE_DIRECT;
+	pktio_param.out_mode = ODP_PKTOUT_MODE_DIRECT;
+
+	pktio = odp_pktio_open(test_options->if_name, global->pool,
+			       &pktio_param);
+
+	if (pktio == ODP_PKTIO_INVALID) {
+		printf("Error: Pktio open failed.\n");
+		return -1;
+	}
+
+	global->pktio = pktio;
+
+	odp_pktio_config_init(&config);
+	config.parser.layer = ODP_PROTO_LAYER_NONE;
+
+	if (odp_pktio_config(pktio, &config)) {
+		printf("Error: Pktio config failed.\n");
+		return -1;
+	}
+
+	if (odp_pktin_queue_config(pktio, NULL) ||
+	    odp_pktout_queue_config(pktio, NULL)) {
+		printf("Error: Pktio queue config failed.\n");
+		return -1;
+	}
+
+	if (odp_pktin_queue(pktio, &global->pktin, 1) != 1 ||
+	    odp_pktout_queue(pktio, &pktout, 1) != 1) {
+		printf("Error: Pktio queue query failed.\n");
+		return -1;
+	}
+
+	if (odp_pktio_start(pktio)) {
+		printf("Error: Pktio start failed.\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+static int create_tm(test_global_t *global)
+{
+	odp_tm_requirements_t req;
+	odp_tm_level_requirements_t *per_level;
+	odp_tm_egress_t egress;
+	odp_tm_shaper_params_t shaper_param;
+	odp_tm_node_params_t node_param;
+	odp_tm_queue_params_t queue_param;
+	odp_tm_node_t tm_node;
+	odp_tm_queue_t tm_queue;
+	uint32_t i;
+	test_options_t *test_options = &global->test_options;
+	uint32_t num_queue = test_options->num_queue;
+	uint32_t num_node = test_options->num_node;
+	uint32_t max_fanin = (num_queue + num_node - 1) / num_node;
+
+	odp_tm_requirements_init(&req);
+	req.max_tm_queues = num_queue + 1;
+	req.num_levels    = 1;
+
+	per_level = &req.per_level[0];
+	per_level->max_num_tm_nodes      = num_node;
+	per_level->max_fanin_per_node    = max_fanin;
+	per_level->max_priority          = 0;
+	per_level->tm_node_shaper_needed = test_options->rate ? 1 : 0;
+
+	odp_tm_egress_init(&egress);
+	egress.egress_kind = ODP_TM_EGRESS_PKT_IO;
+	egress.pktio       = global->pktio;
+
+	global->tm = odp_tm_create("tm perf", &req, &egress);
+
+	if (global->tm == ODP_TM_INVALID) {
+		printf("Error: TM create failed.\n");
+		return -1;
+	}
+
+	if (test_options->rate) {
+		odp_tm_shaper_params_init(&shaper_param);
+		shaper_param.commit_bps   = 1000000ull * test_options->rate;
+		shaper_param.commit_burst = 8 * MAX_BURST * test_options->pkt_len;
+		shaper_param.dual_rate    = 0;
+
+		global->shaper = odp_tm_shaper_create("tm perf shaper",
+						      &shaper_param);
+
+		if (global->shaper == ODP_TM_INVALID) {
+			printf("Error: TM shaper create failed.\n");
+			return -1;
+		}
+	}
+
+	for (i = 0; i < num_node; i++) {
+		odp_tm_node_params_init(&node_param);
+		node_param.max_fanin      = max_fanin;
+		node_param.level          = 0;
+		node_param.shaper_profile = global->shaper;
+
+		tm_node = odp_tm_node_create(global->tm, NULL, &node_param);
+
+		if (tm_node == ODP_TM_INVALID) {
+			printf("Error: TM node create failed (%u).\n", i);
+			return -1;
+		}
+
+		global->tm_node[i] = tm_node;
+
+		if (odp_tm_node_connect(tm_node, ODP_TM_ROOT)) {
+			printf("Error: TM node connect failed (%u).\n", i);
+			return -1;
+		}
+	}
+
+	for (i = 0; i < num_queue; i++) {
+		odp_tm_queue_params_init(&queue_param);
+		queue_param.priority = 0;
+
+		tm_queue = odp_tm_queue_create(global->tm, &queue_param);
+
+		if (tm_queue == ODP_TM_INVALID) {
+			printf("Error: TM queue create failed (%u).\n", i);
+			return -1;
+		}
+
+		global->tm_queue[i] = tm_queue;
+
+		if (odp_tm_queue_connect(tm_queue,
+					 global->tm_node[i % num_node])) {
+			printf("Error: TM queue connect failed (%u).\n", i);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static uint64_t recv_packets(test_global_t *global)
+{
+	odp_packet_t pkt[MAX_BURST];
+	uint64_t rx_pkts = 0;
+	int num;
+
+	while ((num = odp_pktin_recv(global->pktin, pkt, MAX_BURST)) > 0) {
+		odp_packet_free_multi(pkt, num);
+		rx_pkts += num;
+	}
+
+	return rx_pkts;
+}
+
+static int enq_packets(test_global_t *global, uint32_t num,
+		       uint32_t *queue_idx, test_stat_t *stat)
+{
+	odp_packet_t pkt[MAX_BURST];
+	odp_tm_queue_t tm_queue;
+	uint64_t c1;
+	test_options_t *test_options = &global->test_options;
+	int i, ret;
+
+	ret = odp_packet_alloc_multi(global->pool, test_options->pkt_len,
+				     pkt, num);
+	if (ret <= 0)
+		return 0;
+
+	num = ret;
+	c1  = odp_cpu_cycles();
+
+	if (test_options->enq_multi) {
+		/* Whole round into the same queue */
+		tm_queue = global->tm_queue[*queue_idx];
+
+		i = odp_tm_enq_multi(tm_queue, pkt, num);
+		if (i < 0)
+			i = 0;
+
+		(*queue_idx)++;
+		if (*queue_idx == test_options->num_queue)
+			*queue_idx = 0;
+	} else {
+		for (i = 0; i < ret; i++) {
+			tm_queue = global->tm_queue[*queue_idx];
+
+			if (odp_tm_enq(tm_queue, pkt[i]) < 0)
+				break;
+
+			(*queue_idx)++;
+			if (*queue_idx == test_options->num_queue)
+				*queue_idx = 0;
+		}
+	}
+
+	stat->enq_cycles += odp_cpu_cycles_diff(odp_cpu_cycles(), c1);
+
+	if (i < ret) {
+		/* Input is full, retry later */
+		odp_packet_free_multi(&pkt[i], ret - i);
+		stat->enq_fails++;
+	}
+
+	return i;
+}
+
+static int test_tm(void *arg)
+{
+	uint64_t c1, c2;
+	uint64_t rx, enq, idle_ns;
+	uint64_t last_rx = 0;
+	odp_time_t t1, t2, idle_start;
+	test_global_t *global = arg;
+	test_options_t *test_options = &global->test_options;
+	uint32_t num, left, worker_idx, queue_idx;
+	uint32_t num_cpu = test_options->num_cpu;
+	uint32_t burst_size = test_options->burst_size;
+	int thr = odp_thread_id();
+	test_stat_t *stat = &global->stat[thr];
+	int ret = 0;
+
+	/* Packets are divided between workers. Each worker starts from
+	 * a different queue. */
+	worker_idx = odp_atomic_fetch_inc_u32(&global->worker_idx);
+
+	left = test_options->num_pkt / num_cpu;
+	if (worker_idx < test_options->num_pkt % num_cpu)
+		left++;
+
+	queue_idx = worker_idx % test_options->num_queue;
+
+	/* Start all workers at the same time */
+	odp_barrier_wait(&global->barrier);
+
+	t1 = odp_time_local();
+	c1 = odp_cpu_cycles();
+	idle_start = t1;
+
+	if (left == 0)
+		odp_atomic_inc_u32(&global->enq_done);
+
+	while (1) {
+		rx = recv_packets(global);
+		stat->rx_pkts += rx;
+		rx  = odp_atomic_fetch_add_u64(&global->rx_pkts, rx) + rx;
+		enq = odp_atomic_load_u64(&global->enq_pkts);
+
+		if (left && enq - rx + burst_size <= MAX_INFLIGHT) {
+			num = left < burst_size ? left : burst_size;
+			num = enq_packets(global, num, &queue_idx, stat);
+
+			odp_atomic_add_u64(&global->enq_pkts, num);
+			left -= num;
+			stat->enq_pkts += num;
+			idle_start = odp_time_local();
+
+			if (left == 0)
+				odp_atomic_inc_u32(&global->enq_done);
+
+			continue;
+		}
+
+		/* All packets enqueued and received */
+		if (odp_atomic_load_u32(&global->enq_done) == num_cpu &&
+		    odp_atomic_load_u64(&global->rx_pkts) ==
+		    odp_atomic_load_u64(&global->enq_pkts))
+			break;
+
+		/* Waiting for packets held by the TM system */
+		if (rx != last_rx) {
+			last_rx = rx;
+			idle_start = odp_time_local();
+			continue;
+		}
+
+		idle_ns = odp_time_diff_ns(odp_time_local(), idle_start);
+		if (idle_ns > IDLE_TIMEOUT_NS) {
+			printf("Error: No progress (thread %i)\n", thr);
+			ret = -1;
+			break;
+		}
+	}
+
+	c2 = odp_cpu_cycles();
+	t2 = odp_time_local();
+
+	stat->nsec   = odp_time_diff_ns(t2, t1);
+	stat->cycles = odp_cpu_cycles_diff(c2, c1);
+
+	return ret;
+}
+static int start_workers(test_global_t *global, odp_instance_t instance)
+{
+	odph_odpthread_params_t thr_params;
+	test_options_t *test_options = &global->test_options;
+	int num_cpu = test_options->num_cpu;
+
+	memset(&thr_params, 0, sizeof(thr_params));
+	thr_params.thr_type = ODP_THREAD_WORKER;
+	thr_params.instance = instance;
+	thr_params.start    = test_tm;
+	thr_params.arg      = global;
+
+	if (odph_odpthreads_create(global->thread_tbl, &global->cpumask,
+				   &thr_params) != num_cpu)
+		return -1;
+
+	return 0;
+}
+
+static void print_stat(test_global_t *global)
+{
+	int i;
+	test_stat_t *stat;
+	uint64_t enq_pkts = 0;
+	uint64_t enq_fails = 0;
+	uint64_t enq_cycles = 0;
+	uint64_t rx_pkts = 0;
+	uint64_t cycles = 0;
+	uint64_t nsec = 0;
+
+	for (i = 0; i < ODP_THREAD_COUNT_MAX; i++) {
+		stat = &global->stat[i];
+
+		enq_pkts   += stat->enq_pkts;
+		enq_fails  += stat->enq_fails;
+		enq_cycles += stat->enq_cycles;
+		rx_pkts    += stat->rx_pkts;
+		cycles     += stat->cycles;
+
+		if (stat->nsec > nsec)
+			nsec = stat->nsec;
+	}
+
+	if (rx_pkts == 0 || enq_pkts == 0 || nsec == 0) {
+		printf("No results.\n");
+		return;
+	}
+
+	printf("RESULTS - total over %u threads:\n",
+	       global->test_options.num_cpu);
+	printf("  packets enqueued:     %" PRIu64 "\n", enq_pkts);
+	printf("  enqueue retries:      %" PRIu64 "\n", enq_fails);
+	printf("  packets received:     %" PRIu64 "\n", rx_pkts);
+	printf("  duration:             %.3f msec\n", (double)nsec / 1000000);
+	printf("  enq cycles per packet: %.3f\n",
+	       (double)enq_cycles / enq_pkts);
+	printf("  cycles per packet:    %.3f\n", (double)cycles / rx_pkts);
+	printf("  packets per sec:      %.3f M\n\n",
+	       (1000.0 * rx_pkts) / nsec);
+}
+
+static int destroy_tm(test_global_t *global)
+{
+	uint32_t i;
+	int ret = 0;
+
+	if (global->tm == ODP_TM_INVALID)
+		return 0;
+
+	for (i = 0; i < global->test_options.num_queue; i++) {
+		if (global->tm_queue[i] == ODP_TM_INVALID)
+			continue;
+
+		if (odp_tm_queue_disconnect(global->tm_queue[i]) ||
+		    odp_tm_queue_destroy(global->tm_queue[i])) {
+			printf("Error: TM queue destroy failed (%u).\n", i);
+			ret = -1;
+		}
+	}
+
+	for (i = 0; i < global->test_options.num_node; i++) {
+		if (global->tm_node[i] == ODP_TM_INVALID)
+			continue;
+
+		if (odp_tm_node_disconnect(global->tm_node[i]) ||
+		    odp_tm_node_shaper_config(global->tm_node[i],
+					      ODP_TM_INVALID) ||
+		    odp_tm_node_destroy(global->tm_node[i])) {
+			printf("Error: TM node destroy failed (%u).\n", i);
+			ret = -1;
+		}
+	}
+
+	if (global->shaper != ODP_TM_INVALID &&
+	    odp_tm_shaper_destroy(global->shaper)) {
+		printf("Error: TM shaper destroy failed.\n");
+		ret = -1;
+	}
+
+	if (odp_tm_destroy(global->tm)) {
+		printf("Error: TM destroy failed.\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+static int close_pktio(test_global_t *global)
+{
+	int ret = 0;
+
+	if (global->pktio != ODP_PKTIO_INVALID) {
+		if (odp_pktio_stop(global->pktio) ||
+		    odp_pktio_close(global->pktio)) {
+			printf("Error: Pktio close failed.\n");
+			ret = -1;
+		}
+	}
+
+	if (global->pool != ODP_POOL_INVALID &&
+	    odp_pool_destroy(global->pool)) {
+		printf("Error: Pool destroy failed.\n");
+		ret = -1;
+	}
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	odp_instance_t instance;
+	odp_init_t init;
+	test_global_t *global;
+	uint64_t enq_pkts, rx_pkts;
+	uint32_t i;
+	int ret = 0;
+
+	global = &test_global;
+	memset(global, 0, sizeof(test_global_t));
+	global->pool    = ODP_POOL_INVALID;
+	global->pktio   = ODP_PKTIO_INVALID;
+	global->tm      = ODP_TM_INVALID;
+	global->shaper  = ODP_TM_INVALID;
+
+	for (i = 0; i < MAX_NODES; i++)
+		global->tm_node[i] = ODP_TM_INVALID;
+
+	for (i = 0; i < MAX_QUEUES; i++)
+		global->tm_queue[i] = ODP_TM_INVALID;
+
+	odp_atomic_init_u64(&global->enq_pkts, 0);
+	odp_atomic_init_u64(&global->rx_pkts, 0);
+	odp_atomic_init_u32(&global->enq_done, 0);
+	odp_atomic_init_u32(&global->worker_idx, 0);
+
+	if (parse_options(argc, argv, &global->test_options))
+		return -1;
+
+	/* List features not to be used */
+	odp_init_param_init(&init);
+	init.not_used.feat.cls      = 1;
+	init.not_used.feat.crypto   = 1;
+	init.not_used.feat.ipsec    = 1;
+	init.not_used.feat.timer    = 1;
+
+	/* Init ODP before calling anything else */
+	if (odp_init_global(&instance, &init, NULL)) {
+		printf("Error: Global init failed.\n");
+		return -1;
+	}
+
+	/* Init this thread */
+	if (odp_init_local(instance, ODP_THREAD_CONTROL)) {
+		printf("Error: Local init failed.\n");
+		return -1;
+	}
+
+	if (set_num_cpu(global) || open_pktio(global) || create_tm(global)) {
+		ret = -1;
+		goto term;
+	}
+
+	/* Start workers */
+	if (start_workers(global, instance)) {
+		printf("Error: Worker start failed.\n");
+		ret = -1;
+		goto term;
+	}
+
+	/* Wait workers to exit */
+	odph_odpthreads_join(global->thread_tbl);
+
+	enq_pkts = odp_atomic_load_u64(&global->enq_pkts);
+	rx_pkts  = odp_atomic_load_u64(&global->rx_pkts);
+
+	if (rx_pkts != enq_pkts ||
+	    enq_pkts != global->test_options.num_pkt) {
+		printf("Error: Sent %" PRIu64 " packets, received %" PRIu64
+		       "\n", enq_pkts, rx_pkts);
+		ret = -1;
+	}
+
+	print_stat(global);
+
+term:
+	if (destroy_tm(global))
+		ret = -1;
+
+	if (close_pktio(global))
+		ret = -1;
+
+	if (odp_term_local()) {
+		printf("Error: term local failed.\n");
+		return -1;
+	}
+
+	if (odp_term_global(instance)) {
+		printf("Error: term global failed.\n");
+		return -1;
+	}
+
+	return ret;
+}
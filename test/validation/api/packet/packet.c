@@ -1294,6 +1294,89 @@ static void _packet_compare_offset(odp_packet_t pkt1, uint32_t off1,
 	}
 }
 
+static void packet_test_add_rem_data_offset(void)
+{
+	odp_packet_t pkt;
+	odp_pool_capability_t capa;
+	uint32_t pkt_len, i, j, k;
+	uint32_t offset[7], add_len[3];
+	uint8_t *ref, *buf;
+	int ret;
+
+	CU_ASSERT_FATAL(odp_pool_capability(&capa) == 0);
+
+	/* Offsets near both ends and the middle of a segmented packet */
+	pkt_len    = odp_packet_len(segmented_test_packet) / 2;
+	offset[0]  = 0;
+	offset[1]  = 1;
+	offset[2]  = pkt_len / 4;
+	offset[3]  = pkt_len / 2;
+	offset[4]  = pkt_len - pkt_len / 4;
+	offset[5]  = pkt_len - 1;
+	offset[6]  = pkt_len;
+	add_len[0] = 1;
+	add_len[1] = 31;
+	add_len[2] = capa.pkt.min_seg_len + 7;
+
+	ref = malloc(pkt_len);
+	buf = malloc(pkt_len + capa.pkt.min_seg_len + 7);
+	CU_ASSERT_FATAL(ref != NULL && buf != NULL);
+
+	CU_ASSERT_FATAL(odp_packet_copy_to_mem(segmented_test_packet, 0,
+					       pkt_len, ref) == 0);
+
+	for (i = 0; i < sizeof(offset) / sizeof(offset[0]); i++) {
+		for (j = 0; j < sizeof(add_len) / sizeof(add_len[0]); j++) {
+			uint32_t off = offset[i];
+			uint32_t len = add_len[j];
+
+			pkt = odp_packet_copy_part(segmented_test_packet, 0,
+						   pkt_len, packet_pool);
+			CU_ASSERT_FATAL(pkt != ODP_PACKET_INVALID);
+
+			ret = odp_packet_add_data(&pkt, off, len);
+			CU_ASSERT(ret >= 0);
+			if (ret < 0) {
+				odp_packet_free(pkt);
+				continue;
+			}
+			CU_ASSERT(odp_packet_len(pkt) == pkt_len + len);
+			CU_ASSERT(odp_packet_is_valid(pkt) == 1);
+
+			/* Data around the added area must be intact */
+			CU_ASSERT(odp_packet_copy_to_mem(pkt, 0, pkt_len + len,
+							 buf) == 0);
+			CU_ASSERT(memcmp(buf, ref, off) == 0);
+			CU_ASSERT(memcmp(buf + off + len, ref + off,
+					 pkt_len - off) == 0);
+
+			/* Fill added area and remove it */
+			for (k = 0; k < len; k++)
+				buf[off + k] = 0xa5;
+			CU_ASSERT(odp_packet_copy_from_mem(pkt, off, len,
+							   buf + off) == 0);
+
+			ret = odp_packet_rem_data(&pkt, off, len);
+			CU_ASSERT(ret >= 0);
+			if (ret < 0) {
+				odp_packet_free(pkt);
+				continue;
+			}
+			CU_ASSERT(odp_packet_len(pkt) == pkt_len);
+			CU_ASSERT(odp_packet_is_valid(pkt) == 1);
+
+			CU_ASSERT(odp_packet_copy_to_mem(pkt, 0, pkt_len,
+							 buf) == 0);
+			CU_ASSERT(memcmp(buf, ref, pkt_len) == 0);
+
+			odp_packet_free(pkt);
+		}
+	}
+
+	free(buf);
+	free(ref);
+}
+
 static void packet_test_copy(void)
 {
 	odp_packet_t pkt;
@@ -2183,6 +2266,80 @@ static void packet_test_offset(void)
 	CU_ASSERT_PTR_NOT_NULL(ptr);
 }
 
+#define REF_MULTI_NUM 4
+
+static void packet_test_ref_multi(void)
+{
+	odp_packet_t pkt, hdr;
+	odp_packet_t ref[REF_MULTI_NUM];
+	uint32_t pkt_len, offset, hdr_len;
+	odp_pool_t pool;
+	int i, num;
+
+	/* Static references */
+	pool = odp_packet_pool(segmented_test_packet);
+	pkt = odp_packet_copy(segmented_test_packet, pool);
+	CU_ASSERT_FATAL(pkt != ODP_PACKET_INVALID);
+	CU_ASSERT(odp_packet_has_ref(pkt) == 0);
+
+	CU_ASSERT(odp_packet_ref_static_multi(pkt, ref, 0) == 0);
+
+	num = odp_packet_ref_static_multi(pkt, ref, REF_MULTI_NUM);
+	CU_ASSERT_FATAL(num == REF_MULTI_NUM);
+
+	for (i = 0; i < num; i++) {
+		CU_ASSERT(ref[i] != ODP_PACKET_INVALID);
+		packet_compare_data(pkt, ref[i]);
+	}
+
+	CU_ASSERT(odp_packet_has_ref(pkt) == 1);
+	odp_packet_free_multi(ref, num);
+	CU_ASSERT(odp_packet_has_ref(pkt) == 0);
+	odp_packet_free(pkt);
+
+	/* Dynamic references to a segmented packet */
+	pkt = odp_packet_copy(segmented_test_packet, pool);
+	CU_ASSERT_FATAL(pkt != ODP_PACKET_INVALID);
+	pkt_len = odp_packet_len(pkt);
+	offset = pkt_len / 3;
+
+	num = odp_packet_ref_multi(pkt, offset, ref, REF_MULTI_NUM);
+	CU_ASSERT_FATAL(num > 0 && num <= REF_MULTI_NUM);
+	CU_ASSERT(odp_packet_has_ref(pkt) == 1);
+
+	for (i = 0; i < num; i++) {
+		CU_ASSERT_FATAL(ref[i] != ODP_PACKET_INVALID);
+		CU_ASSERT(odp_packet_len(ref[i]) == pkt_len - offset);
+		CU_ASSERT(odp_packet_has_ref(ref[i]) == 1);
+		packet_compare_offset(pkt, offset, ref[i], 0,
+				      pkt_len - offset);
+	}
+
+	/* Unique header on one reference does not affect the others */
+	hdr = odp_packet_copy_part(test_packet, 0,
+				   odp_packet_len(test_packet) / 4, pool);
+	CU_ASSERT_FATAL(hdr != ODP_PACKET_INVALID);
+	hdr_len = odp_packet_len(hdr);
+
+	CU_ASSERT_FATAL(odp_packet_concat(&hdr, ref[0]) >= 0);
+	ref[0] = hdr;
+	CU_ASSERT(odp_packet_len(ref[0]) == hdr_len + pkt_len - offset);
+	packet_compare_offset(pkt, offset, ref[0], hdr_len, pkt_len - offset);
+
+	for (i = 1; i < num; i++) {
+		CU_ASSERT(odp_packet_len(ref[i]) == pkt_len - offset);
+		packet_compare_offset(pkt, offset, ref[i], 0,
+				      pkt_len - offset);
+	}
+
+	/* Original packet becomes unique again when references are freed */
+	for (i = 0; i < num; i++)
+		odp_packet_free(ref[i]);
+
+	CU_ASSERT(odp_packet_has_ref(pkt) == 0);
+	odp_packet_free(pkt);
+}
+
 static void packet_test_ref(void)
 {
 	odp_packet_t base_pkt, segmented_base_pkt, hdr_pkt[4],
@@ -3323,6 +3480,7 @@ odp_testinfo_t packet_suite[] = {
 	ODP_TEST_INFO(packet_test_in_flags),
 	ODP_TEST_INFO(packet_test_error_flags),
 	ODP_TEST_INFO(packet_test_add_rem_data),
+	ODP_TEST_INFO(packet_test_add_rem_data_offset),
 	ODP_TEST_INFO(packet_test_copy),
 	ODP_TEST_INFO(packet_test_copydata),
 	ODP_TEST_INFO(packet_test_concatsplit),
@@ -3335,6 +3493,7 @@ odp_testinfo_t packet_suite[] = {
 	ODP_TEST_INFO(packet_test_align),
 	ODP_TEST_INFO(packet_test_offset),
 	ODP_TEST_INFO(packet_test_ref),
+	ODP_TEST_INFO(packet_test_ref_multi),
 	ODP_TEST_INFO_NULL,
 };
 
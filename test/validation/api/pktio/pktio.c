@@ -32,6 +32,16 @@
 #define PKTIN_TS_MAX_RES       10000000000
 #define PKTIN_TS_CMP_RES       1
 
+#define FLOW_GROUP_NUM_PKTS    16
+#define FLOW_GROUP_NUM_FLOWS   4
+
+#define TCP_SEG_MSS            1000
+#define TCP_SEG_NUM            5
+#define TCP_SEG_PAYLOAD_LEN    ((TCP_SEG_NUM - 1) * TCP_SEG_MSS + 300)
+#define TCP_SEG_SRC_PORT       12049
+#define TCP_SEG_DST_PORT       12050
+#define TCP_SEG_SEQ            0x12345678
+
 #define PKTIO_SRC_MAC		{1, 2, 3, 4, 5, 6}
 #define PKTIO_DST_MAC		{6, 5, 4, 3, 2, 1}
 #undef DEBUG_STATS
@@ -1718,6 +1728,124 @@ static void pktio_test_statistics_counters(void)
 	}
 }
 
+static void pktio_test_queue_statistics(void)
+{
+	odp_pktio_t pktio_rx, pktio_tx;
+	odp_pktio_t pktio[MAX_NUM_IFACES] = {
+		ODP_PKTIO_INVALID, ODP_PKTIO_INVALID
+	};
+	odp_packet_t pkt_tbl[TX_BATCH_LEN];
+	uint32_t pkt_seq[TX_BATCH_LEN];
+	odp_pktin_queue_t pktin;
+	odp_pktout_queue_t pktout;
+	odp_pktin_queue_stats_t in_stats;
+	odp_pktout_queue_stats_t out_stats;
+	odp_pktio_stats_t stats;
+	uint64_t wait = odp_pktin_wait_time(ODP_TIME_SEC_IN_NS);
+	uint64_t tx_octets = 0, rx_octets = 0;
+	int i, num, pkts, tx_pkts, ret;
+	int loop, exact;
+
+	for (i = 0; i < num_ifaces; i++) {
+		pktio[i] = create_pktio(i, ODP_PKTIN_MODE_DIRECT,
+					ODP_PKTOUT_MODE_DIRECT);
+		CU_ASSERT_FATAL(pktio[i] != ODP_PKTIO_INVALID);
+	}
+	pktio_tx = pktio[0];
+	pktio_rx = (num_ifaces > 1) ? pktio[1] : pktio_tx;
+
+	CU_ASSERT_FATAL(odp_pktout_queue(pktio_tx, &pktout, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktin_queue(pktio_rx, &pktin, 1) == 1);
+
+	for (i = 0; i < num_ifaces; i++) {
+		CU_ASSERT_FATAL(odp_pktio_start(pktio[i]) == 0);
+		_pktio_wait_linkup(pktio[i]);
+	}
+
+	num = create_packets(pkt_tbl, pkt_seq, TX_BATCH_LEN, pktio_tx,
+			     pktio_rx);
+	CU_ASSERT_FATAL(num > 0);
+
+	for (i = 0; i < num_ifaces; i++)
+		CU_ASSERT(odp_pktio_stats_reset(pktio[i]) == 0);
+
+	CU_ASSERT(odp_pktin_queue_stats(pktin, &in_stats) == 0);
+	CU_ASSERT(in_stats.packets == 0);
+	CU_ASSERT(in_stats.octets == 0);
+	CU_ASSERT(odp_pktout_queue_stats(pktout, &out_stats) == 0);
+	CU_ASSERT(out_stats.packets == 0);
+	CU_ASSERT(out_stats.octets == 0);
+
+	for (i = 0; i < num; i++)
+		tx_octets += odp_packet_len(pkt_tbl[i]);
+
+	CU_ASSERT_FATAL(send_packets(pktout, pkt_tbl, num) == 0);
+	tx_pkts = num;
+
+	for (pkts = 0; pkts < tx_pkts; pkts += ret) {
+		odp_packet_t pkt;
+
+		ret = odp_pktin_recv_tmo(pktin, &pkt, 1, wait);
+		if (ret <= 0)
+			break;
+
+		rx_octets += odp_packet_len(pkt);
+		odp_packet_free(pkt);
+	}
+
+	/* Counters must be exact, when the driver maintains them. Drivers
+	 * without counters (neither loop nor interface statistics) report
+	 * zero. */
+	loop = !strcmp(iface_name[0], "loop");
+
+	exact = loop || (odp_pktio_stats(pktio_tx, &stats) == 0 &&
+			 stats.out_octets + stats.out_ucast_pkts != 0);
+
+	CU_ASSERT(odp_pktout_queue_stats(pktout, &out_stats) == 0);
+	if (exact) {
+		CU_ASSERT(out_stats.packets == (uint64_t)tx_pkts);
+		CU_ASSERT(out_stats.octets == tx_octets);
+	} else {
+		CU_ASSERT(out_stats.packets == 0 ||
+			  out_stats.packets == (uint64_t)tx_pkts);
+		CU_ASSERT(out_stats.octets == 0 ||
+			  out_stats.octets == tx_octets);
+	}
+	CU_ASSERT(out_stats.discards == 0);
+	CU_ASSERT(out_stats.errors == 0);
+
+	exact = loop || (odp_pktio_stats(pktio_rx, &stats) == 0 &&
+			 stats.in_octets + stats.in_ucast_pkts != 0);
+
+	CU_ASSERT(odp_pktin_queue_stats(pktin, &in_stats) == 0);
+	if (exact) {
+		CU_ASSERT(in_stats.packets == (uint64_t)pkts);
+		CU_ASSERT(in_stats.octets == rx_octets);
+	} else {
+		CU_ASSERT(in_stats.packets == 0 ||
+			  in_stats.packets == (uint64_t)pkts);
+		CU_ASSERT(in_stats.octets == 0 ||
+			  in_stats.octets == rx_octets);
+	}
+	CU_ASSERT(in_stats.discards == 0);
+	CU_ASSERT(in_stats.errors == 0);
+	CU_ASSERT(in_stats.cls_discards == 0);
+
+	for (i = 0; i < num_ifaces; i++)
+		CU_ASSERT(odp_pktio_stats_reset(pktio[i]) == 0);
+
+	CU_ASSERT(odp_pktin_queue_stats(pktin, &in_stats) == 0);
+	CU_ASSERT(in_stats.packets == 0);
+	CU_ASSERT(odp_pktout_queue_stats(pktout, &out_stats) == 0);
+	CU_ASSERT(out_stats.packets == 0);
+
+	for (i = 0; i < num_ifaces; i++) {
+		CU_ASSERT(odp_pktio_stop(pktio[i]) == 0);
+		flush_input_queue(pktio[i], ODP_PKTIN_MODE_DIRECT);
+		CU_ASSERT(odp_pktio_close(pktio[i]) == 0);
+	}
+}
+
 static void pktio_test_start_stop(void)
 {
 	odp_pktio_t pktio[MAX_NUM_IFACES];
@@ -2012,6 +2140,484 @@ static void pktio_test_pktin_ts(void)
 	}
 }
 
+static int pktio_check_pktin_flow_group(void)
+{
+	odp_pktio_t pktio;
+	odp_pktio_capability_t capa;
+	odp_pktio_param_t pktio_param;
+	int ret;
+
+	odp_pktio_param_init(&pktio_param);
+	pktio_param.in_mode = ODP_PKTIN_MODE_DIRECT;
+
+	pktio = odp_pktio_open(iface_name[0], pool[0], &pktio_param);
+	if (pktio == ODP_PKTIO_INVALID)
+		return ODP_TEST_INACTIVE;
+
+	ret = odp_pktio_capability(pktio, &capa);
+	(void)odp_pktio_close(pktio);
+
+	if (ret < 0 || !capa.config.pktin.bit.flow_group ||
+	    capa.config.parser.layer < ODP_PROTO_LAYER_L4)
+		return ODP_TEST_INACTIVE;
+
+	return ODP_TEST_ACTIVE;
+}
+
+static uint16_t pktio_pkt_udp_src_port(odp_packet_t pkt)
+{
+	odph_udphdr_t *udp = odp_packet_l4_ptr(pkt, NULL);
+
+	CU_ASSERT_FATAL(udp != NULL);
+
+	return odp_be_to_cpu_16(udp->src_port);
+}
+
+static void pktio_test_pktin_flow_group(void)
+{
+	odp_pktio_t pktio_tx, pktio_rx;
+	odp_pktio_t pktio[MAX_NUM_IFACES];
+	odp_pktio_capability_t capa;
+	odp_pktio_config_t config;
+	odp_pktout_queue_t pktout_queue;
+	odp_pktin_queue_t pktin_queue;
+	odp_packet_t pkt_tbl[FLOW_GROUP_NUM_PKTS];
+	odp_packet_t rx_tbl[FLOW_GROUP_NUM_PKTS];
+	uint32_t pkt_seq[FLOW_GROUP_NUM_PKTS];
+	uint32_t last_seq[FLOW_GROUP_NUM_FLOWS];
+	odp_time_t wait_time, end;
+	int num_rx = 0;
+	int ret;
+	int i;
+
+	CU_ASSERT_FATAL(num_ifaces >= 1);
+
+	for (i = 0; i < num_ifaces; ++i) {
+		pktio[i] = create_pktio(i, ODP_PKTIN_MODE_DIRECT,
+					ODP_PKTOUT_MODE_DIRECT);
+		CU_ASSERT_FATAL(pktio[i] != ODP_PKTIO_INVALID);
+
+		CU_ASSERT_FATAL(odp_pktio_capability(pktio[i], &capa) == 0);
+		CU_ASSERT_FATAL(capa.config.pktin.bit.flow_group);
+
+		odp_pktio_config_init(&config);
+		config.parser.layer = ODP_PROTO_LAYER_L4;
+		config.pktin.bit.flow_group = 1;
+		CU_ASSERT_FATAL(odp_pktio_config(pktio[i], &config) == 0);
+
+		CU_ASSERT_FATAL(odp_pktio_start(pktio[i]) == 0);
+	}
+
+	for (i = 0; i < num_ifaces; i++)
+		_pktio_wait_linkup(pktio[i]);
+
+	pktio_tx = pktio[0];
+	pktio_rx = (num_ifaces > 1) ? pktio[1] : pktio_tx;
+
+	/* Interleave packets of different flows */
+	ret = create_packets(pkt_tbl, pkt_seq, FLOW_GROUP_NUM_PKTS, pktio_tx,
+			     pktio_rx);
+	CU_ASSERT_FATAL(ret == FLOW_GROUP_NUM_PKTS);
+
+	for (i = 0; i < FLOW_GROUP_NUM_PKTS; i++) {
+		odph_udphdr_t *udp = odp_packet_l4_ptr(pkt_tbl[i], NULL);
+
+		CU_ASSERT_FATAL(udp != NULL);
+		udp->src_port = odp_cpu_to_be_16(12049 +
+						 i % FLOW_GROUP_NUM_FLOWS);
+		CU_ASSERT_FATAL(pktio_fixup_checksums(pkt_tbl[i]) == 0);
+	}
+
+	CU_ASSERT_FATAL(odp_pktout_queue(pktio_tx, &pktout_queue, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktin_queue(pktio_rx, &pktin_queue, 1) == 1);
+	CU_ASSERT_FATAL(send_packets(pktout_queue, pkt_tbl,
+				     FLOW_GROUP_NUM_PKTS) == 0);
+
+	for (i = 0; i < FLOW_GROUP_NUM_FLOWS; i++)
+		last_seq[i] = TEST_SEQ_INVALID;
+
+	wait_time = odp_time_local_from_ns(ODP_TIME_SEC_IN_NS);
+	end = odp_time_sum(odp_time_local(), wait_time);
+
+	do {
+		int num, j, k;
+		uint16_t port[FLOW_GROUP_NUM_PKTS];
+
+		num = odp_pktin_recv(pktin_queue, rx_tbl,
+				     FLOW_GROUP_NUM_PKTS - num_rx);
+		CU_ASSERT_FATAL(num >= 0);
+
+		for (j = 0; j < num; j++) {
+			uint32_t seq = pktio_pkt_seq(rx_tbl[j]);
+			int flow;
+
+			CU_ASSERT(odp_packet_has_flow_hash(rx_tbl[j]));
+			port[j] = pktio_pkt_udp_src_port(rx_tbl[j]);
+			flow = port[j] - 12049;
+			CU_ASSERT_FATAL(flow >= 0 &&
+					flow < FLOW_GROUP_NUM_FLOWS);
+
+			/* Packet order is maintained within a flow */
+			if (last_seq[flow] != TEST_SEQ_INVALID)
+				CU_ASSERT(seq > last_seq[flow]);
+			last_seq[flow] = seq;
+
+			/* Packets of the same flow are adjacent */
+			if (j > 0 && port[j] != port[j - 1]) {
+				for (k = 0; k < j - 1; k++)
+					CU_ASSERT(port[k] != port[j]);
+			}
+
+			/* Same flow, same hash */
+			if (j > 0 && port[j] == port[j - 1])
+				CU_ASSERT(odp_packet_flow_hash(rx_tbl[j]) ==
+					  odp_packet_flow_hash(rx_tbl[j - 1]));
+		}
+
+		odp_packet_free_multi(rx_tbl, num);
+		num_rx += num;
+	} while (num_rx < FLOW_GROUP_NUM_PKTS &&
+		 odp_time_cmp(end, odp_time_local()) > 0);
+
+	CU_ASSERT(num_rx == FLOW_GROUP_NUM_PKTS);
+
+	for (i = 0; i < num_ifaces; i++) {
+		CU_ASSERT_FATAL(odp_pktio_stop(pktio[i]) == 0);
+		CU_ASSERT_FATAL(odp_pktio_close(pktio[i]) == 0);
+	}
+}
+
+static int pktio_check_pktout_tcp_seg(void)
+{
+	odp_pktio_t pktio;
+	odp_pktio_capability_t capa;
+	odp_pktio_param_t pktio_param;
+	int ret;
+
+	odp_pktio_param_init(&pktio_param);
+	pktio_param.in_mode = ODP_PKTIN_MODE_DIRECT;
+
+	pktio = odp_pktio_open(iface_name[0], pool[0], &pktio_param);
+	if (pktio == ODP_PKTIO_INVALID)
+		return ODP_TEST_INACTIVE;
+
+	ret = odp_pktio_capability(pktio, &capa);
+	(void)odp_pktio_close(pktio);
+
+	if (ret < 0 || !capa.config.pktout.bit.tcp_seg_ena ||
+	    capa.config.parser.layer < ODP_PROTO_LAYER_L4)
+		return ODP_TEST_INACTIVE;
+
+	return ODP_TEST_ACTIVE;
+}
+
+static odp_packet_t pktio_create_tcp_packet(odp_pktio_t pktio_src,
+					    odp_pktio_t pktio_dst)
+{
+	odp_packet_t pkt;
+	odph_tcphdr_t tcp;
+	uint32_t l4_offset = ODPH_ETHHDR_LEN + ODPH_IPV4HDR_LEN;
+	uint8_t data[TCP_SEG_PAYLOAD_LEN];
+	int i;
+
+	pkt = odp_packet_alloc(pool[0], l4_offset + ODPH_TCPHDR_LEN +
+			       TCP_SEG_PAYLOAD_LEN);
+	CU_ASSERT_FATAL(pkt != ODP_PACKET_INVALID);
+
+	pktio_init_packet_eth_ipv4(pkt, ODPH_IPPROTO_TCP);
+	pktio_pkt_set_macs(pkt, pktio_src, pktio_dst);
+
+	memset(&tcp, 0, sizeof(tcp));
+	tcp.src_port = odp_cpu_to_be_16(TCP_SEG_SRC_PORT);
+	tcp.dst_port = odp_cpu_to_be_16(TCP_SEG_DST_PORT);
+	tcp.seq_no = odp_cpu_to_be_32(TCP_SEG_SEQ);
+	tcp.hl = ODPH_TCPHDR_LEN / 4;
+	tcp.ack = 1;
+	tcp.psh = 1;
+	tcp.fin = 1;
+	tcp.window = odp_cpu_to_be_16(0xffff);
+	CU_ASSERT_FATAL(odp_packet_copy_from_mem(pkt, l4_offset, sizeof(tcp),
+						 &tcp) == 0);
+	odp_packet_l4_offset_set(pkt, l4_offset);
+
+	for (i = 0; i < TCP_SEG_PAYLOAD_LEN; i++)
+		data[i] = i;
+
+	CU_ASSERT_FATAL(odp_packet_copy_from_mem(pkt,
+						 l4_offset + ODPH_TCPHDR_LEN,
+						 TCP_SEG_PAYLOAD_LEN,
+						 data) == 0);
+
+	return pkt;
+}
+
+static void pktio_test_pktout_tcp_seg(void)
+{
+	odp_pktio_t pktio_tx, pktio_rx;
+	odp_pktio_t pktio[MAX_NUM_IFACES];
+	odp_pktio_capability_t capa;
+	odp_pktio_config_t config;
+	odp_pktout_queue_t pktout_queue;
+	odp_pktin_queue_t pktin_queue;
+	odp_packet_t pkt;
+	odp_time_t wait_time, end;
+	uint8_t data[TCP_SEG_MSS];
+	uint32_t offset = 0;
+	int num_rx = 0;
+	int i, j;
+
+	CU_ASSERT_FATAL(num_ifaces >= 1);
+
+	for (i = 0; i < num_ifaces; ++i) {
+		pktio[i] = create_pktio(i, ODP_PKTIN_MODE_DIRECT,
+					ODP_PKTOUT_MODE_DIRECT);
+		CU_ASSERT_FATAL(pktio[i] != ODP_PKTIO_INVALID);
+
+		CU_ASSERT_FATAL(odp_pktio_capability(pktio[i], &capa) == 0);
+		CU_ASSERT_FATAL(capa.config.pktout.bit.tcp_seg_ena);
+
+		odp_pktio_config_init(&config);
+		config.parser.layer = ODP_PROTO_LAYER_L4;
+		config.pktout.bit.tcp_seg_ena = 1;
+		CU_ASSERT_FATAL(odp_pktio_config(pktio[i], &config) == 0);
+
+		CU_ASSERT_FATAL(odp_pktio_start(pktio[i]) == 0);
+	}
+
+	for (i = 0; i < num_ifaces; i++)
+		_pktio_wait_linkup(pktio[i]);
+
+	pktio_tx = pktio[0];
+	pktio_rx = (num_ifaces > 1) ? pktio[1] : pktio_tx;
+
+	pkt = pktio_create_tcp_packet(pktio_tx, pktio_rx);
+	CU_ASSERT(odp_packet_tcp_mss(pkt) == 0);
+	odp_packet_tcp_mss_set(pkt, TCP_SEG_MSS);
+	CU_ASSERT(odp_packet_tcp_mss(pkt) == TCP_SEG_MSS);
+
+	CU_ASSERT_FATAL(odp_pktout_queue(pktio_tx, &pktout_queue, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktin_queue(pktio_rx, &pktin_queue, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktout_send(pktout_queue, &pkt, 1) == 1);
+
+	wait_time = odp_time_local_from_ns(ODP_TIME_SEC_IN_NS);
+	end = odp_time_sum(odp_time_local(), wait_time);
+
+	do {
+		odph_ipv4hdr_t *ip;
+		odph_tcphdr_t *tcp;
+		uint32_t len;
+		int last;
+
+		if (odp_pktin_recv(pktin_queue, &pkt, 1) != 1)
+			continue;
+
+		tcp = odp_packet_l4_ptr(pkt, NULL);
+		if (!odp_packet_has_tcp(pkt) || tcp == NULL ||
+		    odp_be_to_cpu_16(tcp->dst_port) != TCP_SEG_DST_PORT) {
+			odp_packet_free(pkt);
+			continue;
+		}
+
+		ip = odp_packet_l3_ptr(pkt, NULL);
+		len = odp_packet_len(pkt) - odp_packet_l4_offset(pkt) -
+		      ODPH_TCPHDR_LEN;
+		last = (num_rx == TCP_SEG_NUM - 1);
+
+		CU_ASSERT(len == (last ? TCP_SEG_PAYLOAD_LEN - offset :
+				  TCP_SEG_MSS));
+		CU_ASSERT(odp_be_to_cpu_16(ip->tot_len) ==
+			  ODPH_IPV4HDR_LEN + ODPH_TCPHDR_LEN + len);
+		CU_ASSERT(odph_ipv4_csum_valid(pkt));
+		CU_ASSERT(odph_tcp_chksum_verify(pkt) == 0);
+		CU_ASSERT(odp_be_to_cpu_32(tcp->seq_no) ==
+			  TCP_SEG_SEQ + offset);
+		CU_ASSERT(tcp->ack == 1);
+		CU_ASSERT(tcp->psh == last);
+		CU_ASSERT(tcp->fin == last);
+
+		if (len > TCP_SEG_MSS)
+			len = TCP_SEG_MSS;
+		CU_ASSERT(odp_packet_copy_to_mem(pkt, odp_packet_l4_offset(pkt) +
+						 ODPH_TCPHDR_LEN, len,
+						 data) == 0);
+		for (j = 0; j < (int)len; j++) {
+			if (data[j] != (uint8_t)(offset + j)) {
+				CU_FAIL("payload mismatch");
+				break;
+			}
+		}
+
+		offset += len;
+		num_rx++;
+		odp_packet_free(pkt);
+	} while (num_rx < TCP_SEG_NUM &&
+		 odp_time_cmp(end, odp_time_local()) > 0);
+
+	CU_ASSERT(num_rx == TCP_SEG_NUM);
+	CU_ASSERT(offset == TCP_SEG_PAYLOAD_LEN);
+
+	for (i = 0; i < num_ifaces; i++) {
+		CU_ASSERT_FATAL(odp_pktio_stop(pktio[i]) == 0);
+		CU_ASSERT_FATAL(odp_pktio_close(pktio[i]) == 0);
+	}
+}
+
+static int pktio_check_pktin_tcp_gro(void)
+{
+	odp_pktio_t pktio;
+	odp_pktio_capability_t capa;
+	odp_pktio_param_t pktio_param;
+	int ret;
+
+	odp_pktio_param_init(&pktio_param);
+	pktio_param.in_mode = ODP_PKTIN_MODE_DIRECT;
+
+	pktio = odp_pktio_open(iface_name[0], pool[0], &pktio_param);
+	if (pktio == ODP_PKTIO_INVALID)
+		return ODP_TEST_INACTIVE;
+
+	ret = odp_pktio_capability(pktio, &capa);
+	(void)odp_pktio_close(pktio);
+
+	if (ret < 0 || !capa.config.pktin.bit.tcp_gro ||
+	    !capa.config.pktout.bit.tcp_seg_ena ||
+	    capa.config.parser.layer < ODP_PROTO_LAYER_L4)
+		return ODP_TEST_INACTIVE;
+
+	return ODP_TEST_ACTIVE;
+}
+
+static void pktio_test_pktin_tcp_gro(void)
+{
+	odp_pktio_t pktio_tx, pktio_rx;
+	odp_pktio_t pktio[MAX_NUM_IFACES];
+	odp_pktio_config_t config;
+	odp_pktout_queue_t pktout_queue;
+	odp_pktin_queue_t pktin_queue;
+	odp_pktin_gro_stats_t stats;
+	odp_packet_t pkt;
+	odp_packet_t rx_tbl[TCP_SEG_NUM];
+	odph_tcphdr_t *tcp;
+	odp_time_t wait_time, end;
+	uint8_t data[TCP_SEG_PAYLOAD_LEN];
+	uint32_t offset = 0;
+	int num_rx = 0;
+	int i, j;
+
+	CU_ASSERT_FATAL(num_ifaces >= 1);
+
+	for (i = 0; i < num_ifaces; ++i) {
+		pktio[i] = create_pktio(i, ODP_PKTIN_MODE_DIRECT,
+					ODP_PKTOUT_MODE_DIRECT);
+		CU_ASSERT_FATAL(pktio[i] != ODP_PKTIO_INVALID);
+
+		odp_pktio_config_init(&config);
+		config.parser.layer = ODP_PROTO_LAYER_L4;
+		config.pktin.bit.tcp_gro = 1;
+		config.pktout.bit.tcp_seg_ena = 1;
+		CU_ASSERT_FATAL(odp_pktio_config(pktio[i], &config) == 0);
+
+		CU_ASSERT_FATAL(odp_pktio_start(pktio[i]) == 0);
+	}
+
+	for (i = 0; i < num_ifaces; i++)
+		_pktio_wait_linkup(pktio[i]);
+
+	pktio_tx = pktio[0];
+	pktio_rx = (num_ifaces > 1) ? pktio[1] : pktio_tx;
+
+	/* Segments are sent in one burst. Only the last one has PSH set. */
+	pkt = pktio_create_tcp_packet(pktio_tx, pktio_rx);
+	tcp = odp_packet_l4_ptr(pkt, NULL);
+	CU_ASSERT_FATAL(tcp != NULL);
+	tcp->fin = 0;
+	odp_packet_tcp_mss_set(pkt, TCP_SEG_MSS);
+
+	CU_ASSERT_FATAL(odp_pktout_queue(pktio_tx, &pktout_queue, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktin_queue(pktio_rx, &pktin_queue, 1) == 1);
+	CU_ASSERT_FATAL(odp_pktout_send(pktout_queue, &pkt, 1) == 1);
+
+	wait_time = odp_time_local_from_ns(ODP_TIME_SEC_IN_NS);
+	end = odp_time_sum(odp_time_local(), wait_time);
+
+	do {
+		odph_ipv4hdr_t *ip;
+		uint32_t len;
+		int num;
+
+		num = odp_pktin_recv(pktin_queue, rx_tbl, TCP_SEG_NUM);
+		CU_ASSERT_FATAL(num >= 0);
+
+		for (i = 0; i < num; i++) {
+			pkt = rx_tbl[i];
+			tcp = odp_packet_l4_ptr(pkt, NULL);
+			if (!odp_packet_has_tcp(pkt) || tcp == NULL ||
+			    odp_be_to_cpu_16(tcp->dst_port) !=
+			    TCP_SEG_DST_PORT) {
+				odp_packet_free(pkt);
+				continue;
+			}
+
+			ip = odp_packet_l3_ptr(pkt, NULL);
+			len = odp_packet_len(pkt) - odp_packet_l4_offset(pkt) -
+			      ODPH_TCPHDR_LEN;
+
+			CU_ASSERT(len > 0 &&
+				  offset + len <= TCP_SEG_PAYLOAD_LEN);
+			CU_ASSERT(odp_be_to_cpu_16(ip->tot_len) ==
+				  ODPH_IPV4HDR_LEN + ODPH_TCPHDR_LEN + len);
+			CU_ASSERT(odph_ipv4_csum_valid(pkt));
+			CU_ASSERT(odph_tcp_chksum_verify(pkt) == 0);
+			CU_ASSERT(odp_be_to_cpu_32(tcp->seq_no) ==
+				  TCP_SEG_SEQ + offset);
+			CU_ASSERT(tcp->ack == 1);
+			CU_ASSERT(tcp->psh ==
+				  (offset + len == TCP_SEG_PAYLOAD_LEN));
+
+			/* Merged packets can be segmented again */
+			if (len > TCP_SEG_MSS)
+				CU_ASSERT(odp_packet_tcp_mss(pkt) ==
+					  TCP_SEG_MSS);
+
+			if (len > TCP_SEG_PAYLOAD_LEN - offset)
+				len = TCP_SEG_PAYLOAD_LEN - offset;
+			CU_ASSERT(odp_packet_copy_to_mem(pkt,
+							 odp_packet_l4_offset(pkt) +
+							 ODPH_TCPHDR_LEN, len,
+							 data) == 0);
+			for (j = 0; j < (int)len; j++) {
+				if (data[j] != (uint8_t)(offset + j)) {
+					CU_FAIL("payload mismatch");
+					break;
+				}
+			}
+
+			offset += len;
+			num_rx++;
+			odp_packet_free(pkt);
+		}
+	} while (offset < TCP_SEG_PAYLOAD_LEN &&
+		 odp_time_cmp(end, odp_time_local()) > 0);
+
+	CU_ASSERT(offset == TCP_SEG_PAYLOAD_LEN);
+	CU_ASSERT(num_rx >= 1 && num_rx <= TCP_SEG_NUM);
+
+	/* Each merged packet replaces merged_segs / merged_pkts segments */
+	CU_ASSERT_FATAL(odp_pktin_gro_stats(pktin_queue, &stats) == 0);
+	CU_ASSERT(stats.merged_segs - stats.merged_pkts ==
+		  (uint64_t)(TCP_SEG_NUM - num_rx));
+
+	(void)odp_pktio_stats_reset(pktio_rx);
+	CU_ASSERT_FATAL(odp_pktin_gro_stats(pktin_queue, &stats) == 0);
+	CU_ASSERT(stats.merged_pkts == 0);
+	CU_ASSERT(stats.merged_segs == 0);
+
+	for (i = 0; i < num_ifaces; i++) {
+		CU_ASSERT_FATAL(odp_pktio_stop(pktio[i]) == 0);
+		CU_ASSERT_FATAL(odp_pktio_close(pktio[i]) == 0);
+	}
+}
+
 static void pktio_test_chksum(void (*config_fn)(odp_pktio_t, odp_pktio_t),
 			      void (*prep_fn)(odp_packet_t pkt),
 			      void (*test_fn)(odp_packet_t pkt))
@@ -2817,8 +3423,16 @@ odp_testinfo_t pktio_suite_unsegmented[] = {
 	ODP_TEST_INFO(pktio_test_recv_multi_event),
 	ODP_TEST_INFO_CONDITIONAL(pktio_test_statistics_counters,
 				  pktio_check_statistics_counters),
+	ODP_TEST_INFO_CONDITIONAL(pktio_test_queue_statistics,
+				  pktio_check_statistics_counters),
 	ODP_TEST_INFO_CONDITIONAL(pktio_test_pktin_ts,
 				  pktio_check_pktin_ts),
+	ODP_TEST_INFO_CONDITIONAL(pktio_test_pktin_flow_group,
+				  pktio_check_pktin_flow_group),
+	ODP_TEST_INFO_CONDITIONAL(pktio_test_pktout_tcp_seg,
+				  pktio_check_pktout_tcp_seg),
+	ODP_TEST_INFO_CONDITIONAL(pktio_test_pktin_tcp_gro,
+				  pktio_check_pktin_tcp_gro),
 	ODP_TEST_INFO_CONDITIONAL(pktio_test_chksum_in_ipv4,
 				  pktio_check_chksum_in_ipv4),
 	ODP_TEST_INFO_CONDITIONAL(pktio_test_chksum_in_udp,
@@ -1106,6 +1106,39 @@ static uint32_t send_pkts(odp_tm_queue_t tm_queue, uint32_t num_pkts)
 	return pkts_sent;
 }
 
+static uint32_t send_pkts_multi(odp_tm_queue_t tm_queue, uint32_t num_pkts)
+{
+	xmt_pkt_desc_t *xmt_pkt_desc;
+	odp_time_t      xmt_time;
+	uint32_t        idx, xmt_pkt_idx, pkts_sent;
+	int             rc;
+
+	/* Send all pkts with a single call. */
+	xmt_pkt_idx = num_pkts_sent;
+	xmt_time    = odp_time_local();
+	rc = odp_tm_enq_multi(tm_queue, &xmt_pkts[xmt_pkt_idx], num_pkts);
+	CU_ASSERT(rc <= (int)num_pkts);
+	pkts_sent = rc < 0 ? 0 : rc;
+
+	for (idx = 0; idx < num_pkts; idx++) {
+		xmt_pkt_idx  = num_pkts_sent;
+		xmt_pkt_desc = &xmt_pkt_descs[xmt_pkt_idx];
+
+		xmt_pkt_desc->xmt_idx = xmt_pkt_idx;
+		if (idx < pkts_sent) {
+			xmt_pkt_desc->xmt_time = xmt_time;
+			xmt_pkt_desc->tm_queue = tm_queue;
+		} else {
+			odp_packet_free(xmt_pkts[xmt_pkt_idx]);
+			xmt_pkts[xmt_pkt_idx] = ODP_PACKET_INVALID;
+		}
+
+		num_pkts_sent++;
+	}
+
+	return pkts_sent;
+}
+
 static uint32_t pkts_rcvd_in_send_order(void)
 {
 	xmt_pkt_desc_t *xmt_pkt_desc;
@@ -3299,6 +3332,40 @@ static int test_query_functions(const char *shaper_name,
 	return 0;
 }
 
+static int test_enq_multi(const char *shaper_name,
+			  const char *node_name,
+			  uint8_t     priority,
+			  uint32_t    num_pkts)
+{
+	odp_tm_queue_t tm_queue;
+	pkt_info_t     pkt_info;
+	uint32_t       pkts_sent;
+
+	/* Pick a tm_queue and disable the shaper of its node. Then send all
+	 * pkts with one odp_tm_enq_multi() call and check that they all come
+	 * out in order. */
+	tm_queue = find_tm_queue(0, node_name, priority);
+	if (set_shaper(node_name, shaper_name, 0, 0) != 0)
+		return -1;
+
+	init_xmt_pkts(&pkt_info);
+	pkt_info.pkt_class = 1;
+	if (make_pkts(num_pkts, 128, &pkt_info) != 0)
+		return -1;
+
+	pkts_sent = send_pkts_multi(tm_queue, num_pkts);
+	CU_ASSERT(pkts_sent == num_pkts);
+
+	num_rcv_pkts = receive_pkts(odp_tm_systems[0], rcv_pktin, pkts_sent,
+				    1 * GBPS);
+	CU_ASSERT(num_rcv_pkts == pkts_sent);
+	CU_ASSERT(pkts_rcvd_in_send_order() == pkts_sent);
+
+	flush_leftover_pkts(odp_tm_systems[0], rcv_pktin);
+	CU_ASSERT(odp_tm_is_idle(odp_tm_systems[0]));
+	return 0;
+}
+
 static int check_vlan_marking_pkts(void)
 {
 	odp_packet_t rcv_pkt;
@@ -3967,6 +4034,12 @@ static void traffic_mngr_test_query(void)
 		  == 0);
 }
 
+static void traffic_mngr_test_enq_multi(void)
+{
+	CU_ASSERT(test_enq_multi("enq_multi_shaper", "node_1_3_3", 0, 32)
+		  == 0);
+}
+
 static void traffic_mngr_test_marking(void)
 {
 	odp_packet_color_t color;
@@ -4043,6 +4116,7 @@ odp_testinfo_t traffic_mngr_suite[] = {
 	ODP_TEST_INFO(traffic_mngr_test_byte_wred),
 	ODP_TEST_INFO(traffic_mngr_test_pkt_wred),
 	ODP_TEST_INFO(traffic_mngr_test_query),
+	ODP_TEST_INFO(traffic_mngr_test_enq_multi),
 	ODP_TEST_INFO(traffic_mngr_test_marking),
 	ODP_TEST_INFO(traffic_mngr_test_fanin_info),
 	ODP_TEST_INFO(traffic_mngr_test_destroy),